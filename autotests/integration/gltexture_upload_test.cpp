@@ -0,0 +1,198 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwin_wayland_test.h"
+
+#include "composite.h"
+#include "effectloader.h"
+#include "platform.h"
+#include "scene.h"
+#include "wayland_server.h"
+
+#include "effect_builtins.h"
+
+#include <kwingltexture.h>
+
+namespace KWin
+{
+
+static const QString s_socketName = QStringLiteral("wayland_test_kwin_gltexture_upload-0");
+
+class GLTextureUploadTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+
+    void testUpload();
+    void testManyUploadsInOneFrame();
+    void benchmarkUpload_data();
+    void benchmarkUpload();
+};
+
+static QImage createImage(const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    return image;
+}
+
+static QColor texturePixel(const GLTexture &texture, const QPoint &pos)
+{
+    return texture.toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied).pixelColor(pos);
+}
+
+void GLTextureUploadTest::initTestCase()
+{
+    QSignalSpy applicationStartedSpy(kwinApp(), &Application::started);
+    QVERIFY(applicationStartedSpy.isValid());
+    kwinApp()->platform()->setInitialWindowSize(QSize(1280, 1024));
+    QVERIFY(waylandServer()->init(s_socketName));
+
+    auto config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    KConfigGroup plugins(config, QStringLiteral("Plugins"));
+    ScriptedEffectLoader loader;
+    const auto builtinNames = BuiltInEffects::availableEffectNames() << loader.listOfKnownEffects();
+    for (const QString &name : builtinNames) {
+        plugins.writeEntry(name + QStringLiteral("Enabled"), false);
+    }
+    config->sync();
+    kwinApp()->setConfig(config);
+
+    qputenv("KWIN_COMPOSE", QByteArrayLiteral("O2"));
+
+    kwinApp()->start();
+    QVERIFY(applicationStartedSpy.wait());
+
+    auto scene = Compositor::self()->scene();
+    QVERIFY(scene);
+    QCOMPARE(scene->compositingType(), OpenGLCompositing);
+}
+
+void GLTextureUploadTest::init()
+{
+    QVERIFY(Compositor::self()->scene()->makeOpenGLContextCurrent());
+    GLTexture::resetUploadStatistics();
+}
+
+void GLTextureUploadTest::cleanup()
+{
+    Compositor::self()->scene()->doneOpenGLContextCurrent();
+}
+
+void GLTextureUploadTest::testUpload()
+{
+    // only the damaged rectangles of the image end up in the texture
+    GLTexture texture(GL_RGBA8, QSize(64, 64));
+    texture.update(createImage(QSize(64, 64), Qt::red), QRegion(0, 0, 64, 64));
+    texture.update(createImage(QSize(64, 64), Qt::blue), QRegion(0, 0, 16, 16) | QRegion(32, 32, 8, 8));
+
+    QCOMPARE(texturePixel(texture, QPoint(0, 0)), QColor(Qt::blue));
+    QCOMPARE(texturePixel(texture, QPoint(35, 35)), QColor(Qt::blue));
+    QCOMPARE(texturePixel(texture, QPoint(20, 20)), QColor(Qt::red));
+    QCOMPARE(texturePixel(texture, QPoint(63, 63)), QColor(Qt::red));
+
+    const GLTexture::UploadStatistics statistics = GLTexture::uploadStatistics();
+    QCOMPARE(statistics.uploadedBytes, qint64(64 * 64 + 16 * 16 + 8 * 8) * 4);
+    if (GLTexture::supportsStreamingUploads()) {
+        QCOMPARE(statistics.streamedBytes, statistics.uploadedBytes);
+        QCOMPARE(statistics.fallbacks, 0);
+    } else {
+        QCOMPARE(statistics.streamedBytes, qint64(0));
+    }
+}
+
+void GLTextureUploadTest::testManyUploadsInOneFrame()
+{
+    if (!GLTexture::supportsStreamingUploads()) {
+        QSKIP("Streaming texture uploads are not supported");
+    }
+
+    // more textures are updated than the ring can hold, without the GPU catching up in between
+    const QSize size(512, 512);
+    const qint64 imageSize = qint64(size.width()) * size.height() * 4;
+    const int count = 64;
+    QVector<GLTexture *> textures;
+    for (int i = 0; i < count; ++i) {
+        GLTexture *texture = new GLTexture(GL_RGBA8, size);
+        texture->update(createImage(size, QColor(i * 4, 0, 255 - i * 4)), QRegion(QRect(QPoint(0, 0), size)));
+        textures.append(texture);
+    }
+
+    // none of the uploads has waited for a pixel buffer, the ones that found no free buffer
+    // went the direct way
+    const GLTexture::UploadStatistics statistics = GLTexture::uploadStatistics();
+    QCOMPARE(statistics.uploadedBytes, imageSize * count);
+    QVERIFY(statistics.streamedBytes > 0);
+    QCOMPARE(statistics.streamedBytes / imageSize + statistics.fallbacks, qint64(count));
+    QVERIFY(statistics.pixelBuffers > 0);
+    QVERIFY(statistics.pixelBuffers <= 16);
+
+    for (int i = 0; i < count; ++i) {
+        QCOMPARE(texturePixel(*textures[i], QPoint(100, 100)), QColor(i * 4, 0, 255 - i * 4));
+    }
+    qDeleteAll(textures);
+
+    // once the GPU has read the buffers, they are used again instead of adding more
+    glFinish();
+    const int pixelBuffers = statistics.pixelBuffers;
+    GLTexture::resetUploadStatistics();
+    GLTexture texture(GL_RGBA8, size);
+    texture.update(createImage(size, Qt::green), QRegion(QRect(QPoint(0, 0), size)));
+    QCOMPARE(GLTexture::uploadStatistics().streamedBytes, imageSize);
+    QCOMPARE(GLTexture::uploadStatistics().pixelBuffers, pixelBuffers);
+}
+
+void GLTextureUploadTest::benchmarkUpload_data()
+{
+    QTest::addColumn<bool>("streamed");
+    QTest::addColumn<int>("textureCount");
+
+    QTest::newRow("direct, 4 textures") << false << 4;
+    QTest::newRow("streamed, 4 textures") << true << 4;
+    QTest::newRow("direct, 32 textures") << false << 32;
+    QTest::newRow("streamed, 32 textures") << true << 32;
+}
+
+void GLTextureUploadTest::benchmarkUpload()
+{
+    // a frame in which many windows have been repainted completely
+    QFETCH(bool, streamed);
+    QFETCH(int, textureCount);
+    if (streamed && !GLTexture::supportsStreamingUploads()) {
+        QSKIP("Streaming texture uploads are not supported");
+    }
+
+    const QSize size(1024, 768);
+    const QImage image = createImage(size, Qt::darkCyan);
+    QVector<GLTexture *> textures;
+    for (int i = 0; i < textureCount; ++i) {
+        textures.append(new GLTexture(GL_RGBA8, size));
+    }
+
+    QBENCHMARK {
+        for (GLTexture *texture : qAsConst(textures)) {
+            if (streamed) {
+                texture->update(image, QRegion(image.rect()));
+            } else {
+                texture->update(image);
+            }
+        }
+        glFinish();
+    }
+    qDeleteAll(textures);
+}
+
+} // namespace KWin
+
+WAYLANDTEST_MAIN(KWin::GLTextureUploadTest)
+#include "gltexture_upload_test.moc"
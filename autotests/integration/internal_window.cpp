@@ -67,6 +67,8 @@ private Q_SLOTS:
     void testEffectWindow();
     void testReentrantMoveResize();
     void testDismissPopup();
+    void testPartialRepaint();
+    void testShowAgainWhileClosing();
 };
 
 class HelperWindow : public QRasterWindow
@@ -82,6 +84,9 @@ public:
     Qt::MouseButtons pressedButtons() const {
         return m_pressedButtons;
     }
+    void setColor(const QColor &color) {
+        m_color = color;
+    }
 
 Q_SIGNALS:
     void entered();
@@ -106,6 +111,7 @@ protected:
 private:
     QPoint m_latestGlobalMousePos;
     Qt::MouseButtons m_pressedButtons = Qt::MouseButtons();
+    QColor m_color = Qt::red;
 };
 
 HelperWindow::HelperWindow()
@@ -120,7 +126,7 @@ void HelperWindow::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
     QPainter p(this);
-    p.fillRect(0, 0, width(), height(), Qt::red);
+    p.fillRect(0, 0, width(), height(), m_color);
 }
 
 bool HelperWindow::event(QEvent *event)
@@ -854,6 +860,74 @@ void InternalWindowTest::testDismissPopup()
     QTRY_COMPARE(popupClosedSpy.count(), 1);
 }
 
+void InternalWindowTest::testPartialRepaint()
+{
+    // This test verifies that a repaint of an internal window damages only the repainted
+    // region, and that the pixels are presented without being copied.
+    QSignalSpy clientAddedSpy(workspace(), &Workspace::internalClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    HelperWindow win;
+    win.setGeometry(0, 0, 100, 100);
+    win.show();
+    QTRY_COMPARE(clientAddedSpy.count(), 1);
+    auto internalClient = clientAddedSpy.first().first().value<InternalClient *>();
+    QVERIFY(internalClient);
+    QTRY_VERIFY(!internalClient->internalImageObject().isNull());
+    const uchar *bits = internalClient->internalImageObject().constBits();
+
+    QSignalSpy damagedSpy(internalClient, &Toplevel::damaged);
+    QVERIFY(damagedSpy.isValid());
+    win.setColor(Qt::blue);
+    win.update(QRect(10, 10, 20, 20));
+    QVERIFY(damagedSpy.wait());
+    QCOMPARE(damagedSpy.count(), 1);
+    QCOMPARE(damagedSpy.first().at(1).value<QRegion>(), QRegion(10, 10, 20, 20));
+
+    const QImage image = internalClient->internalImageObject();
+    QCOMPARE(image.constBits(), bits);
+    QCOMPARE(image.pixelColor(15, 15), QColor(Qt::blue));
+    QCOMPARE(image.pixelColor(50, 50), QColor(Qt::red));
+}
+
+void InternalWindowTest::testShowAgainWhileClosing()
+{
+    // This test verifies that an internal window that is shown again while the compositor
+    // still holds the buffer of its previous client paints into a copy of the buffer, so the
+    // closing animation keeps showing the old contents.
+    QSignalSpy clientAddedSpy(workspace(), &Workspace::internalClientAdded);
+    QVERIFY(clientAddedSpy.isValid());
+    HelperWindow win;
+    win.setGeometry(0, 0, 100, 100);
+    win.show();
+    QTRY_COMPARE(clientAddedSpy.count(), 1);
+    auto internalClient = clientAddedSpy.first().first().value<InternalClient *>();
+    QVERIFY(internalClient);
+    QTRY_VERIFY(!internalClient->internalImageObject().isNull());
+
+    // keep the Deleted alive, as a closing animation would
+    Deleted *deleted = nullptr;
+    connect(internalClient, &Toplevel::windowClosed, this, [&deleted](Toplevel *toplevel, Deleted *closed) {
+        Q_UNUSED(toplevel)
+        closed->refWindow();
+        deleted = closed;
+    });
+    win.hide();
+    QTRY_VERIFY(deleted);
+    const QImage closingImage = deleted->internalImageObject().copy();
+    QCOMPARE(closingImage.pixelColor(50, 50), QColor(Qt::red));
+
+    win.setColor(Qt::blue);
+    win.show();
+    QTRY_COMPARE(clientAddedSpy.count(), 2);
+    auto shownAgain = clientAddedSpy.last().first().value<InternalClient *>();
+    QVERIFY(shownAgain);
+    QTRY_COMPARE(shownAgain->internalImageObject().pixelColor(50, 50), QColor(Qt::blue));
+
+    QVERIFY(shownAgain->internalImageObject().constBits() != deleted->internalImageObject().constBits());
+    QCOMPARE(deleted->internalImageObject(), closingImage);
+    deleted->unrefWindow();
+}
+
 }
 
 WAYLANDTEST_MAIN(KWin::InternalWindowTest)
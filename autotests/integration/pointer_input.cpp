@@ -121,6 +121,9 @@ private Q_SLOTS:
     void testHideShowCursor();
     void testDefaultInputRegion();
     void testEmptyInputRegion();
+    void testMotionCoalescing();
+    void benchmarkMotion_data();
+    void benchmarkMotion();
 
 private:
     void render(KWayland::Client::Surface *surface, const QSize &size = QSize(100, 50));
@@ -1717,6 +1720,105 @@ void PointerInputTest::testEmptyInputRegion()
     QVERIFY(Test::waitForWindowDestroyed(client));
 }
 
+void PointerInputTest::testMotionCoalescing()
+{
+    // this test verifies that coalesced motion events are processed once per frame
+    using namespace KWayland::Client;
+    auto pointer = m_seat->createPointer(m_seat);
+    QVERIFY(pointer);
+    QVERIFY(pointer->isValid());
+    QSignalSpy movedSpy(pointer, &Pointer::motion);
+    QVERIFY(movedSpy.isValid());
+
+    // create a window
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QVERIFY(!surface.isNull());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    QVERIFY(!shellSurface.isNull());
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(100, 50), Qt::blue);
+    QVERIFY(client);
+    const QPointF origin = client->frameGeometry().topLeft();
+
+    quint32 timestamp = 1;
+    kwinApp()->platform()->pointerMotion(origin + QPointF(25, 25), timestamp++);
+    QTRY_COMPARE(pointer->enteredSurface(), surface.data());
+
+    PointerInputRedirection *pointerRedirection = input()->pointer();
+    pointerRedirection->setMotionCoalescingEnabled(true);
+    const quint64 coalescedMotionEvents = pointerRedirection->coalescedMotionEvents();
+    QSignalSpy globalPointerChangedSpy(input(), &InputRedirection::globalPointerChanged);
+    QVERIFY(globalPointerChangedSpy.isValid());
+
+    // the motion is not processed before the next frame
+    for (int i = 1; i <= 8; ++i) {
+        kwinApp()->platform()->pointerMotion(origin + QPointF(25 + i, 25), timestamp++);
+    }
+    QCOMPARE(input()->globalPointer(), origin + QPointF(25, 25));
+    QCOMPARE(pointerRedirection->queuedPos(), origin + QPointF(33, 25));
+    QTRY_COMPARE(input()->globalPointer(), origin + QPointF(33, 25));
+    QCOMPARE(globalPointerChangedSpy.count(), 1);
+    QTRY_VERIFY(!movedSpy.isEmpty() && movedSpy.last().first().toPointF() == QPointF(33, 25));
+    QCOMPARE(pointerRedirection->coalescedMotionEvents(), coalescedMotionEvents + 7);
+
+    // a button press processes the queued motion first
+    kwinApp()->platform()->pointerMotion(origin + QPointF(40, 25), timestamp++);
+    kwinApp()->platform()->pointerButtonPressed(BTN_LEFT, timestamp++);
+    QCOMPARE(input()->globalPointer(), origin + QPointF(40, 25));
+    kwinApp()->platform()->pointerButtonReleased(BTN_LEFT, timestamp++);
+
+    // disabling the coalescing processes the motion right away
+    kwinApp()->platform()->pointerMotion(origin + QPointF(50, 25), timestamp++);
+    pointerRedirection->setMotionCoalescingEnabled(false);
+    QCOMPARE(input()->globalPointer(), origin + QPointF(50, 25));
+    kwinApp()->platform()->pointerMotion(origin + QPointF(60, 25), timestamp++);
+    QCOMPARE(input()->globalPointer(), origin + QPointF(60, 25));
+
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
+void PointerInputTest::benchmarkMotion_data()
+{
+    QTest::addColumn<bool>("coalescing");
+
+    QTest::newRow("immediate") << false;
+    QTest::newRow("coalesced") << true;
+}
+
+void PointerInputTest::benchmarkMotion()
+{
+    // the motion events of an 8 kHz mouse during one frame of a 60 Hz output
+    QFETCH(bool, coalescing);
+    static const int eventsPerFrame = 8000 / 60;
+
+    using namespace KWayland::Client;
+    auto pointer = m_seat->createPointer(m_seat);
+    QVERIFY(pointer);
+    QVERIFY(pointer->isValid());
+    QScopedPointer<Surface> surface(Test::createSurface());
+    QVERIFY(!surface.isNull());
+    QScopedPointer<Test::XdgToplevel> shellSurface(Test::createXdgToplevelSurface(surface.data()));
+    QVERIFY(!shellSurface.isNull());
+    AbstractClient *client = Test::renderAndWaitForShown(surface.data(), QSize(800, 600), Qt::blue);
+    QVERIFY(client);
+
+    PointerInputRedirection *pointerRedirection = input()->pointer();
+    pointerRedirection->setMotionCoalescingEnabled(coalescing);
+
+    const QPoint center = client->frameGeometry().center();
+    quint32 timestamp = 1;
+    QBENCHMARK {
+        for (int i = 0; i < eventsPerFrame; ++i) {
+            kwinApp()->platform()->pointerMotion(center + QPointF(i % 100, i % 50), timestamp++);
+        }
+        pointerRedirection->processQueuedMotion();
+    }
+
+    pointerRedirection->setMotionCoalescingEnabled(false);
+    shellSurface.reset();
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
 }
 
 WAYLANDTEST_MAIN(KWin::PointerInputTest)
@@ -51,6 +51,9 @@ private Q_SLOTS:
     void testFullscreenWindowGroups();
     void testActivateFocusedWindow();
     void testReentrantMoveResize();
+    void testFindClientByWindowIds();
+    void benchmarkPropertyNotify_data();
+    void benchmarkPropertyNotify();
 };
 
 void X11ClientTest::initTestCase()
@@ -1107,5 +1110,122 @@ void X11ClientTest::testReentrantMoveResize()
     QVERIFY(Test::waitForWindowDestroyed(client));
 }
 
+static xcb_window_t createX11Window(xcb_connection_t *c, const QRect &geometry)
+{
+    xcb_window_t w = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, w, rootWindow(),
+                      geometry.x(),
+                      geometry.y(),
+                      geometry.width(),
+                      geometry.height(),
+                      0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+    xcb_size_hints_t hints;
+    memset(&hints, 0, sizeof(hints));
+    xcb_icccm_size_hints_set_position(&hints, 1, geometry.x(), geometry.y());
+    xcb_icccm_size_hints_set_size(&hints, 1, geometry.width(), geometry.height());
+    xcb_icccm_set_wm_normal_hints(c, w, &hints);
+    xcb_map_window(c, w);
+    return w;
+}
+
+void X11ClientTest::testFindClientByWindowIds()
+{
+    // this test verifies that a managed client is found by each of its windows
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+    const xcb_window_t w = createX11Window(c.data(), QRect(0, 0, 100, 200));
+    xcb_flush(c.data());
+    QVERIFY(windowCreatedSpy.wait());
+    X11Client *client = windowCreatedSpy.first().first().value<X11Client *>();
+    QVERIFY(client);
+    QCOMPARE(client->window(), w);
+
+    QCOMPARE(workspace()->findClient(Predicate::WindowMatch, w), client);
+    QCOMPARE(workspace()->findClient(Predicate::WrapperIdMatch, client->wrapperId()), client);
+    QCOMPARE(workspace()->findClient(Predicate::FrameIdMatch, client->frameId()), client);
+    if (client->inputId() != XCB_WINDOW_NONE) {
+        QCOMPARE(workspace()->findClient(Predicate::InputIdMatch, client->inputId()), client);
+    }
+    QCOMPARE(workspace()->findClient(Predicate::InputIdMatch, XCB_WINDOW_NONE), nullptr);
+    QCOMPARE(workspace()->findClient(Predicate::FrameIdMatch, w), nullptr);
+
+    // the input window goes away together with the decoration
+    const xcb_window_t inputId = client->inputId();
+    client->setNoBorder(true);
+    QCOMPARE(client->inputId(), XCB_WINDOW_NONE);
+    if (inputId != XCB_WINDOW_NONE) {
+        QCOMPARE(workspace()->findClient(Predicate::InputIdMatch, inputId), nullptr);
+    }
+    QCOMPARE(workspace()->findClient(Predicate::WindowMatch, w), client);
+
+    // and nothing is found after the window is closed
+    const xcb_window_t frameId = client->frameId();
+    QSignalSpy windowClosedSpy(client, &X11Client::windowClosed);
+    QVERIFY(windowClosedSpy.isValid());
+    xcb_unmap_window(c.data(), w);
+    xcb_flush(c.data());
+    QVERIFY(windowClosedSpy.wait());
+    QCOMPARE(workspace()->findClient(Predicate::WindowMatch, w), nullptr);
+    QCOMPARE(workspace()->findClient(Predicate::FrameIdMatch, frameId), nullptr);
+    xcb_destroy_window(c.data(), w);
+    c.reset();
+}
+
+void X11ClientTest::benchmarkPropertyNotify_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void X11ClientTest::benchmarkPropertyNotify()
+{
+    // this benchmark replays property notify events for many managed windows, every event
+    // looks up the client of its window, the time per event must not depend on the count
+    QFETCH(int, count);
+    QScopedPointer<xcb_connection_t, XcbConnectionDeleter> c(xcb_connect(nullptr, nullptr));
+    QVERIFY(!xcb_connection_has_error(c.data()));
+    QSignalSpy windowCreatedSpy(workspace(), &Workspace::clientAdded);
+    QVERIFY(windowCreatedSpy.isValid());
+
+    QVector<xcb_window_t> windows;
+    for (int i = 0; i < count; ++i) {
+        windows << createX11Window(c.data(), QRect(i % 100, i % 100, 100, 100));
+    }
+    xcb_flush(c.data());
+    QTRY_COMPARE_WITH_TIMEOUT(windowCreatedSpy.count(), count, 60000);
+
+    // the frame windows are looked up after the client windows
+    QVector<xcb_property_notify_event_t> events;
+    for (int i = 0; i < 1000; ++i) {
+        X11Client *client = windowCreatedSpy.at((i * 7) % count).first().value<X11Client *>();
+        xcb_property_notify_event_t event;
+        memset(&event, 0, sizeof(event));
+        event.response_type = XCB_PROPERTY_NOTIFY;
+        event.window = (i % 2) ? client->frameId() : client->window();
+        event.atom = atoms->kde_net_wm_user_creation_time;
+        event.state = XCB_PROPERTY_NEW_VALUE;
+        events << event;
+    }
+
+    QBENCHMARK {
+        for (xcb_property_notify_event_t &event : events) {
+            workspace()->workspaceEvent(reinterpret_cast<xcb_generic_event_t *>(&event));
+        }
+    }
+
+    for (xcb_window_t w : qAsConst(windows)) {
+        xcb_unmap_window(c.data(), w);
+        xcb_destroy_window(c.data(), w);
+    }
+    xcb_flush(c.data());
+    QTRY_VERIFY_WITH_TIMEOUT(workspace()->clientList().isEmpty(), 60000);
+    c.reset();
+}
+
 WAYLANDTEST_MAIN(X11ClientTest)
 #include "x11_client_test.moc"
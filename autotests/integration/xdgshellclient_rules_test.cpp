@@ -130,6 +130,9 @@ private Q_SLOTS:
     void testInactiveOpacityForceTemporarily();
 
     void testMatchAfterNameChange();
+    void testMatchAfterTitleChange();
+    void benchmarkTitleChange_data();
+    void benchmarkTitleChange();
 };
 
 void TestXdgShellClientRules::initTestCase()
@@ -4288,5 +4291,116 @@ void TestXdgShellClientRules::testMatchAfterNameChange()
     QCOMPARE(c->keepAbove(), true);
 }
 
+static KSharedConfig::Ptr createTitleRules(int count)
+{
+    // Creates a rule that keeps org.kde.foo above once its build is done, and @p count rules
+    // for other applications, some of which match every window by its title.
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QString(), KConfig::SimpleConfig);
+    config->group("General").writeEntry("count", count + 1);
+
+    for (int i = 1; i <= count; ++i) {
+        KConfigGroup group = config->group(QString::number(i));
+        group.writeEntry("below", true);
+        group.writeEntry("belowrule", int(Rules::Force));
+        if (i % 10 == 0) {
+            group.writeEntry("title", QStringLiteral("^Terminal %1 - .*$").arg(i));
+            group.writeEntry("titlematch", int(Rules::RegExpMatch));
+        } else {
+            group.writeEntry("wmclass", QStringLiteral("org.kde.app%1").arg(i));
+            group.writeEntry("wmclasscomplete", false);
+            group.writeEntry("wmclassmatch", int(Rules::ExactMatch));
+        }
+        group.sync();
+    }
+
+    KConfigGroup group = config->group(QString::number(count + 1));
+    group.writeEntry("above", true);
+    group.writeEntry("aboverule", int(Rules::Force));
+    group.writeEntry("wmclass", "org.kde.foo");
+    group.writeEntry("wmclasscomplete", false);
+    group.writeEntry("wmclassmatch", int(Rules::ExactMatch));
+    group.writeEntry("title", "^build \\d+ done$");
+    group.writeEntry("titlematch", int(Rules::RegExpMatch));
+    group.sync();
+
+    return config;
+}
+
+void TestXdgShellClientRules::testMatchAfterTitleChange()
+{
+    RuleBook::self()->setConfig(createTitleRules(100));
+    workspace()->slotReconfigure();
+
+    AbstractClient *client;
+    Surface *surface;
+    Test::XdgToplevel *shellSurface;
+    std::tie(client, surface, shellSurface) = createWindow(QStringLiteral("org.kde.foo"));
+    QVERIFY(client);
+    QCOMPARE(client->keepAbove(), false);
+    QCOMPARE(client->keepBelow(), false);
+
+    // None of the rules matches the first titles.
+    QSignalSpy captionChangedSpy(client, &AbstractClient::captionChanged);
+    for (int i = 0; i < 10; ++i) {
+        shellSurface->set_title(QStringLiteral("build %1 running").arg(i));
+        QVERIFY(captionChangedSpy.wait());
+    }
+    QCoreApplication::processEvents();
+    QCOMPARE(client->keepAbove(), false);
+
+    shellSurface->set_title(QStringLiteral("build 10 done"));
+    QVERIFY(captionChangedSpy.wait());
+    QTRY_COMPARE(client->keepAbove(), true);
+    QCOMPARE(client->keepBelow(), false);
+
+    // Destroy the client.
+    delete shellSurface;
+    delete surface;
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
+void TestXdgShellClientRules::benchmarkTitleChange_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("cache");
+
+    QTest::newRow("100 rules, linear") << 100 << false;
+    QTest::newRow("100 rules, cached") << 100 << true;
+    QTest::newRow("1000 rules, linear") << 1000 << false;
+    QTest::newRow("1000 rules, cached") << 1000 << true;
+}
+
+void TestXdgShellClientRules::benchmarkTitleChange()
+{
+    // Every change of the title of a window matched by a title rule looks up its rules again.
+    QFETCH(int, count);
+    QFETCH(bool, cache);
+    RuleBook::self()->setMatchCacheEnabled(cache);
+    RuleBook::self()->setConfig(createTitleRules(count));
+    workspace()->slotReconfigure();
+
+    AbstractClient *client;
+    Surface *surface;
+    Test::XdgToplevel *shellSurface;
+    std::tie(client, surface, shellSurface) = createWindow(QStringLiteral("org.kde.foo"));
+    QVERIFY(client);
+    QSignalSpy captionChangedSpy(client, &AbstractClient::captionChanged);
+    shellSurface->set_title(QStringLiteral("build 1 done"));
+    QVERIFY(captionChangedSpy.wait());
+
+    int found = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 100; ++i) {
+            found += RuleBook::self()->find(client, true).checkKeepAbove(false) ? 1 : 0;
+        }
+    }
+    QVERIFY(found > 0);
+
+    RuleBook::self()->setMatchCacheEnabled(true);
+    delete shellSurface;
+    delete surface;
+    QVERIFY(Test::waitForWindowDestroyed(client));
+}
+
 WAYLANDTEST_MAIN(TestXdgShellClientRules)
 #include "xdgshellclient_rules_test.moc"
@@ -104,6 +104,8 @@ private Q_SLOTS:
     void testPointerInputTransform();
     void testReentrantSetFrameGeometry();
     void testDoubleMaximize();
+    void benchmarkFindClient_data();
+    void benchmarkFindClient();
 };
 
 void TestXdgShellClient::testXdgWindowReactive()
@@ -1838,5 +1840,54 @@ void TestXdgShellClient::testMaximizeFull()
     QVERIFY(Test::waitForWindowDestroyed(client));
 }
 
+void TestXdgShellClient::benchmarkFindClient_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("500") << 500;
+}
+
+void TestXdgShellClient::benchmarkFindClient()
+{
+    // This test verifies that the client of a surface is found with many clients, the time
+    // needed for a lookup must not depend on the number of clients.
+    QFETCH(int, count);
+
+    QVector<Surface *> surfaces;
+    QVector<Test::XdgToplevel *> shellSurfaces;
+    QVector<AbstractClient *> clients;
+    for (int i = 0; i < count; ++i) {
+        Surface *surface = Test::createSurface();
+        surfaces << surface;
+        shellSurfaces << Test::createXdgToplevelSurface(surface);
+        AbstractClient *client = Test::renderAndWaitForShown(surface, QSize(10, 10), Qt::blue);
+        QVERIFY(client);
+        clients << client;
+    }
+
+    for (AbstractClient *client : qAsConst(clients)) {
+        QCOMPARE(waylandServer()->findClient(client->surface()), client);
+        QCOMPARE(waylandServer()->findXdgToplevelClient(client->surface()), client);
+        QCOMPARE(waylandServer()->findXdgSurfaceClient(client->surface()), client);
+    }
+
+    int found = 0;
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            found += waylandServer()->findClient(clients[i % count]->surface()) ? 1 : 0;
+        }
+    }
+    QVERIFY(found > 0);
+
+    // The surfaces of destroyed clients must not be found anymore.
+    QSignalSpy destroyedSpy(clients.first(), &QObject::destroyed);
+    qDeleteAll(shellSurfaces);
+    qDeleteAll(surfaces);
+    QVERIFY(destroyedSpy.wait());
+    QTRY_VERIFY(waylandServer()->clients().isEmpty());
+}
+
 WAYLANDTEST_MAIN(TestXdgShellClient)
 #include "xdgshellclient_test.moc"
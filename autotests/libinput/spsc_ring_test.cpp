@@ -0,0 +1,116 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include "../../src/libinput/spscring.h"
+
+#include <QtTest>
+#include <QThread>
+
+using namespace KWin::LibInput;
+
+class TestSpscRing : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testPushPop();
+    void testFull();
+    void testWrapAround();
+    void testThreads();
+};
+
+void TestSpscRing::testPushPop()
+{
+    SpscRing<int, 4> ring;
+    int value = 0;
+    QVERIFY(ring.isEmpty());
+    QVERIFY(!ring.peek(&value));
+
+    QVERIFY(ring.tryPush(1));
+    QVERIFY(ring.tryPush(2));
+    // nothing is visible before the values are published
+    QVERIFY(ring.isEmpty());
+    ring.publish();
+    QVERIFY(!ring.isEmpty());
+
+    QVERIFY(ring.peek(&value));
+    QCOMPARE(value, 1);
+    ring.pop();
+    QVERIFY(ring.tryPop(&value));
+    QCOMPARE(value, 2);
+    QVERIFY(ring.isEmpty());
+    QVERIFY(!ring.tryPop(&value));
+}
+
+void TestSpscRing::testFull()
+{
+    SpscRing<int, 4> ring;
+    for (int i = 0; i < 4; ++i) {
+        QVERIFY(ring.tryPush(i));
+    }
+    QVERIFY(!ring.tryPush(4));
+    ring.publish();
+
+    int value = 0;
+    QVERIFY(ring.tryPop(&value));
+    QCOMPARE(value, 0);
+    QVERIFY(ring.tryPush(4));
+    QVERIFY(!ring.tryPush(5));
+}
+
+void TestSpscRing::testWrapAround()
+{
+    SpscRing<int, 4> ring;
+    int value = 0;
+    for (int i = 0; i < 100; ++i) {
+        QVERIFY(ring.tryPush(i));
+        QVERIFY(ring.tryPush(i + 1000));
+        ring.publish();
+        QVERIFY(ring.tryPop(&value));
+        QCOMPARE(value, i);
+        QVERIFY(ring.tryPop(&value));
+        QCOMPARE(value, i + 1000);
+    }
+    QVERIFY(ring.isEmpty());
+}
+
+void TestSpscRing::testThreads()
+{
+    // The values must arrive in order and none may be lost while both threads are busy.
+    static const int count = 200000;
+    SpscRing<int, 64> ring;
+
+    QScopedPointer<QThread> producer(QThread::create([&ring]() {
+        int next = 0;
+        while (next < count) {
+            while (next < count && ring.tryPush(next)) {
+                ++next;
+            }
+            ring.publish();
+            QThread::yieldCurrentThread();
+        }
+    }));
+    producer->start();
+
+    int expected = 0;
+    int value = 0;
+    bool ordered = true;
+    while (expected < count) {
+        if (ring.tryPop(&value)) {
+            ordered &= value == expected;
+            ++expected;
+        } else {
+            QThread::yieldCurrentThread();
+        }
+    }
+    QVERIFY(producer->wait());
+    QVERIFY(ordered);
+    QVERIFY(ring.isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestSpscRing)
+#include "spsc_ring_test.moc"
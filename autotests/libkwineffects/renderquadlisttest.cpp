@@ -0,0 +1,243 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#include <kwinrenderquadlist.h>
+
+#include <QMatrix4x4>
+#include <QTest>
+
+Q_DECLARE_METATYPE(KWin::WindowQuadList)
+
+static const unsigned int s_triangles = 0x0004; // GL_TRIANGLES
+static const unsigned int s_quads = 0x0007; // GL_QUADS
+
+class RenderQuadListTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testConversion();
+    void testClipped_data();
+    void testClipped();
+    void testMakeInterleavedArrays_data();
+    void testMakeInterleavedArrays();
+    void benchmarkClip_data();
+    void benchmarkWindowQuadListClip();
+    void benchmarkRenderQuadListClip();
+    void benchmarkArrays_data();
+    void benchmarkWindowQuadListArrays();
+    void benchmarkRenderQuadListArrays();
+};
+
+static KWin::WindowQuad makeQuad(const QRectF &r, const QPointF &textureOffset = QPointF(), bool rotated = false)
+{
+    const QPointF t = r.topLeft() + textureOffset;
+    const QSizeF s = rotated ? r.size().transposed() : r.size();
+    KWin::WindowQuad quad;
+    quad[0] = KWin::WindowVertex(r.left(), r.top(), t.x(), t.y());
+    quad[1] = KWin::WindowVertex(r.right(), r.top(), rotated ? t.x() : t.x() + s.width(), rotated ? t.y() + s.height() : t.y());
+    quad[2] = KWin::WindowVertex(r.right(), r.bottom(), t.x() + s.width(), t.y() + s.height());
+    quad[3] = KWin::WindowVertex(r.left(), r.bottom(), rotated ? t.x() + s.width() : t.x(), rotated ? t.y() : t.y() + s.height());
+    return quad;
+}
+
+/**
+ * Clips the @a quads the way the OpenGL scene did before the RenderQuadList.
+ */
+static KWin::WindowQuadList clipWindowQuads(const KWin::WindowQuadList &quads, const QRegion &region, const QPoint &offset)
+{
+    KWin::WindowQuadList ret;
+    for (const QRect &r : region) {
+        const QRectF rf(r.translated(-offset));
+        for (const KWin::WindowQuad &quad : quads) {
+            const QRectF quadRect(QPointF(quad.left(), quad.top()), QPointF(quad.right(), quad.bottom()));
+            const QRectF intersected = rf.intersected(quadRect);
+            if (intersected.isValid()) {
+                ret << quad.makeSubQuad(intersected.left(), intersected.top(), intersected.right(), intersected.bottom());
+            }
+        }
+    }
+    return ret;
+}
+
+static KWin::WindowQuadList makeWindowGrid(int subdivisions)
+{
+    KWin::WindowQuadList quads;
+    quads.append(makeQuad(QRectF(0, 0, 1000, 800)));
+    return quads.makeRegularGrid(subdivisions, subdivisions);
+}
+
+static QRegion makeClipRegion()
+{
+    // A window partially covered by two other windows.
+    return QRegion(100, 100, 1000, 800) - QRegion(0, 0, 400, 300) - QRegion(800, 600, 600, 600);
+}
+
+static void compareQuads(const KWin::WindowQuadList &actual, const KWin::WindowQuadList &expected)
+{
+    QCOMPARE(actual.count(), expected.count());
+    for (int i = 0; i < actual.count(); ++i) {
+        for (int j = 0; j < 4; ++j) {
+            QCOMPARE(float(actual[i][j].x()), float(expected[i][j].x()));
+            QCOMPARE(float(actual[i][j].y()), float(expected[i][j].y()));
+            QCOMPARE(float(actual[i][j].u()), float(expected[i][j].u()));
+            QCOMPARE(float(actual[i][j].v()), float(expected[i][j].v()));
+        }
+    }
+}
+
+void RenderQuadListTest::testConversion()
+{
+    KWin::WindowQuadList quads;
+    quads.append(makeQuad(QRectF(0, 0, 100, 50)));
+    quads.append(makeQuad(QRectF(100, 0, 20, 50), QPointF(3, 4), true));
+
+    const KWin::RenderQuadList renderQuads = KWin::RenderQuadList::fromWindowQuads(quads);
+    QCOMPARE(renderQuads.count(), 2);
+    QCOMPARE(renderQuads.rect(1), QRectF(100, 0, 20, 50));
+    QCOMPARE(renderQuads.boundingRect(), QRectF(0, 0, 120, 50));
+    compareQuads(renderQuads.toWindowQuads(), quads);
+
+    KWin::RenderQuadList appended;
+    appended.append(QRectF(0, 0, 100, 50), QVector2D(0, 0), QVector2D(100, 0), QVector2D(100, 50), QVector2D(0, 50));
+    KWin::WindowQuadList first;
+    first.append(quads.first());
+    compareQuads(appended.toWindowQuads(), first);
+
+    const KWin::RenderQuadList copy = renderQuads;
+    QVERIFY(copy.isSharedWith(renderQuads));
+    QVERIFY(!appended.isSharedWith(renderQuads));
+}
+
+void RenderQuadListTest::testClipped_data()
+{
+    QTest::addColumn<KWin::WindowQuadList>("quads");
+    QTest::addColumn<QRegion>("region");
+    QTest::addColumn<QPoint>("offset");
+
+    KWin::WindowQuadList single;
+    single.append(makeQuad(QRectF(0, 0, 100, 100)));
+    QTest::newRow("inside") << single << QRegion(0, 0, 200, 200) << QPoint(0, 0);
+    QTest::newRow("outside") << single << QRegion(200, 200, 10, 10) << QPoint(0, 0);
+    QTest::newRow("partial") << single << QRegion(50, 25, 100, 100) << QPoint(0, 0);
+    QTest::newRow("offset") << single << QRegion(50, 25, 100, 100) << QPoint(20, 10);
+    QTest::newRow("empty") << single << QRegion() << QPoint(0, 0);
+
+    KWin::WindowQuadList rotated;
+    rotated.append(makeQuad(QRectF(0, 0, 20, 100), QPointF(5, 7), true));
+    QTest::newRow("rotated") << rotated << QRegion(0, 30, 10, 40) << QPoint(0, 0);
+
+    // Covers both the vectorized and the remaining quads.
+    QTest::newRow("grid") << makeWindowGrid(7) << makeClipRegion() << QPoint(100, 100);
+}
+
+void RenderQuadListTest::testClipped()
+{
+    QFETCH(KWin::WindowQuadList, quads);
+    QFETCH(QRegion, region);
+    QFETCH(QPoint, offset);
+
+    const KWin::RenderQuadList clipped = KWin::RenderQuadList::fromWindowQuads(quads).clipped(region, offset);
+    compareQuads(clipped.toWindowQuads(), clipWindowQuads(quads, region, offset));
+}
+
+void RenderQuadListTest::testMakeInterleavedArrays_data()
+{
+    QTest::addColumn<unsigned int>("type");
+    QTest::addColumn<int>("verticesPerQuad");
+
+    QTest::newRow("quads") << s_quads << 4;
+    QTest::newRow("triangles") << s_triangles << 6;
+}
+
+void RenderQuadListTest::testMakeInterleavedArrays()
+{
+    QFETCH(unsigned int, type);
+    QFETCH(int, verticesPerQuad);
+
+    KWin::WindowQuadList quads = makeWindowGrid(3);
+    quads.append(makeQuad(QRectF(0, 0, 20, 100), QPointF(5, 7), true));
+
+    QMatrix4x4 textureMatrix;
+    textureMatrix.translate(0, 1);
+    textureMatrix.scale(1.0 / 1000, -1.0 / 800);
+
+    QVector<KWin::GLVertex2D> expected(quads.count() * verticesPerQuad);
+    QVector<KWin::GLVertex2D> actual(quads.count() * verticesPerQuad);
+    quads.makeInterleavedArrays(type, expected.data(), textureMatrix);
+    KWin::RenderQuadList::fromWindowQuads(quads).makeInterleavedArrays(type, actual.data(), textureMatrix);
+
+    for (int i = 0; i < expected.count(); ++i) {
+        QCOMPARE(actual[i].position, expected[i].position);
+        QCOMPARE(actual[i].texcoord, expected[i].texcoord);
+    }
+}
+
+void RenderQuadListTest::benchmarkClip_data()
+{
+    QTest::addColumn<int>("subdivisions");
+
+    // A window without effects, and the grids of the deform effects.
+    QTest::newRow("1 quad") << 1;
+    QTest::newRow("64 quads") << 8;
+    QTest::newRow("400 quads") << 20;
+    QTest::newRow("2500 quads") << 50;
+}
+
+void RenderQuadListTest::benchmarkWindowQuadListClip()
+{
+    QFETCH(int, subdivisions);
+    const KWin::WindowQuadList quads = makeWindowGrid(subdivisions);
+    const QRegion region = makeClipRegion();
+
+    QBENCHMARK {
+        const KWin::WindowQuadList clipped = clipWindowQuads(quads, region, QPoint(100, 100));
+        Q_UNUSED(clipped)
+    }
+}
+
+void RenderQuadListTest::benchmarkRenderQuadListClip()
+{
+    QFETCH(int, subdivisions);
+    const KWin::RenderQuadList quads = KWin::RenderQuadList::fromWindowQuads(makeWindowGrid(subdivisions));
+    const QRegion region = makeClipRegion();
+
+    QBENCHMARK {
+        const KWin::RenderQuadList clipped = quads.clipped(region, QPoint(100, 100));
+        Q_UNUSED(clipped)
+    }
+}
+
+void RenderQuadListTest::benchmarkArrays_data()
+{
+    benchmarkClip_data();
+}
+
+void RenderQuadListTest::benchmarkWindowQuadListArrays()
+{
+    QFETCH(int, subdivisions);
+    const KWin::WindowQuadList quads = makeWindowGrid(subdivisions);
+    QVector<KWin::GLVertex2D> vertices(quads.count() * 4);
+
+    QBENCHMARK {
+        quads.makeInterleavedArrays(s_quads, vertices.data(), QMatrix4x4());
+    }
+}
+
+void RenderQuadListTest::benchmarkRenderQuadListArrays()
+{
+    QFETCH(int, subdivisions);
+    const KWin::RenderQuadList quads = KWin::RenderQuadList::fromWindowQuads(makeWindowGrid(subdivisions));
+    QVector<KWin::GLVertex2D> vertices(quads.count() * 4);
+
+    QBENCHMARK {
+        quads.makeInterleavedArrays(s_quads, vertices.data(), QMatrix4x4());
+    }
+}
+
+QTEST_MAIN(RenderQuadListTest)
+#include "renderquadlisttest.moc"
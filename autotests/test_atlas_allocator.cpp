@@ -0,0 +1,158 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "../src/plugins/scenes/opengl/atlasallocator.h"
+
+using namespace KWin;
+
+class TestAtlasAllocator : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testAllocate();
+    void testTooLarge();
+    void testReuse();
+    void testShelfHeight();
+    void testRepack();
+    void testRepackTooSmall();
+};
+
+static bool hasOverlaps(const AtlasAllocator &allocator)
+{
+    const QVector<int> handles = allocator.handles();
+    for (int i = 0; i < handles.count(); ++i) {
+        for (int j = i + 1; j < handles.count(); ++j) {
+            if (allocator.rect(handles[i]).intersects(allocator.rect(handles[j]))) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void TestAtlasAllocator::testAllocate()
+{
+    AtlasAllocator allocator(QSize(100, 100));
+
+    const int first = allocator.allocate(QSize(60, 20));
+    const int second = allocator.allocate(QSize(40, 20));
+    const int third = allocator.allocate(QSize(30, 20));
+    QVERIFY(first != -1);
+    QVERIFY(second != -1);
+    QVERIFY(third != -1);
+
+    QCOMPARE(allocator.rect(first), QRect(0, 0, 60, 20));
+    QCOMPARE(allocator.rect(second), QRect(60, 0, 40, 20));
+    QCOMPARE(allocator.rect(third), QRect(0, 20, 30, 20));
+    QCOMPARE(allocator.count(), 3);
+    QCOMPARE(allocator.usedArea(), qint64(60 * 20 + 40 * 20 + 30 * 20));
+    QVERIFY(!hasOverlaps(allocator));
+
+    QCOMPARE(allocator.allocate(QSize()), -1);
+}
+
+void TestAtlasAllocator::testTooLarge()
+{
+    AtlasAllocator allocator(QSize(100, 100));
+    QCOMPARE(allocator.allocate(QSize(101, 10)), -1);
+    QCOMPARE(allocator.allocate(QSize(10, 101)), -1);
+
+    QVERIFY(allocator.allocate(QSize(100, 60)) != -1);
+    QCOMPARE(allocator.allocate(QSize(100, 60)), -1);
+    QCOMPARE(allocator.count(), 1);
+}
+
+void TestAtlasAllocator::testReuse()
+{
+    AtlasAllocator allocator(QSize(100, 40));
+
+    const int first = allocator.allocate(QSize(50, 20));
+    const int second = allocator.allocate(QSize(50, 20));
+    const int third = allocator.allocate(QSize(100, 20));
+    QVERIFY(third != -1);
+    QCOMPARE(allocator.allocate(QSize(10, 20)), -1);
+
+    // The space of released rectangles is merged and reused.
+    allocator.release(first);
+    allocator.release(second);
+    QCOMPARE(allocator.count(), 1);
+    const int wide = allocator.allocate(QSize(90, 20));
+    QCOMPARE(allocator.rect(wide), QRect(0, 0, 90, 20));
+
+    // The last shelf is given back once it's empty, so a rectangle of another height can
+    // take its place.
+    allocator.release(third);
+    const int flat = allocator.allocate(QSize(100, 8));
+    QCOMPARE(allocator.rect(flat), QRect(0, 20, 100, 8));
+    QVERIFY(!hasOverlaps(allocator));
+}
+
+void TestAtlasAllocator::testShelfHeight()
+{
+    AtlasAllocator allocator(QSize(100, 100));
+
+    const int tall = allocator.allocate(QSize(10, 30));
+    QCOMPARE(allocator.rect(tall), QRect(0, 0, 10, 30));
+
+    // A rectangle that would waste too much of the shelf goes to a new one.
+    const int small = allocator.allocate(QSize(10, 10));
+    QCOMPARE(allocator.rect(small), QRect(0, 30, 10, 10));
+
+    const int medium = allocator.allocate(QSize(10, 25));
+    QCOMPARE(allocator.rect(medium), QRect(10, 0, 10, 25));
+    QVERIFY(!hasOverlaps(allocator));
+}
+
+void TestAtlasAllocator::testRepack()
+{
+    AtlasAllocator allocator(QSize(100, 100));
+
+    QVector<int> handles;
+    for (int i = 0; i < 10; ++i) {
+        handles.append(allocator.allocate(QSize(100, 10)));
+    }
+    QCOMPARE(allocator.allocate(QSize(100, 10)), -1);
+
+    // Releasing every other rectangle leaves holes in the middle of the atlas.
+    for (int i = 0; i < handles.count(); i += 2) {
+        allocator.release(handles[i]);
+    }
+    QCOMPARE(allocator.allocate(QSize(50, 20)), -1);
+
+    QVERIFY(allocator.repack(QSize(100, 100)));
+    QCOMPARE(allocator.count(), 5);
+    for (int i = 1; i < handles.count(); i += 2) {
+        QCOMPARE(allocator.rect(handles[i]).size(), QSize(100, 10));
+    }
+    QVERIFY(!hasOverlaps(allocator));
+
+    const int handle = allocator.allocate(QSize(50, 20));
+    QCOMPARE(allocator.rect(handle), QRect(0, 50, 50, 20));
+}
+
+void TestAtlasAllocator::testRepackTooSmall()
+{
+    AtlasAllocator allocator(QSize(100, 100));
+    const int first = allocator.allocate(QSize(100, 50));
+    const int second = allocator.allocate(QSize(100, 50));
+
+    QVERIFY(!allocator.repack(QSize(100, 60)));
+    QCOMPARE(allocator.size(), QSize(100, 100));
+    QCOMPARE(allocator.rect(first), QRect(0, 0, 100, 50));
+    QCOMPARE(allocator.rect(second), QRect(0, 50, 100, 50));
+
+    QVERIFY(allocator.repack(QSize(200, 50)));
+    QCOMPARE(allocator.size(), QSize(200, 50));
+    QVERIFY(!hasOverlaps(allocator));
+}
+
+QTEST_MAIN(TestAtlasAllocator)
+#include "test_atlas_allocator.moc"
@@ -0,0 +1,254 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "../src/hittestgrid.h"
+
+using namespace KWin;
+
+namespace
+{
+
+struct Window
+{
+    QRect geometry;
+    int desktop;
+};
+
+}
+
+static const QRect s_workspace(0, 0, 3840, 1080);
+
+/**
+ * Creates @a count windows spread over two screens and four virtual desktops, the stacking
+ * order is the order of the windows.
+ */
+static QVector<Window> createWindows(int count)
+{
+    QRandomGenerator generator(42);
+    QVector<Window> windows;
+    windows.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QSize size(generator.bounded(200, 800), generator.bounded(150, 600));
+        const QPoint pos(generator.bounded(-100, s_workspace.width() - size.width() + 100),
+                         generator.bounded(-50, s_workspace.height() - size.height() + 50));
+        windows.append(Window{QRect(pos, size), i % 4});
+    }
+    return windows;
+}
+
+static QVector<QPoint> createPositions(int count)
+{
+    QRandomGenerator generator(7);
+    QVector<QPoint> positions;
+    positions.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        positions.append(QPoint(generator.bounded(s_workspace.width()), generator.bounded(s_workspace.height())));
+    }
+    return positions;
+}
+
+/**
+ * Finds the topmost window the way InputRedirection does without the grid.
+ */
+static const Window *findLinear(const QVector<Window> &windows, const QPoint &pos, int desktop)
+{
+    for (int i = windows.count() - 1; i >= 0; --i) {
+        const Window &window = windows[i];
+        if (window.desktop != desktop) {
+            continue;
+        }
+        if (window.geometry.contains(pos)) {
+            return &window;
+        }
+    }
+    return nullptr;
+}
+
+static void fillGrid(HitTestGrid<const Window *> *grid, const QVector<Window> &windows, int desktop)
+{
+    grid->reset(s_workspace);
+    for (int i = 0; i < windows.count(); ++i) {
+        if (windows[i].desktop == desktop) {
+            grid->insert(&windows[i], windows[i].geometry, i);
+        }
+    }
+}
+
+class TestHitTestGrid : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testStackingOrder();
+    void testPredicate();
+    void testRemove();
+    void testOutside();
+    void testSameAsLinear();
+    void benchmarkFind_data();
+    void benchmarkFind();
+};
+
+void TestHitTestGrid::testStackingOrder()
+{
+    const Window bottom{QRect(0, 0, 500, 500), 0};
+    const Window top{QRect(100, 100, 500, 500), 0};
+
+    HitTestGrid<const Window *> grid;
+    grid.reset(QRect(0, 0, 1000, 1000), 64);
+    // insert the topmost window first, the grid must not depend on the order of insertion
+    grid.insert(&top, top.geometry, 1);
+    grid.insert(&bottom, bottom.geometry, 0);
+    QCOMPARE(grid.count(), 2);
+
+    auto any = [](const Window *) {
+        return true;
+    };
+    QCOMPARE(grid.find(QPoint(50, 50), any), &bottom);
+    QCOMPARE(grid.find(QPoint(200, 200), any), &top);
+    QCOMPARE(grid.find(QPoint(550, 550), any), &top);
+    QCOMPARE(grid.find(QPoint(700, 700), any), nullptr);
+}
+
+void TestHitTestGrid::testPredicate()
+{
+    const Window bottom{QRect(0, 0, 500, 500), 0};
+    const Window top{QRect(0, 0, 500, 500), 1};
+
+    HitTestGrid<const Window *> grid;
+    grid.reset(QRect(0, 0, 1000, 1000));
+    grid.insert(&bottom, bottom.geometry, 0);
+    grid.insert(&top, top.geometry, 1);
+
+    int calls = 0;
+    const Window *found = grid.find(QPoint(10, 10), [&calls](const Window *window) {
+        calls++;
+        return window->desktop == 0;
+    });
+    QCOMPARE(found, &bottom);
+    QCOMPARE(calls, 2);
+
+    // the predicate is not called for windows that don't contain the position
+    calls = 0;
+    found = grid.find(QPoint(600, 10), [&calls](const Window *) {
+        calls++;
+        return true;
+    });
+    QCOMPARE(found, nullptr);
+    QCOMPARE(calls, 0);
+}
+
+void TestHitTestGrid::testRemove()
+{
+    const Window bottom{QRect(0, 0, 500, 500), 0};
+    const Window top{QRect(0, 0, 800, 800), 0};
+
+    HitTestGrid<const Window *> grid;
+    grid.reset(QRect(0, 0, 1000, 1000), 100);
+    grid.insert(&bottom, bottom.geometry, 0);
+    grid.insert(&top, top.geometry, 1);
+
+    auto any = [](const Window *) {
+        return true;
+    };
+    QCOMPARE(grid.find(QPoint(10, 10), any), &top);
+    grid.remove(&top);
+    QVERIFY(!grid.contains(&top));
+    QCOMPARE(grid.count(), 1);
+    QCOMPARE(grid.find(QPoint(10, 10), any), &bottom);
+    QCOMPARE(grid.find(QPoint(700, 700), any), nullptr);
+
+    // removing an unknown window does nothing
+    grid.remove(&top);
+    QCOMPARE(grid.count(), 1);
+
+    // moving a window is removing and inserting it again
+    grid.remove(&bottom);
+    grid.insert(&bottom, QRect(600, 600, 100, 100), 0);
+    QCOMPARE(grid.find(QPoint(10, 10), any), nullptr);
+    QCOMPARE(grid.find(QPoint(650, 650), any), &bottom);
+}
+
+void TestHitTestGrid::testOutside()
+{
+    const Window partial{QRect(-100, -100, 200, 200), 0};
+    const Window outside{QRect(2000, 0, 100, 100), 0};
+
+    HitTestGrid<const Window *> grid;
+    grid.reset(QRect(0, 0, 1000, 1000));
+    grid.insert(&partial, partial.geometry, 0);
+    grid.insert(&outside, outside.geometry, 1);
+    QCOMPARE(grid.count(), 2);
+
+    auto any = [](const Window *) {
+        return true;
+    };
+    QCOMPARE(grid.find(QPoint(50, 50), any), &partial);
+    QCOMPARE(grid.find(QPoint(-50, -50), any), nullptr);
+    QCOMPARE(grid.find(QPoint(2050, 50), any), nullptr);
+
+    grid.remove(&outside);
+    QCOMPARE(grid.count(), 1);
+}
+
+void TestHitTestGrid::testSameAsLinear()
+{
+    const QVector<Window> windows = createWindows(500);
+    const QVector<QPoint> positions = createPositions(2000);
+
+    HitTestGrid<const Window *> grid;
+    for (int desktop = 0; desktop < 4; ++desktop) {
+        fillGrid(&grid, windows, desktop);
+        for (const QPoint &pos : positions) {
+            const Window *found = grid.find(pos, [](const Window *) {
+                return true;
+            });
+            QCOMPARE(found, findLinear(windows, pos, desktop));
+        }
+    }
+}
+
+void TestHitTestGrid::benchmarkFind_data()
+{
+    QTest::addColumn<bool>("useGrid");
+
+    QTest::newRow("stacking order") << false;
+    QTest::newRow("grid") << true;
+}
+
+void TestHitTestGrid::benchmarkFind()
+{
+    // 500 windows on four virtual desktops, the pointer moves over the current desktop
+    QFETCH(bool, useGrid);
+    const QVector<Window> windows = createWindows(500);
+    const QVector<QPoint> positions = createPositions(1000);
+
+    HitTestGrid<const Window *> grid;
+    fillGrid(&grid, windows, 0);
+
+    int found = 0;
+    QBENCHMARK {
+        for (const QPoint &pos : positions) {
+            const Window *window;
+            if (useGrid) {
+                window = grid.find(pos, [](const Window *) {
+                    return true;
+                });
+            } else {
+                window = findLinear(windows, pos, 0);
+            }
+            found += window ? 1 : 0;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+QTEST_MAIN(TestHitTestGrid)
+#include "test_hittestgrid.moc"
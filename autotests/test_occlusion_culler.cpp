@@ -0,0 +1,313 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "occlusionculler.h"
+
+using namespace KWin;
+
+struct CullingWindow
+{
+    QRegion paint;
+    QRegion clip;
+    bool translucent = false;
+};
+
+/**
+ * A frame as seen by the occlusion culling pass: the windows in the stacking order from
+ * the bottom to the top, with their damage and opaque regions.
+ */
+struct CullingFrame
+{
+    QRegion displayRegion;
+    QRegion repaintRegion;
+    QVector<CullingWindow> windows;
+};
+Q_DECLARE_METATYPE(CullingFrame)
+
+struct CullingResult
+{
+    QVector<QRegion> windowRegions;
+    QRegion background;
+    QRegion paintedArea;
+};
+
+// The occlusion culling pass as it used to be implemented with QRegion in Scene::paintSimpleScreen()
+static CullingResult cullWithQRegion(const CullingFrame &frame)
+{
+    CullingResult result;
+    result.windowRegions.resize(frame.windows.count());
+
+    QRegion allclips;
+    QRegion upperTranslucentDamage = frame.repaintRegion;
+    for (int i = frame.windows.count() - 1; i >= 0; --i) {
+        const CullingWindow &window = frame.windows[i];
+        QRegion region = window.paint | upperTranslucentDamage;
+        region -= allclips;
+        if (!window.clip.isEmpty() && !window.translucent) {
+            allclips |= window.clip;
+            upperTranslucentDamage |= region - window.clip;
+        } else {
+            upperTranslucentDamage |= region;
+        }
+        result.windowRegions[i] = region;
+    }
+
+    QRegion dirtyArea = frame.repaintRegion;
+    for (const CullingWindow &window : frame.windows) {
+        dirtyArea |= window.paint;
+    }
+    result.background = dirtyArea - allclips;
+
+    QRegion paintedArea = result.background;
+    for (int i = 0; i < frame.windows.count(); ++i) {
+        paintedArea |= result.windowRegions[i];
+        result.windowRegions[i] = paintedArea;
+    }
+    result.paintedArea = paintedArea;
+    return result;
+}
+
+static CullingResult cullWithRectangleSet(OcclusionCuller &culler, const CullingFrame &frame)
+{
+    CullingResult result;
+    result.windowRegions.resize(frame.windows.count());
+
+    culler.begin(frame.windows.count(), false, frame.displayRegion, frame.repaintRegion);
+    for (int i = frame.windows.count() - 1; i >= 0; --i) {
+        const CullingWindow &window = frame.windows[i];
+        culler.cullWindow(i, window.paint, window.clip, window.translucent);
+    }
+
+    QRegion dirtyArea = frame.repaintRegion;
+    for (const CullingWindow &window : frame.windows) {
+        dirtyArea |= window.paint;
+    }
+    result.background = culler.exposedRegion(dirtyArea);
+
+    culler.beginPainting(result.background);
+    for (int i = 0; i < frame.windows.count(); ++i) {
+        result.windowRegions[i] = culler.paintWindow(i);
+    }
+    result.paintedArea = culler.paintedArea();
+    return result;
+}
+
+/**
+ * Generates a frame with @a windowCount windows spread over @a outputCount outputs placed
+ * next to each other, like a session with many overlapping windows. About a third of the
+ * windows are translucent, and a few of them are damaged in every frame.
+ */
+static CullingFrame generateFrame(quint32 seed, int windowCount, int outputCount)
+{
+    QRandomGenerator random(seed);
+    const QSize outputSize(1920, 1080);
+
+    CullingFrame frame;
+    for (int i = 0; i < outputCount; ++i) {
+        frame.displayRegion += QRect(QPoint(i * outputSize.width(), 0), outputSize);
+    }
+
+    for (int i = 0; i < windowCount; ++i) {
+        const QRect output(QPoint(random.bounded(outputCount) * outputSize.width(), 0), outputSize);
+        const QSize size(random.bounded(200, 1200), random.bounded(150, 900));
+        const QRect geometry(output.x() + random.bounded(output.width() - size.width()),
+                             random.bounded(output.height() - size.height()),
+                             size.width(), size.height());
+
+        CullingWindow window;
+        window.translucent = random.bounded(3) == 0;
+        if (!window.translucent) {
+            // Opaque contents below a server-side decoration.
+            window.clip = geometry.adjusted(0, 30, 0, 0);
+        }
+        if (random.bounded(10) == 0) {
+            window.paint = geometry;
+        } else if (random.bounded(4) == 0) {
+            window.paint = QRect(geometry.x() + random.bounded(geometry.width() / 2),
+                                 geometry.y() + random.bounded(geometry.height() / 2),
+                                 random.bounded(10, geometry.width() / 2),
+                                 random.bounded(10, geometry.height() / 2));
+        }
+        frame.windows.append(window);
+    }
+
+    frame.repaintRegion = QRect(random.bounded(outputSize.width()), random.bounded(outputSize.height()), 64, 64);
+    return frame;
+}
+
+class TestOcclusionCuller : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testOperations_data();
+    void testOperations();
+    void testRandomOperations();
+    void testCulling_data();
+    void testCulling();
+    void benchmarkQRegion_data();
+    void benchmarkQRegion();
+    void benchmarkRectangleSet_data();
+    void benchmarkRectangleSet();
+};
+
+static bool sameArea(const QRegion &a, const QRegion &b)
+{
+    return (a ^ b).isEmpty();
+}
+
+void TestOcclusionCuller::testOperations_data()
+{
+    QTest::addColumn<QRegion>("a");
+    QTest::addColumn<QRegion>("b");
+
+    QTest::newRow("empty") << QRegion() << QRegion();
+    QTest::newRow("empty a") << QRegion() << QRegion(0, 0, 100, 100);
+    QTest::newRow("empty b") << QRegion(0, 0, 100, 100) << QRegion();
+    QTest::newRow("same") << QRegion(0, 0, 100, 100) << QRegion(0, 0, 100, 100);
+    QTest::newRow("disjoint") << QRegion(0, 0, 100, 100) << QRegion(200, 200, 100, 100);
+    QTest::newRow("touching") << QRegion(0, 0, 100, 100) << QRegion(100, 0, 100, 100);
+    QTest::newRow("overlapping") << QRegion(0, 0, 100, 100) << QRegion(50, 50, 100, 100);
+    QTest::newRow("contained") << QRegion(0, 0, 100, 100) << QRegion(25, 25, 50, 50);
+    QTest::newRow("cross") << QRegion(0, 40, 100, 20) << QRegion(40, 0, 20, 100);
+    QTest::newRow("complex") << (QRegion(0, 0, 100, 100) | QRegion(150, 20, 30, 200))
+                             << (QRegion(50, 10, 120, 40) | QRegion(0, 90, 300, 5));
+}
+
+void TestOcclusionCuller::testOperations()
+{
+    QFETCH(QRegion, a);
+    QFETCH(QRegion, b);
+
+    RectangleSet setA;
+    setA.assign(a);
+    RectangleSet setB;
+    setB.assign(b);
+
+    RectangleSet result;
+    result.unite(setA, setB);
+    QVERIFY(sameArea(result.toRegion(), a | b));
+    result.subtract(setA, setB);
+    QVERIFY(sameArea(result.toRegion(), a - b));
+    result.intersect(setA, setB);
+    QVERIFY(sameArea(result.toRegion(), a & b));
+}
+
+void TestOcclusionCuller::testRandomOperations()
+{
+    QRandomGenerator random(42);
+    RectangleSet setA;
+    RectangleSet setB;
+    RectangleSet result;
+
+    for (int i = 0; i < 200; ++i) {
+        QRegion a;
+        QRegion b;
+        for (int j = 0; j < 8; ++j) {
+            a += QRect(random.bounded(200), random.bounded(200), random.bounded(1, 80), random.bounded(1, 80));
+            b += QRect(random.bounded(200), random.bounded(200), random.bounded(1, 80), random.bounded(1, 80));
+        }
+        setA.assign(a);
+        setB.assign(b);
+
+        result.unite(setA, setB);
+        QVERIFY(sameArea(result.toRegion(), a | b));
+        QCOMPARE(result.toRegion().rectCount(), (a | b).rectCount());
+        result.subtract(setA, setB);
+        QVERIFY(sameArea(result.toRegion(), a - b));
+        result.intersect(setA, setB);
+        QVERIFY(sameArea(result.toRegion(), a & b));
+    }
+}
+
+void TestOcclusionCuller::testCulling_data()
+{
+    QTest::addColumn<CullingFrame>("frame");
+
+    for (quint32 seed = 0; seed < 20; ++seed) {
+        QTest::addRow("seed %u", seed) << generateFrame(seed, 60, 3);
+    }
+}
+
+void TestOcclusionCuller::testCulling()
+{
+    QFETCH(CullingFrame, frame);
+
+    OcclusionCuller culler;
+    const CullingResult expected = cullWithQRegion(frame);
+    const CullingResult actual = cullWithRectangleSet(culler, frame);
+
+    QVERIFY(sameArea(actual.background, expected.background));
+    QVERIFY(sameArea(actual.paintedArea, expected.paintedArea));
+    QCOMPARE(actual.windowRegions.count(), expected.windowRegions.count());
+    for (int i = 0; i < expected.windowRegions.count(); ++i) {
+        QVERIFY(sameArea(actual.windowRegions[i], expected.windowRegions[i]));
+    }
+}
+
+static void addBenchmarkRows()
+{
+    QTest::addColumn<QVector<CullingFrame>>("frames");
+
+    // Each row replays a sequence of frames with different window layouts and damage.
+    const struct {
+        const char *name;
+        int windowCount;
+        int outputCount;
+    } scenarios[] = {
+        {"10 windows, 1 output", 10, 1},
+        {"60 windows, 3 outputs", 60, 3},
+        {"200 windows, 4 outputs", 200, 4},
+    };
+    for (const auto &scenario : scenarios) {
+        QVector<CullingFrame> frames;
+        for (quint32 seed = 0; seed < 16; ++seed) {
+            frames.append(generateFrame(seed, scenario.windowCount, scenario.outputCount));
+        }
+        QTest::newRow(scenario.name) << frames;
+    }
+}
+
+void TestOcclusionCuller::benchmarkQRegion_data()
+{
+    addBenchmarkRows();
+}
+
+void TestOcclusionCuller::benchmarkQRegion()
+{
+    QFETCH(QVector<CullingFrame>, frames);
+
+    QBENCHMARK {
+        for (const CullingFrame &frame : qAsConst(frames)) {
+            cullWithQRegion(frame);
+        }
+    }
+}
+
+void TestOcclusionCuller::benchmarkRectangleSet_data()
+{
+    addBenchmarkRows();
+}
+
+void TestOcclusionCuller::benchmarkRectangleSet()
+{
+    QFETCH(QVector<CullingFrame>, frames);
+
+    OcclusionCuller culler;
+    QBENCHMARK {
+        for (const CullingFrame &frame : qAsConst(frames)) {
+            cullWithRectangleSet(culler, frame);
+        }
+    }
+}
+
+QTEST_GUILESS_MAIN(TestOcclusionCuller)
+#include "test_occlusion_culler.moc"
@@ -0,0 +1,99 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+
+#include "../src/plugins/scenes/opengl/openglrenderlist.h"
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(KWin::OpenGLRenderList::Node)
+
+using Batches = QVector<QVector<int>>;
+
+static OpenGLRenderList::Node makeNode(const QRect &rect, bool blend, qreal opacity = 1.0)
+{
+    OpenGLRenderList::Node node;
+    node.quads.append(QRect(QPoint(0, 0), rect.size()),
+                      QVector2D(0, 0), QVector2D(rect.width(), 0),
+                      QVector2D(rect.width(), rect.height()), QVector2D(0, rect.height()));
+    node.offset = rect.topLeft();
+    node.blend = blend;
+    node.modulation = QVector4D(opacity, opacity, opacity, opacity);
+    if (opacity != 1.0) {
+        node.traits |= ShaderTrait::Modulate;
+    }
+    return node;
+}
+
+class TestOpenGLRenderList : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testBuildBatches_data();
+    void testBuildBatches();
+};
+
+void TestOpenGLRenderList::testBuildBatches_data()
+{
+    QTest::addColumn<QVector<OpenGLRenderList::Node>>("nodes");
+    QTest::addColumn<Batches>("batches");
+
+    QTest::newRow("empty") << QVector<OpenGLRenderList::Node>() << Batches();
+
+    QTest::newRow("disjoint") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), false),
+        makeNode(QRect(200, 0, 100, 100), true),
+        makeNode(QRect(400, 0, 100, 100), false),
+        makeNode(QRect(600, 0, 100, 100), true),
+    } << Batches{{0, 2}, {1, 3}};
+
+    QTest::newRow("stacked") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), false),
+        makeNode(QRect(50, 50, 100, 100), true),
+        makeNode(QRect(100, 100, 100, 100), false),
+    } << Batches{{0}, {1}, {2}};
+
+    // The third node only overlaps the first one, which is drawn before it anyway.
+    QTest::newRow("overlaps earlier batch") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), false),
+        makeNode(QRect(200, 0, 100, 100), true),
+        makeNode(QRect(50, 50, 100, 100), false),
+    } << Batches{{0, 2}, {1}};
+
+    // The third node overlaps the second one, so it can't be drawn before it.
+    QTest::newRow("overlaps later batch") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), false),
+        makeNode(QRect(200, 0, 100, 100), true),
+        makeNode(QRect(250, 50, 100, 100), false),
+    } << Batches{{0}, {1}, {2}};
+
+    QTest::newRow("adjacent") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), false),
+        makeNode(QRect(100, 0, 100, 100), true),
+        makeNode(QRect(200, 0, 100, 100), false),
+    } << Batches{{0, 2}, {1}};
+
+    QTest::newRow("opacity") << QVector<OpenGLRenderList::Node>{
+        makeNode(QRect(0, 0, 100, 100), true, 0.5),
+        makeNode(QRect(200, 0, 100, 100), true, 0.75),
+        makeNode(QRect(400, 0, 100, 100), true, 0.5),
+    } << Batches{{0, 2}, {1}};
+}
+
+void TestOpenGLRenderList::testBuildBatches()
+{
+    QFETCH(QVector<OpenGLRenderList::Node>, nodes);
+    QFETCH(Batches, batches);
+
+    QCOMPARE(OpenGLRenderList::buildBatches(nodes), batches);
+}
+
+QTEST_GUILESS_MAIN(TestOpenGLRenderList)
+#include "test_opengl_render_list.moc"
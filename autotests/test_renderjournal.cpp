@@ -0,0 +1,74 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QTest>
+#include <QThread>
+
+#include "renderjournal.h"
+
+using namespace KWin;
+using namespace std::chrono_literals;
+
+class TestRenderJournal : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testPercentile();
+    void testPercentileDecay();
+};
+
+static void renderFrame(RenderJournal &journal, std::chrono::microseconds duration)
+{
+    journal.beginFrame();
+    if (duration > 0us) {
+        QThread::usleep(duration.count());
+    }
+    journal.endFrame();
+}
+
+void TestRenderJournal::testEmpty()
+{
+    RenderJournal journal;
+    QCOMPARE(journal.minimum(), 0ns);
+    QCOMPARE(journal.maximum(), 0ns);
+    QCOMPARE(journal.average(), 0ns);
+    QCOMPARE(journal.percentile(0.95), 0ns);
+}
+
+void TestRenderJournal::testPercentile()
+{
+    RenderJournal journal;
+    for (int i = 0; i < 20; ++i) {
+        renderFrame(journal, 2ms);
+    }
+
+    // The percentile estimate is never below the time it actually took to render a frame.
+    QVERIFY(journal.percentile(0.95) >= 2ms);
+    QVERIFY(journal.percentile(0.5) >= 2ms);
+    QVERIFY(journal.percentile(0.95) >= journal.percentile(0.5));
+}
+
+void TestRenderJournal::testPercentileDecay()
+{
+    RenderJournal journal;
+    for (int i = 0; i < 20; ++i) {
+        renderFrame(journal, 5ms);
+    }
+    QVERIFY(journal.percentile(0.95) >= 5ms);
+
+    // After enough cheap frames, the expensive ones should no longer affect the estimate.
+    for (int i = 0; i < 300; ++i) {
+        renderFrame(journal, 0us);
+    }
+    QVERIFY(journal.percentile(0.95) < 5ms);
+}
+
+QTEST_GUILESS_MAIN(TestRenderJournal)
+#include "test_renderjournal.moc"
@@ -0,0 +1,208 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QElapsedTimer>
+#include <QTest>
+#include <QtConcurrent>
+
+#include "../src/effects/screenshot/screenshotcomposer.h"
+
+using namespace KWin;
+
+/**
+ * Returns the pixels of @a image the way glReadPixels() would return them, i.e. as RGBA
+ * bytes from the bottom row to the top row.
+ */
+static QByteArray toGLPixels(const QImage &image)
+{
+    const QImage rgba = image.convertToFormat(QImage::Format_RGBA8888);
+    QByteArray pixels;
+    pixels.reserve(rgba.width() * rgba.height() * 4);
+    for (int y = rgba.height() - 1; y >= 0; --y) {
+        pixels.append(reinterpret_cast<const char *>(rgba.constScanLine(y)), rgba.width() * 4);
+    }
+    return pixels;
+}
+
+static QImage generateImage(const QSize &size)
+{
+    QImage image(size, QImage::Format_ARGB32);
+    for (int y = 0; y < size.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            line[x] = qRgba(x & 0xff, y & 0xff, (x + y) & 0xff, 0xff);
+        }
+    }
+    return image;
+}
+
+static ScreenShotTile makeTile(const QByteArray &pixels, const QRect &sourceRect, const QSize &size)
+{
+    ScreenShotTile tile;
+    tile.data = reinterpret_cast<const uchar *>(pixels.constData());
+    tile.size = size;
+    tile.stride = size.width() * 4;
+    tile.sourceRect = sourceRect;
+    return tile;
+}
+
+class TestScreenShotComposer : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testConvert();
+    void testComposeSingleTile();
+    void testComposeTiles();
+    void testCursor();
+    void benchmarkSynchronous_data();
+    void benchmarkSynchronous();
+    void benchmarkAsynchronous_data();
+    void benchmarkAsynchronous();
+};
+
+void TestScreenShotComposer::testConvert()
+{
+    const QImage expected = generateImage(QSize(37, 23));
+    const QByteArray pixels = toGLPixels(expected);
+
+    const QImage actual = convertFromGLImage(reinterpret_cast<const uchar *>(pixels.constData()),
+                                             expected.size(), expected.width() * 4);
+    QCOMPARE(actual.format(), QImage::Format_ARGB32);
+    QCOMPARE(actual, expected);
+}
+
+void TestScreenShotComposer::testComposeSingleTile()
+{
+    const QImage expected = generateImage(QSize(40, 20));
+    const QByteArray pixels = toGLPixels(expected);
+
+    ScreenShotComposition composition;
+    composition.area = QRect(100, 50, 20, 10);
+    composition.devicePixelRatio = 2.0;
+    composition.tiles.append(makeTile(pixels, composition.area, expected.size()));
+
+    QImage actual = composeScreenShot(composition);
+    QCOMPARE(actual.devicePixelRatio(), 2.0);
+    actual.setDevicePixelRatio(1.0);
+    QCOMPARE(actual, expected);
+}
+
+void TestScreenShotComposer::testComposeTiles()
+{
+    // An area that spans two screens next to each other, but only partially covers them.
+    QImage left(QSize(30, 40), QImage::Format_ARGB32);
+    left.fill(Qt::red);
+    QImage right(QSize(20, 40), QImage::Format_ARGB32);
+    right.fill(Qt::blue);
+    const QByteArray leftPixels = toGLPixels(left);
+    const QByteArray rightPixels = toGLPixels(right);
+
+    ScreenShotComposition composition;
+    composition.area = QRect(70, 0, 60, 50);
+    composition.composite = true;
+    composition.tiles.append(makeTile(leftPixels, QRect(70, 0, 30, 40), left.size()));
+    composition.tiles.append(makeTile(rightPixels, QRect(100, 0, 20, 40), right.size()));
+
+    const QImage actual = composeScreenShot(composition);
+    QCOMPARE(actual.size(), QSize(60, 50));
+    QCOMPARE(actual.format(), QImage::Format_ARGB32_Premultiplied);
+    QCOMPARE(actual.pixel(0, 0), QColor(Qt::red).rgba());
+    QCOMPARE(actual.pixel(29, 39), QColor(Qt::red).rgba());
+    QCOMPARE(actual.pixel(30, 0), QColor(Qt::blue).rgba());
+    QCOMPARE(actual.pixel(49, 39), QColor(Qt::blue).rgba());
+    QCOMPARE(actual.pixel(50, 0), qRgba(0, 0, 0, 0));
+    QCOMPARE(actual.pixel(0, 40), qRgba(0, 0, 0, 0));
+}
+
+void TestScreenShotComposer::testCursor()
+{
+    QImage screen(QSize(100, 100), QImage::Format_ARGB32);
+    screen.fill(Qt::black);
+    const QByteArray pixels = toGLPixels(screen);
+
+    QImage cursor(QSize(4, 4), QImage::Format_ARGB32_Premultiplied);
+    cursor.fill(Qt::white);
+
+    ScreenShotComposition composition;
+    composition.area = QRect(1000, 0, 100, 100);
+    composition.tiles.append(makeTile(pixels, composition.area, screen.size()));
+    composition.cursorImage = cursor;
+    composition.cursorPosition = QPoint(1010, 20);
+
+    const QImage actual = composeScreenShot(composition);
+    QCOMPARE(actual.pixel(9, 19), QColor(Qt::black).rgba());
+    QCOMPARE(actual.pixel(10, 20), QColor(Qt::white).rgba());
+    QCOMPARE(actual.pixel(13, 23), QColor(Qt::white).rgba());
+    QCOMPARE(actual.pixel(14, 24), QColor(Qt::black).rgba());
+}
+
+static void addBenchmarkRows()
+{
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("1080p") << QSize(1920, 1080);
+    QTest::newRow("1440p") << QSize(2560, 1440);
+    QTest::newRow("4k") << QSize(3840, 2160);
+}
+
+static const int s_screenShotCount = 16;
+
+void TestScreenShotComposer::benchmarkSynchronous_data()
+{
+    addBenchmarkRows();
+}
+
+void TestScreenShotComposer::benchmarkSynchronous()
+{
+    QFETCH(QSize, size);
+
+    // The time the compositor thread used to spend per screenshot, not counting the stall
+    // while waiting for the GPU in glGetTexImage().
+    const QByteArray pixels = toGLPixels(generateImage(size));
+    ScreenShotComposition composition;
+    composition.area = QRect(QPoint(0, 0), size);
+    composition.tiles.append(makeTile(pixels, composition.area, size));
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < s_screenShotCount; ++i) {
+        composeScreenShot(composition);
+    }
+    QTest::setBenchmarkResult(timer.nsecsElapsed() / s_screenShotCount, QTest::WalltimeNanoseconds);
+}
+
+void TestScreenShotComposer::benchmarkAsynchronous_data()
+{
+    addBenchmarkRows();
+}
+
+void TestScreenShotComposer::benchmarkAsynchronous()
+{
+    QFETCH(QSize, size);
+
+    // The time the compositor thread spends per screenshot when the image is composed in
+    // the thread pool; waiting for the results is not accounted for.
+    const QByteArray pixels = toGLPixels(generateImage(size));
+    ScreenShotComposition composition;
+    composition.area = QRect(QPoint(0, 0), size);
+    composition.tiles.append(makeTile(pixels, composition.area, size));
+
+    qint64 elapsed = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < s_screenShotCount; ++i) {
+        timer.start();
+        QFuture<QImage> future = QtConcurrent::run(composeScreenShot, composition);
+        elapsed += timer.nsecsElapsed();
+        future.waitForFinished();
+    }
+    QTest::setBenchmarkResult(elapsed / s_screenShotCount, QTest::WalltimeNanoseconds);
+}
+
+QTEST_GUILESS_MAIN(TestScreenShotComposer)
+#include "test_screenshot_composer.moc"
@@ -0,0 +1,155 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "../src/smartplacement.h"
+
+using namespace KWin;
+
+/**
+ * Adds @a count windows to the @a placement, spread over the @a area and a bit beyond it.
+ * Every tenth window is kept above and every tenth window is ignored.
+ */
+static void addWindows(SmartPlacement *placement, QRandomGenerator *generator, const QRect &area, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        const QSize size(generator->bounded(1, 800), generator->bounded(1, 600));
+        const QPoint pos(generator->bounded(area.left() - 100, area.right()),
+                         generator->bounded(area.top() - 100, area.bottom()));
+        SmartPlacement::Weight weight = SmartPlacement::Normal;
+        switch (generator->bounded(10)) {
+        case 0:
+            weight = SmartPlacement::KeptAbove;
+            break;
+        case 1:
+            weight = SmartPlacement::Ignored;
+            break;
+        }
+        placement->addWindow(QRect(pos, size), weight);
+    }
+}
+
+class TestSmartPlacement : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testEmpty();
+    void testFreeSpace();
+    void testKeptAbove();
+    void testIgnored();
+    void testTooLarge();
+    void testSameAsLinear();
+    void benchmarkPlace_data();
+    void benchmarkPlace();
+};
+
+void TestSmartPlacement::testEmpty()
+{
+    SmartPlacement placement;
+    QCOMPARE(placement.place(QSize(200, 100), QRect(10, 20, 1000, 1000)), QPoint(10, 20));
+}
+
+void TestSmartPlacement::testFreeSpace()
+{
+    SmartPlacement placement;
+    placement.addWindow(QRect(0, 0, 300, 300));
+    QCOMPARE(placement.place(QSize(200, 200), QRect(0, 0, 1000, 1000)), QPoint(300, 0));
+    QCOMPARE(placement.placeLinear(QSize(200, 200), QRect(0, 0, 1000, 1000)), QPoint(300, 0));
+
+    // there is no room right of the window, the new window goes below it
+    QCOMPARE(placement.place(QSize(800, 200), QRect(0, 0, 1000, 1000)), QPoint(0, 300));
+}
+
+void TestSmartPlacement::testKeptAbove()
+{
+    const QRect area(0, 0, 1000, 500);
+
+    // both halves are covered, the first one is taken
+    SmartPlacement normal;
+    normal.addWindow(QRect(0, 0, 500, 500));
+    normal.addWindow(QRect(500, 0, 500, 500));
+    QCOMPARE(normal.place(QSize(500, 500), area), QPoint(0, 0));
+
+    // a window kept above covers more than a normal one
+    SmartPlacement keptAbove;
+    keptAbove.addWindow(QRect(0, 0, 500, 500), SmartPlacement::KeptAbove);
+    keptAbove.addWindow(QRect(500, 0, 500, 500));
+    QCOMPARE(keptAbove.place(QSize(500, 500), area), QPoint(500, 0));
+    QCOMPARE(keptAbove.placeLinear(QSize(500, 500), area), QPoint(500, 0));
+}
+
+void TestSmartPlacement::testIgnored()
+{
+    SmartPlacement placement;
+    placement.addWindow(QRect(0, 0, 500, 500), SmartPlacement::Ignored);
+    QCOMPARE(placement.place(QSize(200, 200), QRect(0, 0, 1000, 1000)), QPoint(0, 0));
+}
+
+void TestSmartPlacement::testTooLarge()
+{
+    // a window taller than the area is placed at the top
+    SmartPlacement placement;
+    placement.addWindow(QRect(0, 0, 300, 300));
+    const QPoint pos = placement.place(QSize(200, 1200), QRect(0, 0, 1000, 1000));
+    QCOMPARE(pos, placement.placeLinear(QSize(200, 1200), QRect(0, 0, 1000, 1000)));
+    QCOMPARE(pos.y(), 0);
+}
+
+void TestSmartPlacement::testSameAsLinear()
+{
+    QRandomGenerator generator(42);
+    for (int i = 0; i < 2000; ++i) {
+        const QRect area(generator.bounded(50), generator.bounded(50),
+                         generator.bounded(300, 3000), generator.bounded(200, 1200));
+        SmartPlacement placement;
+        addWindows(&placement, &generator, area, generator.bounded(60));
+
+        const QSize size(generator.bounded(1, 900), generator.bounded(1, 900));
+        QCOMPARE(placement.place(size, area), placement.placeLinear(size, area));
+    }
+}
+
+void TestSmartPlacement::benchmarkPlace_data()
+{
+    QTest::addColumn<bool>("sweep");
+    QTest::addColumn<int>("windowCount");
+
+    QTest::newRow("linear, 50 windows") << false << 50;
+    QTest::newRow("sweep, 50 windows") << true << 50;
+    QTest::newRow("linear, 200 windows") << false << 200;
+    QTest::newRow("sweep, 200 windows") << true << 200;
+    QTest::newRow("linear, 500 windows") << false << 500;
+    QTest::newRow("sweep, 500 windows") << true << 500;
+}
+
+void TestSmartPlacement::benchmarkPlace()
+{
+    // an ultrawide output covered by many windows, as after restoring a session
+    QFETCH(bool, sweep);
+    QFETCH(int, windowCount);
+    const QRect area(0, 0, 5120, 1440);
+
+    QRandomGenerator generator(7);
+    SmartPlacement placement;
+    for (int i = 0; i < windowCount; ++i) {
+        const QSize size(generator.bounded(200, 800), generator.bounded(150, 550));
+        placement.addWindow(QRect(QPoint(generator.bounded(area.width() - 200), generator.bounded(area.height() - 150)), size));
+    }
+
+    QPoint pos;
+    QBENCHMARK {
+        pos = sweep ? placement.place(QSize(400, 300), area) : placement.placeLinear(QSize(400, 300), area);
+    }
+    QVERIFY(area.contains(pos));
+}
+
+QTEST_MAIN(TestSmartPlacement)
+#include "test_smart_placement.moc"
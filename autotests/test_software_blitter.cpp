@@ -0,0 +1,380 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QTest>
+
+#include "../src/plugins/scenes/qpainter/softwareblitter.h"
+
+using namespace KWin;
+
+Q_DECLARE_METATYPE(KWin::SoftwareBlitIsa)
+Q_DECLARE_METATYPE(QImage::Format)
+
+static QVector<SoftwareBlitIsa> supportedIsas()
+{
+    QVector<SoftwareBlitIsa> isas;
+    for (SoftwareBlitIsa isa : {SoftwareBlitIsa::Generic, SoftwareBlitIsa::SSE2, SoftwareBlitIsa::AVX2, SoftwareBlitIsa::NEON}) {
+        if (isSoftwareBlitIsaSupported(isa)) {
+            isas.append(isa);
+        }
+    }
+    return isas;
+}
+
+static uint randomPixel(QRandomGenerator &random, bool opaque)
+{
+    // Mostly opaque and fully transparent pixels, like in the contents of real windows.
+    const int kind = random.bounded(4);
+    const uint alpha = opaque || kind == 0 ? 0xff : (kind == 1 ? 0 : random.bounded(256));
+    if (!alpha) {
+        return 0;
+    }
+    return qRgba(random.bounded(alpha + 1), random.bounded(alpha + 1), random.bounded(alpha + 1), alpha);
+}
+
+static QImage randomImage(const QSize &size, QImage::Format format, quint32 seed)
+{
+    QRandomGenerator random(seed);
+    QImage image(size, format);
+    const bool opaque = format == QImage::Format_RGB32;
+    for (int y = 0; y < size.height(); ++y) {
+        uint *line = reinterpret_cast<uint *>(image.scanLine(y));
+        for (int x = 0; x < size.width(); ++x) {
+            line[x] = randomPixel(random, opaque);
+        }
+    }
+    return image;
+}
+
+/**
+ * Scales the @a image up by the @a scale with the nearest neighbor sampling at pixel centers.
+ */
+static QImage scaleImage(const QImage &image, qreal scale)
+{
+    QImage scaled(image.size() * scale, image.format());
+    for (int y = 0; y < scaled.height(); ++y) {
+        const uint *source = reinterpret_cast<const uint *>(image.constScanLine(int((y + 0.5) / scale)));
+        uint *destination = reinterpret_cast<uint *>(scaled.scanLine(y));
+        for (int x = 0; x < scaled.width(); ++x) {
+            destination[x] = source[int((x + 0.5) / scale)];
+        }
+    }
+    return scaled;
+}
+
+static bool fuzzyCompare(const QImage &actual, const QImage &expected, int tolerance)
+{
+    if (actual.size() != expected.size()) {
+        return false;
+    }
+    for (int y = 0; y < actual.height(); ++y) {
+        for (int x = 0; x < actual.width(); ++x) {
+            const QRgb a = actual.pixel(x, y);
+            const QRgb b = expected.pixel(x, y);
+            if (qAbs(qRed(a) - qRed(b)) > tolerance || qAbs(qGreen(a) - qGreen(b)) > tolerance
+                    || qAbs(qBlue(a) - qBlue(b)) > tolerance || qAbs(qAlpha(a) - qAlpha(b)) > tolerance) {
+                qWarning() << "Pixels at" << x << y << "differ:" << Qt::hex << a << b;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+class TestSoftwareBlitter : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testKernels_data();
+    void testKernels();
+    void testDrawImage_data();
+    void testDrawImage();
+    void testUnsupported_data();
+    void testUnsupported();
+    void benchmarkQPainter_data();
+    void benchmarkQPainter();
+    void benchmarkBlitter_data();
+    void benchmarkBlitter();
+};
+
+void TestSoftwareBlitter::testKernels_data()
+{
+    QTest::addColumn<SoftwareBlitIsa>("isa");
+
+    for (SoftwareBlitIsa isa : supportedIsas()) {
+        QTest::newRow(qPrintable(SoftwareBlitter::isaName(isa))) << isa;
+    }
+}
+
+void TestSoftwareBlitter::testKernels()
+{
+    QFETCH(SoftwareBlitIsa, isa);
+
+    // All kernels must produce exactly the same results as the generic ones, regardless of
+    // how many pixels are left over after the vectorized loops.
+    const SoftwareBlitKernels *expected = softwareBlitKernels(SoftwareBlitIsa::Generic);
+    const SoftwareBlitKernels *actual = softwareBlitKernels(isa);
+    QVERIFY(actual);
+
+    QRandomGenerator random(7);
+    for (int count = 0; count < 70; ++count) {
+        QVector<uint> source(count);
+        QVector<uint> background(count);
+        for (int i = 0; i < count; ++i) {
+            source[i] = randomPixel(random, false);
+            background[i] = randomPixel(random, false);
+        }
+
+        for (uint constAlpha : {255, 254, 128, 1, 0}) {
+            QVector<uint> expectedPixels = background;
+            QVector<uint> actualPixels = background;
+            expected->sourceOver(expectedPixels.data(), source.constData(), count, constAlpha);
+            actual->sourceOver(actualPixels.data(), source.constData(), count, constAlpha);
+            QCOMPARE(actualPixels, expectedPixels);
+        }
+
+        QVector<uint> expectedPixels(count);
+        QVector<uint> actualPixels(count);
+        expected->copyOpaque(expectedPixels.data(), source.constData(), count);
+        actual->copyOpaque(actualPixels.data(), source.constData(), count);
+        QCOMPARE(actualPixels, expectedPixels);
+
+        expectedPixels = source;
+        actualPixels = source;
+        expected->makeOpaque(expectedPixels.data(), count);
+        actual->makeOpaque(actualPixels.data(), count);
+        QCOMPARE(actualPixels, expectedPixels);
+
+        expected->fetchScaled2x(expectedPixels.data(), source.constData(), count);
+        actual->fetchScaled2x(actualPixels.data(), source.constData(), count);
+        QCOMPARE(actualPixels, expectedPixels);
+
+        expected->fetchScaled3x2(expectedPixels.data(), source.constData(), count);
+        actual->fetchScaled3x2(actualPixels.data(), source.constData(), count);
+        QCOMPARE(actualPixels, expectedPixels);
+    }
+}
+
+void TestSoftwareBlitter::testDrawImage_data()
+{
+    QTest::addColumn<SoftwareBlitIsa>("isa");
+    QTest::addColumn<QImage::Format>("destinationFormat");
+    QTest::addColumn<QImage::Format>("sourceFormat");
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<qreal>("opacity");
+    QTest::addColumn<QRegion>("clip");
+
+    const struct {
+        const char *name;
+        QImage::Format destinationFormat;
+        QImage::Format sourceFormat;
+        qreal scale;
+        qreal opacity;
+        QRegion clip;
+    } cases[] = {
+        {"opaque", QImage::Format_RGB32, QImage::Format_RGB32, 1, 1, QRegion()},
+        {"opaque, clipped", QImage::Format_RGB32, QImage::Format_RGB32, 1, 1, QRegion(30, 20, 20, 10) | QRegion(50, 40, 30, 30)},
+        {"opaque, translucent", QImage::Format_RGB32, QImage::Format_RGB32, 1, 0.6, QRegion()},
+        {"argb", QImage::Format_RGB32, QImage::Format_ARGB32_Premultiplied, 1, 1, QRegion()},
+        {"argb, translucent", QImage::Format_RGB32, QImage::Format_ARGB32_Premultiplied, 1, 0.3, QRegion()},
+        {"argb on argb", QImage::Format_ARGB32_Premultiplied, QImage::Format_ARGB32_Premultiplied, 1, 0.8, QRegion()},
+        {"opaque, 2x", QImage::Format_RGB32, QImage::Format_RGB32, 2, 1, QRegion()},
+        {"argb, 2x, clipped", QImage::Format_RGB32, QImage::Format_ARGB32_Premultiplied, 2, 1, QRegion(27, 21, 11, 13) | QRegion(40, 40, 10, 10)},
+        {"opaque, 1.5x", QImage::Format_RGB32, QImage::Format_RGB32, 1.5, 1, QRegion()},
+        {"argb, 1.5x, translucent, clipped", QImage::Format_RGB32, QImage::Format_ARGB32_Premultiplied, 1.5, 0.5, QRegion(28, 22, 12, 14)},
+    };
+
+    for (SoftwareBlitIsa isa : supportedIsas()) {
+        for (const auto &testCase : cases) {
+            QTest::addRow("%s, %s", qPrintable(SoftwareBlitter::isaName(isa)), testCase.name)
+                << isa << testCase.destinationFormat << testCase.sourceFormat
+                << testCase.scale << testCase.opacity << testCase.clip;
+        }
+    }
+}
+
+void TestSoftwareBlitter::testDrawImage()
+{
+    QFETCH(SoftwareBlitIsa, isa);
+    QFETCH(QImage::Format, destinationFormat);
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(qreal, scale);
+    QFETCH(qreal, opacity);
+    QFETCH(QRegion, clip);
+
+    const QImage background = randomImage(QSize(200, 150), destinationFormat, 1);
+    const QImage source = randomImage(QSize(64, 48), sourceFormat, 2);
+    const QRect sourceRect(4, 2, 40, 30);
+    const QPoint position(24, 18);
+
+    // The blitter draws with the transformation of the painter, like in a scaled output.
+    QImage actual = background;
+    QPainter painter(&actual);
+    painter.scale(scale, scale);
+    if (!clip.isEmpty()) {
+        painter.setClipRegion(clip);
+    }
+    painter.setOpacity(opacity);
+    SoftwareBlitter blitter(isa);
+    QVERIFY(blitter.drawImage(&painter, QRectF(position, sourceRect.size()), source, sourceRect));
+    painter.end();
+    QCOMPARE(blitter.blittedImageCount(), quint64(1));
+
+    // QPainter draws an image that is already scaled, so the results don't depend on how it
+    // samples scaled images.
+    QImage expected = background;
+    painter.begin(&expected);
+    if (!clip.isEmpty()) {
+        QRegion deviceClip;
+        for (const QRect &rect : clip) {
+            deviceClip += QRect(rect.topLeft() * scale, rect.size() * scale);
+        }
+        painter.setClipRegion(deviceClip);
+    }
+    painter.setOpacity(opacity);
+    painter.drawImage(position * scale, scaleImage(source.copy(sourceRect), scale));
+    painter.end();
+
+    // QPainter interpolates opaque images with the opacity, which rounds once instead of twice.
+    const int tolerance = opacity < 1 ? 1 : 0;
+    QVERIFY(fuzzyCompare(actual, expected, tolerance));
+}
+
+void TestSoftwareBlitter::testUnsupported_data()
+{
+    QTest::addColumn<QImage::Format>("sourceFormat");
+    QTest::addColumn<QTransform>("transform");
+    QTest::addColumn<QRectF>("targetRect");
+    QTest::addColumn<bool>("smooth");
+
+    const QRectF targetRect(10, 10, 40, 30);
+    QTest::newRow("not premultiplied") << QImage::Format_ARGB32 << QTransform() << targetRect << false;
+    QTest::newRow("rotated") << QImage::Format_RGB32 << QTransform().rotate(90) << targetRect << false;
+    QTest::newRow("mirrored") << QImage::Format_RGB32 << QTransform::fromScale(-1, 1) << targetRect << false;
+    QTest::newRow("3x") << QImage::Format_RGB32 << QTransform::fromScale(3, 3) << targetRect << false;
+    QTest::newRow("downscaled") << QImage::Format_RGB32 << QTransform::fromScale(0.5, 0.5) << targetRect << false;
+    QTest::newRow("smooth 2x") << QImage::Format_RGB32 << QTransform::fromScale(2, 2) << targetRect << true;
+    QTest::newRow("subpixel") << QImage::Format_RGB32 << QTransform() << targetRect.translated(0.5, 0) << false;
+}
+
+void TestSoftwareBlitter::testUnsupported()
+{
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(QTransform, transform);
+    QFETCH(QRectF, targetRect);
+    QFETCH(bool, smooth);
+
+    const QImage background = randomImage(QSize(200, 150), QImage::Format_RGB32, 1);
+    const QImage source = randomImage(QSize(40, 30), QImage::Format_RGB32, 2).convertToFormat(sourceFormat);
+
+    QImage image = background;
+    QPainter painter(&image);
+    painter.setTransform(transform);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, smooth);
+    SoftwareBlitter blitter(SoftwareBlitter::bestIsa());
+    QVERIFY(!blitter.drawImage(&painter, targetRect, source, source.rect()));
+    painter.end();
+    QCOMPARE(blitter.fallbackImageCount(), quint64(1));
+    QCOMPARE(image, background);
+}
+
+/**
+ * Adds the benchmark rows for drawing with the @a isa; the rows of the QPainter benchmark
+ * have no prefix, the instruction set isn't used there.
+ */
+static void addBenchmarkRows(SoftwareBlitIsa isa, const QString &prefix)
+{
+    // Typical window sizes, and a full screen window on a 4k output with the scale factor 2.
+    const struct {
+        const char *name;
+        QSize size;
+        QImage::Format sourceFormat;
+        qreal scale;
+        qreal opacity;
+    } scenarios[] = {
+        {"800x600, opaque", QSize(800, 600), QImage::Format_RGB32, 1, 1},
+        {"800x600, argb", QSize(800, 600), QImage::Format_ARGB32_Premultiplied, 1, 1},
+        {"800x600, translucent", QSize(800, 600), QImage::Format_ARGB32_Premultiplied, 1, 0.8},
+        {"1920x1080, opaque", QSize(1920, 1080), QImage::Format_RGB32, 1, 1},
+        {"1920x1080, argb", QSize(1920, 1080), QImage::Format_ARGB32_Premultiplied, 1, 1},
+        {"1920x1080, 2x", QSize(1920, 1080), QImage::Format_RGB32, 2, 1},
+        {"1280x720, 1.5x", QSize(1280, 720), QImage::Format_RGB32, 1.5, 1},
+    };
+    for (const auto &scenario : scenarios) {
+        QTest::newRow(qPrintable(prefix + QLatin1String(scenario.name)))
+            << isa << scenario.size << scenario.sourceFormat << scenario.scale << scenario.opacity;
+    }
+}
+
+static void addBenchmarkColumns()
+{
+    QTest::addColumn<SoftwareBlitIsa>("isa");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QImage::Format>("sourceFormat");
+    QTest::addColumn<qreal>("scale");
+    QTest::addColumn<qreal>("opacity");
+}
+
+void TestSoftwareBlitter::benchmarkQPainter_data()
+{
+    addBenchmarkColumns();
+    addBenchmarkRows(SoftwareBlitIsa::Generic, QString());
+}
+
+void TestSoftwareBlitter::benchmarkQPainter()
+{
+    QFETCH(QSize, size);
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(qreal, scale);
+    QFETCH(qreal, opacity);
+
+    const QImage source = randomImage(size, sourceFormat, 2);
+    QImage destination = randomImage(size * scale, QImage::Format_RGB32, 1);
+
+    QPainter painter(&destination);
+    painter.scale(scale, scale);
+    painter.setOpacity(opacity);
+    QBENCHMARK {
+        painter.drawImage(QRectF(QPointF(0, 0), size), source, source.rect());
+    }
+}
+
+void TestSoftwareBlitter::benchmarkBlitter_data()
+{
+    addBenchmarkColumns();
+    for (SoftwareBlitIsa isa : supportedIsas()) {
+        addBenchmarkRows(isa, SoftwareBlitter::isaName(isa) + QLatin1String(", "));
+    }
+}
+
+void TestSoftwareBlitter::benchmarkBlitter()
+{
+    QFETCH(SoftwareBlitIsa, isa);
+    QFETCH(QSize, size);
+    QFETCH(QImage::Format, sourceFormat);
+    QFETCH(qreal, scale);
+    QFETCH(qreal, opacity);
+
+    const QImage source = randomImage(size, sourceFormat, 2);
+    QImage destination = randomImage(size * scale, QImage::Format_RGB32, 1);
+
+    QPainter painter(&destination);
+    painter.scale(scale, scale);
+    painter.setOpacity(opacity);
+    SoftwareBlitter blitter(isa);
+    QBENCHMARK {
+        blitter.drawImage(&painter, QRectF(QPointF(0, 0), size), source, source.rect());
+    }
+    QCOMPARE(blitter.fallbackImageCount(), quint64(0));
+}
+
+QTEST_GUILESS_MAIN(TestSoftwareBlitter)
+#include "test_software_blitter.moc"
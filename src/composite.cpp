@@ -13,6 +13,7 @@
 #include "decorations/decoratedclient.h"
 #include "deleted.h"
 #include "effects.h"
+#include "frametimingrecorder.h"
 #include "ftrace.h"
 #include "internal_client.h"
 #include "overlaywindow.h"
@@ -39,6 +40,7 @@
 #include <KPluginLoader>
 #include <KPluginMetaData>
 #include <KNotification>
+#include <KScreenLocker/KsldApp>
 #include <KSelectionOwner>
 
 #include <QDateTime>
@@ -46,6 +48,7 @@
 #include <QMenu>
 #include <QOpenGLContext>
 #include <QQuickWindow>
+#include <QSet>
 #include <QtConcurrentRun>
 #include <QTextStream>
 #include <QTimerEvent>
@@ -149,6 +152,7 @@ Compositor::Compositor(QObject* workspace)
     // register DBus
     new CompositorDBusInterface(this);
     FTraceLogger::create();
+    FrameTimingRecorder::create();
 }
 
 Compositor::~Compositor()
@@ -317,6 +321,11 @@ void Compositor::startupWithWorkspace()
     Workspace::self()->markXStackingOrderAsDirty();
     Q_ASSERT(m_scene);
 
+    if (waylandServer() && waylandServer()->hasScreenLockerIntegration()) {
+        connect(ScreenLocker::KSldApp::self(), &ScreenLocker::KSldApp::lockStateChanged,
+                this, &Compositor::invalidateWindowsToRender, Qt::UniqueConnection);
+    }
+
     const Platform *platform = kwinApp()->platform();
     if (platform->isPerScreenRenderingEnabled()) {
         const QVector<AbstractOutput *> outputs = platform->enabledOutputs();
@@ -374,6 +383,7 @@ void Compositor::registerRenderLoop(RenderLoop *renderLoop, AbstractOutput *outp
     Q_ASSERT(!m_renderLoops.contains(renderLoop));
     m_renderLoops.insert(renderLoop, output);
     connect(renderLoop, &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    FrameTimingRecorder::self()->registerRenderLoop(renderLoop, output ? output->name() : QStringLiteral("screens"));
 }
 
 void Compositor::unregisterRenderLoop(RenderLoop *renderLoop)
@@ -381,6 +391,7 @@ void Compositor::unregisterRenderLoop(RenderLoop *renderLoop)
     Q_ASSERT(m_renderLoops.contains(renderLoop));
     m_renderLoops.remove(renderLoop);
     disconnect(renderLoop, &RenderLoop::frameRequested, this, &Compositor::handleFrameRequested);
+    FrameTimingRecorder::self()->unregisterRenderLoop(renderLoop);
 }
 
 void Compositor::handleOutputEnabled(AbstractOutput *output)
@@ -467,6 +478,9 @@ void Compositor::stop()
     delete m_scene;
     m_scene = nullptr;
 
+    m_windowsToRender.clear();
+    m_windowsToRenderValid = false;
+
     m_state = State::Off;
     Q_EMIT compositingToggled(false);
 }
@@ -575,16 +589,37 @@ void Compositor::handleFrameRequested(RenderLoop *renderLoop)
 
 QList<Toplevel *> Compositor::windowsToRender() const
 {
-    // Create a list of all windows in the stacking order
-    QList<Toplevel *> windows = Workspace::self()->xStackingOrder();
+    if (m_windowsToRenderValid) {
+        m_windowsToRenderCacheHits++;
+    } else {
+        m_windowsToRender = buildWindowsToRender();
+        m_windowsToRenderValid = true;
+        m_windowsToRenderCacheRebuilds++;
+    }
+    return m_windowsToRender;
+}
 
-    // Move elevated windows to the top of the stacking order
+void Compositor::invalidateWindowsToRender()
+{
+    m_windowsToRenderValid = false;
+}
+
+quint64 Compositor::windowsToRenderCacheHits() const
+{
+    return m_windowsToRenderCacheHits;
+}
+
+quint64 Compositor::windowsToRenderCacheRebuilds() const
+{
+    return m_windowsToRenderCacheRebuilds;
+}
+
+QList<Toplevel *> Compositor::buildWindowsToRender() const
+{
+    // Create a list of all windows in the stacking order
+    const QList<Toplevel *> stackingOrder = Workspace::self()->xStackingOrder();
     const QList<EffectWindow *> elevatedList = static_cast<EffectsHandlerImpl *>(effects)->elevatedWindows();
-    for (EffectWindow *c : elevatedList) {
-        Toplevel *t = static_cast<EffectWindowImpl *>(c)->window();
-        windows.removeAll(t);
-        windows.append(t);
-    }
+    const bool screenLocked = waylandServer() && waylandServer()->isScreenLocked();
 
     // Skip windows that are not yet ready for being painted and if screen is locked skip windows
     // that are neither lockscreen nor inputmethod windows.
@@ -592,14 +627,34 @@ QList<Toplevel *> Compositor::windowsToRender() const
     // TODO? This cannot be used so carelessly - needs protections against broken clients, the
     // window should not get focus before it's displayed, handle unredirected windows properly and
     // so on.
-    for (Toplevel *win : windows) {
+    auto isRendered = [screenLocked](Toplevel *win) {
         if (!win->readyForPainting()) {
-            windows.removeAll(win);
+            return false;
         }
-        if (waylandServer() && waylandServer()->isScreenLocked()) {
-            if(!win->isLockScreen() && !win->isInputMethod()) {
-                windows.removeAll(win);
-            }
+        if (screenLocked && !win->isLockScreen() && !win->isInputMethod()) {
+            return false;
+        }
+        return true;
+    };
+
+    QList<Toplevel *> windows;
+    windows.reserve(stackingOrder.count());
+
+    QSet<Toplevel *> elevated;
+    for (EffectWindow *c : elevatedList) {
+        elevated.insert(static_cast<EffectWindowImpl *>(c)->window());
+    }
+    for (Toplevel *win : stackingOrder) {
+        if (!elevated.contains(win) && isRendered(win)) {
+            windows.append(win);
+        }
+    }
+
+    // Move elevated windows to the top of the stacking order
+    for (EffectWindow *c : elevatedList) {
+        Toplevel *t = static_cast<EffectWindowImpl *>(c)->window();
+        if (isRendered(t)) {
+            windows.append(t);
         }
     }
     return windows;
@@ -88,6 +88,20 @@ public:
     void keepSupportProperty(xcb_atom_t atom);
     void removeSupportProperty(xcb_atom_t atom);
     QList<Toplevel *> windowsToRender() const;
+    /**
+     * Marks the list returned by windowsToRender() as outdated. This has to be called when
+     * the stacking order, the elevated windows, the readiness of a window for painting or
+     * the screen lock state change.
+     */
+    void invalidateWindowsToRender();
+    /**
+     * Returns how many times windowsToRender() returned the cached list.
+     */
+    quint64 windowsToRenderCacheHits() const;
+    /**
+     * Returns how many times windowsToRender() had to rebuild the list.
+     */
+    quint64 windowsToRenderCacheRebuilds() const;
 
 Q_SIGNALS:
     void compositingToggled(bool active);
@@ -134,6 +148,7 @@ private:
 
     void registerRenderLoop(RenderLoop *renderLoop, AbstractOutput *output);
     void unregisterRenderLoop(RenderLoop *renderLoop);
+    QList<Toplevel *> buildWindowsToRender() const;
 
     State m_state;
 
@@ -143,6 +158,10 @@ private:
     QTimer m_unusedSupportPropertyTimer;
     Scene *m_scene;
     QMap<RenderLoop *, AbstractOutput *> m_renderLoops;
+    mutable QList<Toplevel *> m_windowsToRender;
+    mutable bool m_windowsToRenderValid = false;
+    mutable quint64 m_windowsToRenderCacheHits = 0;
+    mutable quint64 m_windowsToRenderCacheRebuilds = 0;
 };
 
 class KWIN_EXPORT WaylandCompositor final : public Compositor
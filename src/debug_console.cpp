@@ -17,6 +17,7 @@
 #include "waylandclient.h"
 #include "workspace.h"
 #include "keyboard_input.h"
+#include "pointer_input.h"
 #include "input_event.h"
 #include "subsurfacemonitor.h"
 #include "libinput/connection.h"
@@ -38,6 +39,7 @@
 #include <QMouseEvent>
 #include <QMetaProperty>
 #include <QMetaType>
+#include <QTimer>
 
 // xkb
 #include <xkbcommon/xkbcommon.h>
@@ -565,6 +567,14 @@ DebugConsole::DebugConsole()
         m_ui->inputDevicesView->setModel(new InputDeviceModel(this));
         m_ui->inputDevicesView->setItemDelegate(new DebugConsoleDelegate(this));
     }
+    // the compositing statistics change every frame, so poll them while the tab is visible
+    m_compositingTabTimer = new QTimer(this);
+    m_compositingTabTimer->setInterval(1000);
+    connect(m_compositingTabTimer, &QTimer::timeout, this, &DebugConsole::updateCompositingTab);
+    m_inputDevicesTabTimer = new QTimer(this);
+    m_inputDevicesTabTimer->setInterval(1000);
+    connect(m_inputDevicesTabTimer, &QTimer::timeout, this, &DebugConsole::updateInputDevicesTab);
+
     m_ui->quitButton->setIcon(QIcon::fromTheme(QStringLiteral("application-exit")));
     m_ui->tabWidget->setTabIcon(0, QIcon::fromTheme(QStringLiteral("view-list-tree")));
     m_ui->tabWidget->setTabIcon(1, QIcon::fromTheme(QStringLiteral("view-list-tree")));
@@ -585,10 +595,22 @@ DebugConsole::DebugConsole()
                 m_inputFilter.reset(new DebugConsoleFilter(m_ui->inputTextEdit));
                 input()->installInputEventSpy(m_inputFilter.data());
             }
+            if (index == 3) {
+                updateInputDevicesTab();
+                m_inputDevicesTabTimer->start();
+            } else {
+                m_inputDevicesTabTimer->stop();
+            }
             if (index == 5) {
                 updateKeyboardTab();
                 connect(input(), &InputRedirection::keyStateChanged, this, &DebugConsole::updateKeyboardTab);
             }
+            if (index == 6) {
+                updateCompositingTab();
+                m_compositingTabTimer->start();
+            } else {
+                m_compositingTabTimer->stop();
+            }
         }
     );
 
@@ -673,6 +695,40 @@ void DebugConsole::updateKeyboardTab()
     m_ui->activeModifiersLabel->setText(stateActiveComponents<xkb_mod_index_t>(state, xkb_keymap_num_mods(map), modActive, &xkb_keymap_mod_get_name));
 }
 
+void DebugConsole::updateCompositingTab()
+{
+    Compositor *compositor = Compositor::self();
+    if (!compositor) {
+        return;
+    }
+    m_ui->renderListCacheHitsLabel->setText(QString::number(compositor->windowsToRenderCacheHits()));
+    m_ui->renderListCacheRebuildsLabel->setText(QString::number(compositor->windowsToRenderCacheRebuilds()));
+
+    if (const Scene *scene = compositor->scene()) {
+        const Scene::ItemCacheStatistics &statistics = scene->itemCacheStatistics();
+        m_ui->clippedQuadsHitsLabel->setText(QString::number(statistics.clippedQuadsHits));
+        m_ui->clippedQuadsMissesLabel->setText(QString::number(statistics.clippedQuadsMisses));
+        m_ui->transformHitsLabel->setText(QString::number(statistics.transformHits));
+        m_ui->transformMissesLabel->setText(QString::number(statistics.transformMisses));
+    }
+}
+
+void DebugConsole::updateInputDevicesTab()
+{
+    const PointerInputRedirection::MotionLatency latency = input()->pointer()->motionLatency();
+    m_ui->motionEventsLabel->setText(QString::number(latency.events));
+    if (latency.events) {
+        m_ui->lastMotionLatencyLabel->setText(i18n("%1 µs", latency.last));
+        m_ui->averageMotionLatencyLabel->setText(i18n("%1 µs", latency.total / latency.events));
+        m_ui->maximumMotionLatencyLabel->setText(i18n("%1 µs", latency.maximum));
+    }
+    if (input()->pointer()->isMotionCoalescingEnabled()) {
+        m_ui->coalescedMotionEventsLabel->setText(QString::number(input()->pointer()->coalescedMotionEvents()));
+    } else {
+        m_ui->coalescedMotionEventsLabel->setText(i18n("Disabled"));
+    }
+}
+
 void DebugConsole::showEvent(QShowEvent *event)
 {
     QWidget::showEvent(event);
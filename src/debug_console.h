@@ -20,6 +20,7 @@
 #include <functional>
 
 class QTextEdit;
+class QTimer;
 
 namespace Ui
 {
@@ -104,9 +105,13 @@ protected:
 private:
     void initGLTab();
     void updateKeyboardTab();
+    void updateCompositingTab();
+    void updateInputDevicesTab();
 
     QScopedPointer<Ui::DebugConsole> m_ui;
     QScopedPointer<DebugConsoleFilter> m_inputFilter;
+    QTimer *m_compositingTabTimer;
+    QTimer *m_inputDevicesTabTimer;
 };
 
 class SurfaceTreeModel : public QAbstractItemModel
@@ -153,10 +153,10 @@ DecorationRenderer *DecorationItem::renderer() const
     return m_renderer.data();
 }
 
-WindowQuadList DecorationItem::buildQuads() const
+RenderQuadList DecorationItem::buildQuads() const
 {
     if (m_window->frameMargins().isNull()) {
-        return WindowQuadList();
+        return RenderQuadList();
     }
 
     QRect rects[4];
@@ -189,7 +189,7 @@ WindowQuadList DecorationItem::buildQuads() const
         Qt::Horizontal, // Bottom
     };
 
-    WindowQuadList list;
+    RenderQuadList list;
     list.reserve(4);
 
     for (int i = 0; i < 4; ++i) {
@@ -208,21 +208,21 @@ WindowQuadList DecorationItem::buildQuads() const
         const int u1 = (x1 + offsets[i].x()) * textureScale;
         const int v1 = (y1 + offsets[i].y()) * textureScale;
 
-        WindowQuad quad;
+        const QRectF rect(QPointF(x0, y0), QPointF(x1, y1));
 
         if (orientations[i] == Qt::Vertical) {
-            quad[0] = WindowVertex(x0, y0, v0, u0); // Top-left
-            quad[1] = WindowVertex(x1, y0, v0, u1); // Top-right
-            quad[2] = WindowVertex(x1, y1, v1, u1); // Bottom-right
-            quad[3] = WindowVertex(x0, y1, v1, u0); // Bottom-left
+            list.append(rect,
+                        QVector2D(v0, u0),  // Top-left
+                        QVector2D(v0, u1),  // Top-right
+                        QVector2D(v1, u1),  // Bottom-right
+                        QVector2D(v1, u0)); // Bottom-left
         } else {
-            quad[0] = WindowVertex(x0, y0, u0, v0); // Top-left
-            quad[1] = WindowVertex(x1, y0, u1, v0); // Top-right
-            quad[2] = WindowVertex(x1, y1, u1, v1); // Bottom-right
-            quad[3] = WindowVertex(x0, y1, u0, v1); // Bottom-left
+            list.append(rect,
+                        QVector2D(u0, v0),  // Top-left
+                        QVector2D(u1, v0),  // Top-right
+                        QVector2D(u1, v1),  // Bottom-right
+                        QVector2D(u0, v1)); // Bottom-left
         }
-
-        list.append(quad);
     }
 
     return list;
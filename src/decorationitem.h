@@ -79,7 +79,7 @@ private Q_SLOTS:
 
 protected:
     void preprocess() override;
-    WindowQuadList buildQuads() const override;
+    RenderQuadList buildQuads() const override;
 
 private:
     Toplevel *m_window;
@@ -13,6 +13,7 @@
 #include "abstract_output.h"
 #include "effectsadaptor.h"
 #include "effectloader.h"
+#include "frametimingrecorder.h"
 #ifdef KWIN_BUILD_ACTIVITIES
 #include "activities.h"
 #endif
@@ -373,12 +374,49 @@ void EffectsHandlerImpl::reconfigure()
     m_effectLoader->queryAndLoadAll();
 }
 
+inline void EffectsHandlerImpl::enterPaintCall(EffectsIterator effect)
+{
+    if (Q_UNLIKELY(m_recordEffectTimings)) {
+        chargePaintTime();
+        m_paintCallStack.append(effect - m_activeEffects.constBegin());
+    }
+}
+
+inline void EffectsHandlerImpl::enterFinalPaintCall()
+{
+    if (Q_UNLIKELY(m_recordEffectTimings)) {
+        chargePaintTime();
+        m_paintCallStack.append(-1);
+    }
+}
+
+inline void EffectsHandlerImpl::leavePaintCall()
+{
+    if (Q_UNLIKELY(m_recordEffectTimings)) {
+        chargePaintTime();
+        m_paintCallStack.removeLast();
+    }
+}
+
+// Effects call into each other, so the innermost call is charged only with the time that
+// has passed since the previous effect or the scene was entered or returned from.
+void EffectsHandlerImpl::chargePaintTime()
+{
+    const std::chrono::nanoseconds timestamp = std::chrono::steady_clock::now().time_since_epoch();
+    if (!m_paintCallStack.isEmpty() && m_paintCallStack.last() >= 0) {
+        m_effectPaintTimes[m_paintCallStack.last()] += timestamp - m_lastPaintCallTimestamp;
+    }
+    m_lastPaintCallTimestamp = timestamp;
+}
+
 // the idea is that effects call this function again which calls the next one
 void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData& data, std::chrono::milliseconds presentTime)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintScreenIterator);
         (*m_currentPaintScreenIterator++)->prePaintScreen(data, presentTime);
         --m_currentPaintScreenIterator;
+        leavePaintCall();
     }
     // no special final code
 }
@@ -386,10 +424,15 @@ void EffectsHandlerImpl::prePaintScreen(ScreenPrePaintData& data, std::chrono::m
 void EffectsHandlerImpl::paintScreen(int mask, const QRegion &region, ScreenPaintData& data)
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintScreenIterator);
         (*m_currentPaintScreenIterator++)->paintScreen(mask, region, data);
         --m_currentPaintScreenIterator;
-    } else
+        leavePaintCall();
+    } else {
+        enterFinalPaintCall();
         m_scene->finalPaintScreen(mask, region, data);
+        leavePaintCall();
+    }
 }
 
 void EffectsHandlerImpl::paintDesktop(int desktop, int mask, QRegion region, ScreenPaintData &data)
@@ -411,8 +454,10 @@ void EffectsHandlerImpl::paintDesktop(int desktop, int mask, QRegion region, Scr
 void EffectsHandlerImpl::postPaintScreen()
 {
     if (m_currentPaintScreenIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintScreenIterator);
         (*m_currentPaintScreenIterator++)->postPaintScreen();
         --m_currentPaintScreenIterator;
+        leavePaintCall();
     }
     // no special final code
 }
@@ -420,8 +465,10 @@ void EffectsHandlerImpl::postPaintScreen()
 void EffectsHandlerImpl::prePaintWindow(EffectWindow* w, WindowPrePaintData& data, std::chrono::milliseconds presentTime)
 {
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintWindowIterator);
         (*m_currentPaintWindowIterator++)->prePaintWindow(w, data, presentTime);
         --m_currentPaintWindowIterator;
+        leavePaintCall();
     }
     // no special final code
 }
@@ -429,28 +476,39 @@ void EffectsHandlerImpl::prePaintWindow(EffectWindow* w, WindowPrePaintData& dat
 void EffectsHandlerImpl::paintWindow(EffectWindow* w, int mask, const QRegion &region, WindowPaintData& data)
 {
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintWindowIterator);
         (*m_currentPaintWindowIterator++)->paintWindow(w, mask, region, data);
         --m_currentPaintWindowIterator;
-    } else
+        leavePaintCall();
+    } else {
+        enterFinalPaintCall();
         m_scene->finalPaintWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+        leavePaintCall();
+    }
 }
 
 void EffectsHandlerImpl::paintEffectFrame(EffectFrame* frame, const QRegion &region, double opacity, double frameOpacity)
 {
     if (m_currentPaintEffectFrameIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintEffectFrameIterator);
         (*m_currentPaintEffectFrameIterator++)->paintEffectFrame(frame, region, opacity, frameOpacity);
         --m_currentPaintEffectFrameIterator;
+        leavePaintCall();
     } else {
+        enterFinalPaintCall();
         const EffectFrameImpl* frameImpl = static_cast<const EffectFrameImpl*>(frame);
         frameImpl->finalRender(region, opacity, frameOpacity);
+        leavePaintCall();
     }
 }
 
 void EffectsHandlerImpl::postPaintWindow(EffectWindow* w)
 {
     if (m_currentPaintWindowIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentPaintWindowIterator);
         (*m_currentPaintWindowIterator++)->postPaintWindow(w);
         --m_currentPaintWindowIterator;
+        leavePaintCall();
     }
     // no special final code
 }
@@ -466,10 +524,15 @@ Effect *EffectsHandlerImpl::provides(Effect::Feature ef)
 void EffectsHandlerImpl::drawWindow(EffectWindow* w, int mask, const QRegion &region, WindowPaintData& data)
 {
     if (m_currentDrawWindowIterator != m_activeEffects.constEnd()) {
+        enterPaintCall(m_currentDrawWindowIterator);
         (*m_currentDrawWindowIterator++)->drawWindow(w, mask, region, data);
         --m_currentDrawWindowIterator;
-    } else
+        leavePaintCall();
+    } else {
+        enterFinalPaintCall();
         m_scene->finalDrawWindow(static_cast<EffectWindowImpl*>(w), mask, region, data);
+        leavePaintCall();
+    }
 }
 
 bool EffectsHandlerImpl::hasDecorationShadows() const
@@ -501,6 +564,33 @@ void EffectsHandlerImpl::startPaint()
     m_currentPaintWindowIterator = m_activeEffects.constBegin();
     m_currentPaintScreenIterator = m_activeEffects.constBegin();
     m_currentPaintEffectFrameIterator = m_activeEffects.constBegin();
+
+    m_recordEffectTimings = FrameTimingRecorder::activeRecorder() != nullptr;
+    if (m_recordEffectTimings) {
+        m_effectPaintTimes.fill(std::chrono::nanoseconds::zero(), m_activeEffects.count());
+        m_paintCallStack.clear();
+    }
+}
+
+void EffectsHandlerImpl::endPaint()
+{
+    if (!m_recordEffectTimings) {
+        return;
+    }
+    m_recordEffectTimings = false;
+
+    FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder();
+    if (!recorder) {
+        return;
+    }
+    for (int i = 0; i < m_activeEffects.count(); ++i) {
+        auto it = std::find_if(loaded_effects.constBegin(), loaded_effects.constEnd(), [this, i](const EffectPair &pair) {
+            return pair.second == m_activeEffects[i];
+        });
+        if (it != loaded_effects.constEnd()) {
+            recorder->addEffectTime(it->first, m_effectPaintTimes[i]);
+        }
+    }
 }
 
 void EffectsHandlerImpl::slotClientMaximized(KWin::AbstractClient *c, MaximizeMode maxMode)
@@ -1083,6 +1173,7 @@ void EffectsHandlerImpl::setElevatedWindow(KWin::EffectWindow* w, bool set)
     elevated_windows.removeAll(w);
     if (set)
         elevated_windows.append(w);
+    m_compositor->invalidateWindowsToRender();
 }
 
 void EffectsHandlerImpl::setTabBoxWindow(EffectWindow* w)
@@ -1491,6 +1582,21 @@ bool EffectsHandlerImpl::blocksDirectScanout() const
     return false;
 }
 
+bool EffectsHandlerImpl::needsAllWindows() const
+{
+    for (Effect *effect : m_activeEffects) {
+        if (effect->needsAllWindows()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EffectsHandlerImpl::hasActiveEffects() const
+{
+    return !m_activeEffects.isEmpty();
+}
+
 KWaylandServer::Display *EffectsHandlerImpl::waylandDisplay() const
 {
     if (waylandServer()) {
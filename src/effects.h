@@ -185,6 +185,7 @@ public:
 
     // internal (used by kwin core or compositing code)
     void startPaint();
+    void endPaint();
     void grabbedKeyboardEvent(QKeyEvent* e);
     bool hasKeyboardGrab() const;
 
@@ -201,6 +202,17 @@ public:
      */
     bool blocksDirectScanout() const;
 
+    /**
+     * Returns @c true if an active effect needs the window painting passes to run for
+     * all windows, not only the ones that intersect the output being painted.
+     */
+    bool needsAllWindows() const;
+
+    /**
+     * Returns @c true if any effect takes part in painting the current frame.
+     */
+    bool hasActiveEffects() const;
+
     /**
      * @returns Whether we are currently in a desktop rendering process triggered by paintDesktop hook
      */
@@ -338,11 +350,22 @@ private:
 
     typedef QVector< Effect*> EffectsList;
     typedef EffectsList::const_iterator EffectsIterator;
+    void enterPaintCall(EffectsIterator effect);
+    void enterFinalPaintCall();
+    void leavePaintCall();
+    void chargePaintTime();
+
     EffectsList m_activeEffects;
     EffectsIterator m_currentDrawWindowIterator;
     EffectsIterator m_currentPaintWindowIterator;
     EffectsIterator m_currentPaintEffectFrameIterator;
     EffectsIterator m_currentPaintScreenIterator;
+    // Time spent by each active effect in the current paint pass, recorded only while the
+    // FrameTimingRecorder is enabled. -1 on the call stack stands for the scene.
+    bool m_recordEffectTimings = false;
+    QVector<std::chrono::nanoseconds> m_effectPaintTimes;
+    QVector<int> m_paintCallStack;
+    std::chrono::nanoseconds m_lastPaintCallTimestamp = std::chrono::nanoseconds::zero();
     typedef QHash< QByteArray, QList< Effect*> > PropertyEffectMap;
     PropertyEffectMap m_propertiesForEffects;
     QHash<QByteArray, qulonglong> m_managedProperties;
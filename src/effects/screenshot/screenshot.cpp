@@ -9,13 +9,16 @@
     SPDX-License-Identifier: GPL-2.0-or-later
 */
 #include "screenshot.h"
+#include "screenshotcomposer.h"
 #include "screenshotdbusinterface1.h"
 #include "screenshotdbusinterface2.h"
 
 #include <kwinglplatform.h>
 #include <kwinglutils.h>
 
-#include <QPainter>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent>
 
 namespace KWin
 {
@@ -32,7 +35,8 @@ struct ScreenShotAreaData
     QFutureInterface<QImage> promise;
     ScreenShotFlags flags;
     QRect area;
-    QImage result;
+    qreal devicePixelRatio = 1.0;
+    QVector<ScreenShotReadback> readbacks;
     QList<EffectScreen *> screens;
 };
 
@@ -43,35 +47,39 @@ struct ScreenShotScreenData
     EffectScreen *screen = nullptr;
 };
 
-static void convertFromGLImage(QImage &img, int w, int h)
-{
-    // from QtOpenGL/qgl.cpp
-    // SPDX-FileCopyrightText: 2010 Nokia Corporation and /or its subsidiary(-ies)
-    // see https://github.com/qt/qtbase/blob/dev/src/opengl/qgl.cpp
-    if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
-        // OpenGL gives RGBA; Qt wants ARGB
-        uint *p = reinterpret_cast<uint *>(img.bits());
-        uint *end = p + w * h;
-        while (p < end) {
-            uint a = *p << 24;
-            *p = (*p >> 8) | a;
-            p++;
-        }
-    } else {
-        // OpenGL gives ABGR (i.e. RGBA backwards); Qt wants ARGB
-        for (int y = 0; y < h; y++) {
-            uint *q = reinterpret_cast<uint *>(img.scanLine(y));
-            for (int x = 0; x < w; ++x) {
-                const uint pixel = *q;
-                *q = ((pixel << 16) & 0xff0000) | ((pixel >> 16) & 0xff)
-                     | (pixel & 0xff00ff00);
-
-                q++;
-            }
-        }
+/**
+ * The pixels of a screenshot tile, either in a pixel buffer object that is being filled
+ * asynchronously or, if sync objects are unsupported, in an image read synchronously.
+ */
+struct ScreenShotReadback
+{
+    GLuint pixelBuffer = 0;
+    GLsync fence = nullptr;
+    const uchar *mappedData = nullptr;
+    QImage image;
+    QSize size;
+    QRect sourceRect;
+};
+
+struct ScreenShotJob
+{
+    QFutureInterface<QImage> promise;
+    ScreenShotComposition composition;
+    QVector<ScreenShotReadback> readbacks;
+    QFutureWatcher<QImage> *watcher = nullptr;
+};
+
+static int readbackStride(const QSize &size)
+{
+    return size.width() * 4;
+}
 
+static bool supportsAsyncReadback()
+{
+    if (GLPlatform::instance()->isGLES()) {
+        return hasGLVersion(3, 0);
     }
-    img = img.mirrored();
+    return hasGLVersion(3, 2) || hasGLExtension(QByteArrayLiteral("GL_ARB_sync"));
 }
 
 bool ScreenShotEffect::supported()
@@ -82,17 +90,42 @@ bool ScreenShotEffect::supported()
 ScreenShotEffect::ScreenShotEffect()
     : m_dbusInterface1(new ScreenShotDBusInterface1(this))
     , m_dbusInterface2(new ScreenShotDBusInterface2(this))
+    , m_readbackTimer(new QTimer(this))
+    , m_asyncReadback(supportsAsyncReadback())
 {
     connect(effects, &EffectsHandler::screenAdded, this, &ScreenShotEffect::handleScreenAdded);
     connect(effects, &EffectsHandler::screenRemoved, this, &ScreenShotEffect::handleScreenRemoved);
     connect(effects, &EffectsHandler::windowClosed, this, &ScreenShotEffect::handleWindowClosed);
+
+    // The fences are polled rather than waited on, a screenshot is usually read back within
+    // a couple of milliseconds after the frame has been submitted.
+    m_readbackTimer->setInterval(2);
+    m_readbackTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_readbackTimer, &QTimer::timeout, this, [this]() {
+        effects->makeOpenGLContextCurrent();
+        processReadbacks();
+    });
 }
 
 ScreenShotEffect::~ScreenShotEffect()
 {
+    effects->makeOpenGLContextCurrent();
+
     cancelWindowScreenShots();
     cancelAreaScreenShots();
     cancelScreenScreenShots();
+
+    for (ScreenShotJob *job : qAsConst(m_jobs)) {
+        if (job->watcher) {
+            // The worker may still read from the mapped pixel buffers.
+            job->watcher->waitForFinished();
+        }
+        for (ScreenShotReadback &readback : job->readbacks) {
+            releaseReadback(&readback);
+        }
+        job->promise.reportCanceled();
+        delete job;
+    }
 }
 
 QFuture<QImage> ScreenShotEffect::scheduleScreenShot(EffectScreen *screen, ScreenShotFlags flags)
@@ -142,9 +175,7 @@ QFuture<QImage> ScreenShotEffect::scheduleScreenShot(const QRect &area, ScreenSh
         }
     }
 
-    data.result = QImage(area.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
-    data.result.fill(Qt::transparent);
-    data.result.setDevicePixelRatio(devicePixelRatio);
+    data.devicePixelRatio = devicePixelRatio;
 
     m_areaScreenShots.append(data);
     effects->addRepaint(area);
@@ -182,8 +213,14 @@ void ScreenShotEffect::cancelWindowScreenShots()
 
 void ScreenShotEffect::cancelAreaScreenShots()
 {
+    if (m_asyncReadback && !m_areaScreenShots.isEmpty()) {
+        effects->makeOpenGLContextCurrent();
+    }
     while (!m_areaScreenShots.isEmpty()) {
         ScreenShotAreaData screenshot = m_areaScreenShots.takeLast();
+        for (ScreenShotReadback &readback : screenshot.readbacks) {
+            releaseReadback(&readback);
+        }
         screenshot.promise.reportCanceled();
     }
 }
@@ -233,7 +270,8 @@ void ScreenShotEffect::takeScreenShot(ScreenShotWindowData *screenshot)
 
         // render window into offscreen texture
         int mask = PAINT_WINDOW_TRANSFORMED | PAINT_WINDOW_TRANSLUCENT;
-        QImage img;
+        ScreenShotReadback readback;
+        readback.sourceRect = geometry;
         if (effects->isOpenGLCompositing()) {
             GLRenderTarget::pushRenderTarget(target.data());
             glClearColor(0.0, 0.0, 0.0, 0.0);
@@ -246,21 +284,20 @@ void ScreenShotEffect::takeScreenShot(ScreenShotWindowData *screenshot)
 
             effects->drawWindow(window, mask, infiniteRegion(), d);
 
-            // copy content from framebuffer into image
-            img = QImage(offscreenTexture->size(), QImage::Format_ARGB32);
-            img.setDevicePixelRatio(devicePixelRatio);
-            glReadnPixels(0, 0, img.width(), img.height(), GL_RGBA, GL_UNSIGNED_BYTE, img.sizeInBytes(),
-                          static_cast<GLvoid *>(img.bits()));
+            // copy content from framebuffer into a pixel buffer
+            readback.size = offscreenTexture->size();
+            readPixels(&readback);
             GLRenderTarget::popRenderTarget();
-            convertFromGLImage(img, img.width(), img.height());
         }
 
+        ScreenShotComposition composition;
+        composition.area = geometry;
+        composition.devicePixelRatio = devicePixelRatio;
         if (screenshot->flags & ScreenShotIncludeCursor) {
-            grabPointerImage(img, geometry.x(), geometry.y());
+            grabPointerImage(&composition);
         }
 
-        screenshot->promise.reportResult(img);
-        screenshot->promise.reportFinished();
+        submitScreenShot(screenshot->promise, composition, {readback});
     } else {
         screenshot->promise.reportCanceled();
     }
@@ -270,65 +307,61 @@ bool ScreenShotEffect::takeScreenShot(ScreenShotAreaData *screenshot)
 {
     if (!m_paintedScreen) {
         // On X11, all screens are painted simultaneously and there is no native HiDPI support.
-        QImage snapshot = blitScreenshot(screenshot->area);
+        ScreenShotComposition composition;
+        composition.area = screenshot->area;
         if (screenshot->flags & ScreenShotIncludeCursor) {
-            grabPointerImage(snapshot, screenshot->area.x(), screenshot->area.y());
-        }
-        screenshot->promise.reportResult(snapshot);
-        screenshot->promise.reportFinished();
-    } else {
-        if (!screenshot->screens.contains(m_paintedScreen)) {
-            return false;
-        }
-        screenshot->screens.removeOne(m_paintedScreen);
-
-        const QRect sourceRect = screenshot->area & m_paintedScreen->geometry();
-        qreal sourceDevicePixelRatio = 1.0;
-        if (screenshot->flags & ScreenShotNativeResolution) {
-            sourceDevicePixelRatio = m_paintedScreen->devicePixelRatio();
+            grabPointerImage(&composition);
         }
+        submitScreenShot(screenshot->promise, composition, {blitScreenshot(screenshot->area)});
+        return true;
+    }
 
-        const QImage snapshot = blitScreenshot(sourceRect, sourceDevicePixelRatio);
-        const QRect nativeArea(screenshot->area.topLeft(),
-                               screenshot->area.size() * screenshot->result.devicePixelRatio());
+    if (!screenshot->screens.contains(m_paintedScreen)) {
+        return false;
+    }
+    screenshot->screens.removeOne(m_paintedScreen);
 
-        QPainter painter(&screenshot->result);
-        painter.setWindow(nativeArea);
-        painter.drawImage(sourceRect, snapshot);
-        painter.end();
+    const QRect sourceRect = screenshot->area & m_paintedScreen->geometry();
+    qreal sourceDevicePixelRatio = 1.0;
+    if (screenshot->flags & ScreenShotNativeResolution) {
+        sourceDevicePixelRatio = m_paintedScreen->devicePixelRatio();
+    }
+    screenshot->readbacks.append(blitScreenshot(sourceRect, sourceDevicePixelRatio));
 
-        if (screenshot->screens.isEmpty()) {
-            if (screenshot->flags & ScreenShotIncludeCursor) {
-                grabPointerImage(screenshot->result, screenshot->area.x(), screenshot->area.y());
-            }
-            screenshot->promise.reportResult(screenshot->result);
-            screenshot->promise.reportFinished();
-        }
+    if (!screenshot->screens.isEmpty()) {
+        return false;
     }
 
-    return screenshot->promise.isFinished();
+    ScreenShotComposition composition;
+    composition.area = screenshot->area;
+    composition.devicePixelRatio = screenshot->devicePixelRatio;
+    composition.composite = true;
+    if (screenshot->flags & ScreenShotIncludeCursor) {
+        grabPointerImage(&composition);
+    }
+    submitScreenShot(screenshot->promise, composition, screenshot->readbacks);
+    return true;
 }
 
 bool ScreenShotEffect::takeScreenShot(ScreenShotScreenData *screenshot)
 {
-    if (!m_paintedScreen || screenshot->screen == m_paintedScreen) {
-        qreal devicePixelRatio = 1.0;
-        if (screenshot->flags & ScreenShotNativeResolution) {
-            devicePixelRatio = screenshot->screen->devicePixelRatio();
-        }
-
-        QImage snapshot = blitScreenshot(screenshot->screen->geometry(), devicePixelRatio);
-        if (screenshot->flags & ScreenShotIncludeCursor) {
-            const int xOffset = screenshot->screen->geometry().x();
-            const int yOffset = screenshot->screen->geometry().y();
-            grabPointerImage(snapshot, xOffset, yOffset);
-        }
+    if (m_paintedScreen && screenshot->screen != m_paintedScreen) {
+        return false;
+    }
 
-        screenshot->promise.reportResult(snapshot);
-        screenshot->promise.reportFinished();
+    qreal devicePixelRatio = 1.0;
+    if (screenshot->flags & ScreenShotNativeResolution) {
+        devicePixelRatio = screenshot->screen->devicePixelRatio();
     }
 
-    return screenshot->promise.isFinished();
+    ScreenShotComposition composition;
+    composition.area = screenshot->screen->geometry();
+    composition.devicePixelRatio = devicePixelRatio;
+    if (screenshot->flags & ScreenShotIncludeCursor) {
+        grabPointerImage(&composition);
+    }
+    submitScreenShot(screenshot->promise, composition, {blitScreenshot(composition.area, devicePixelRatio)});
+    return true;
 }
 
 void ScreenShotEffect::postPaintScreen()
@@ -351,46 +384,172 @@ void ScreenShotEffect::postPaintScreen()
             m_screenScreenShots.removeAt(i);
         }
     }
+
+    processReadbacks();
 }
 
-QImage ScreenShotEffect::blitScreenshot(const QRect &geometry, qreal devicePixelRatio) const
+ScreenShotReadback ScreenShotEffect::blitScreenshot(const QRect &geometry, qreal devicePixelRatio) const
 {
-    QImage image;
+    ScreenShotReadback readback;
+    readback.sourceRect = geometry;
 
     if (effects->isOpenGLCompositing()) {
-        const QSize nativeSize = geometry.size() * devicePixelRatio;
+        readback.size = geometry.size() * devicePixelRatio;
 
-        if (GLRenderTarget::blitSupported() && !GLPlatform::instance()->isGLES()) {
-            image = QImage(nativeSize.width(), nativeSize.height(), QImage::Format_ARGB32);
-            GLTexture texture(GL_RGBA8, nativeSize.width(), nativeSize.height());
+        if (GLRenderTarget::blitSupported()) {
+            GLTexture texture(GL_RGBA8, readback.size.width(), readback.size.height());
             GLRenderTarget target(texture);
             target.blitFromFramebuffer(geometry);
-            // copy content from framebuffer into image
-            texture.bind();
-            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                          static_cast<GLvoid *>(image.bits()));
-            texture.unbind();
+            // copy content from the texture into a pixel buffer
+            GLRenderTarget::pushRenderTarget(&target);
+            readPixels(&readback);
+            GLRenderTarget::popRenderTarget();
         } else {
-            image = QImage(nativeSize.width(), nativeSize.height(), QImage::Format_ARGB32);
-            glReadPixels(0, 0, nativeSize.width(), nativeSize.height(), GL_RGBA,
-                         GL_UNSIGNED_BYTE, static_cast<GLvoid *>(image.bits()));
+            readPixels(&readback);
         }
-        convertFromGLImage(image, nativeSize.width(), nativeSize.height());
     }
 
-    image.setDevicePixelRatio(devicePixelRatio);
-    return image;
+    return readback;
+}
+
+void ScreenShotEffect::readPixels(ScreenShotReadback *readback) const
+{
+    const int stride = readbackStride(readback->size);
+    const qsizetype byteCount = qsizetype(stride) * readback->size.height();
+
+    if (!m_asyncReadback) {
+        readback->image = QImage(readback->size, QImage::Format_ARGB32);
+        glReadnPixels(0, 0, readback->size.width(), readback->size.height(), GL_RGBA, GL_UNSIGNED_BYTE,
+                      readback->image.sizeInBytes(), static_cast<GLvoid *>(readback->image.bits()));
+        return;
+    }
+
+    // With a pixel buffer bound, glReadPixels() only queues the transfer, the fence tells
+    // when the pixels have landed in the buffer.
+    glGenBuffers(1, &readback->pixelBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pixelBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, byteCount, nullptr, GL_STREAM_READ);
+    glReadPixels(0, 0, readback->size.width(), readback->size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glFlush();
+}
+
+void ScreenShotEffect::releaseReadback(ScreenShotReadback *readback) const
+{
+    if (readback->mappedData) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback->pixelBuffer);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        readback->mappedData = nullptr;
+    }
+    if (readback->fence) {
+        glDeleteSync(readback->fence);
+        readback->fence = nullptr;
+    }
+    if (readback->pixelBuffer) {
+        glDeleteBuffers(1, &readback->pixelBuffer);
+        readback->pixelBuffer = 0;
+    }
+    readback->image = QImage();
+}
+
+void ScreenShotEffect::submitScreenShot(const QFutureInterface<QImage> &promise,
+                                        const ScreenShotComposition &composition,
+                                        const QVector<ScreenShotReadback> &readbacks)
+{
+    ScreenShotJob *job = new ScreenShotJob;
+    job->promise = promise;
+    job->composition = composition;
+    job->readbacks = readbacks;
+    m_jobs.append(job);
+}
+
+void ScreenShotEffect::processReadbacks()
+{
+    bool waiting = false;
+
+    for (ScreenShotJob *job : qAsConst(m_jobs)) {
+        if (job->watcher) {
+            continue;
+        }
+
+        bool ready = true;
+        for (const ScreenShotReadback &readback : qAsConst(job->readbacks)) {
+            if (readback.fence) {
+                const GLenum status = glClientWaitSync(readback.fence, 0, 0);
+                if (status == GL_TIMEOUT_EXPIRED) {
+                    ready = false;
+                    break;
+                }
+            }
+        }
+        if (!ready) {
+            waiting = true;
+            continue;
+        }
+
+        job->composition.tiles.clear();
+        for (ScreenShotReadback &readback : job->readbacks) {
+            ScreenShotTile tile;
+            tile.size = readback.size;
+            tile.stride = readbackStride(readback.size);
+            tile.sourceRect = readback.sourceRect;
+            if (readback.pixelBuffer) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+                readback.mappedData = static_cast<const uchar *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+                                                                                  qsizetype(tile.stride) * tile.size.height(),
+                                                                                  GL_MAP_READ_BIT));
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+                tile.data = readback.mappedData;
+            } else if (!readback.image.isNull()) {
+                tile.data = readback.image.constBits();
+            }
+            job->composition.tiles.append(tile);
+        }
+
+        // The worker reads straight from the mapped pixel buffers, they are unmapped after
+        // the image has been composed.
+        job->watcher = new QFutureWatcher<QImage>(this);
+        connect(job->watcher, &QFutureWatcher<QImage>::finished, this, [this, job]() {
+            finishScreenShot(job);
+        });
+        job->watcher->setFuture(QtConcurrent::run(composeScreenShot, job->composition));
+    }
+
+    if (waiting) {
+        m_readbackTimer->start();
+    } else {
+        m_readbackTimer->stop();
+    }
+}
+
+void ScreenShotEffect::finishScreenShot(ScreenShotJob *job)
+{
+    m_jobs.removeOne(job);
+
+    effects->makeOpenGLContextCurrent();
+    for (ScreenShotReadback &readback : job->readbacks) {
+        releaseReadback(&readback);
+    }
+
+    job->promise.reportResult(job->watcher->result());
+    job->promise.reportFinished();
+
+    job->watcher->deleteLater();
+    delete job;
 }
 
-void ScreenShotEffect::grabPointerImage(QImage &snapshot, int xOffset, int yOffset) const
+void ScreenShotEffect::grabPointerImage(ScreenShotComposition *composition) const
 {
     const PlatformCursorImage cursor = effects->cursorImage();
     if (cursor.image().isNull()) {
         return;
     }
 
-    QPainter painter(&snapshot);
-    painter.drawImage(effects->cursorPos() - cursor.hotSpot() - QPoint(xOffset, yOffset), cursor.image());
+    composition->cursorImage = cursor.image();
+    composition->cursorPosition = effects->cursorPos() - cursor.hotSpot();
 }
 
 bool ScreenShotEffect::isActive() const
@@ -17,6 +17,8 @@
 #include <QImage>
 #include <QObject>
 
+class QTimer;
+
 namespace KWin
 {
 
@@ -35,6 +37,9 @@ class ScreenShotDBusInterface2;
 struct ScreenShotWindowData;
 struct ScreenShotAreaData;
 struct ScreenShotScreenData;
+struct ScreenShotReadback;
+struct ScreenShotJob;
+struct ScreenShotComposition;
 
 /**
  * The ScreenShotEffect provides a convenient way to capture the contents of a given window,
@@ -43,6 +48,10 @@ struct ScreenShotScreenData;
  * Use the QFutureWatcher class to get notified when the requested screenshot is ready. Note
  * that the screenshot QFuture object can get cancelled if the captured window or the screen is
  * removed.
+ *
+ * If the OpenGL implementation supports sync objects, the pixels are read back into pixel
+ * buffer objects and the effect doesn't wait for the GPU; the pixel buffers are mapped once
+ * their fences have signalled, and the image is converted and composed in a worker thread.
  */
 class ScreenShotEffect : public Effect
 {
@@ -93,12 +102,22 @@ private:
     void cancelAreaScreenShots();
     void cancelScreenScreenShots();
 
-    void grabPointerImage(QImage &snapshot, int xOffset, int yOffset) const;
-    QImage blitScreenshot(const QRect &geometry, qreal devicePixelRatio = 1.0) const;
+    void grabPointerImage(ScreenShotComposition *composition) const;
+    ScreenShotReadback blitScreenshot(const QRect &geometry, qreal devicePixelRatio = 1.0) const;
+    void readPixels(ScreenShotReadback *readback) const;
+    void releaseReadback(ScreenShotReadback *readback) const;
+
+    void submitScreenShot(const QFutureInterface<QImage> &promise, const ScreenShotComposition &composition,
+                          const QVector<ScreenShotReadback> &readbacks);
+    void processReadbacks();
+    void finishScreenShot(ScreenShotJob *job);
 
     QVector<ScreenShotWindowData> m_windowScreenShots;
     QVector<ScreenShotAreaData> m_areaScreenShots;
     QVector<ScreenShotScreenData> m_screenScreenShots;
+    QVector<ScreenShotJob *> m_jobs;
+    QTimer *m_readbackTimer;
+    bool m_asyncReadback;
 
     QScopedPointer<ScreenShotDBusInterface1> m_dbusInterface1;
     QScopedPointer<ScreenShotDBusInterface2> m_dbusInterface2;
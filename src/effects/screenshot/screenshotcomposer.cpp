@@ -0,0 +1,82 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2010 Nokia Corporation and /or its subsidiary(-ies)
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "screenshotcomposer.h"
+
+#include <QPainter>
+
+namespace KWin
+{
+
+QImage convertFromGLImage(const uchar *data, const QSize &size, int stride)
+{
+    if (!data || size.isEmpty()) {
+        return QImage();
+    }
+
+    // from QtOpenGL/qgl.cpp
+    // SPDX-FileCopyrightText: 2010 Nokia Corporation and /or its subsidiary(-ies)
+    // see https://github.com/qt/qtbase/blob/dev/src/opengl/qgl.cpp
+    // The rows are flipped while being converted, so every pixel is touched only once.
+    QImage image(size, QImage::Format_ARGB32);
+    for (int y = 0; y < size.height(); ++y) {
+        const uint *source = reinterpret_cast<const uint *>(data + qsizetype(size.height() - 1 - y) * stride);
+        uint *destination = reinterpret_cast<uint *>(image.scanLine(y));
+        if (QSysInfo::ByteOrder == QSysInfo::BigEndian) {
+            // OpenGL gives RGBA; Qt wants ARGB
+            for (int x = 0; x < size.width(); ++x) {
+                const uint pixel = source[x];
+                destination[x] = (pixel >> 8) | (pixel << 24);
+            }
+        } else {
+            // OpenGL gives ABGR (i.e. RGBA backwards); Qt wants ARGB
+            for (int x = 0; x < size.width(); ++x) {
+                const uint pixel = source[x];
+                destination[x] = ((pixel << 16) & 0xff0000) | ((pixel >> 16) & 0xff)
+                        | (pixel & 0xff00ff00);
+            }
+        }
+    }
+    return image;
+}
+
+QImage composeScreenShot(const ScreenShotComposition &composition)
+{
+    QImage result;
+
+    if (composition.composite) {
+        result = QImage(composition.area.size() * composition.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        result.fill(Qt::transparent);
+        result.setDevicePixelRatio(composition.devicePixelRatio);
+
+        const QRect nativeArea(composition.area.topLeft(),
+                               composition.area.size() * composition.devicePixelRatio);
+
+        QPainter painter(&result);
+        painter.setWindow(nativeArea);
+        for (const ScreenShotTile &tile : composition.tiles) {
+            painter.drawImage(tile.sourceRect, convertFromGLImage(tile.data, tile.size, tile.stride));
+        }
+        painter.end();
+    } else if (!composition.tiles.isEmpty()) {
+        const ScreenShotTile &tile = composition.tiles.constFirst();
+        result = convertFromGLImage(tile.data, tile.size, tile.stride);
+        result.setDevicePixelRatio(composition.devicePixelRatio);
+    }
+
+    if (!result.isNull() && !composition.cursorImage.isNull()) {
+        QPainter painter(&result);
+        painter.drawImage(composition.cursorPosition - composition.area.topLeft(), composition.cursorImage);
+    }
+
+    return result;
+}
+
+} // namespace KWin
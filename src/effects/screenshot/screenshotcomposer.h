@@ -0,0 +1,62 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * A part of a screenshot as it has been read back from the GPU, i.e. RGBA pixels stored
+ * from the bottom row to the top row.
+ */
+struct ScreenShotTile
+{
+    const uchar *data = nullptr;
+    QSize size;
+    int stride = 0;
+    QRect sourceRect; ///< The covered area in the global coordinates
+};
+
+/**
+ * Describes how the tiles of a screenshot are put together into the final image.
+ *
+ * Composing a screenshot doesn't touch any compositor state, so it can be done in a
+ * worker thread while the compositor carries on painting.
+ */
+struct ScreenShotComposition
+{
+    QRect area;
+    qreal devicePixelRatio = 1.0;
+    QVector<ScreenShotTile> tiles;
+    /**
+     * Whether the tiles have to be painted on a transparent canvas covering the area, as
+     * opposed to using the only tile as it is.
+     */
+    bool composite = false;
+    QImage cursorImage;
+    QPoint cursorPosition; ///< The top-left corner of the cursor image in the global coordinates
+};
+
+/**
+ * Converts the RGBA pixels read back from OpenGL to a QImage with the ARGB32 format and
+ * flips them vertically.
+ */
+QImage convertFromGLImage(const uchar *data, const QSize &size, int stride);
+
+/**
+ * Returns the final image of the screenshot described by the @a composition.
+ */
+QImage composeScreenShot(const ScreenShotComposition &composition);
+
+} // namespace KWin
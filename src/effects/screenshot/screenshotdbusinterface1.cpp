@@ -467,16 +467,26 @@ static QString saveTempImage(const QImage &image)
     }
     image.save(&temp);
     temp.close();
-    KNotification::event(KNotification::Notification,
-                         i18nc("Notification caption that a screenshot got saved to file", "Screenshot"),
-                         i18nc("Notification with path to screenshot file", "Screenshot saved to %1", temp.fileName()),
-                         QStringLiteral("spectacle"));
     return temp.fileName();
 }
 
 void ScreenShotSinkFile1::flush(const QImage &image)
 {
-    QDBusConnection::sessionBus().send(m_replyMessage.createReply(saveTempImage(image)));
+    // Encoding the image takes a while, so it's done in a worker thread. The watcher is
+    // owned by the interface because the sink is destroyed right after it's been flushed.
+    auto watcher = new QFutureWatcher<QString>(m_interface);
+    QObject::connect(watcher, &QFutureWatcher<QString>::finished, m_interface, [watcher, replyMessage = m_replyMessage]() {
+        const QString fileName = watcher->result();
+        if (!fileName.isEmpty()) {
+            KNotification::event(KNotification::Notification,
+                                 i18nc("Notification caption that a screenshot got saved to file", "Screenshot"),
+                                 i18nc("Notification with path to screenshot file", "Screenshot saved to %1", fileName),
+                                 QStringLiteral("spectacle"));
+        }
+        QDBusConnection::sessionBus().send(replyMessage.createReply(fileName));
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(saveTempImage, image));
 }
 
 ScreenShotDBusInterface1::ScreenShotDBusInterface1(ScreenShotEffect *effect, QObject *parent)
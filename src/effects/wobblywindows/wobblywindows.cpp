@@ -1089,4 +1089,10 @@ bool WobblyWindowsEffect::isActive() const
     return !windows.isEmpty();
 }
 
+bool WobblyWindowsEffect::needsAllWindows() const
+{
+    // A wobbling window can stick out of its geometry onto another output.
+    return true;
+}
+
 } // namespace KWin
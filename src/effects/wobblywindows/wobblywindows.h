@@ -47,6 +47,7 @@ public:
     void prePaintWindow(EffectWindow* w, WindowPrePaintData& data, std::chrono::milliseconds presentTime) override;
     void postPaintScreen() override;
     bool isActive() const override;
+    bool needsAllWindows() const override;
 
     int requestedEffectChainPosition() const override {
         // Please notice that the Wobbly Windows effect has to be placed
@@ -0,0 +1,361 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "frametimingrecorder.h"
+
+#include <QDataStream>
+#include <QDBusConnection>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+KWIN_SINGLETON_FACTORY(KWin::FrameTimingRecorder)
+
+static const quint32 s_binaryMagic = 0x4b574654;
+static const quint32 s_binaryVersion = 1;
+
+static std::chrono::nanoseconds currentTime()
+{
+    return std::chrono::steady_clock::now().time_since_epoch();
+}
+
+FrameTimingRecorder::FrameTimingRecorder(QObject *parent)
+    : QObject(parent)
+{
+    QDBusConnection::sessionBus().registerObject(QStringLiteral("/FrameTiming"), this, QDBusConnection::ExportScriptableContents);
+    if (qEnvironmentVariableIsSet("KWIN_FRAME_TIMING")) {
+        setEnabled(true);
+    }
+}
+
+FrameTimingRecorder::~FrameTimingRecorder()
+{
+    qDeleteAll(m_timelines);
+    s_self = nullptr;
+}
+
+void FrameTimingRecorder::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_currentFrame = nullptr;
+
+    for (Timeline *timeline : qAsConst(m_timelines)) {
+        if (enabled) {
+            allocate(timeline);
+        } else {
+            timeline->frames = QVector<Frame>();
+        }
+    }
+
+    Q_EMIT enabledChanged();
+}
+
+void FrameTimingRecorder::clear()
+{
+    m_currentFrame = nullptr;
+    for (Timeline *timeline : qAsConst(m_timelines)) {
+        if (m_enabled) {
+            allocate(timeline);
+        }
+    }
+}
+
+void FrameTimingRecorder::allocate(Timeline *timeline)
+{
+    timeline->frames.fill(Frame(), capacity);
+    timeline->sequence = 0;
+    timeline->completedSequence = 0;
+    timeline->pendingRepaintRequest = std::chrono::nanoseconds::zero();
+}
+
+void FrameTimingRecorder::registerRenderLoop(RenderLoop *renderLoop, const QString &name)
+{
+    Timeline *timeline = m_timelines.value(renderLoop);
+    if (!timeline) {
+        timeline = new Timeline;
+        m_timelines.insert(renderLoop, timeline);
+    }
+    timeline->name = name;
+    if (m_enabled) {
+        allocate(timeline);
+    }
+}
+
+void FrameTimingRecorder::unregisterRenderLoop(RenderLoop *renderLoop)
+{
+    Timeline *timeline = m_timelines.take(renderLoop);
+    if (!timeline) {
+        return;
+    }
+    if (m_currentFrame >= timeline->frames.constData()
+            && m_currentFrame < timeline->frames.constData() + timeline->frames.count()) {
+        m_currentFrame = nullptr;
+    }
+    delete timeline;
+}
+
+FrameTimingRecorder::Timeline *FrameTimingRecorder::findTimeline(RenderLoop *renderLoop) const
+{
+    Timeline *timeline = m_timelines.value(renderLoop);
+    if (!timeline || timeline->frames.isEmpty()) {
+        return nullptr;
+    }
+    return timeline;
+}
+
+FrameTimingRecorder::Frame *FrameTimingRecorder::findFrame(Timeline *timeline, quint64 sequence) const
+{
+    if (sequence == 0 || sequence > timeline->sequence || timeline->sequence - sequence >= quint64(capacity)) {
+        return nullptr;
+    }
+    Frame *frame = &timeline->frames[(sequence - 1) % capacity];
+    return frame->sequence == sequence ? frame : nullptr;
+}
+
+void FrameTimingRecorder::repaintRequested(RenderLoop *renderLoop)
+{
+    if (Timeline *timeline = findTimeline(renderLoop)) {
+        if (timeline->pendingRepaintRequest == std::chrono::nanoseconds::zero()) {
+            timeline->pendingRepaintRequest = currentTime();
+        }
+    }
+}
+
+void FrameTimingRecorder::beginFrame(RenderLoop *renderLoop)
+{
+    Timeline *timeline = findTimeline(renderLoop);
+    if (!timeline) {
+        m_currentFrame = nullptr;
+        return;
+    }
+
+    timeline->sequence++;
+
+    Frame *frame = &timeline->frames[(timeline->sequence - 1) % capacity];
+    frame->sequence = timeline->sequence;
+    frame->timestamps.fill(std::chrono::nanoseconds::zero());
+    frame->effectCount = 0;
+    frame->failed = false;
+
+    const std::chrono::nanoseconds timestamp = currentTime();
+    if (timeline->pendingRepaintRequest != std::chrono::nanoseconds::zero()) {
+        frame->timestamps[int(Phase::RepaintRequested)] = timeline->pendingRepaintRequest;
+    } else {
+        frame->timestamps[int(Phase::RepaintRequested)] = timestamp;
+    }
+    frame->timestamps[int(Phase::BeginFrame)] = timestamp;
+    timeline->pendingRepaintRequest = std::chrono::nanoseconds::zero();
+
+    m_currentFrame = frame;
+}
+
+void FrameTimingRecorder::mark(Phase phase)
+{
+    if (m_currentFrame) {
+        m_currentFrame->timestamps[int(phase)] = currentTime();
+    }
+}
+
+void FrameTimingRecorder::addEffectTime(const QString &name, std::chrono::nanoseconds duration)
+{
+    if (!m_currentFrame || m_currentFrame->effectCount == maxEffectCount) {
+        return;
+    }
+    m_currentFrame->effects[m_currentFrame->effectCount++] = EffectTiming{effectIndex(name), duration};
+}
+
+quint16 FrameTimingRecorder::effectIndex(const QString &name)
+{
+    // The number of effects is small, and new names are only seen when an effect becomes
+    // active for the first time.
+    int index = m_effectNames.indexOf(name);
+    if (index == -1) {
+        index = m_effectNames.count();
+        m_effectNames.append(name);
+    }
+    return index;
+}
+
+FrameTimingRecorder::Frame *FrameTimingRecorder::nextCompletedFrame(RenderLoop *renderLoop)
+{
+    Timeline *timeline = findTimeline(renderLoop);
+    if (!timeline || timeline->completedSequence >= timeline->sequence) {
+        return nullptr;
+    }
+    timeline->completedSequence++;
+    return findFrame(timeline, timeline->completedSequence);
+}
+
+void FrameTimingRecorder::frameFailed(RenderLoop *renderLoop)
+{
+    if (Frame *frame = nextCompletedFrame(renderLoop)) {
+        frame->failed = true;
+    }
+}
+
+void FrameTimingRecorder::framePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp)
+{
+    if (Frame *frame = nextCompletedFrame(renderLoop)) {
+        frame->timestamps[int(Phase::Presented)] = timestamp;
+    }
+}
+
+template <typename Function>
+void FrameTimingRecorder::forEachFrame(const Timeline *timeline, Function function) const
+{
+    const quint64 count = std::min<quint64>(timeline->sequence, capacity);
+    for (quint64 sequence = timeline->sequence - count + 1; sequence <= timeline->sequence; ++sequence) {
+        function(timeline->frames[(sequence - 1) % capacity]);
+    }
+}
+
+QByteArray FrameTimingRecorder::exportBinary() const
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+
+    stream << s_binaryMagic << s_binaryVersion;
+    stream << quint32(m_effectNames.count());
+    for (const QString &name : m_effectNames) {
+        stream << name;
+    }
+
+    QVector<const Timeline *> timelines;
+    for (const Timeline *timeline : m_timelines) {
+        if (!timeline->frames.isEmpty()) {
+            timelines.append(timeline);
+        }
+    }
+
+    stream << quint32(timelines.count());
+    for (const Timeline *timeline : qAsConst(timelines)) {
+        stream << timeline->name;
+        stream << quint32(std::min<quint64>(timeline->sequence, capacity));
+        forEachFrame(timeline, [&stream](const Frame &frame) {
+            stream << frame.sequence << quint8(frame.failed);
+            for (const std::chrono::nanoseconds &timestamp : frame.timestamps) {
+                stream << qint64(timestamp.count());
+            }
+            stream << quint32(frame.effectCount);
+            for (int i = 0; i < frame.effectCount; ++i) {
+                stream << frame.effects[i].effect << qint64(frame.effects[i].duration.count());
+            }
+        });
+    }
+
+    return data;
+}
+
+static double toMicroseconds(std::chrono::nanoseconds timestamp)
+{
+    return std::chrono::duration<double, std::micro>(timestamp).count();
+}
+
+static QJsonObject makeCompleteEvent(const QString &name, int tid,
+                                     std::chrono::nanoseconds begin, std::chrono::nanoseconds end)
+{
+    return QJsonObject{
+        {QStringLiteral("name"), name},
+        {QStringLiteral("ph"), QStringLiteral("X")},
+        {QStringLiteral("pid"), 1},
+        {QStringLiteral("tid"), tid},
+        {QStringLiteral("ts"), toMicroseconds(begin)},
+        {QStringLiteral("dur"), toMicroseconds(end - begin)},
+    };
+}
+
+static QJsonObject makeInstantEvent(const QString &name, int tid, std::chrono::nanoseconds timestamp)
+{
+    return QJsonObject{
+        {QStringLiteral("name"), name},
+        {QStringLiteral("ph"), QStringLiteral("i")},
+        {QStringLiteral("s"), QStringLiteral("t")},
+        {QStringLiteral("pid"), 1},
+        {QStringLiteral("tid"), tid},
+        {QStringLiteral("ts"), toMicroseconds(timestamp)},
+    };
+}
+
+QString FrameTimingRecorder::exportChromeTrace() const
+{
+    QJsonArray events;
+    int tid = 0;
+
+    for (const Timeline *timeline : m_timelines) {
+        if (timeline->frames.isEmpty()) {
+            continue;
+        }
+        ++tid;
+
+        events.append(QJsonObject{
+            {QStringLiteral("name"), QStringLiteral("thread_name")},
+            {QStringLiteral("ph"), QStringLiteral("M")},
+            {QStringLiteral("pid"), 1},
+            {QStringLiteral("tid"), tid},
+            {QStringLiteral("args"), QJsonObject{{QStringLiteral("name"), timeline->name}}},
+        });
+
+        forEachFrame(timeline, [this, &events, tid](const Frame &frame) {
+            auto timestamp = [&frame](Phase phase) {
+                return frame.timestamps[int(phase)];
+            };
+            auto appendSpan = [&events, tid](const QString &name, std::chrono::nanoseconds begin,
+                                             std::chrono::nanoseconds end, const QJsonObject &args = {}) {
+                if (begin == std::chrono::nanoseconds::zero() || end < begin) {
+                    return;
+                }
+                QJsonObject event = makeCompleteEvent(name, tid, begin, end);
+                if (!args.isEmpty()) {
+                    event.insert(QStringLiteral("args"), args);
+                }
+                events.append(event);
+            };
+
+            const std::chrono::nanoseconds frameEnd = std::max(timestamp(Phase::EndFrame), timestamp(Phase::SwapEnd));
+            appendSpan(QStringLiteral("Frame %1").arg(frame.sequence), timestamp(Phase::BeginFrame), frameEnd,
+                       QJsonObject{{QStringLiteral("failed"), frame.failed}});
+            appendSpan(QStringLiteral("Pre-paint"), timestamp(Phase::PrePaintBegin), timestamp(Phase::PaintBegin));
+
+            QJsonObject effectArgs;
+            for (int i = 0; i < frame.effectCount; ++i) {
+                const EffectTiming &effect = frame.effects[i];
+                effectArgs.insert(m_effectNames.value(effect.effect), toMicroseconds(effect.duration));
+            }
+            appendSpan(QStringLiteral("Paint"), timestamp(Phase::PaintBegin), timestamp(Phase::PostPaintBegin), effectArgs);
+            appendSpan(QStringLiteral("Post-paint"), timestamp(Phase::PostPaintBegin), timestamp(Phase::PostPaintEnd));
+            if (timestamp(Phase::SwapEnd) != std::chrono::nanoseconds::zero()) {
+                appendSpan(QStringLiteral("Swap"), timestamp(Phase::EndFrame), timestamp(Phase::SwapEnd));
+            }
+
+            if (timestamp(Phase::RepaintRequested) != std::chrono::nanoseconds::zero()) {
+                events.append(makeInstantEvent(QStringLiteral("Repaint requested"), tid, timestamp(Phase::RepaintRequested)));
+            }
+            if (timestamp(Phase::Presented) != std::chrono::nanoseconds::zero()) {
+                events.append(makeInstantEvent(QStringLiteral("Presented"), tid, timestamp(Phase::Presented)));
+            }
+        });
+    }
+
+    const QJsonObject document{
+        {QStringLiteral("traceEvents"), events},
+        {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")},
+    };
+    return QString::fromUtf8(QJsonDocument(document).toJson(QJsonDocument::Compact));
+}
+
+} // namespace KWin
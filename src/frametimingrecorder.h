@@ -0,0 +1,181 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <kwinglobals.h>
+
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+#include <array>
+#include <chrono>
+
+namespace KWin
+{
+
+class RenderLoop;
+
+/**
+ * FrameTimingRecorder is a singleton that keeps a timeline of the most recently rendered
+ * frames for every output.
+ *
+ * For every frame, it records when the repaint was requested, when the render loop began
+ * and ended the frame, how long the scene spent in the pre-paint, paint and post-paint
+ * passes, how long every active effect took, when the buffer swap finished and when the
+ * frame was presented on the screen. The frames are kept in a fixed-size ring buffer that
+ * is allocated when the recording is enabled, so recording a frame never allocates.
+ *
+ * Usage: Either:
+ *  Set the KWIN_FRAME_TIMING environment variable before starting the application
+ *  Calling on DBus /FrameTiming org.kde.kwin.FrameTiming.setEnabled true
+ * The recorded frames can be fetched with exportBinary() or exportChromeTrace(). The
+ * latter can be loaded in chrome://tracing or Perfetto.
+ */
+class KWIN_EXPORT FrameTimingRecorder : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "org.kde.kwin.FrameTiming")
+    Q_PROPERTY(bool isEnabled READ isEnabled NOTIFY enabledChanged)
+
+public:
+    enum class Phase {
+        RepaintRequested,
+        BeginFrame,
+        PrePaintBegin,
+        PaintBegin,
+        PostPaintBegin,
+        PostPaintEnd,
+        EndFrame,
+        SwapEnd,
+        Presented,
+    };
+
+    static constexpr int phaseCount = int(Phase::Presented) + 1;
+    static constexpr int maxEffectCount = 32;
+    static constexpr int capacity = 1024;
+
+    ~FrameTimingRecorder() override;
+
+    /**
+     * Returns the recorder if it exists and frames are being recorded, otherwise @c null.
+     * This is meant to be used in hot paths, so they don't pay anything but a branch while
+     * the recording is disabled.
+     */
+    static FrameTimingRecorder *activeRecorder()
+    {
+        return s_self && s_self->m_enabled ? s_self : nullptr;
+    }
+
+    /**
+     * Whether frames are being recorded.
+     */
+    bool isEnabled() const
+    {
+        return m_enabled;
+    }
+
+    /**
+     * Starts tracking frames rendered by the given @a renderLoop. The @a name is used to
+     * identify the timeline in exported data, usually it is the name of the output.
+     */
+    void registerRenderLoop(RenderLoop *renderLoop, const QString &name);
+    void unregisterRenderLoop(RenderLoop *renderLoop);
+
+    /**
+     * Notifies the recorder that a repaint has been requested on the @a renderLoop. Only
+     * the first request before the frame begins is recorded.
+     */
+    void repaintRequested(RenderLoop *renderLoop);
+
+    /**
+     * Starts a new frame on the @a renderLoop. The frame becomes the current frame, i.e.
+     * subsequent calls to mark() and addEffectTime() apply to it.
+     */
+    void beginFrame(RenderLoop *renderLoop);
+
+    /**
+     * Records the current time for the given @a phase of the current frame.
+     */
+    void mark(Phase phase);
+
+    /**
+     * Records that the effect with the given @a name has spent @a duration painting the
+     * current frame.
+     */
+    void addEffectTime(const QString &name, std::chrono::nanoseconds duration);
+
+    void frameFailed(RenderLoop *renderLoop);
+    void framePresented(RenderLoop *renderLoop, std::chrono::nanoseconds timestamp);
+
+Q_SIGNALS:
+    void enabledChanged();
+
+public Q_SLOTS:
+    Q_SCRIPTABLE void setEnabled(bool enabled);
+    Q_SCRIPTABLE void clear();
+
+    /**
+     * Returns the recorded frames serialized with QDataStream.
+     *
+     * The data starts with the magic number 0x4b574654 ("KWFT") and the format version,
+     * followed by the table of effect names, and then by every timeline: its name and
+     * the frames from the oldest to the newest one. Each frame is stored as its sequence
+     * number, whether it failed, a timestamp in nanoseconds for every Phase (0 if the
+     * phase has not been reached), and the list of (effect name index, duration) pairs.
+     */
+    Q_SCRIPTABLE QByteArray exportBinary() const;
+
+    /**
+     * Returns the recorded frames in the Chrome trace event JSON format.
+     */
+    Q_SCRIPTABLE QString exportChromeTrace() const;
+
+private:
+    struct EffectTiming
+    {
+        quint16 effect;
+        std::chrono::nanoseconds duration;
+    };
+
+    struct Frame
+    {
+        quint64 sequence = 0;
+        std::array<std::chrono::nanoseconds, phaseCount> timestamps;
+        std::array<EffectTiming, maxEffectCount> effects;
+        int effectCount = 0;
+        bool failed = false;
+    };
+
+    struct Timeline
+    {
+        QString name;
+        QVector<Frame> frames;
+        quint64 sequence = 0;
+        quint64 completedSequence = 0;
+        std::chrono::nanoseconds pendingRepaintRequest = std::chrono::nanoseconds::zero();
+    };
+
+    Timeline *findTimeline(RenderLoop *renderLoop) const;
+    Frame *findFrame(Timeline *timeline, quint64 sequence) const;
+    Frame *nextCompletedFrame(RenderLoop *renderLoop);
+    template <typename Function>
+    void forEachFrame(const Timeline *timeline, Function function) const;
+    void allocate(Timeline *timeline);
+    quint16 effectIndex(const QString &name);
+
+    QHash<RenderLoop *, Timeline *> m_timelines;
+    QVector<QString> m_effectNames;
+    Frame *m_currentFrame = nullptr;
+    bool m_enabled = false;
+    KWIN_SINGLETON(FrameTimingRecorder)
+};
+
+} // namespace KWin
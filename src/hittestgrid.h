@@ -0,0 +1,165 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+#include <algorithm>
+
+namespace KWin
+{
+
+/**
+ * The HitTestGrid divides an area into square cells and remembers which items overlap each
+ * cell, so the items at a position can be found without looking at all of them.
+ *
+ * The items of a cell are sorted by their stacking index, the topmost item comes first.
+ * The parts of the items outside the area of the grid are ignored.
+ */
+template<typename T>
+class HitTestGrid
+{
+public:
+    /**
+     * Removes all items and makes the grid cover the given @a bounds.
+     */
+    void reset(const QRect &bounds, int cellSize = 256)
+    {
+        m_bounds = bounds;
+        m_cellSize = cellSize;
+        m_columns = bounds.isEmpty() ? 0 : (bounds.width() + cellSize - 1) / cellSize;
+        m_rows = bounds.isEmpty() ? 0 : (bounds.height() + cellSize - 1) / cellSize;
+        m_cells.clear();
+        m_cells.resize(m_columns * m_rows);
+        m_placements.clear();
+    }
+
+    QRect bounds() const
+    {
+        return m_bounds;
+    }
+
+    int count() const
+    {
+        return m_placements.count();
+    }
+
+    bool contains(const T &item) const
+    {
+        return m_placements.contains(item);
+    }
+
+    /**
+     * Adds the @a item covering the given @a rect. Items with a higher @a stackingIndex are
+     * found before the items with a lower one.
+     */
+    void insert(const T &item, const QRect &rect, int stackingIndex)
+    {
+        Q_ASSERT(!contains(item));
+        const Placement placement{cellRange(rect), stackingIndex};
+        m_placements.insert(item, placement);
+
+        const Entry entry{stackingIndex, rect, item};
+        forEachCell(placement.cells, [&entry](QVector<Entry> &cell) {
+            const auto it = std::upper_bound(cell.begin(), cell.end(), entry, [](const Entry &a, const Entry &b) {
+                return a.stackingIndex > b.stackingIndex;
+            });
+            cell.insert(it, entry);
+        });
+    }
+
+    void remove(const T &item)
+    {
+        const auto placement = m_placements.constFind(item);
+        if (placement == m_placements.constEnd()) {
+            return;
+        }
+        forEachCell(placement->cells, [&item](QVector<Entry> &cell) {
+            cell.erase(std::remove_if(cell.begin(), cell.end(), [&item](const Entry &entry) {
+                return entry.item == item;
+            }), cell.end());
+        });
+        m_placements.erase(placement);
+    }
+
+    /**
+     * Returns the topmost item whose rectangle contains @a pos and that is accepted by the
+     * @a predicate, or a default constructed item if there is none. The @a predicate is only
+     * called for the items whose rectangle contains @a pos.
+     */
+    template<typename Predicate>
+    T find(const QPoint &pos, Predicate predicate) const
+    {
+        if (!m_bounds.contains(pos)) {
+            return T();
+        }
+        const int column = (pos.x() - m_bounds.x()) / m_cellSize;
+        const int row = (pos.y() - m_bounds.y()) / m_cellSize;
+        for (const Entry &entry : m_cells[row * m_columns + column]) {
+            if (entry.rect.contains(pos) && predicate(entry.item)) {
+                return entry.item;
+            }
+        }
+        return T();
+    }
+
+private:
+    struct Entry
+    {
+        int stackingIndex;
+        QRect rect;
+        T item;
+    };
+
+    struct Placement
+    {
+        QRect cells;
+        int stackingIndex;
+    };
+
+    /**
+     * Returns the columns and rows of the cells overlapped by @a rect.
+     */
+    QRect cellRange(const QRect &rect) const
+    {
+        const QRect clipped = rect & m_bounds;
+        if (clipped.isEmpty()) {
+            return QRect();
+        }
+        const QPoint topLeft = clipped.topLeft() - m_bounds.topLeft();
+        const QPoint bottomRight = clipped.bottomRight() - m_bounds.topLeft();
+        return QRect(QPoint(topLeft.x() / m_cellSize, topLeft.y() / m_cellSize),
+                     QPoint(bottomRight.x() / m_cellSize, bottomRight.y() / m_cellSize));
+    }
+
+    template<typename Function>
+    void forEachCell(const QRect &cells, Function function)
+    {
+        if (cells.isEmpty()) {
+            return;
+        }
+        for (int row = cells.top(); row <= cells.bottom(); ++row) {
+            for (int column = cells.left(); column <= cells.right(); ++column) {
+                function(m_cells[row * m_columns + column]);
+            }
+        }
+    }
+
+    QRect m_bounds;
+    int m_cellSize = 256;
+    int m_columns = 0;
+    int m_rows = 0;
+    QVector<QVector<Entry>> m_cells;
+    QHash<T, Placement> m_placements;
+};
+
+} // namespace KWin
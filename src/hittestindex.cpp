@@ -0,0 +1,164 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "hittestindex.h"
+#include "abstract_client.h"
+#include "unmanaged.h"
+#include "virtualdesktops.h"
+#include "workspace.h"
+
+#include <utility>
+
+namespace KWin
+{
+
+static QRect hitTestRect(const Toplevel *toplevel)
+{
+    // The resize borders of the decoration and the sub-surfaces can be outside of the frame.
+    return toplevel->frameGeometry() | toplevel->bufferGeometry() | toplevel->inputGeometry()
+        | toplevel->visibleGeometry();
+}
+
+HitTestIndex::HitTestIndex(Workspace *workspace)
+    : QObject(workspace)
+    , m_workspace(workspace)
+{
+    connect(workspace, &Workspace::unmanagedAdded, this, &HitTestIndex::markAllDirty);
+    connect(workspace, &Workspace::unmanagedRemoved, this, &HitTestIndex::markAllDirty);
+    connect(VirtualDesktopManager::self(), &VirtualDesktopManager::currentChanged, this, &HitTestIndex::markAllDirty);
+}
+
+bool HitTestIndex::isEnabled()
+{
+    return qgetenv("KWIN_INPUT_HITTEST_INDEX") != "0";
+}
+
+bool HitTestIndex::covers(const QPoint &pos)
+{
+    update();
+    return m_toplevels.bounds().contains(pos);
+}
+
+void HitTestIndex::update()
+{
+    if (m_stackingOrderSerial != m_workspace->stackingOrderSerial()
+            || m_toplevels.bounds() != m_workspace->geometry()) {
+        m_dirty = true;
+    }
+    if (m_dirty) {
+        rebuild();
+        return;
+    }
+    if (m_dirtyToplevels.isEmpty()) {
+        return;
+    }
+    const QSet<Toplevel *> dirtyToplevels = std::exchange(m_dirtyToplevels, {});
+    for (Toplevel *toplevel : dirtyToplevels) {
+        place(toplevel);
+    }
+}
+
+void HitTestIndex::rebuild()
+{
+    m_dirty = false;
+    m_dirtyToplevels.clear();
+    m_stackingOrderSerial = m_workspace->stackingOrderSerial();
+    m_toplevels.reset(m_workspace->geometry());
+    m_unmanaged.reset(m_workspace->geometry());
+    m_stackingIndices.clear();
+    m_unmanagedIndices.clear();
+
+    const QList<Toplevel *> &stacking = m_workspace->stackingOrder();
+    for (int i = 0; i < stacking.count(); ++i) {
+        m_stackingIndices.insert(stacking[i], i);
+    }
+    const QList<Unmanaged *> &unmanaged = m_workspace->unmanagedList();
+    for (int i = 0; i < unmanaged.count(); ++i) {
+        // The unmanaged windows are looked up in the order of the list, not the stacking order.
+        m_unmanagedIndices.insert(unmanaged[i], -i);
+    }
+
+    for (Toplevel *toplevel : stacking) {
+        track(toplevel);
+        place(toplevel);
+    }
+    for (Unmanaged *toplevel : unmanaged) {
+        if (!m_stackingIndices.contains(toplevel)) {
+            track(toplevel);
+            place(toplevel);
+        }
+    }
+}
+
+void HitTestIndex::place(Toplevel *toplevel)
+{
+    m_toplevels.remove(toplevel);
+    m_unmanaged.remove(toplevel);
+    if (toplevel->isDeleted()) {
+        // a deleted window doesn't get mouse events
+        return;
+    }
+
+    const QRect rect = hitTestRect(toplevel);
+    const auto unmanagedIndex = m_unmanagedIndices.constFind(toplevel);
+    if (unmanagedIndex != m_unmanagedIndices.constEnd()) {
+        m_unmanaged.insert(toplevel, rect, *unmanagedIndex);
+    }
+
+    const auto stackingIndex = m_stackingIndices.constFind(toplevel);
+    if (stackingIndex == m_stackingIndices.constEnd()) {
+        return;
+    }
+    if (AbstractClient *client = qobject_cast<AbstractClient *>(toplevel)) {
+        if (client->isMinimized() || !client->isOnCurrentDesktop()) {
+            return;
+        }
+    }
+    m_toplevels.insert(toplevel, rect, *stackingIndex);
+}
+
+void HitTestIndex::track(Toplevel *toplevel)
+{
+    if (m_tracked.contains(toplevel)) {
+        return;
+    }
+    m_tracked.insert(toplevel);
+
+    connect(toplevel, &QObject::destroyed, this, [this](QObject *object) {
+        m_tracked.remove(object);
+        markAllDirty();
+    });
+    if (toplevel->isDeleted()) {
+        return;
+    }
+
+    auto markToplevelDirty = [this, toplevel]() {
+        markDirty(toplevel);
+    };
+    connect(toplevel, &Toplevel::frameGeometryChanged, this, markToplevelDirty);
+    connect(toplevel, &Toplevel::bufferGeometryChanged, this, markToplevelDirty);
+    connect(toplevel, &Toplevel::visibleGeometryChanged, this, markToplevelDirty);
+    if (AbstractClient *client = qobject_cast<AbstractClient *>(toplevel)) {
+        connect(client, &AbstractClient::decorationChanged, this, markToplevelDirty);
+        connect(client, &AbstractClient::desktopChanged, this, markToplevelDirty);
+        connect(client, &AbstractClient::minimizedChanged, this, markToplevelDirty);
+    }
+}
+
+void HitTestIndex::markDirty(Toplevel *toplevel)
+{
+    m_dirtyToplevels.insert(toplevel);
+}
+
+void HitTestIndex::markAllDirty()
+{
+    m_dirty = true;
+}
+
+} // namespace KWin
@@ -0,0 +1,95 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "hittestgrid.h"
+
+#include <QObject>
+#include <QSet>
+
+namespace KWin
+{
+
+class Toplevel;
+class Workspace;
+
+/**
+ * The HitTestIndex finds the windows at a position for the input redirection without walking
+ * the whole stacking order.
+ *
+ * It keeps the windows in a HitTestGrid covering the workspace, sorted by their position in the
+ * stacking order. Windows that are minimized or on another virtual desktop are left out. A
+ * window is moved in the grid when its geometry or its state changes; the grid is built again
+ * when the stacking order, the unmanaged windows, the current virtual desktop or the geometry
+ * of the workspace change.
+ *
+ * The windows in the grid still have to be checked with Toplevel::hitTest(), the grid only
+ * knows the rectangles enclosing them.
+ */
+class HitTestIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HitTestIndex(Workspace *workspace);
+
+    /**
+     * Returns @c false if the index has been disabled with KWIN_INPUT_HITTEST_INDEX=0.
+     */
+    static bool isEnabled();
+
+    /**
+     * Returns @c true if the grid covers the position @a pos. The windows at other positions
+     * have to be looked up in the stacking order.
+     */
+    bool covers(const QPoint &pos);
+
+    /**
+     * Returns the topmost window at @a pos in the stacking order that is accepted by the
+     * @a predicate, or @c null if there is none.
+     */
+    template<typename Predicate>
+    Toplevel *findToplevel(const QPoint &pos, Predicate predicate)
+    {
+        update();
+        return m_toplevels.find(pos, predicate);
+    }
+
+    /**
+     * Returns the first unmanaged window in Workspace::unmanagedList() at @a pos that is
+     * accepted by the @a predicate, or @c null if there is none.
+     */
+    template<typename Predicate>
+    Toplevel *findUnmanaged(const QPoint &pos, Predicate predicate)
+    {
+        update();
+        return m_unmanaged.find(pos, predicate);
+    }
+
+private:
+    void update();
+    void rebuild();
+    void place(Toplevel *toplevel);
+    void track(Toplevel *toplevel);
+    void markDirty(Toplevel *toplevel);
+    void markAllDirty();
+
+    Workspace *m_workspace;
+    HitTestGrid<Toplevel *> m_toplevels;
+    HitTestGrid<Toplevel *> m_unmanaged;
+    QHash<Toplevel *, int> m_stackingIndices;
+    QHash<Toplevel *, int> m_unmanagedIndices;
+    QSet<QObject *> m_tracked;
+    QSet<Toplevel *> m_dirtyToplevels;
+    quint64 m_stackingOrderSerial = 0;
+    bool m_dirty = true;
+};
+
+} // namespace KWin
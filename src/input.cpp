@@ -12,6 +12,7 @@
 #include "effects.h"
 #include "gestures.h"
 #include "globalshortcuts.h"
+#include "hittestindex.h"
 #include "input_event.h"
 #include "input_event_spy.h"
 #include "keyboard_input.h"
@@ -1418,7 +1419,13 @@ public:
         case QEvent::MouseMove: {
             seat->notifyPointerMotion(event->globalPos());
             MouseEvent *e = static_cast<MouseEvent*>(event);
-            if (e->delta() != QSizeF()) {
+            const QVector<MouseEvent::RelativeMotion> relativeMotions = e->relativeMotions();
+            if (!relativeMotions.isEmpty()) {
+                // clients using relative motion get every event, not only the merged one
+                for (const MouseEvent::RelativeMotion &motion : relativeMotions) {
+                    seat->relativePointerMotion(motion.delta, motion.deltaUnaccelerated, motion.timestampMicroseconds);
+                }
+            } else if (e->delta() != QSizeF()) {
                 seat->relativePointerMotion(e->delta(), e->deltaUnaccelerated(), e->timestampMicroseconds());
             }
             seat->notifyPointerFrame();
@@ -2386,13 +2393,13 @@ void InputRedirection::setupLibInput()
         connect(conn, &LibInput::Connection::keyChanged, m_keyboard, &KeyboardInputRedirection::processKey);
         connect(conn, &LibInput::Connection::pointerMotion, this,
             [this] (const QSizeF &delta, const QSizeF &deltaNonAccel, uint32_t time, quint64 timeMicroseconds, LibInput::Device *device) {
-                m_pointer->processMotion(m_pointer->pos() + QPointF(delta.width(), delta.height()), delta, deltaNonAccel, time, timeMicroseconds, device);
+                m_pointer->queueMotion(m_pointer->queuedPos() + QPointF(delta.width(), delta.height()), delta, deltaNonAccel, time, timeMicroseconds, device);
             }
         );
         connect(conn, &LibInput::Connection::pointerMotionAbsolute, this,
             [this] (QPointF orig, QPointF screen, uint32_t time, LibInput::Device *device) {
                 Q_UNUSED(orig)
-                m_pointer->processMotion(screen, time, device);
+                m_pointer->queueMotion(screen, QSizeF(), QSizeF(), time, 0, device);
             }
         );
         connect(conn, &LibInput::Connection::touchDown, m_touch, &TouchInputRedirection::processDown);
@@ -2547,7 +2554,7 @@ void InputRedirection::setupLibInputWithScreens()
 
 void InputRedirection::processPointerMotion(const QPointF &pos, uint32_t time)
 {
-    m_pointer->processMotion(pos, time);
+    m_pointer->queueMotion(pos, QSizeF(), QSizeF(), time, 0, nullptr);
 }
 
 void InputRedirection::processPointerButton(uint32_t button, InputRedirection::PointerButtonState state, uint32_t time)
@@ -2627,11 +2634,18 @@ Toplevel *InputRedirection::findToplevel(const QPoint &pos)
         if (effects && static_cast<EffectsHandlerImpl*>(effects)->isMouseInterception()) {
             return nullptr;
         }
-        const QList<Unmanaged *> &unmanaged = Workspace::self()->unmanagedList();
-        Q_FOREACH (Unmanaged *u, unmanaged) {
-            if (u->hitTest(pos)) {
+        HitTestIndex *index = hitTestIndex();
+        if (index && index->covers(pos)) {
+            if (Toplevel *u = index->findUnmanaged(pos, [&pos](Toplevel *t) { return t->hitTest(pos); })) {
                 return u;
             }
+        } else {
+            const QList<Unmanaged *> &unmanaged = Workspace::self()->unmanagedList();
+            Q_FOREACH (Unmanaged *u, unmanaged) {
+                if (u->hitTest(pos)) {
+                    return u;
+                }
+            }
         }
     }
     return findManagedToplevel(pos);
@@ -2643,38 +2657,49 @@ Toplevel *InputRedirection::findManagedToplevel(const QPoint &pos)
         return nullptr;
     }
     const bool isScreenLocked = waylandServer() && waylandServer()->isScreenLocked();
-    const QList<Toplevel *> &stacking = Workspace::self()->stackingOrder();
-    if (stacking.isEmpty()) {
-        return nullptr;
-    }
-    auto it = stacking.end();
-    do {
-        --it;
-        Toplevel *t = (*it);
+    auto acceptsInput = [&pos, isScreenLocked](Toplevel *t) {
         if (t->isDeleted()) {
             // a deleted window doesn't get mouse events
-            continue;
+            return false;
         }
         if (AbstractClient *c = dynamic_cast<AbstractClient*>(t)) {
             if (!c->isOnCurrentActivity() || !c->isOnCurrentDesktop() || c->isMinimized() || c->isHiddenInternal()) {
-                continue;
+                return false;
             }
         }
         if (!t->readyForPainting()) {
-            continue;
+            return false;
         }
         if (isScreenLocked) {
             if (!t->isLockScreen() && !t->isInputMethod()) {
-                continue;
+                return false;
             }
         }
-        if (t->hitTest(pos)) {
-            return t;
+        return t->hitTest(pos);
+    };
+
+    HitTestIndex *index = hitTestIndex();
+    if (index && index->covers(pos)) {
+        return index->findToplevel(pos, acceptsInput);
+    }
+
+    const QList<Toplevel *> &stacking = Workspace::self()->stackingOrder();
+    for (auto it = stacking.crbegin(); it != stacking.crend(); ++it) {
+        if (acceptsInput(*it)) {
+            return *it;
         }
-    } while (it != stacking.begin());
+    }
     return nullptr;
 }
 
+HitTestIndex *InputRedirection::hitTestIndex()
+{
+    if (!m_hitTestIndex && HitTestIndex::isEnabled()) {
+        m_hitTestIndex = new HitTestIndex(Workspace::self());
+    }
+    return m_hitTestIndex;
+}
+
 Qt::KeyboardModifiers InputRedirection::keyboardModifiers() const
 {
     return m_keyboard->modifiers();
@@ -32,6 +32,7 @@ class QWheelEvent;
 namespace KWin
 {
 class GlobalShortcutsManager;
+class HitTestIndex;
 class Toplevel;
 class InputEventFilter;
 class InputEventSpy;
@@ -316,6 +317,7 @@ private:
     void reconfigure();
     void setupInputFilters();
     void installInputEventFilter(InputEventFilter *filter);
+    HitTestIndex *hitTestIndex();
     KeyboardInputRedirection *m_keyboard;
     PointerInputRedirection *m_pointer;
     TabletInputRedirection *m_tablet;
@@ -327,6 +329,7 @@ private:
     LibInput::Connection *m_libInput = nullptr;
 
     WindowSelectorFilter *m_windowSelector = nullptr;
+    QPointer<HitTestIndex> m_hitTestIndex;
 
     QVector<InputEventFilter*> m_filters;
     QVector<InputEventSpy*> m_spies;
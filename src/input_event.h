@@ -12,6 +12,7 @@
 #include "input.h"
 
 #include <QInputEvent>
+#include <QVector>
 
 namespace KWin
 {
@@ -61,6 +62,25 @@ public:
         m_nativeButton = button;
     }
 
+    struct RelativeMotion
+    {
+        QSizeF delta;
+        QSizeF deltaUnaccelerated;
+        quint64 timestampMicroseconds;
+    };
+
+    /**
+     * The relative motion of each of the motion events that have been merged into this one,
+     * empty if the event has not been merged.
+     */
+    QVector<RelativeMotion> relativeMotions() const {
+        return m_relativeMotions;
+    }
+
+    void setRelativeMotions(const QVector<RelativeMotion> &motions) {
+        m_relativeMotions = motions;
+    }
+
 private:
     QSizeF m_delta;
     QSizeF m_deltaUnccelerated;
@@ -68,6 +88,7 @@ private:
     LibInput::Device *m_device;
     Qt::KeyboardModifiers m_modifiersRelevantForShortcuts = Qt::KeyboardModifiers();
     quint32 m_nativeButton = 0;
+    QVector<RelativeMotion> m_relativeMotions;
 };
 
 // TODO: Don't derive from QWheelEvent, this event is quite domain specific.
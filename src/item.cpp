@@ -16,7 +16,10 @@
 namespace KWin
 {
 
+static quint64 s_lastGeneration = 0;
+
 Item::Item(Item *parent)
+    : m_generation(++s_lastGeneration)
 {
     setParentItem(parent);
     connect(kwinApp()->platform(), &Platform::outputDisabled, this, &Item::removeRepaints);
@@ -66,6 +69,7 @@ void Item::setParentItem(Item *item)
     if (m_parentItem) {
         m_parentItem->addChild(this);
     }
+    updateGeneration();
     updateEffectiveVisibility();
 }
 
@@ -106,6 +110,7 @@ void Item::setPosition(const QPoint &point)
     if (m_position != point) {
         scheduleRepaint(boundingRect());
         m_position = point;
+        updateGeneration();
         updateBoundingRect();
         scheduleRepaint(boundingRect());
         Q_EMIT positionChanged();
@@ -174,7 +179,10 @@ QMatrix4x4 Item::transform() const
 
 void Item::setTransform(const QMatrix4x4 &transform)
 {
-    m_transform = transform;
+    if (m_transform != transform) {
+        m_transform = transform;
+        updateGeneration();
+    }
 }
 
 QRegion Item::mapToGlobal(const QRegion &region) const
@@ -290,17 +298,18 @@ void Item::preprocess()
 {
 }
 
-WindowQuadList Item::buildQuads() const
+RenderQuadList Item::buildQuads() const
 {
-    return WindowQuadList();
+    return RenderQuadList();
 }
 
 void Item::discardQuads()
 {
     m_quads.reset();
+    updateGeneration();
 }
 
-WindowQuadList Item::quads() const
+RenderQuadList Item::quads() const
 {
     if (!m_quads.has_value()) {
         m_quads = buildQuads();
@@ -308,6 +317,16 @@ WindowQuadList Item::quads() const
     return m_quads.value();
 }
 
+quint64 Item::generation() const
+{
+    return m_generation;
+}
+
+void Item::updateGeneration()
+{
+    m_generation = ++s_lastGeneration;
+}
+
 QRegion Item::repaints(AbstractOutput *output) const
 {
     return m_repaints.value(output, QRect(QPoint(0, 0), screens()->size()));
@@ -349,6 +368,7 @@ void Item::updateEffectiveVisibility()
     }
 
     m_effectiveVisible = effectiveVisible;
+    updateGeneration();
     scheduleRepaintInternal(boundingRect());
 
     for (Item *childItem : qAsConst(m_childItems)) {
@@ -8,6 +8,7 @@
 
 #include "kwinglobals.h"
 #include "kwineffects.h"
+#include "kwinrenderquadlist.h"
 
 #include <QMatrix4x4>
 #include <QObject>
@@ -90,9 +91,16 @@ public:
     QRegion repaints(AbstractOutput *output) const;
     void resetRepaints(AbstractOutput *output);
 
-    WindowQuadList quads() const;
+    RenderQuadList quads() const;
     virtual void preprocess();
 
+    /**
+     * Returns a number that changes whenever the quads, the position, the transform, the
+     * parent or the visibility of the item change. No two items share a generation, so it
+     * can be used to check whether anything computed from the item is still up to date.
+     */
+    quint64 generation() const;
+
 Q_SIGNALS:
     /**
      * This signal is emitted when the position of this item has changed.
@@ -110,7 +118,7 @@ Q_SIGNALS:
     void boundingRectChanged();
 
 protected:
-    virtual WindowQuadList buildQuads() const;
+    virtual RenderQuadList buildQuads() const;
     void discardQuads();
 
 private:
@@ -123,6 +131,7 @@ private:
     bool computeEffectiveVisibility() const;
     void updateEffectiveVisibility();
     void removeRepaints(AbstractOutput *output);
+    void updateGeneration();
 
     QPointer<Item> m_parentItem;
     QList<Item *> m_childItems;
@@ -134,7 +143,8 @@ private:
     bool m_visible = true;
     bool m_effectiveVisible = true;
     QMap<AbstractOutput *, QRegion> m_repaints;
-    mutable std::optional<WindowQuadList> m_quads;
+    quint64 m_generation;
+    mutable std::optional<RenderQuadList> m_quads;
     mutable std::optional<QList<Item *>> m_sortedChildItems;
 };
 
@@ -103,6 +103,9 @@ void Workspace::updateStackingOrder(bool propagate_new_clients)
     bool changed = (force_restacking || new_stacking_order != stacking_order);
     force_restacking = false;
     stacking_order = new_stacking_order;
+    if (changed) {
+        m_stackingOrderSerial++;
+    }
     if (changed || propagate_new_clients) {
         propagateClients(propagate_new_clients);
         markXStackingOrderAsDirty();
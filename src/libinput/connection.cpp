@@ -170,6 +170,11 @@ Connection::Connection(Context *input, QObject *parent)
 
 Connection::~Connection()
 {
+    Event *event;
+    while (m_eventRing.tryPop(&event)) {
+        delete event;
+    }
+    reclaimEvents();
     delete s_adaptor;
     s_adaptor = nullptr;
     s_self = nullptr;
@@ -226,20 +231,60 @@ void Connection::deactivate()
 void Connection::handleEvent()
 {
     QMutexLocker locker(&m_mutex);
-    const bool wasEmpty = m_eventQueue.isEmpty();
+    reclaimEvents();
+
+    // Reading resumes after a stall, see processEvents()
+    if (m_notifier && !m_notifier->isEnabled()) {
+        m_notifier->setEnabled(true);
+    }
+
+    bool haveEvents = false;
     do {
+        if (m_outstandingEvents == s_eventRingCapacity) {
+            // The remaining events stay in libinput until the main thread has caught up. The
+            // fd stays readable, so it must not be watched until then.
+            if (m_notifier) {
+                m_notifier->setEnabled(false);
+            }
+            m_readingStalled = true;
+            break;
+        }
         m_input->dispatch();
         Event *event = m_input->event();
         if (!event) {
             break;
         }
-        m_eventQueue << event;
+        m_eventRing.tryPush(event);
+        m_outstandingEvents++;
+        haveEvents = true;
     } while (true);
-    if (wasEmpty && !m_eventQueue.isEmpty()) {
-        Q_EMIT eventsRead();
+
+    if (haveEvents) {
+        m_eventRing.publish();
+        if (!m_eventsPending.exchange(true)) {
+            Q_EMIT eventsRead();
+        }
+    }
+}
+
+void Connection::reclaimEvents()
+{
+    Event *event;
+    while (m_processedEventRing.tryPop(&event)) {
+        delete event;
+        m_outstandingEvents--;
     }
 }
 
+void Connection::recycleEvent(Event *event)
+{
+    // Events are destroyed on the libinput thread, destroying them releases libinput objects.
+    // There are never more events in flight than the ring can hold, so this can't fail.
+    const bool pushed = m_processedEventRing.tryPush(event);
+    Q_ASSERT(pushed);
+    Q_UNUSED(pushed)
+}
+
 #ifndef KWIN_BUILD_TESTING
 QPointF devicePointToGlobalPosition(const QPointF &devicePos, const AbstractWaylandOutput *output)
 {
@@ -327,11 +372,15 @@ KWin::TabletToolId createTabletId(libinput_tablet_tool *tool, void *userData)
 
 void Connection::processEvents()
 {
-    QMutexLocker locker(&m_mutex);
-    while (!m_eventQueue.isEmpty()) {
-        QScopedPointer<Event> event(m_eventQueue.takeFirst());
+    // Events published after this point are read in another call, see handleEvent().
+    m_eventsPending = false;
+
+    Event *event;
+    while (m_eventRing.tryPop(&event)) {
         switch (event->type()) {
             case LIBINPUT_EVENT_DEVICE_ADDED: {
+                // The devices are configured through libinput, which is not thread-safe.
+                QMutexLocker locker(&m_mutex);
                 auto device = new Device(event->nativeDevice());
                 device->moveToThread(s_thread);
                 m_devices << device;
@@ -375,6 +424,7 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_DEVICE_REMOVED: {
+                QMutexLocker locker(&m_mutex);
                 auto it = std::find_if(m_devices.begin(), m_devices.end(), [&event] (Device *d) { return event->device() == d; } );
                 if (it == m_devices.end()) {
                     // we don't know this device
@@ -418,12 +468,12 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_KEYBOARD_KEY: {
-                KeyEvent *ke = static_cast<KeyEvent*>(event.data());
+                KeyEvent *ke = static_cast<KeyEvent*>(event);
                 Q_EMIT keyChanged(ke->key(), ke->state(), ke->time(), ke->device());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_AXIS: {
-                PointerEvent *pe = static_cast<PointerEvent*>(event.data());
+                PointerEvent *pe = static_cast<PointerEvent*>(event);
                 const auto axes = pe->axis();
                 for (const InputRedirection::PointerAxis &axis : axes) {
                     Q_EMIT pointerAxisChanged(axis, pe->axisValue(axis), pe->discreteAxisValue(axis),
@@ -432,40 +482,37 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_POINTER_BUTTON: {
-                PointerEvent *pe = static_cast<PointerEvent*>(event.data());
+                PointerEvent *pe = static_cast<PointerEvent*>(event);
                 Q_EMIT pointerButtonChanged(pe->button(), pe->buttonState(), pe->time(), pe->device());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION: {
-                PointerEvent *pe = static_cast<PointerEvent*>(event.data());
+                PointerEvent *pe = static_cast<PointerEvent*>(event);
                 auto delta = pe->delta();
                 auto deltaNonAccel = pe->deltaUnaccelerated();
                 quint32 latestTime = pe->time();
                 quint64 latestTimeUsec = pe->timeMicroseconds();
-                auto it = m_eventQueue.begin();
-                while (it != m_eventQueue.end()) {
-                    if ((*it)->type() == LIBINPUT_EVENT_POINTER_MOTION) {
-                        QScopedPointer<PointerEvent> p(static_cast<PointerEvent*>(*it));
-                        delta += p->delta();
-                        deltaNonAccel += p->deltaUnaccelerated();
-                        latestTime = p->time();
-                        latestTimeUsec = p->timeMicroseconds();
-                        it = m_eventQueue.erase(it);
-                    } else {
-                        break;
-                    }
+                Event *next;
+                while (m_eventRing.peek(&next) && next->type() == LIBINPUT_EVENT_POINTER_MOTION) {
+                    PointerEvent *p = static_cast<PointerEvent*>(next);
+                    delta += p->delta();
+                    deltaNonAccel += p->deltaUnaccelerated();
+                    latestTime = p->time();
+                    latestTimeUsec = p->timeMicroseconds();
+                    m_eventRing.pop();
+                    recycleEvent(p);
                 }
                 Q_EMIT pointerMotion(delta, deltaNonAccel, latestTime, latestTimeUsec, pe->device());
                 break;
             }
             case LIBINPUT_EVENT_POINTER_MOTION_ABSOLUTE: {
-                PointerEvent *pe = static_cast<PointerEvent*>(event.data());
+                PointerEvent *pe = static_cast<PointerEvent*>(event);
                 Q_EMIT pointerMotionAbsolute(pe->absolutePos(), pe->absolutePos(m_size), pe->time(), pe->device());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_DOWN: {
 #ifndef KWIN_BUILD_TESTING
-                TouchEvent *te = static_cast<TouchEvent*>(event.data());
+                TouchEvent *te = static_cast<TouchEvent*>(event);
                 const auto *output = static_cast<AbstractWaylandOutput*>(
                             kwinApp()->platform()->enabledOutputs()[te->device()->screenId()]);
                 const QPointF globalPos =
@@ -476,13 +523,13 @@ void Connection::processEvents()
 #endif
             }
             case LIBINPUT_EVENT_TOUCH_UP: {
-                TouchEvent *te = static_cast<TouchEvent*>(event.data());
+                TouchEvent *te = static_cast<TouchEvent*>(event);
                 Q_EMIT touchUp(te->id(), te->time(), te->device());
                 break;
             }
             case LIBINPUT_EVENT_TOUCH_MOTION: {
 #ifndef KWIN_BUILD_TESTING
-                TouchEvent *te = static_cast<TouchEvent*>(event.data());
+                TouchEvent *te = static_cast<TouchEvent*>(event);
                 const auto *output = static_cast<AbstractWaylandOutput*>(
                             kwinApp()->platform()->enabledOutputs()[te->device()->screenId()]);
                 const QPointF globalPos =
@@ -501,17 +548,17 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_PINCH_BEGIN: {
-                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event.data());
+                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event);
                 Q_EMIT pinchGestureBegin(pe->fingerCount(), pe->time(), pe->device());
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_PINCH_UPDATE: {
-                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event.data());
+                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event);
                 Q_EMIT pinchGestureUpdate(pe->scale(), pe->angleDelta(), pe->delta(), pe->time(), pe->device());
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_PINCH_END: {
-                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event.data());
+                PinchGestureEvent *pe = static_cast<PinchGestureEvent*>(event);
                 if (pe->isCancelled()) {
                     Q_EMIT pinchGestureCancelled(pe->time(), pe->device());
                 } else {
@@ -520,17 +567,17 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_SWIPE_BEGIN: {
-                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event.data());
+                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event);
                 Q_EMIT swipeGestureBegin(se->fingerCount(), se->time(), se->device());
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_SWIPE_UPDATE: {
-                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event.data());
+                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event);
                 Q_EMIT swipeGestureUpdate(se->delta(), se->time(), se->device());
                 break;
             }
             case LIBINPUT_EVENT_GESTURE_SWIPE_END: {
-                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event.data());
+                SwipeGestureEvent *se = static_cast<SwipeGestureEvent*>(event);
                 if (se->isCancelled()) {
                     Q_EMIT swipeGestureCancelled(se->time(), se->device());
                 } else {
@@ -539,7 +586,7 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_SWITCH_TOGGLE: {
-                SwitchEvent *se = static_cast<SwitchEvent*>(event.data());
+                SwitchEvent *se = static_cast<SwitchEvent*>(event);
                 switch (se->state()) {
                 case SwitchEvent::State::Off:
                     Q_EMIT switchToggledOff(se->time(), se->timeMicroseconds(), se->device());
@@ -555,7 +602,7 @@ void Connection::processEvents()
             case LIBINPUT_EVENT_TABLET_TOOL_AXIS:
             case LIBINPUT_EVENT_TABLET_TOOL_PROXIMITY:
             case LIBINPUT_EVENT_TABLET_TOOL_TIP: {
-                auto *tte = static_cast<TabletToolEvent *>(event.data());
+                auto *tte = static_cast<TabletToolEvent *>(event);
 
                 KWin::InputRedirection::TabletEventType tabletEventType;
                 switch (event->type()) {
@@ -590,21 +637,21 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_TABLET_TOOL_BUTTON: {
-                auto *tabletEvent = static_cast<TabletToolButtonEvent *>(event.data());
+                auto *tabletEvent = static_cast<TabletToolButtonEvent *>(event);
                 Q_EMIT tabletToolButtonEvent(tabletEvent->buttonId(),
                                            tabletEvent->isButtonPressed(),
                                            createTabletId(tabletEvent->tool(), event->device()->groupUserData()));
                 break;
             }
             case LIBINPUT_EVENT_TABLET_PAD_BUTTON: {
-                auto *tabletEvent = static_cast<TabletPadButtonEvent *>(event.data());
+                auto *tabletEvent = static_cast<TabletPadButtonEvent *>(event);
                 Q_EMIT tabletPadButtonEvent(tabletEvent->buttonId(),
                                           tabletEvent->isButtonPressed(),
                                           { event->device()->groupUserData() });
                 break;
             }
             case LIBINPUT_EVENT_TABLET_PAD_RING: {
-                auto *tabletEvent = static_cast<TabletPadRingEvent *>(event.data());
+                auto *tabletEvent = static_cast<TabletPadRingEvent *>(event);
                 tabletEvent->position();
                 Q_EMIT tabletPadRingEvent(tabletEvent->number(),
                                         tabletEvent->position(),
@@ -613,7 +660,7 @@ void Connection::processEvents()
                 break;
             }
             case LIBINPUT_EVENT_TABLET_PAD_STRIP: {
-                auto *tabletEvent = static_cast<TabletPadStripEvent *>(event.data());
+                auto *tabletEvent = static_cast<TabletPadStripEvent *>(event);
                 Q_EMIT tabletPadStripEvent(tabletEvent->number(),
                                          tabletEvent->position(),
                                          tabletEvent->source() == LIBINPUT_TABLET_PAD_STRIP_SOURCE_FINGER,
@@ -624,7 +671,16 @@ void Connection::processEvents()
                 // nothing
                 break;
         }
+        recycleEvent(event);
     }
+    m_processedEventRing.publish();
+
+    // The libinput thread stopped reading events because the ring was full, it reads the
+    // remaining events and watches the fd again.
+    if (m_readingStalled.exchange(false)) {
+        QMetaObject::invokeMethod(this, &Connection::handleEvent, Qt::QueuedConnection);
+    }
+
     if (wasSuspended) {
         if (m_keyboardBeforeSuspend && !m_keyboard) {
             Q_EMIT hasKeyboardChanged(false);
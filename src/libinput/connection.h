@@ -13,6 +13,7 @@
 
 #include "input.h"
 #include "keyboard_input.h"
+#include "spscring.h"
 
 #include <QObject>
 #include <QPointer>
@@ -21,6 +22,8 @@
 #include <QVector>
 #include <QStringList>
 
+#include <atomic>
+
 class QSocketNotifier;
 class QThread;
 
@@ -139,6 +142,8 @@ private Q_SLOTS:
 private:
     Connection(Context *input, QObject *parent = nullptr);
     void handleEvent();
+    void reclaimEvents();
+    void recycleEvent(Event *event);
     void applyDeviceConfig(Device *device);
     void applyScreenToDevice(Device *device);
     Context *m_input;
@@ -155,7 +160,14 @@ private:
     bool m_touchBeforeSuspend = false;
     bool m_tabletModeSwitchBeforeSuspend = false;
     QMutex m_mutex;
-    QVector<Event*> m_eventQueue;
+    // The events read on the libinput thread are handed to the main thread with m_eventRing,
+    // and handed back with m_processedEventRing to be destroyed on the libinput thread.
+    static const int s_eventRingCapacity = 1024;
+    SpscRing<Event *, s_eventRingCapacity> m_eventRing;
+    SpscRing<Event *, s_eventRingCapacity> m_processedEventRing;
+    int m_outstandingEvents = 0;
+    std::atomic<bool> m_eventsPending{false};
+    std::atomic<bool> m_readingStalled{false};
     bool wasSuspended = false;
     QVector<Device*> m_devices;
     KSharedConfigPtr m_config;
@@ -0,0 +1,107 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+#ifndef KWIN_LIBINPUT_SPSCRING_H
+#define KWIN_LIBINPUT_SPSCRING_H
+
+#include <QtGlobal>
+
+#include <atomic>
+
+namespace KWin
+{
+namespace LibInput
+{
+
+/**
+ * @short A bounded queue for passing values from one thread to another without locking.
+ *
+ * There must be only one producer and one consumer at a time. The producer writes values with
+ * tryPush() and makes them visible to the consumer with publish(), so a batch of values is
+ * handed over at once. The consumer reads the values with peek() and pop().
+ *
+ * The slots are allocated together with the ring, pushing and popping values never allocates.
+ */
+template<typename T, int Capacity>
+class SpscRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+public:
+    /**
+     * Writes the @a value to the ring, returns @c false if the ring is full. The value is not
+     * visible to the consumer before publish() is called.
+     */
+    bool tryPush(const T &value)
+    {
+        if (m_pendingTail - m_head.load(std::memory_order_acquire) == quint32(Capacity)) {
+            return false;
+        }
+        m_slots[m_pendingTail & s_mask] = value;
+        ++m_pendingTail;
+        return true;
+    }
+
+    /**
+     * Makes the values written since the last call visible to the consumer.
+     */
+    void publish()
+    {
+        m_tail.store(m_pendingTail, std::memory_order_seq_cst);
+    }
+
+    bool isEmpty() const
+    {
+        return m_head.load(std::memory_order_relaxed) == m_tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Reads the oldest value without removing it, returns @c false if the ring is empty.
+     */
+    bool peek(T *value) const
+    {
+        const quint32 head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *value = m_slots[head & s_mask];
+        return true;
+    }
+
+    /**
+     * Removes the oldest value, the ring must not be empty.
+     */
+    void pop()
+    {
+        Q_ASSERT(!isEmpty());
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool tryPop(T *value)
+    {
+        if (!peek(value)) {
+            return false;
+        }
+        pop();
+        return true;
+    }
+
+private:
+    static constexpr quint32 s_mask = Capacity - 1;
+
+    // The indices grow without bounds and wrap around, only their difference matters.
+    alignas(64) std::atomic<quint32> m_head{0};
+    alignas(64) std::atomic<quint32> m_tail{0};
+    alignas(64) quint32 m_pendingTail = 0;
+    T m_slots[Capacity];
+};
+
+}
+}
+
+#endif
@@ -78,6 +78,28 @@ bool AnimationEffect::isActive() const
     return !d->m_animations.isEmpty() && !effects->isScreenLocked();
 }
 
+bool AnimationEffect::needsAllWindows() const
+{
+    Q_D(const AnimationEffect);
+    // Animations other than the color ones can move or grow the window beyond its
+    // visible geometry, possibly onto other outputs.
+    for (auto entry = d->m_animations.constBegin(); entry != d->m_animations.constEnd(); ++entry) {
+        for (const AniData &anim : entry->first) {
+            switch (anim.attribute) {
+            case Opacity:
+            case Brightness:
+            case Saturation:
+            case Clip:
+            case CrossFadePrevious:
+                break;
+            default:
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
 
 #define RELATIVE_XY(_FIELD_) const bool relative[2] = { static_cast<bool>(metaData(Relative##_FIELD_##X, meta)), \
                                                         static_cast<bool>(metaData(Relative##_FIELD_##Y, meta)) }
@@ -690,6 +690,11 @@ bool Effect::blocksDirectScanout() const
     return true;
 }
 
+bool Effect::needsAllWindows() const
+{
+    return false;
+}
+
 //****************************************
 // EffectFactory
 //****************************************
@@ -174,7 +174,7 @@ X-KDE-Library=kwin4_effect_cooleffect
 
 #define KWIN_EFFECT_API_MAKE_VERSION( major, minor ) (( major ) << 8 | ( minor ))
 #define KWIN_EFFECT_API_VERSION_MAJOR 0
-#define KWIN_EFFECT_API_VERSION_MINOR 233
+#define KWIN_EFFECT_API_VERSION_MINOR 234
 #define KWIN_EFFECT_API_VERSION KWIN_EFFECT_API_MAKE_VERSION( \
         KWIN_EFFECT_API_VERSION_MAJOR, KWIN_EFFECT_API_VERSION_MINOR )
 
@@ -646,6 +646,18 @@ public:
      */
     virtual bool blocksDirectScanout() const;
 
+    /**
+     * By default, the compositor only runs the window painting passes for windows that
+     * intersect the output being painted, unless the screen is painted with transformed
+     * windows. Overwrite this method to return true if your effect needs prePaintWindow(),
+     * paintWindow() and postPaintWindow() to be called for all windows, for example because
+     * it paints windows outside of their visible geometry. It is only queried while the
+     * effect is active.
+     *
+     * @since 5.23
+     */
+    virtual bool needsAllWindows() const;
+
 public Q_SLOTS:
     virtual bool borderActivated(ElectricBorder border);
 
@@ -16,6 +16,7 @@
 #include "kwinglutils.h"
 
 #include "kwingltexture_p.h"
+#include "logging_p.h"
 
 #include <QPixmap>
 #include <QImage>
@@ -36,6 +37,9 @@ bool GLTexturePrivate::s_supportsUnpack = false;
 bool GLTexturePrivate::s_supportsTextureStorage = false;
 bool GLTexturePrivate::s_supportsTextureSwizzle = false;
 bool GLTexturePrivate::s_supportsTextureFormatRG = false;
+bool GLTexturePrivate::s_supportsStreamingUploads = false;
+GLUploadRing *GLTexturePrivate::s_uploadRing = nullptr;
+GLTexture::UploadStatistics GLTexturePrivate::s_uploadStatistics;
 uint GLTexturePrivate::s_textureObjectCounter = 0;
 uint GLTexturePrivate::s_fbo = 0;
 
@@ -76,6 +80,34 @@ struct {
     { GL_R8,       GL_RED,  GL_UNSIGNED_BYTE               }, // QImage::Format_Grayscale8
 };
 
+/**
+ * Returns the format and the type of the pixels uploaded for the @a image, and the format the
+ * image has to be converted to before it's uploaded.
+ */
+static QImage::Format imageUploadFormat(const QImage &image, GLenum *glFormat, GLenum *type)
+{
+    if (!GLPlatform::instance()->isGLES()) {
+        const QImage::Format index = image.format();
+
+        if (index < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[index].internalFormat) {
+            *glFormat = formatTable[index].format;
+            *type = formatTable[index].type;
+            return index;
+        }
+        *glFormat = GL_BGRA;
+        *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+        return QImage::Format_ARGB32_Premultiplied;
+    }
+    if (GLTexturePrivate::s_supportsARGB32) {
+        *glFormat = GL_BGRA_EXT;
+        *type = GL_UNSIGNED_BYTE;
+        return QImage::Format_ARGB32_Premultiplied;
+    }
+    *glFormat = GL_RGBA;
+    *type = GL_UNSIGNED_BYTE;
+    return QImage::Format_RGBA8888_Premultiplied;
+}
+
 GLTexture::GLTexture(GLenum target)
     : d_ptr(new GLTexturePrivate())
 {
@@ -328,12 +360,125 @@ void GLTexturePrivate::initStatic()
 
         s_supportsUnpack = hasGLExtension(QByteArrayLiteral("GL_EXT_unpack_subimage"));
     }
+
+    // Pixel buffer objects are core since OpenGL 2.1 and OpenGL ES 3.0
+    if (!GLPlatform::instance()->isGLES()) {
+        s_supportsStreamingUploads = (hasGLVersion(3, 0) || hasGLExtension(QByteArrayLiteral("GL_ARB_map_buffer_range")))
+            && (hasGLVersion(3, 2) || hasGLExtension(QByteArrayLiteral("GL_ARB_sync")));
+    } else {
+        s_supportsStreamingUploads = hasGLVersion(3, 0);
+    }
+    if (qgetenv("KWIN_GL_STREAMING_UPLOADS") == QByteArrayLiteral("0")) {
+        s_supportsStreamingUploads = false;
+    }
 }
 
 void GLTexturePrivate::cleanup()
 {
     s_supportsFramebufferObjects = false;
     s_supportsARGB32 = false;
+    s_supportsStreamingUploads = false;
+    delete s_uploadRing;
+    s_uploadRing = nullptr;
+}
+
+GLUploadRing::GLUploadRing()
+{
+}
+
+GLUploadRing::~GLUploadRing()
+{
+    for (Slot &slot : m_slots) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+        }
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+int GLUploadRing::bufferCount() const
+{
+    return m_slots.count();
+}
+
+bool GLUploadRing::isIdle(Slot &slot)
+{
+    if (!slot.fence) {
+        return true;
+    }
+    const GLenum status = glClientWaitSync(slot.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    if (status == GL_WAIT_FAILED) {
+        qCWarning(LIBKWINGLUTILS) << "Failed to check a pixel buffer fence";
+        glFinish();
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    return true;
+}
+
+uchar *GLUploadRing::map(qint64 size)
+{
+    // Look for a buffer the GPU is done with, starting after the one used last
+    int index = -1;
+    for (int i = 1; i <= m_slots.count(); ++i) {
+        const int candidate = (m_current + i) % m_slots.count();
+        if (isIdle(m_slots[candidate])) {
+            index = candidate;
+            break;
+        }
+    }
+    if (index == -1) {
+        if (m_slots.count() == s_maxSlotCount) {
+            return nullptr;
+        }
+        Slot slot;
+        glGenBuffers(1, &slot.buffer);
+        m_slots.append(slot);
+        index = m_slots.count() - 1;
+    }
+
+    Slot &slot = m_slots[index];
+    if (slot.size < size) {
+        // Grow in steps of 1 MiB, so a window that is resized doesn't reallocate all the time
+        const qint64 newSize = (size + 0xfffff) & ~qint64(0xfffff);
+        if (m_totalSize - slot.size + newSize > s_maxTotalSize && m_slots.count() > 1) {
+            return nullptr;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, newSize, nullptr, GL_STREAM_DRAW);
+        m_totalSize += newSize - slot.size;
+        slot.size = newSize;
+    } else {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, slot.buffer);
+    }
+    m_current = index;
+
+    // The GPU has finished reading the buffer, so it doesn't need to be synchronized
+    void *data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size,
+                                  GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!data) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    return static_cast<uchar *>(data);
+}
+
+bool GLUploadRing::unmap()
+{
+    if (glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_FALSE) {
+        // The contents of the buffer got lost, e.g. because the screen mode changed
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        return false;
+    }
+    return true;
+}
+
+void GLUploadRing::fence()
+{
+    m_slots[m_current].fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 }
 
 bool GLTexture::isNull() const
@@ -368,30 +513,7 @@ void GLTexture::update(const QImage &image, const QPoint &offset, const QRect &s
 
     GLenum glFormat;
     GLenum type;
-    QImage::Format uploadFormat;
-    if (!GLPlatform::instance()->isGLES()) {
-        const QImage::Format index = image.format();
-
-        if (index < sizeof(formatTable) / sizeof(formatTable[0]) && formatTable[index].internalFormat) {
-            glFormat = formatTable[index].format;
-            type = formatTable[index].type;
-            uploadFormat = index;
-        } else {
-            glFormat = GL_BGRA;
-            type = GL_UNSIGNED_INT_8_8_8_8_REV;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
-        }
-    } else {
-        if (d->s_supportsARGB32) {
-            glFormat = GL_BGRA_EXT;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_ARGB32_Premultiplied;
-        } else {
-            glFormat = GL_RGBA;
-            type = GL_UNSIGNED_BYTE;
-            uploadFormat = QImage::Format_RGBA8888_Premultiplied;
-        }
-    }
+    const QImage::Format uploadFormat = imageUploadFormat(image, &glFormat, &type);
     bool useUnpack = d->s_supportsUnpack && image.format() == uploadFormat && !src.isNull();
 
     QImage im;
@@ -430,6 +552,102 @@ void GLTexture::update(const QImage &image, const QPoint &offset, const QRect &s
         glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
         glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
     }
+
+    GLTexturePrivate::s_uploadStatistics.uploadedBytes += qint64(width) * height * (im.depth() / 8);
+}
+
+/**
+ * Returns the rectangles of the @a region to upload. If the rectangles cover most of their
+ * bounding rectangle, it's cheaper to upload the few pixels between them than to upload each
+ * rectangle on its own.
+ */
+static QVector<QRect> uploadRects(const QRegion &region)
+{
+    if (region.rectCount() <= 1) {
+        return QVector<QRect>(region.begin(), region.end());
+    }
+    qint64 area = 0;
+    for (const QRect &rect : region) {
+        area += qint64(rect.width()) * rect.height();
+    }
+    const QRect bounds = region.boundingRect();
+    if (qint64(bounds.width()) * bounds.height() * 2 <= area * 3) {
+        return {bounds};
+    }
+    return QVector<QRect>(region.begin(), region.end());
+}
+
+void GLTexture::update(const QImage &image, const QRegion &region)
+{
+    if (image.isNull() || isNull()) {
+        return;
+    }
+
+    Q_D(GLTexture);
+    Q_ASSERT(!d->m_foreign);
+
+    GLenum glFormat;
+    GLenum type;
+    const QImage::Format format = imageUploadFormat(image, &glFormat, &type);
+    const QVector<QRect> rects = uploadRects(region & image.rect());
+
+    // Images that have to be converted go the slow path, the conversion costs more anyway
+    if (!d->s_supportsStreamingUploads || image.format() != format || image.depth() != 32) {
+        for (const QRect &rect : rects) {
+            update(image, rect.topLeft(), rect);
+        }
+        return;
+    }
+
+    // The rows of all rectangles are packed one after another into a single buffer
+    const int bytesPerPixel = image.depth() / 8;
+    qint64 size = 0;
+    for (const QRect &rect : rects) {
+        size += qint64(rect.width()) * rect.height() * bytesPerPixel;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    if (!d->s_uploadRing) {
+        d->s_uploadRing = new GLUploadRing();
+    }
+    uchar *data = d->s_uploadRing->map(size);
+    if (!data) {
+        GLTexturePrivate::s_uploadStatistics.fallbacks++;
+        for (const QRect &rect : rects) {
+            update(image, rect.topLeft(), rect);
+        }
+        return;
+    }
+
+    qint64 offset = 0;
+    for (const QRect &rect : rects) {
+        const int rowSize = rect.width() * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(data + offset, image.constScanLine(y) + rect.x() * bytesPerPixel, rowSize);
+            offset += rowSize;
+        }
+    }
+    if (!d->s_uploadRing->unmap()) {
+        for (const QRect &rect : rects) {
+            update(image, rect.topLeft(), rect);
+        }
+        return;
+    }
+
+    bind();
+    offset = 0;
+    for (const QRect &rect : rects) {
+        glTexSubImage2D(d->m_target, 0, rect.x(), rect.y(), rect.width(), rect.height(), glFormat, type,
+                        reinterpret_cast<const void *>(offset));
+        offset += qint64(rect.width()) * rect.height() * bytesPerPixel;
+    }
+    unbind();
+    d->s_uploadRing->fence();
+
+    GLTexturePrivate::s_uploadStatistics.uploadedBytes += size;
+    GLTexturePrivate::s_uploadStatistics.streamedBytes += size;
 }
 
 void GLTexture::discard()
@@ -715,6 +933,23 @@ bool GLTexture::supportsFormatRG()
     return GLTexturePrivate::s_supportsTextureFormatRG;
 }
 
+bool GLTexture::supportsStreamingUploads()
+{
+    return GLTexturePrivate::s_supportsStreamingUploads;
+}
+
+GLTexture::UploadStatistics GLTexture::uploadStatistics()
+{
+    UploadStatistics statistics = GLTexturePrivate::s_uploadStatistics;
+    statistics.pixelBuffers = GLTexturePrivate::s_uploadRing ? GLTexturePrivate::s_uploadRing->bufferCount() : 0;
+    return statistics;
+}
+
+void GLTexture::resetUploadStatistics()
+{
+    GLTexturePrivate::s_uploadStatistics = UploadStatistics();
+}
+
 QImage GLTexture::toImage() const
 {
     QImage ret(size(), QImage::Format_RGBA8888_Premultiplied);
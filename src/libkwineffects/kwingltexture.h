@@ -41,6 +41,27 @@ enum TextureCoordinateType {
 class KWINGLUTILS_EXPORT GLTexture
 {
 public:
+    /**
+     * Counts the pixel data uploaded to textures with update().
+     */
+    struct UploadStatistics
+    {
+        qint64 uploadedBytes = 0;
+        /**
+         * The part of the uploaded bytes that went through the pixel buffer ring.
+         */
+        qint64 streamedBytes = 0;
+        /**
+         * How often an upload went the direct way, because all pixel buffers were still read
+         * by the GPU and no more could be added.
+         */
+        int fallbacks = 0;
+        /**
+         * The number of pixel buffers in the ring, uploads never wait for them.
+         */
+        int pixelBuffers = 0;
+    };
+
     explicit GLTexture(GLenum target);
     GLTexture(const GLTexture& tex);
     explicit GLTexture(const QImage& image, GLenum target = GL_TEXTURE_2D);
@@ -100,6 +121,14 @@ public:
     QMatrix4x4 matrix(TextureCoordinateType type) const;
 
     void update(const QImage& image, const QPoint &offset = QPoint(0, 0), const QRect &src = QRect());
+    /**
+     * Uploads the parts of the @a image in the @a region to the same position in the texture.
+     *
+     * If streaming uploads are supported, the pixels are copied to a pixel buffer and the
+     * GPU uploads them from there asynchronously. Small rectangles close to each other are
+     * uploaded together.
+     */
+    void update(const QImage &image, const QRegion &region);
     virtual void discard();
     void bind();
     void unbind();
@@ -143,6 +172,20 @@ public:
      */
     static bool supportsFormatRG();
 
+    /**
+     * Returns @c true if update() can upload images through a ring of pixel buffers.
+     *
+     * This requires OpenGL 3.2 or OpenGL ES 3.0, or the extensions for mapping buffer ranges
+     * and sync objects. It can be disabled with KWIN_GL_STREAMING_UPLOADS=0.
+     */
+    static bool supportsStreamingUploads();
+
+    /**
+     * Returns the uploads since the last call to resetUploadStatistics().
+     */
+    static UploadStatistics uploadStatistics();
+    static void resetUploadStatistics();
+
 protected:
     QExplicitlySharedDataPointer<GLTexturePrivate> d_ptr;
     GLTexture(GLTexturePrivate& dd);
@@ -20,6 +20,7 @@
 #include <QSharedData>
 #include <QImage>
 #include <QMatrix4x4>
+#include <QVector>
 #include <epoxy/gl.h>
 
 namespace KWin
@@ -27,6 +28,54 @@ namespace KWin
 // forward declarations
 class GLVertexBuffer;
 
+/**
+ * The GLUploadRing is a ring of pixel buffers for uploading pixels to textures without
+ * waiting for the GPU. The pixels are written to a buffer the GPU is done with, and a fence
+ * tells when the GPU has read them and the buffer can be written again.
+ *
+ * Many textures can be updated in one frame, the ring grows when all of its buffers are still
+ * read by the GPU instead of waiting for one of them.
+ */
+class GLUploadRing
+{
+public:
+    GLUploadRing();
+    ~GLUploadRing();
+
+    /**
+     * Binds a buffer the GPU no longer reads to GL_PIXEL_UNPACK_BUFFER and maps the first
+     * @a size bytes of it. Returns @c null if all buffers are busy and the ring can't grow
+     * anymore, or if the buffer can't be mapped; the pixels have to be uploaded directly then.
+     */
+    uchar *map(qint64 size);
+    /**
+     * Unmaps the buffer, the pixels can be uploaded from it afterwards.
+     */
+    bool unmap();
+    /**
+     * Marks the end of the uploads from the buffer and unbinds it.
+     */
+    void fence();
+
+    int bufferCount() const;
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        qint64 size = 0;
+        GLsync fence = nullptr;
+    };
+
+    static bool isIdle(Slot &slot);
+
+    static const int s_maxSlotCount = 16;
+    static const qint64 s_maxTotalSize = 128 * 1024 * 1024;
+    QVector<Slot> m_slots;
+    qint64 m_totalSize = 0;
+    int m_current = -1;
+};
+
 class KWINGLUTILS_EXPORT GLTexturePrivate
     : public QSharedData
 {
@@ -68,6 +117,9 @@ public:
     static bool s_supportsTextureStorage;
     static bool s_supportsTextureSwizzle;
     static bool s_supportsTextureFormatRG;
+    static bool s_supportsStreamingUploads;
+    static GLUploadRing *s_uploadRing;
+    static GLTexture::UploadStatistics s_uploadStatistics;
     static GLuint s_fbo;
     static uint s_textureObjectCounter;
 private:
@@ -0,0 +1,290 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "kwinrenderquadlist.h"
+
+#include <QMatrix4x4>
+
+#include <algorithm>
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+#ifndef GL_TRIANGLES
+#  define GL_TRIANGLES      0x0004
+#endif
+
+#ifndef GL_QUADS
+#  define GL_QUADS          0x0007
+#endif
+
+namespace KWin
+{
+
+int RenderQuadList::count() const
+{
+    return m_components[X0].count();
+}
+
+bool RenderQuadList::isEmpty() const
+{
+    return m_components[X0].isEmpty();
+}
+
+void RenderQuadList::reserve(int count)
+{
+    for (QVector<float> &component : m_components) {
+        component.reserve(count);
+    }
+}
+
+void RenderQuadList::clear()
+{
+    for (QVector<float> &component : m_components) {
+        component.clear();
+    }
+}
+
+void RenderQuadList::append(const QRectF &rect, const QVector2D &topLeft, const QVector2D &topRight,
+                            const QVector2D &bottomRight, const QVector2D &bottomLeft)
+{
+    m_components[X0].append(rect.left());
+    m_components[X1].append(rect.right());
+    m_components[X2].append(rect.right());
+    m_components[X3].append(rect.left());
+    m_components[Y0].append(rect.top());
+    m_components[Y1].append(rect.top());
+    m_components[Y2].append(rect.bottom());
+    m_components[Y3].append(rect.bottom());
+    m_components[U0].append(topLeft.x());
+    m_components[U1].append(topRight.x());
+    m_components[U2].append(bottomRight.x());
+    m_components[U3].append(bottomLeft.x());
+    m_components[V0].append(topLeft.y());
+    m_components[V1].append(topRight.y());
+    m_components[V2].append(bottomRight.y());
+    m_components[V3].append(bottomLeft.y());
+}
+
+void RenderQuadList::append(const WindowQuad &quad)
+{
+    for (int i = 0; i < 4; ++i) {
+        m_components[X0 + i].append(quad[i].x());
+        m_components[Y0 + i].append(quad[i].y());
+        m_components[U0 + i].append(quad[i].u());
+        m_components[V0 + i].append(quad[i].v());
+    }
+}
+
+QRectF RenderQuadList::rect(int index) const
+{
+    const float left = std::min({m_components[X0][index], m_components[X1][index], m_components[X2][index], m_components[X3][index]});
+    const float right = std::max({m_components[X0][index], m_components[X1][index], m_components[X2][index], m_components[X3][index]});
+    const float top = std::min({m_components[Y0][index], m_components[Y1][index], m_components[Y2][index], m_components[Y3][index]});
+    const float bottom = std::max({m_components[Y0][index], m_components[Y1][index], m_components[Y2][index], m_components[Y3][index]});
+    return QRectF(QPointF(left, top), QPointF(right, bottom));
+}
+
+QRectF RenderQuadList::boundingRect() const
+{
+    if (isEmpty()) {
+        return QRectF();
+    }
+    QRectF ret = rect(0);
+    for (int i = 1; i < count(); ++i) {
+        ret |= rect(i);
+    }
+    return ret;
+}
+
+void RenderQuadList::appendSubQuad(const RenderQuadList &quads, int index, float left, float top, float right, float bottom)
+{
+    // Same as WindowQuad::makeSubQuad(), the texture coordinates of the corners of the part
+    // are interpolated bilinearly from the ones of the corners of the quad.
+    const QVector<float> *components = quads.m_components;
+    const float xOrigin = components[X0][index];
+    const float yOrigin = components[Y0][index];
+    const float widthReciprocal = 1 / (components[X1][index] - xOrigin);
+    const float heightReciprocal = 1 / (components[Y2][index] - yOrigin);
+
+    const float xs[4] = {left, right, right, left};
+    const float ys[4] = {top, top, bottom, bottom};
+    float us[4];
+    float vs[4];
+    for (int i = 0; i < 4; ++i) {
+        const float w1 = (xs[i] - xOrigin) * widthReciprocal;
+        const float w2 = (ys[i] - yOrigin) * heightReciprocal;
+        const float c0 = (1 - w1) * (1 - w2);
+        const float c1 = w1 * (1 - w2);
+        const float c2 = w1 * w2;
+        const float c3 = (1 - w1) * w2;
+        us[i] = c0 * components[U0][index] + c1 * components[U1][index]
+            + c2 * components[U2][index] + c3 * components[U3][index];
+        vs[i] = c0 * components[V0][index] + c1 * components[V1][index]
+            + c2 * components[V2][index] + c3 * components[V3][index];
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        m_components[X0 + i].append(xs[i]);
+        m_components[Y0 + i].append(ys[i]);
+        m_components[U0 + i].append(us[i]);
+        m_components[V0 + i].append(vs[i]);
+    }
+}
+
+RenderQuadList RenderQuadList::clipped(const QRegion &region, const QPointF &offset) const
+{
+    RenderQuadList ret;
+    ret.reserve(count());
+
+    const float *lefts = m_components[X0].constData();
+    const float *tops = m_components[Y0].constData();
+    const float *rights = m_components[X1].constData();
+    const float *bottoms = m_components[Y2].constData();
+    const int quadCount = count();
+
+    for (const QRect &r : region) {
+        const QRectF clipRect = QRectF(r).translated(-offset);
+        const float clipLeft = clipRect.left();
+        const float clipTop = clipRect.top();
+        const float clipRight = clipRect.right();
+        const float clipBottom = clipRect.bottom();
+
+        int i = 0;
+#if defined(__SSE2__)
+        const __m128 clipLefts = _mm_set1_ps(clipLeft);
+        const __m128 clipTops = _mm_set1_ps(clipTop);
+        const __m128 clipRights = _mm_set1_ps(clipRight);
+        const __m128 clipBottoms = _mm_set1_ps(clipBottom);
+
+        // Intersect four quads with the clip rectangle at once.
+        for (; i + 4 <= quadCount; i += 4) {
+            alignas(16) float left[4];
+            alignas(16) float top[4];
+            alignas(16) float right[4];
+            alignas(16) float bottom[4];
+            const __m128 l = _mm_max_ps(_mm_loadu_ps(lefts + i), clipLefts);
+            const __m128 t = _mm_max_ps(_mm_loadu_ps(tops + i), clipTops);
+            const __m128 rr = _mm_min_ps(_mm_loadu_ps(rights + i), clipRights);
+            const __m128 b = _mm_min_ps(_mm_loadu_ps(bottoms + i), clipBottoms);
+            int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(l, rr), _mm_cmplt_ps(t, b)));
+            if (!mask) {
+                continue;
+            }
+            _mm_store_ps(left, l);
+            _mm_store_ps(top, t);
+            _mm_store_ps(right, rr);
+            _mm_store_ps(bottom, b);
+            for (int j = 0; j < 4; ++j) {
+                if (mask & (1 << j)) {
+                    ret.appendSubQuad(*this, i + j, left[j], top[j], right[j], bottom[j]);
+                }
+            }
+        }
+#endif // __SSE2__
+        for (; i < quadCount; ++i) {
+            const float left = std::max(lefts[i], clipLeft);
+            const float top = std::max(tops[i], clipTop);
+            const float right = std::min(rights[i], clipRight);
+            const float bottom = std::min(bottoms[i], clipBottom);
+            if (left < right && top < bottom) {
+                ret.appendSubQuad(*this, i, left, top, right, bottom);
+            }
+        }
+    }
+
+    return ret;
+}
+
+void RenderQuadList::makeInterleavedArrays(unsigned int type, GLVertex2D *vertices, const QMatrix4x4 &textureMatrix) const
+{
+    // Since we know that the texture matrix just scales and translates
+    // we can use this information to optimize the transformation
+    const float coeffX = textureMatrix(0, 0);
+    const float coeffY = textureMatrix(1, 1);
+    const float offsetX = textureMatrix(0, 3);
+    const float offsetY = textureMatrix(1, 3);
+
+    Q_ASSERT(type == GL_QUADS || type == GL_TRIANGLES);
+
+    const float *xs[4] = {m_components[X0].constData(), m_components[X1].constData(), m_components[X2].constData(), m_components[X3].constData()};
+    const float *ys[4] = {m_components[Y0].constData(), m_components[Y1].constData(), m_components[Y2].constData(), m_components[Y3].constData()};
+    const float *us[4] = {m_components[U0].constData(), m_components[U1].constData(), m_components[U2].constData(), m_components[U3].constData()};
+    const float *vs[4] = {m_components[V0].constData(), m_components[V1].constData(), m_components[V2].constData(), m_components[V3].constData()};
+
+    const auto corner = [&](int index, int corner) {
+        GLVertex2D vertex;
+        vertex.position = QVector2D(xs[corner][index], ys[corner][index]);
+        vertex.texcoord = QVector2D(us[corner][index] * coeffX + offsetX, vs[corner][index] * coeffY + offsetY);
+        return vertex;
+    };
+
+    GLVertex2D *vertex = vertices;
+    const int quadCount = count();
+
+    if (type == GL_QUADS) {
+        for (int i = 0; i < quadCount; ++i) {
+            *(vertex++) = corner(i, 0); // Top-left
+            *(vertex++) = corner(i, 1); // Top-right
+            *(vertex++) = corner(i, 2); // Bottom-right
+            *(vertex++) = corner(i, 3); // Bottom-left
+        }
+    } else {
+        for (int i = 0; i < quadCount; ++i) {
+            const GLVertex2D topLeft = corner(i, 0);
+            const GLVertex2D topRight = corner(i, 1);
+            const GLVertex2D bottomRight = corner(i, 2);
+            const GLVertex2D bottomLeft = corner(i, 3);
+
+            // First triangle
+            *(vertex++) = topRight;
+            *(vertex++) = topLeft;
+            *(vertex++) = bottomLeft;
+
+            // Second triangle
+            *(vertex++) = bottomLeft;
+            *(vertex++) = bottomRight;
+            *(vertex++) = topRight;
+        }
+    }
+}
+
+bool RenderQuadList::isSharedWith(const RenderQuadList &other) const
+{
+    // All components are detached together, so it's enough to compare one of them.
+    return m_components[X0].constData() == other.m_components[X0].constData();
+}
+
+RenderQuadList RenderQuadList::fromWindowQuads(const WindowQuadList &quads)
+{
+    RenderQuadList ret;
+    ret.reserve(quads.count());
+    for (const WindowQuad &quad : quads) {
+        ret.append(quad);
+    }
+    return ret;
+}
+
+WindowQuadList RenderQuadList::toWindowQuads() const
+{
+    WindowQuadList ret;
+    ret.reserve(count());
+    for (int i = 0; i < count(); ++i) {
+        WindowQuad quad;
+        for (int j = 0; j < 4; ++j) {
+            quad[j] = WindowVertex(m_components[X0 + j][i], m_components[Y0 + j][i],
+                                   m_components[U0 + j][i], m_components[V0 + j][i]);
+        }
+        ret.append(quad);
+    }
+    return ret;
+}
+
+} // namespace KWin
@@ -0,0 +1,94 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwineffects.h"
+
+namespace KWin
+{
+
+/**
+ * @short A list of quads in single precision, ready to be uploaded to the GPU.
+ *
+ * Unlike the WindowQuadList, which stores each vertex in double precision, the RenderQuadList
+ * stores every component of every corner of the quads in a separate array of floats. The quads
+ * can be clipped without going through the vertices one by one, and they can be written into a
+ * vertex buffer without converting them first.
+ *
+ * The vertices of each quad are in the clockwise order starting from the top-left corner, like
+ * in WindowQuad. Clipping expects the quads to be axis aligned, which they are unless an effect
+ * has deformed them.
+ *
+ * fromWindowQuads() and toWindowQuads() convert between the two lists, for effects that work
+ * with window quads.
+ *
+ * @since 5.23
+ */
+class KWINEFFECTS_EXPORT RenderQuadList
+{
+public:
+    int count() const;
+    bool isEmpty() const;
+    void reserve(int count);
+    void clear();
+
+    /**
+     * Appends the quad covering the @a rect, with the texture coordinates of its corners.
+     */
+    void append(const QRectF &rect, const QVector2D &topLeft, const QVector2D &topRight,
+                const QVector2D &bottomRight, const QVector2D &bottomLeft);
+    void append(const WindowQuad &quad);
+
+    /**
+     * Returns the rectangle enclosing the quad at the @a index.
+     */
+    QRectF rect(int index) const;
+    /**
+     * Returns the rectangle enclosing all quads.
+     */
+    QRectF boundingRect() const;
+
+    /**
+     * Returns the parts of the quads inside the @a region. The @a offset is the position of
+     * the quads in the coordinate system of the region. The texture coordinates of the parts
+     * are interpolated from the ones of the corners of the quads.
+     */
+    RenderQuadList clipped(const QRegion &region, const QPointF &offset = QPointF()) const;
+
+    /**
+     * Writes the vertices of the quads to @a vertices, the same way as
+     * WindowQuadList::makeInterleavedArrays().
+     */
+    void makeInterleavedArrays(unsigned int type, GLVertex2D *vertices, const QMatrix4x4 &textureMatrix) const;
+
+    /**
+     * Returns @c true if both lists share the same data, i.e. one is an unmodified copy of
+     * the other.
+     */
+    bool isSharedWith(const RenderQuadList &other) const;
+
+    static RenderQuadList fromWindowQuads(const WindowQuadList &quads);
+    WindowQuadList toWindowQuads() const;
+
+private:
+    enum Component {
+        X0, X1, X2, X3,
+        Y0, Y1, Y2, Y3,
+        U0, U1, U2, U3,
+        V0, V1, V2, V3,
+        ComponentCount,
+    };
+
+    void appendSubQuad(const RenderQuadList &quads, int index, float left, float top, float right, float bottom);
+
+    QVector<float> m_components[ComponentCount];
+};
+
+} // namespace KWin
@@ -0,0 +1,338 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "occlusionculler.h"
+
+#include <QVarLengthArray>
+
+#include <algorithm>
+#include <climits>
+
+namespace KWin
+{
+
+static const RectangleSet::Box *nextBand(const RectangleSet::Box *box, const RectangleSet::Box *end)
+{
+    const int y1 = box->y1;
+    while (box != end && box->y1 == y1) {
+        ++box;
+    }
+    return box;
+}
+
+void RectangleSet::clear()
+{
+    m_boxes.clear();
+}
+
+bool RectangleSet::isEmpty() const
+{
+    return m_boxes.empty();
+}
+
+int RectangleSet::count() const
+{
+    return m_boxes.size();
+}
+
+const RectangleSet::Box *RectangleSet::begin() const
+{
+    return m_boxes.data();
+}
+
+const RectangleSet::Box *RectangleSet::end() const
+{
+    return m_boxes.data() + m_boxes.size();
+}
+
+void RectangleSet::assign(const QRegion &region)
+{
+    m_boxes.clear();
+    for (const QRect &rect : region) {
+        m_boxes.push_back(Box{rect.x(), rect.y(), rect.x() + rect.width(), rect.y() + rect.height()});
+    }
+}
+
+void RectangleSet::assign(const RectangleSet &other)
+{
+    m_boxes.assign(other.m_boxes.begin(), other.m_boxes.end());
+}
+
+QRegion RectangleSet::toRegion() const
+{
+    if (m_boxes.empty()) {
+        return QRegion();
+    }
+    if (m_boxes.size() == 1) {
+        const Box &box = m_boxes.front();
+        return QRegion(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1);
+    }
+
+    // The boxes are y-x banded and coalesced the same way QRegion stores its rectangles,
+    // so they can be handed over without going through QRegion's own region algebra.
+    QVarLengthArray<QRect, 32> rects;
+    rects.reserve(m_boxes.size());
+    for (const Box &box : m_boxes) {
+        rects.append(QRect(box.x1, box.y1, box.x2 - box.x1, box.y2 - box.y1));
+    }
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.count());
+    return region;
+}
+
+void RectangleSet::swap(RectangleSet &other)
+{
+    m_boxes.swap(other.m_boxes);
+}
+
+void RectangleSet::unite(const RectangleSet &a, const RectangleSet &b)
+{
+    combine(a, b, Operation::Unite);
+}
+
+void RectangleSet::subtract(const RectangleSet &a, const RectangleSet &b)
+{
+    combine(a, b, Operation::Subtract);
+}
+
+void RectangleSet::intersect(const RectangleSet &a, const RectangleSet &b)
+{
+    combine(a, b, Operation::Intersect);
+}
+
+void RectangleSet::combine(const RectangleSet &a, const RectangleSet &b, Operation operation)
+{
+    Q_ASSERT(this != &a && this != &b);
+
+    m_boxes.clear();
+    m_previousBand = -1;
+
+    const Box *bandA = a.begin();
+    const Box *endA = a.end();
+    const Box *bandB = b.begin();
+    const Box *endB = b.end();
+
+    // Sweep from the top to the bottom, splitting the plane into horizontal slabs at every
+    // band boundary of either operand, and combine the spans of both operands in each slab.
+    int y = INT_MIN;
+    while (true) {
+        while (bandA != endA && bandA->y2 <= y) {
+            bandA = nextBand(bandA, endA);
+        }
+        while (bandB != endB && bandB->y2 <= y) {
+            bandB = nextBand(bandB, endB);
+        }
+
+        if (bandA == endA && (bandB == endB || operation != Operation::Unite)) {
+            break;
+        }
+        if (bandB == endB && operation == Operation::Intersect) {
+            break;
+        }
+
+        int top = INT_MAX;
+        if (bandA != endA) {
+            top = std::min(top, bandA->y1);
+        }
+        if (bandB != endB) {
+            top = std::min(top, bandB->y1);
+        }
+        y = std::max(y, top);
+
+        int bottom = INT_MAX;
+        const Box *spansA = bandA;
+        const Box *spansEndA = bandA;
+        if (bandA != endA) {
+            if (bandA->y1 > y) {
+                bottom = std::min(bottom, bandA->y1);
+            } else {
+                bottom = std::min(bottom, bandA->y2);
+                spansEndA = nextBand(bandA, endA);
+            }
+        }
+        const Box *spansB = bandB;
+        const Box *spansEndB = bandB;
+        if (bandB != endB) {
+            if (bandB->y1 > y) {
+                bottom = std::min(bottom, bandB->y1);
+            } else {
+                bottom = std::min(bottom, bandB->y2);
+                spansEndB = nextBand(bandB, endB);
+            }
+        }
+
+        appendBand(spansA, spansEndA, spansB, spansEndB, y, bottom, operation);
+        y = bottom;
+    }
+}
+
+void RectangleSet::appendBand(const Box *a, const Box *aEnd, const Box *b, const Box *bEnd,
+                              int y1, int y2, Operation operation)
+{
+    const int bandStart = m_boxes.size();
+
+    switch (operation) {
+    case Operation::Unite:
+        while (a != aEnd || b != bEnd) {
+            if (b == bEnd || (a != aEnd && a->x1 < b->x1)) {
+                appendSpan(a->x1, a->x2, y1, y2, bandStart);
+                ++a;
+            } else {
+                appendSpan(b->x1, b->x2, y1, y2, bandStart);
+                ++b;
+            }
+        }
+        break;
+    case Operation::Subtract:
+        for (; a != aEnd; ++a) {
+            int x = a->x1;
+            while (b != bEnd && b->x2 <= x) {
+                ++b;
+            }
+            for (const Box *cut = b; cut != bEnd && cut->x1 < a->x2; ++cut) {
+                if (cut->x1 > x) {
+                    appendSpan(x, cut->x1, y1, y2, bandStart);
+                }
+                x = std::max(x, cut->x2);
+                if (x >= a->x2) {
+                    break;
+                }
+            }
+            appendSpan(x, a->x2, y1, y2, bandStart);
+        }
+        break;
+    case Operation::Intersect:
+        while (a != aEnd && b != bEnd) {
+            appendSpan(std::max(a->x1, b->x1), std::min(a->x2, b->x2), y1, y2, bandStart);
+            if (a->x2 < b->x2) {
+                ++a;
+            } else {
+                ++b;
+            }
+        }
+        break;
+    }
+
+    coalesceBand(bandStart);
+}
+
+void RectangleSet::appendSpan(int x1, int x2, int y1, int y2, int bandStart)
+{
+    if (x1 >= x2) {
+        return;
+    }
+    if (int(m_boxes.size()) > bandStart && m_boxes.back().x2 >= x1) {
+        m_boxes.back().x2 = std::max(m_boxes.back().x2, x2);
+    } else {
+        m_boxes.push_back(Box{x1, y1, x2, y2});
+    }
+}
+
+void RectangleSet::coalesceBand(int bandStart)
+{
+    const int bandEnd = m_boxes.size();
+    if (bandStart == bandEnd) {
+        return;
+    }
+
+    // Merge the band with the one above if they touch and have the same spans.
+    if (m_previousBand != -1 && bandStart - m_previousBand == bandEnd - bandStart
+            && m_boxes[m_previousBand].y2 == m_boxes[bandStart].y1) {
+        const int count = bandEnd - bandStart;
+        bool equal = true;
+        for (int i = 0; i < count; ++i) {
+            const Box &previous = m_boxes[m_previousBand + i];
+            const Box &current = m_boxes[bandStart + i];
+            if (previous.x1 != current.x1 || previous.x2 != current.x2) {
+                equal = false;
+                break;
+            }
+        }
+        if (equal) {
+            const int y2 = m_boxes[bandStart].y2;
+            for (int i = m_previousBand; i < bandStart; ++i) {
+                m_boxes[i].y2 = y2;
+            }
+            m_boxes.resize(bandStart);
+            return;
+        }
+    }
+
+    m_previousBand = bandStart;
+}
+
+void OcclusionCuller::begin(int windowCount, bool fullRepaint, const QRegion &displayRegion, const QRegion &repaintRegion)
+{
+    if (int(m_windows.size()) < windowCount) {
+        m_windows.resize(windowCount);
+    }
+    m_fullRepaint = fullRepaint;
+    m_displayRegion.assign(displayRegion);
+    m_allClips.clear();
+    m_upperTranslucentDamage.assign(repaintRegion);
+    m_paintedArea.clear();
+}
+
+void OcclusionCuller::cullWindow(int index, const QRegion &paint, const QRegion &clip, bool translucent)
+{
+    RectangleSet &region = m_windows[index];
+
+    // Subtract the parts which will possibly be drawn as part of a higher opaque window.
+    if (m_fullRepaint) {
+        region.subtract(m_displayRegion, m_allClips);
+    } else {
+        m_input.assign(paint);
+        m_scratch.unite(m_input, m_upperTranslucentDamage);
+        region.subtract(m_scratch, m_allClips);
+    }
+
+    if (!clip.isEmpty() && !translucent) {
+        // Clip away the opaque regions for all windows below this one.
+        m_input.assign(clip);
+        m_scratch.unite(m_allClips, m_input);
+        m_allClips.swap(m_scratch);
+
+        // Extend the translucent damage for windows below this by the remaining regions.
+        if (!m_fullRepaint) {
+            m_scratch2.subtract(region, m_input);
+            m_scratch.unite(m_upperTranslucentDamage, m_scratch2);
+            m_upperTranslucentDamage.swap(m_scratch);
+        }
+    } else if (!m_fullRepaint) {
+        m_scratch.unite(m_upperTranslucentDamage, region);
+        m_upperTranslucentDamage.swap(m_scratch);
+    }
+}
+
+QRegion OcclusionCuller::exposedRegion(const QRegion &region)
+{
+    m_input.assign(region);
+    m_scratch.subtract(m_input, m_allClips);
+    return m_scratch.toRegion();
+}
+
+void OcclusionCuller::beginPainting(const QRegion &region)
+{
+    m_paintedArea.assign(region);
+}
+
+QRegion OcclusionCuller::paintWindow(int index)
+{
+    m_scratch.unite(m_paintedArea, m_windows[index]);
+    m_paintedArea.swap(m_scratch);
+    return m_paintedArea.toRegion();
+}
+
+QRegion OcclusionCuller::paintedArea() const
+{
+    return m_paintedArea.toRegion();
+}
+
+} // namespace KWin
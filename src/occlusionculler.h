@@ -0,0 +1,137 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <kwinglobals.h>
+
+#include <QRegion>
+
+#include <vector>
+
+namespace KWin
+{
+
+/**
+ * The RectangleSet class represents a region as a list of y-x banded rectangles, like
+ * QRegion does. Unlike QRegion, its storage is not implicitly shared but reused by every
+ * operation, so once the buffers have grown to the working set size, region algebra does
+ * not allocate anymore.
+ *
+ * The results of unite(), subtract() and intersect() are stored in the set on which they
+ * are called, which must not be one of the operands.
+ */
+class KWIN_EXPORT RectangleSet
+{
+public:
+    struct Box
+    {
+        int x1;
+        int y1;
+        int x2;
+        int y2;
+    };
+
+    void clear();
+    bool isEmpty() const;
+    int count() const;
+    const Box *begin() const;
+    const Box *end() const;
+
+    void assign(const QRegion &region);
+    void assign(const RectangleSet &other);
+    QRegion toRegion() const;
+
+    void unite(const RectangleSet &a, const RectangleSet &b);
+    void subtract(const RectangleSet &a, const RectangleSet &b);
+    void intersect(const RectangleSet &a, const RectangleSet &b);
+
+    void swap(RectangleSet &other);
+
+private:
+    enum class Operation {
+        Unite,
+        Subtract,
+        Intersect,
+    };
+
+    void combine(const RectangleSet &a, const RectangleSet &b, Operation operation);
+    void appendBand(const Box *a, const Box *aEnd, const Box *b, const Box *bEnd,
+                    int y1, int y2, Operation operation);
+    void appendSpan(int x1, int x2, int y1, int y2, int bandStart);
+    void coalesceBand(int bandStart);
+
+    std::vector<Box> m_boxes;
+    int m_previousBand = -1;
+};
+
+/**
+ * The OcclusionCuller class implements the occlusion culling pass of the scene.
+ *
+ * Windows are culled from the top to the bottom with cullWindow(), which removes the parts
+ * covered by opaque windows above and adds the damage of translucent windows above. Then
+ * the regions to paint are accumulated from the bottom to the top with paintWindow().
+ *
+ * All intermediate regions live in RectangleSets owned by the culler, which are reused
+ * from frame to frame; QRegions are only created for the results that are handed over to
+ * the scene.
+ */
+class KWIN_EXPORT OcclusionCuller
+{
+public:
+    /**
+     * Starts a new culling pass for @a windowCount windows. If @a fullRepaint is @c true,
+     * every window has to be painted in the entire @a displayRegion except for the parts
+     * that are occluded. Otherwise the damage of translucent windows is propagated to the
+     * windows below, starting with the @a repaintRegion.
+     */
+    void begin(int windowCount, bool fullRepaint, const QRegion &displayRegion, const QRegion &repaintRegion);
+
+    /**
+     * Culls the window with the given @a index, the windows must be culled from the top
+     * to the bottom. @a paint is the damage of the window, @a clip is the region covered
+     * by the opaque parts of the window, which has to be empty if @a translucent is @c true.
+     */
+    void cullWindow(int index, const QRegion &paint, const QRegion &clip, bool translucent);
+
+    /**
+     * Returns the parts of @a region that are not covered by the opaque parts of any window.
+     */
+    QRegion exposedRegion(const QRegion &region);
+
+    /**
+     * Starts accumulating the painted area with the given @a region.
+     */
+    void beginPainting(const QRegion &region);
+
+    /**
+     * Adds the visible parts of the window with the given @a index to the painted area and
+     * returns the painted area so far, which is the region the window has to be painted
+     * in. The windows must be painted from the bottom to the top.
+     */
+    QRegion paintWindow(int index);
+
+    /**
+     * Returns the area that has been painted.
+     */
+    QRegion paintedArea() const;
+
+private:
+    std::vector<RectangleSet> m_windows;
+    RectangleSet m_displayRegion;
+    RectangleSet m_allClips;
+    RectangleSet m_upperTranslucentDamage;
+    RectangleSet m_paintedArea;
+    RectangleSet m_input;
+    RectangleSet m_scratch;
+    RectangleSet m_scratch2;
+    bool m_fullRepaint = false;
+};
+
+} // namespace KWin
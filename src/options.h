@@ -60,6 +60,7 @@ enum RenderTimeEstimator {
     RenderTimeEstimatorMinimum,
     RenderTimeEstimatorMaximum,
     RenderTimeEstimatorAverage,
+    RenderTimeEstimatorPercentile,
 };
 
 class Settings;
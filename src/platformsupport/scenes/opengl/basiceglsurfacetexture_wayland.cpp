@@ -99,9 +99,7 @@ void BasicEGLSurfaceTextureWayland::updateShmTexture(KWaylandServer::ShmClientBu
     }
 
     const QRegion damage = mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region);
-    for (const QRect &rect : damage) {
-        m_texture->update(image, rect.topLeft(), rect);
-    }
+    m_texture->update(image, damage);
 }
 
 bool BasicEGLSurfaceTextureWayland::loadEglTexture(KWaylandServer::DrmClientBuffer *buffer)
@@ -5,6 +5,7 @@
 */
 
 #include "platformqpaintersurfacetexture_wayland.h"
+#include "qpainterbackend.h"
 #include "surfaceitem_wayland.h"
 #include "utils.h"
 
@@ -16,6 +17,16 @@
 namespace KWin
 {
 
+static bool isZeroCopyEnabled()
+{
+    static const bool enabled = [] {
+        bool ok = false;
+        const int value = qEnvironmentVariableIntValue("KWIN_QPAINTER_SHM_ZERO_COPY", &ok);
+        return !ok || value != 0;
+    }();
+    return enabled;
+}
+
 PlatformQPainterSurfaceTextureWayland::PlatformQPainterSurfaceTextureWayland(QPainterBackend *backend,
                                                                              SurfacePixmapWayland *pixmap)
     : PlatformQPainterSurfaceTexture(backend)
@@ -23,13 +34,24 @@ PlatformQPainterSurfaceTextureWayland::PlatformQPainterSurfaceTextureWayland(QPa
 {
 }
 
+PlatformQPainterSurfaceTextureWayland::~PlatformQPainterSurfaceTextureWayland()
+{
+    // Gives the borrowed buffer back to the client
+    setImage(QImage(), false);
+    Q_ASSERT(!m_borrowedBuffer);
+}
+
 bool PlatformQPainterSurfaceTextureWayland::create()
 {
     auto buffer = qobject_cast<KWaylandServer::ShmClientBuffer *>(m_pixmap->buffer());
     if (Q_LIKELY(buffer)) {
-        // The buffer data is copied as the buffer interface returns a QImage
-        // which doesn't own the data of the underlying wl_shm_buffer object.
-        m_image = buffer->data().copy();
+        if (isZeroCopyEnabled() && m_pixmap->surface()) {
+            borrow(buffer);
+        } else {
+            // The buffer data is copied as the buffer interface returns a QImage
+            // which doesn't own the data of the underlying wl_shm_buffer object.
+            setImage(buffer->data().copy(), false);
+        }
     }
     return !m_image.isNull();
 }
@@ -41,6 +63,16 @@ void PlatformQPainterSurfaceTextureWayland::update(const QRegion &region)
         return;
     }
 
+    if (m_borrowedBuffer) {
+        if (!m_pixmap->surface() || m_pixmap->isDiscarded()) {
+            detach();
+        } else if (m_borrowedBuffer != buffer) {
+            // A new buffer contains the entire surface, not only the damaged parts.
+            borrow(buffer);
+        }
+        return;
+    }
+
     const QImage image = buffer->data();
     const QRegion dirtyRegion = mapRegion(m_pixmap->item()->surfaceToBufferMatrix(), region);
     QPainter painter(&m_image);
@@ -52,4 +84,44 @@ void PlatformQPainterSurfaceTextureWayland::update(const QRegion &region)
     }
 }
 
+void PlatformQPainterSurfaceTextureWayland::discard()
+{
+    if (m_borrowedBuffer) {
+        detach();
+    }
+}
+
+void PlatformQPainterSurfaceTextureWayland::borrow(KWaylandServer::ShmClientBuffer *buffer)
+{
+    // The reference holds back the release event, so the client won't write to the buffer
+    // while it's being painted. The image keeps the shm pool mapped.
+    buffer->ref();
+    setImage(buffer->data(), true);
+    m_borrowedBuffer = buffer;
+}
+
+void PlatformQPainterSurfaceTextureWayland::detach()
+{
+    setImage(m_image.copy(), false);
+}
+
+void PlatformQPainterSurfaceTextureWayland::setImage(const QImage &image, bool borrowed)
+{
+    if (m_borrowedBuffer) {
+        m_backend->addBorrowedShmBytes(-m_image.sizeInBytes());
+        m_borrowedBuffer->unref();
+        m_borrowedBuffer = nullptr;
+    } else {
+        m_backend->addCopiedShmBytes(-m_image.sizeInBytes());
+    }
+
+    m_image = image;
+
+    if (borrowed) {
+        m_backend->addBorrowedShmBytes(m_image.sizeInBytes());
+    } else {
+        m_backend->addCopiedShmBytes(m_image.sizeInBytes());
+    }
+}
+
 } // namespace KWin
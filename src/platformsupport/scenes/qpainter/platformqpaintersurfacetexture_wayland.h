@@ -8,21 +8,44 @@
 
 #include "platformqpaintersurfacetexture.h"
 
+namespace KWaylandServer
+{
+class ShmClientBuffer;
+}
+
 namespace KWin
 {
 
 class SurfacePixmapWayland;
 
+/**
+ * The PlatformQPainterSurfaceTextureWayland class provides the contents of a wl_shm buffer
+ * to the QPainter scene.
+ *
+ * By default, the texture keeps a reference to the client buffer and the scene paints
+ * straight from the shared memory, the client doesn't get the buffer back until a newer
+ * one has been attached. Once the surface is gone or the pixmap has been discarded, the
+ * client may reuse the memory while the window is still shown, e.g. in a closing
+ * animation, so the contents are copied then. Setting KWIN_QPAINTER_SHM_ZERO_COPY=0 makes
+ * the texture always keep a private copy of the buffer.
+ */
 class KWIN_EXPORT PlatformQPainterSurfaceTextureWayland : public PlatformQPainterSurfaceTexture
 {
 public:
     PlatformQPainterSurfaceTextureWayland(QPainterBackend *backend, SurfacePixmapWayland *pixmap);
+    ~PlatformQPainterSurfaceTextureWayland() override;
 
     bool create() override;
     void update(const QRegion &region) override;
+    void discard() override;
 
 private:
+    void borrow(KWaylandServer::ShmClientBuffer *buffer);
+    void detach();
+    void setImage(const QImage &image, bool borrowed);
+
     SurfacePixmapWayland *m_pixmap;
+    KWaylandServer::ShmClientBuffer *m_borrowedBuffer = nullptr;
 };
 
 } // namespace KWin
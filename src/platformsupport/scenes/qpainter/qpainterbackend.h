@@ -55,6 +55,26 @@ public:
      */
     virtual QImage *bufferForScreen(AbstractOutput *output) = 0;
 
+    /**
+     * Returns the total size of the client shm buffers that are rendered directly, without
+     * being copied first.
+     */
+    qint64 borrowedShmBytes() const {
+        return m_borrowedShmBytes;
+    }
+    /**
+     * Returns the total size of the private copies of client shm buffers.
+     */
+    qint64 copiedShmBytes() const {
+        return m_copiedShmBytes;
+    }
+    void addBorrowedShmBytes(qint64 bytes) {
+        m_borrowedShmBytes += bytes;
+    }
+    void addCopiedShmBytes(qint64 bytes) {
+        m_copiedShmBytes += bytes;
+    }
+
 protected:
     QPainterBackend();
     /**
@@ -69,6 +89,8 @@ protected:
 
 private:
     bool m_failed;
+    qint64 m_borrowedShmBytes = 0;
+    qint64 m_copiedShmBytes = 0;
 };
 
 } // KWin
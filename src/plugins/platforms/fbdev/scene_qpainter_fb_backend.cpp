@@ -46,6 +46,10 @@ FramebufferQPainterBackend::FramebufferQPainterBackend(FramebufferBackend *backe
 
 void FramebufferQPainterBackend::reactivate()
 {
+    // The contents of the fb device may have been changed while the session was inactive.
+    m_damageJournal.clear();
+    m_bufferAge = 0;
+
     const QVector<AbstractOutput *> outputs = m_backend->outputs();
     for (AbstractOutput *output : outputs) {
         output->renderLoop()->uninhibit();
@@ -71,21 +75,39 @@ QImage* FramebufferQPainterBackend::bufferForScreen(AbstractOutput *output)
 
 QRegion FramebufferQPainterBackend::beginFrame(AbstractOutput *output)
 {
-    return output->geometry();
+    return m_damageJournal.accumulate(m_bufferAge, output->geometry());
 }
 
 void FramebufferQPainterBackend::endFrame(AbstractOutput *output, const QRegion &damage)
 {
-    Q_UNUSED(damage)
-
     if (!kwinApp()->platform()->session()->isActive()) {
         return;
     }
 
     static_cast<FramebufferOutput *>(output)->vsyncMonitor()->arm();
 
+    // The render buffer is kept between frames, so the fb device only needs to be updated
+    // where the scene has painted, unless its contents are unknown.
+    QRegion copyRegion = damage.translated(-output->geometry().topLeft());
+    if (m_bufferAge == 0) {
+        copyRegion = m_renderBuffer.rect();
+    }
+
     QPainter p(&m_backBuffer);
-    p.drawImage(QPoint(0, 0), m_backend->isBGR() ? m_renderBuffer.rgbSwapped() : m_renderBuffer);
+    for (const QRect &rect : copyRegion) {
+        const QRect sourceRect = rect & m_renderBuffer.rect();
+        if (sourceRect.isEmpty()) {
+            continue;
+        }
+        if (m_backend->isBGR()) {
+            p.drawImage(sourceRect.topLeft(), m_renderBuffer.copy(sourceRect).rgbSwapped());
+        } else {
+            p.drawImage(sourceRect.topLeft(), m_renderBuffer, sourceRect);
+        }
+    }
+
+    m_damageJournal.add(damage);
+    m_bufferAge = 1;
 }
 
 }
@@ -9,6 +9,7 @@
 #ifndef KWIN_SCENE_QPAINTER_FB_BACKEND_H
 #define KWIN_SCENE_QPAINTER_FB_BACKEND_H
 #include "qpainterbackend.h"
+#include "utils.h"
 
 #include <QObject>
 #include <QImage>
@@ -40,6 +41,11 @@ private:
      * @brief buffer to draw into
      */
     QImage m_backBuffer;
+    /**
+     * @brief damage of the last frames, only the damaged parts are copied to the fb device
+     */
+    DamageJournal m_damageJournal;
+    int m_bufferAge = 0;
 
     FramebufferBackend *m_backend;
 };
@@ -29,33 +29,65 @@ VirtualQPainterBackend::~VirtualQPainterBackend() = default;
 
 QImage *VirtualQPainterBackend::bufferForScreen(AbstractOutput *output)
 {
-    return &m_backBuffers[output];
+    return &m_outputs[output].buffer;
 }
 
 QRegion VirtualQPainterBackend::beginFrame(AbstractOutput *output)
 {
-    return output->geometry();
+    const Output &rendererOutput = m_outputs[output];
+    return rendererOutput.damageJournal.accumulate(rendererOutput.bufferAge, output->geometry());
 }
 
 void VirtualQPainterBackend::createOutputs()
 {
-    m_backBuffers.clear();
+    m_outputs.clear();
     const auto outputs = m_backend->enabledOutputs();
     for (const auto &output : outputs) {
-        QImage buffer(output->pixelSize(), QImage::Format_RGB32);
-        buffer.fill(Qt::black);
-        m_backBuffers.insert(output, buffer);
+        Output rendererOutput;
+        rendererOutput.buffer = QImage(output->pixelSize(), QImage::Format_RGB32);
+        rendererOutput.buffer.fill(Qt::black);
+        m_outputs.insert(output, rendererOutput);
     }
 }
 
 void VirtualQPainterBackend::endFrame(AbstractOutput *output, const QRegion &damage)
 {
-    Q_UNUSED(damage)
+    Output &rendererOutput = m_outputs[output];
+    rendererOutput.damageJournal.add(damage);
+    rendererOutput.bufferAge = 1;
 
     static_cast<VirtualOutput *>(output)->vsyncMonitor()->arm();
 
     if (m_backend->saveFrames()) {
-        m_backBuffers[output].save(QStringLiteral("%1/%s-%3.png").arg(m_backend->screenshotDirPath(), output->name(), QString::number(m_frameCounter++)));
+        saveFrame(output, rendererOutput, damage);
+    }
+    m_frameCounter++;
+}
+
+void VirtualQPainterBackend::saveFrame(AbstractOutput *output, const Output &rendererOutput, const QRegion &damage)
+{
+    const QString frame = QString::number(m_frameCounter);
+    if (!m_backend->saveDamageOnly()) {
+        rendererOutput.buffer.save(QStringLiteral("%1/%2-%3.png").arg(m_backend->screenshotDirPath(), output->name(), frame));
+        return;
+    }
+
+    const QRect geometry = output->geometry();
+    const QRect bufferRect = rendererOutput.buffer.rect();
+    const qreal scale = output->scale();
+    for (const QRect &rect : damage) {
+        const QRectF logicalRect = rect.translated(-geometry.topLeft());
+        const QRect nativeRect = QRectF(logicalRect.topLeft() * scale, logicalRect.size() * scale).toAlignedRect() & bufferRect;
+        if (nativeRect.isEmpty()) {
+            continue;
+        }
+        const QString fileName = QStringLiteral("%1/%2-%3-%4,%5-%6x%7.png")
+                                     .arg(m_backend->screenshotDirPath(), output->name(), frame)
+                                     .arg(nativeRect.x())
+                                     .arg(nativeRect.y())
+                                     .arg(nativeRect.width())
+                                     .arg(nativeRect.height());
+        rendererOutput.buffer.copy(nativeRect).save(fileName);
     }
 }
 
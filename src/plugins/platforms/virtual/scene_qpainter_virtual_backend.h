@@ -10,6 +10,7 @@
 #define KWIN_SCENE_QPAINTER_VIRTUAL_BACKEND_H
 
 #include "qpainterbackend.h"
+#include "utils.h"
 
 #include <QObject>
 #include <QVector>
@@ -32,9 +33,21 @@ public:
     void endFrame(AbstractOutput *output, const QRegion &damage) override;
 
 private:
+    struct Output
+    {
+        QImage buffer;
+        DamageJournal damageJournal;
+        /**
+         * The buffer is reused from frame to frame, so it is either undefined or contains
+         * the previous frame.
+         */
+        int bufferAge = 0;
+    };
+
     void createOutputs();
+    void saveFrame(AbstractOutput *output, const Output &rendererOutput, const QRegion &damage);
 
-    QMap<AbstractOutput *, QImage> m_backBuffers;
+    QMap<AbstractOutput *, Output> m_outputs;
     VirtualBackend *m_backend;
     int m_frameCounter = 0;
 };
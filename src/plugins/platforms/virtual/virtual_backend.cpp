@@ -36,6 +36,7 @@ VirtualBackend::VirtualBackend(QObject *parent)
         if (!m_screenshotDir.isNull()) {
             qDebug() << "Screenshots saved to: " << m_screenshotDir->path();
         }
+        m_saveDamageOnly = qEnvironmentVariableIsSet("KWIN_WAYLAND_VIRTUAL_SCREENSHOTS_DAMAGE_ONLY");
     }
 
     supportsOutputChanges();
@@ -38,6 +38,13 @@ public:
         return !m_screenshotDir.isNull();
     }
     QString screenshotDirPath() const;
+    /**
+     * Whether only the damaged rectangles of the frames should be saved rather than the
+     * entire frames.
+     */
+    bool saveDamageOnly() const {
+        return m_saveDamageOnly;
+    }
 
     QPainterBackend* createQPainterBackend() override;
     OpenGLBackend *createOpenGLBackend() override;
@@ -65,6 +72,7 @@ private:
     QVector<VirtualOutput*> m_outputs;
     QVector<VirtualOutput*> m_outputsEnabled;
     QScopedPointer<QTemporaryDir> m_screenshotDir;
+    bool m_saveDamageOnly = false;
     Session *m_session;
 };
 
@@ -75,6 +75,7 @@ void WaylandQPainterOutput::updateSize(const QSize &size)
     m_back = nullptr;
     qDeleteAll(m_slots);
     m_slots.clear();
+    m_damageJournal.clear();
 }
 
 void WaylandQPainterOutput::present(const QRegion &damage)
@@ -89,7 +90,7 @@ void WaylandQPainterOutput::present(const QRegion &damage)
 
     auto s = m_waylandOutput->surface();
     s->attachBuffer(m_back->buffer);
-    s->damage(damage);
+    s->damage(mapToLocal(damage));
     s->setScale(std::ceil(m_waylandOutput->scale()));
     s->commit();
 
@@ -177,7 +178,7 @@ void WaylandQPainterBackend::endFrame(AbstractOutput *output, const QRegion &dam
     WaylandQPainterOutput *rendererOutput = m_outputs[output];
     Q_ASSERT(rendererOutput);
 
-    rendererOutput->present(rendererOutput->mapToLocal(damage));
+    rendererOutput->present(damage);
 }
 
 QImage *WaylandQPainterBackend::bufferForScreen(AbstractOutput *output)
@@ -12,8 +12,6 @@
 
 #include "internal_client.h"
 
-#include <QPainter>
-
 namespace KWin
 {
 namespace QPA
@@ -21,6 +19,7 @@ namespace QPA
 
 BackingStore::BackingStore(QWindow *window)
     : QPlatformBackingStore(window)
+    , m_buffer(std::make_shared<QImage>())
 {
 }
 
@@ -28,38 +27,47 @@ BackingStore::~BackingStore() = default;
 
 QPaintDevice *BackingStore::paintDevice()
 {
-    return &m_backBuffer;
+    return m_buffer.get();
+}
+
+void BackingStore::beginPaint(const QRegion &region)
+{
+    Q_UNUSED(region)
+
+    // The buffer can be painted into as long as the compositor only holds it for the client
+    // that shows this window, the damage is presented with the next flush
+    if (m_buffer.use_count() == 1) {
+        return;
+    }
+    const Window *platformWindow = static_cast<Window *>(window()->handle());
+    if (m_presentedClient && m_presentedClient == platformWindow->client()) {
+        return;
+    }
+
+    m_buffer = std::make_shared<QImage>(m_buffer->copy());
+    m_presentedClient.clear();
 }
 
 void BackingStore::resize(const QSize &size, const QRegion &staticContents)
 {
     Q_UNUSED(staticContents)
 
-    if (m_backBuffer.size() == size) {
+    if (m_buffer->size() == size) {
         return;
     }
 
     const QPlatformWindow *platformWindow = static_cast<QPlatformWindow *>(window()->handle());
     const qreal devicePixelRatio = platformWindow->devicePixelRatio();
 
-    m_backBuffer = QImage(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
-    m_backBuffer.setDevicePixelRatio(devicePixelRatio);
-
-    m_frontBuffer = QImage(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
-    m_frontBuffer.setDevicePixelRatio(devicePixelRatio);
+    // The compositor keeps the previous buffer as long as it needs it
+    m_buffer = std::make_shared<QImage>(size * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    m_buffer->setDevicePixelRatio(devicePixelRatio);
+    m_presentedClient.clear();
 }
 
-static QRect scaledRect(const QRect &rect, qreal devicePixelRatio)
+static void releaseBuffer(void *info)
 {
-    return QRect(rect.topLeft() * devicePixelRatio, rect.size() * devicePixelRatio);
-}
-
-static void blitImage(const QImage &source, QImage &target, const QRegion &region)
-{
-    QPainter painter(&target);
-    for (const QRect &rect : region) {
-        painter.drawImage(rect, source, scaledRect(rect, source.devicePixelRatio()));
-    }
+    delete static_cast<std::shared_ptr<QImage> *>(info);
 }
 
 void BackingStore::flush(QWindow *window, const QRegion &region, const QPoint &offset)
@@ -72,9 +80,14 @@ void BackingStore::flush(QWindow *window, const QRegion &region, const QPoint &o
         return;
     }
 
-    blitImage(m_backBuffer, m_frontBuffer, region);
+    // The image shares the pixels of the buffer and keeps it alive until the compositor
+    // drops the last copy of the image
+    QImage image(m_buffer->bits(), m_buffer->width(), m_buffer->height(), m_buffer->bytesPerLine(),
+                 m_buffer->format(), releaseBuffer, new std::shared_ptr<QImage>(m_buffer));
+    image.setDevicePixelRatio(m_buffer->devicePixelRatio());
 
-    client->present(m_frontBuffer, region);
+    m_presentedClient = client;
+    client->present(image, region);
 }
 
 }
@@ -14,11 +14,29 @@
 
 #include <qpa/qplatformbackingstore.h>
 
+#include <QPointer>
+
+#include <memory>
+
 namespace KWin
 {
+
+class InternalClient;
+
 namespace QPA
 {
 
+/**
+ * The BackingStore hands the buffer it paints into to the compositor without copying it.
+ *
+ * The compositor gets a QImage that shares the pixels of the buffer, so the next paint goes
+ * into the pixels the compositor shows and only the damaged part has to be uploaded again.
+ * As everything runs on the main thread, the compositor never sees a half painted buffer.
+ *
+ * If the compositor still holds the buffer for a client that is gone, for example in the
+ * closing animation of a window that has been shown again, the paint goes into a copy of the
+ * buffer instead, and the old buffer is released once the compositor is done with it.
+ */
 class BackingStore : public QPlatformBackingStore
 {
 public:
@@ -26,12 +44,13 @@ public:
     ~BackingStore() override;
 
     QPaintDevice *paintDevice() override;
+    void beginPaint(const QRegion &region) override;
     void flush(QWindow *window, const QRegion &region, const QPoint &offset) override;
     void resize(const QSize &size, const QRegion &staticContents) override;
 
 private:
-    QImage m_backBuffer;
-    QImage m_frontBuffer;
+    std::shared_ptr<QImage> m_buffer;
+    QPointer<InternalClient> m_presentedClient;
 };
 
 }
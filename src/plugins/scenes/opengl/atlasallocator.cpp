@@ -0,0 +1,187 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "atlasallocator.h"
+
+#include <algorithm>
+
+namespace KWin
+{
+
+AtlasAllocator::AtlasAllocator(const QSize &size)
+    : m_size(size)
+{
+}
+
+QSize AtlasAllocator::size() const
+{
+    return m_size;
+}
+
+int AtlasAllocator::count() const
+{
+    return m_rects.count();
+}
+
+qint64 AtlasAllocator::usedArea() const
+{
+    return m_usedArea;
+}
+
+bool AtlasAllocator::place(const QSize &size, QRect *rect)
+{
+    // Look for the shelf with the least wasted height that has room for the rectangle. A shelf
+    // is not used if more than a third of its height would be wasted.
+    int bestShelf = -1;
+    int bestSpan = -1;
+    for (int i = 0; i < m_shelves.count(); ++i) {
+        const Shelf &shelf = m_shelves[i];
+        if (size.height() > shelf.height || shelf.height - size.height() > size.height() / 2) {
+            continue;
+        }
+        if (bestShelf != -1 && m_shelves[bestShelf].height <= shelf.height) {
+            continue;
+        }
+        for (int j = 0; j < shelf.freeSpans.count(); ++j) {
+            if (shelf.freeSpans[j].width >= size.width()) {
+                bestShelf = i;
+                bestSpan = j;
+                break;
+            }
+        }
+    }
+
+    if (bestShelf != -1) {
+        Shelf &shelf = m_shelves[bestShelf];
+        Span &span = shelf.freeSpans[bestSpan];
+        *rect = QRect(QPoint(span.x, shelf.y), size);
+        span.x += size.width();
+        span.width -= size.width();
+        if (!span.width) {
+            shelf.freeSpans.remove(bestSpan);
+        }
+        return true;
+    }
+
+    const int y = m_shelves.isEmpty() ? 0 : m_shelves.last().y + m_shelves.last().height;
+    if (size.width() > m_size.width() || y + size.height() > m_size.height()) {
+        return false;
+    }
+
+    Shelf shelf{y, size.height(), {}};
+    if (size.width() < m_size.width()) {
+        shelf.freeSpans.append(Span{size.width(), m_size.width() - size.width()});
+    }
+    m_shelves.append(shelf);
+    *rect = QRect(QPoint(0, y), size);
+    return true;
+}
+
+int AtlasAllocator::allocate(const QSize &size)
+{
+    if (size.isEmpty()) {
+        return -1;
+    }
+
+    QRect rect;
+    if (!place(size, &rect)) {
+        return -1;
+    }
+
+    const int handle = ++m_lastHandle;
+    m_rects.insert(handle, rect);
+    m_usedArea += qint64(size.width()) * size.height();
+    return handle;
+}
+
+void AtlasAllocator::release(int handle)
+{
+    const QRect rect = m_rects.take(handle);
+    if (rect.isNull()) {
+        return;
+    }
+    m_usedArea -= qint64(rect.width()) * rect.height();
+
+    auto shelf = std::find_if(m_shelves.begin(), m_shelves.end(), [&rect](const Shelf &candidate) {
+        return candidate.y == rect.y();
+    });
+    Q_ASSERT(shelf != m_shelves.end());
+
+    // Keep the free spans sorted, and merge them with their neighbours.
+    QVector<Span> &spans = shelf->freeSpans;
+    auto it = std::lower_bound(spans.begin(), spans.end(), rect.x(), [](const Span &span, int x) {
+        return span.x < x;
+    });
+    it = spans.insert(it, Span{rect.x(), rect.width()});
+    if (it + 1 != spans.end() && it->x + it->width == (it + 1)->x) {
+        it->width += (it + 1)->width;
+        spans.erase(it + 1);
+    }
+    if (it != spans.begin() && (it - 1)->x + (it - 1)->width == it->x) {
+        (it - 1)->width += it->width;
+        spans.erase(it);
+    }
+
+    // Empty shelves at the bottom are given back, so taller rectangles can be placed there.
+    while (!m_shelves.isEmpty()) {
+        const Shelf &last = m_shelves.last();
+        if (last.freeSpans.count() != 1 || last.freeSpans.first().width != m_size.width()) {
+            break;
+        }
+        m_shelves.removeLast();
+    }
+}
+
+QRect AtlasAllocator::rect(int handle) const
+{
+    return m_rects.value(handle);
+}
+
+QVector<int> AtlasAllocator::handles() const
+{
+    QVector<int> ret;
+    ret.reserve(m_rects.count());
+    for (auto it = m_rects.constBegin(); it != m_rects.constEnd(); ++it) {
+        ret.append(it.key());
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+bool AtlasAllocator::repack(const QSize &size)
+{
+    // Placing the tallest rectangles first keeps the shelves filled.
+    QVector<int> sorted = handles();
+    std::stable_sort(sorted.begin(), sorted.end(), [this](int a, int b) {
+        const QRect &first = m_rects[a];
+        const QRect &second = m_rects[b];
+        if (first.height() != second.height()) {
+            return first.height() > second.height();
+        }
+        return first.width() > second.width();
+    });
+
+    AtlasAllocator packed(size);
+    QHash<int, QRect> rects;
+    rects.reserve(m_rects.count());
+    for (int handle : qAsConst(sorted)) {
+        QRect rect;
+        if (!packed.place(m_rects[handle].size(), &rect)) {
+            return false;
+        }
+        rects.insert(handle, rect);
+    }
+
+    m_size = size;
+    m_shelves = packed.m_shelves;
+    m_rects = rects;
+    return true;
+}
+
+} // namespace KWin
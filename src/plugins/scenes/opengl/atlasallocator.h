@@ -0,0 +1,86 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QHash>
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * The AtlasAllocator packs rectangles into a bin with shelves: each shelf is a row as tall as
+ * the first rectangle placed in it, and the rectangles are placed side by side in the shelves.
+ * The space of released rectangles is reused by later allocations of a similar height.
+ *
+ * Released rectangles can leave holes that are too small to be reused, repack() places all
+ * rectangles again from scratch to get rid of them.
+ */
+class AtlasAllocator
+{
+public:
+    explicit AtlasAllocator(const QSize &size = QSize());
+
+    QSize size() const;
+
+    /**
+     * Returns the number of allocated rectangles.
+     */
+    int count() const;
+    /**
+     * Returns the area covered by the allocated rectangles.
+     */
+    qint64 usedArea() const;
+
+    /**
+     * Allocates a rectangle of the given @a size, returns the handle of the rectangle or -1
+     * if there is no room for it.
+     */
+    int allocate(const QSize &size);
+    void release(int handle);
+
+    /**
+     * Returns the rectangle with the given @a handle.
+     */
+    QRect rect(int handle) const;
+    QVector<int> handles() const;
+
+    /**
+     * Places all rectangles again in a bin of the given @a size. The handles stay the same,
+     * but the rectangles may have moved. If the rectangles don't fit, @c false is returned
+     * and nothing is changed.
+     */
+    bool repack(const QSize &size);
+
+private:
+    struct Span
+    {
+        int x;
+        int width;
+    };
+
+    struct Shelf
+    {
+        int y;
+        int height;
+        QVector<Span> freeSpans;
+    };
+
+    bool place(const QSize &size, QRect *rect);
+
+    QSize m_size;
+    QVector<Shelf> m_shelves;
+    QHash<int, QRect> m_rects;
+    qint64 m_usedArea = 0;
+    int m_lastHandle = 0;
+};
+
+} // namespace KWin
@@ -0,0 +1,149 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "opengldecorationatlas.h"
+
+#include "kwinglutils.h"
+
+#include <QImage>
+
+namespace KWin
+{
+
+// The atlas starts with room for the decorations of a few dozen windows.
+static const int s_initialSize = 1024;
+
+static int nextPowerOfTwo(int value)
+{
+    int ret = 1;
+    while (ret < value) {
+        ret <<= 1;
+    }
+    return ret;
+}
+
+OpenGLDecorationAtlas::OpenGLDecorationAtlas(QObject *parent)
+    : QObject(parent)
+{
+}
+
+OpenGLDecorationAtlas::~OpenGLDecorationAtlas() = default;
+
+bool OpenGLDecorationAtlas::isSupported()
+{
+    return GLRenderTarget::supported() && qgetenv("KWIN_GL_DECORATION_ATLAS") != "0";
+}
+
+GLTexture *OpenGLDecorationAtlas::texture() const
+{
+    return m_texture.data();
+}
+
+int OpenGLDecorationAtlas::allocate(const QSize &size)
+{
+    const int handle = m_allocator.allocate(size);
+    if (handle != -1 || size.isEmpty()) {
+        return handle;
+    }
+
+    if (!m_maxTextureSize) {
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
+    }
+    if (size.width() > m_maxTextureSize || size.height() > m_maxTextureSize) {
+        return -1;
+    }
+
+    // Pack the rectangles again to get rid of the holes left by the released ones, and make
+    // the texture larger until the new rectangle fits too.
+    QSize textureSize = m_allocator.size();
+    if (textureSize.isEmpty()) {
+        textureSize = QSize(qMax(s_initialSize, nextPowerOfTwo(size.width())), s_initialSize);
+        textureSize = textureSize.boundedTo(QSize(m_maxTextureSize, m_maxTextureSize));
+    }
+
+    while (true) {
+        AtlasAllocator allocator = m_allocator;
+        if (allocator.repack(textureSize)) {
+            const int newHandle = allocator.allocate(size);
+            if (newHandle != -1) {
+                relocate(allocator);
+                return newHandle;
+            }
+        }
+
+        if (textureSize.width() >= m_maxTextureSize && textureSize.height() >= m_maxTextureSize) {
+            return -1;
+        }
+        if (textureSize.height() < m_maxTextureSize && textureSize.height() <= textureSize.width()) {
+            textureSize.setHeight(qMin(textureSize.height() * 2, m_maxTextureSize));
+        } else {
+            textureSize.setWidth(qMin(textureSize.width() * 2, m_maxTextureSize));
+        }
+    }
+}
+
+void OpenGLDecorationAtlas::relocate(const AtlasAllocator &allocator)
+{
+    QScopedPointer<GLTexture> texture(new GLTexture(GL_RGBA8, allocator.size().width(), allocator.size().height()));
+    texture->setYInverted(true);
+    texture->setWrapMode(GL_CLAMP_TO_EDGE);
+    texture->clear();
+
+    if (m_texture) {
+        Q_EMIT aboutToRelocate();
+
+        // Copy the rectangles from the old texture, the framebuffer and the texture have the
+        // same orientation so the rectangles don't have to be flipped.
+        GLRenderTarget source(*m_texture);
+        GLRenderTarget::pushRenderTarget(&source);
+        texture->bind();
+        const QVector<int> handles = m_allocator.handles();
+        for (int handle : handles) {
+            const QRect from = m_allocator.rect(handle);
+            const QRect to = allocator.rect(handle);
+            glCopyTexSubImage2D(texture->target(), 0, to.x(), to.y(), from.x(), from.y(), from.width(), from.height());
+        }
+        texture->unbind();
+        GLRenderTarget::popRenderTarget();
+        m_repacks++;
+    }
+
+    m_texture.swap(texture);
+    m_allocator = allocator;
+}
+
+void OpenGLDecorationAtlas::release(int handle)
+{
+    m_allocator.release(handle);
+}
+
+QRect OpenGLDecorationAtlas::rect(int handle) const
+{
+    return m_allocator.rect(handle);
+}
+
+void OpenGLDecorationAtlas::update(int handle, const QImage &image, const QPoint &offset)
+{
+    m_texture->update(image, m_allocator.rect(handle).topLeft() + offset);
+    m_uploadedBytes += image.sizeInBytes();
+}
+
+OpenGLDecorationAtlas::Statistics OpenGLDecorationAtlas::statistics() const
+{
+    const QSize size = m_texture ? m_texture->size() : QSize();
+    return Statistics{
+        .allocations = m_allocator.count(),
+        .repacks = m_repacks,
+        .textureBytes = qint64(size.width()) * size.height() * 4,
+        .usedBytes = m_allocator.usedArea() * 4,
+        .uploadedBytes = m_uploadedBytes,
+    };
+}
+
+} // namespace KWin
@@ -0,0 +1,91 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "atlasallocator.h"
+
+#include <QObject>
+#include <QScopedPointer>
+
+class QImage;
+
+namespace KWin
+{
+
+class GLTexture;
+
+/**
+ * The OpenGLDecorationAtlas is a texture shared by the decorations of all windows, so they can
+ * be drawn without binding a texture for each window.
+ *
+ * Every decoration renderer allocates a rectangle in the atlas for its parts. When there is no
+ * room left for a new rectangle, the rectangles are packed again and the texture grows if
+ * needed; the contents of the rectangles are copied on the GPU, so the renderers have to look
+ * up the position of their rectangle each time they use it.
+ */
+class OpenGLDecorationAtlas : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Statistics
+    {
+        int allocations = 0;
+        int repacks = 0;
+        qint64 textureBytes = 0;
+        qint64 usedBytes = 0;
+        qint64 uploadedBytes = 0;
+    };
+
+    explicit OpenGLDecorationAtlas(QObject *parent = nullptr);
+    ~OpenGLDecorationAtlas() override;
+
+    /**
+     * Returns @c false if the atlas can't be used, because framebuffer objects are not
+     * supported or because it has been disabled with KWIN_GL_DECORATION_ATLAS=0.
+     */
+    static bool isSupported();
+
+    GLTexture *texture() const;
+
+    /**
+     * Allocates a rectangle of the given @a size in device pixels, returns its handle or -1
+     * if the rectangle doesn't fit in the largest texture supported by the driver.
+     */
+    int allocate(const QSize &size);
+    void release(int handle);
+    QRect rect(int handle) const;
+
+    /**
+     * Uploads the @a image to the rectangle with the given @a handle, at the @a offset
+     * relative to the top-left corner of the rectangle.
+     */
+    void update(int handle, const QImage &image, const QPoint &offset);
+
+    Statistics statistics() const;
+
+Q_SIGNALS:
+    /**
+     * This signal is emitted before the rectangles are moved to a new texture, everything
+     * that refers to the current texture has to be drawn before.
+     */
+    void aboutToRelocate();
+
+private:
+    void relocate(const AtlasAllocator &allocator);
+
+    AtlasAllocator m_allocator;
+    QScopedPointer<GLTexture> m_texture;
+    int m_maxTextureSize = 0;
+    int m_repacks = 0;
+    qint64 m_uploadedBytes = 0;
+};
+
+} // namespace KWin
@@ -0,0 +1,283 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "openglrenderlist.h"
+
+#include <cstddef>
+
+namespace KWin
+{
+
+// The index buffer for quads uses 16 bit indices, so a draw can't use more vertices.
+static const int s_maxIndexedQuadVertices = 16384 * 4;
+
+static bool isCompatible(const OpenGLRenderList::Node &a, const OpenGLRenderList::Node &b)
+{
+    return a.blend == b.blend && a.traits == b.traits && a.modulation == b.modulation
+        && a.saturation == b.saturation;
+}
+
+static QRectF boundingRect(const OpenGLRenderList::Node &node)
+{
+    return node.quads.boundingRect().translated(node.offset);
+}
+
+OpenGLRenderList::OpenGLRenderList()
+    : m_enabled(qgetenv("KWIN_GL_BATCHING") != "0")
+{
+}
+
+bool OpenGLRenderList::isEnabled() const
+{
+    return m_enabled;
+}
+
+bool OpenGLRenderList::isRecording() const
+{
+    return m_recording;
+}
+
+void OpenGLRenderList::begin(const QMatrix4x4 &projectionMatrix)
+{
+    Q_ASSERT(!m_recording);
+    m_projectionMatrix = projectionMatrix;
+    m_recording = true;
+}
+
+void OpenGLRenderList::end()
+{
+    Q_ASSERT(m_recording);
+    flush();
+    m_recording = false;
+}
+
+void OpenGLRenderList::append(const Node &node)
+{
+    Q_ASSERT(m_recording);
+    if (node.quads.isEmpty() || !node.texture) {
+        return;
+    }
+    m_nodes.append(node);
+    m_frameStatistics.nodes++;
+    m_frameStatistics.batchedNodes++;
+}
+
+void OpenGLRenderList::beginFrame()
+{
+    m_frameStatistics = Statistics();
+}
+
+void OpenGLRenderList::endFrame()
+{
+    m_lastFrameStatistics = m_frameStatistics;
+}
+
+OpenGLRenderList::Statistics &OpenGLRenderList::frameStatistics()
+{
+    return m_frameStatistics;
+}
+
+OpenGLRenderList::Statistics OpenGLRenderList::lastFrameStatistics() const
+{
+    return m_lastFrameStatistics;
+}
+
+QVector<QVector<int>> OpenGLRenderList::buildBatches(const QVector<Node> &nodes)
+{
+    struct Batch
+    {
+        int key;
+        QVector<int> nodes;
+        QVector<QRectF> rects;
+        QRectF boundingRect;
+    };
+    QVector<Batch> batches;
+
+    const auto overlaps = [](const Batch &batch, const QRectF &rect) {
+        if (!batch.boundingRect.intersects(rect)) {
+            return false;
+        }
+        for (const QRectF &other : batch.rects) {
+            if (other.intersects(rect)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    for (int i = 0; i < nodes.count(); ++i) {
+        const QRectF rect = boundingRect(nodes[i]);
+
+        // Look for the earliest batch the node can join. The node would be drawn before all
+        // batches after that one, so it must not overlap any of them.
+        int target = -1;
+        for (int j = batches.count() - 1; j >= 0; --j) {
+            if (isCompatible(nodes[batches[j].key], nodes[i])) {
+                target = j;
+            }
+            if (overlaps(batches[j], rect)) {
+                break;
+            }
+        }
+
+        if (target == -1) {
+            batches.append(Batch{i, {}, {}, QRectF()});
+            target = batches.count() - 1;
+        }
+        Batch &batch = batches[target];
+        batch.nodes.append(i);
+        batch.rects.append(rect);
+        batch.boundingRect |= rect;
+    }
+
+    QVector<QVector<int>> ret;
+    ret.reserve(batches.count());
+    for (const Batch &batch : qAsConst(batches)) {
+        ret.append(batch.nodes);
+    }
+    return ret;
+}
+
+void OpenGLRenderList::flush()
+{
+    if (m_nodes.isEmpty()) {
+        return;
+    }
+
+    const QVector<QVector<int>> batches = buildBatches(m_nodes);
+
+    const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
+    const GLenum primitiveType = indexedQuads ? GL_QUADS : GL_TRIANGLES;
+    const int verticesPerQuad = indexedQuads ? 4 : 6;
+
+    int quadCount = 0;
+    for (const Node &node : qAsConst(m_nodes)) {
+        quadCount += node.quads.count();
+    }
+    const size_t size = verticesPerQuad * quadCount * sizeof(GLVertex2D);
+
+    const GLVertexAttrib attribs[] = {
+        { VA_Position, 2, GL_FLOAT, offsetof(GLVertex2D, position) },
+        { VA_TexCoord, 2, GL_FLOAT, offsetof(GLVertex2D, texcoord) },
+    };
+
+    GLVertexBuffer *vbo = GLVertexBuffer::streamingBuffer();
+    vbo->reset();
+    vbo->setAttribLayout(attribs, 2, sizeof(GLVertex2D));
+
+    GLVertex2D *map = static_cast<GLVertex2D *>(vbo->map(size));
+
+    struct Draw
+    {
+        GLTexture *texture;
+        int firstVertex;
+        int vertexCount;
+    };
+    QVector<QVector<Draw>> draws(batches.count());
+
+    // Write the vertices in the order in which they are drawn, so consecutive nodes with the
+    // same texture can be drawn with a single call.
+    int v = 0;
+    for (int i = 0; i < batches.count(); ++i) {
+        for (int index : batches[i]) {
+            const Node &node = m_nodes[index];
+            const int vertexCount = node.quads.count() * verticesPerQuad;
+
+            node.quads.makeInterleavedArrays(primitiveType, &map[v], node.textureMatrix);
+            if (!node.offset.isNull()) {
+                const QVector2D offset(node.offset);
+                for (int j = v; j < v + vertexCount; ++j) {
+                    map[j].position += offset;
+                }
+            }
+
+            QVector<Draw> &batchDraws = draws[i];
+            if (!batchDraws.isEmpty() && batchDraws.last().texture == node.texture
+                    && (!indexedQuads || batchDraws.last().vertexCount + vertexCount <= s_maxIndexedQuadVertices)) {
+                batchDraws.last().vertexCount += vertexCount;
+            } else {
+                batchDraws.append(Draw{node.texture, v, vertexCount});
+            }
+            v += vertexCount;
+        }
+    }
+
+    vbo->unmap();
+    vbo->bindArrays();
+    m_frameStatistics.uploadedBytes += size;
+
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+    GLShader *shader = nullptr;
+    ShaderTraits shaderTraits;
+    QVector4D modulation;
+    float saturation = 0;
+    bool blend = false;
+    GLTexture *texture = nullptr;
+
+    for (int i = 0; i < batches.count(); ++i) {
+        const Node &key = m_nodes[batches[i].first()];
+
+        if (!shader || shaderTraits != key.traits) {
+            if (shader) {
+                ShaderManager::instance()->popShader();
+            }
+            shader = ShaderManager::instance()->pushShader(key.traits);
+            shaderTraits = key.traits;
+            shader->setUniform(GLShader::ModelViewProjectionMatrix, m_projectionMatrix);
+            shader->setUniform(GLShader::ModulationConstant, key.modulation);
+            shader->setUniform(GLShader::Saturation, key.saturation);
+            modulation = key.modulation;
+            saturation = key.saturation;
+            m_frameStatistics.stateChanges += 4;
+        }
+        if (modulation != key.modulation) {
+            shader->setUniform(GLShader::ModulationConstant, key.modulation);
+            modulation = key.modulation;
+            m_frameStatistics.stateChanges++;
+        }
+        if (saturation != key.saturation) {
+            shader->setUniform(GLShader::Saturation, key.saturation);
+            saturation = key.saturation;
+            m_frameStatistics.stateChanges++;
+        }
+        if (blend != key.blend) {
+            if (key.blend) {
+                glEnable(GL_BLEND);
+            } else {
+                glDisable(GL_BLEND);
+            }
+            blend = key.blend;
+            m_frameStatistics.stateChanges++;
+        }
+
+        for (const Draw &draw : qAsConst(draws[i])) {
+            if (texture != draw.texture) {
+                draw.texture->setFilter(GL_LINEAR);
+                draw.texture->setWrapMode(GL_CLAMP_TO_EDGE);
+                draw.texture->bind();
+                texture = draw.texture;
+                m_frameStatistics.stateChanges++;
+            }
+            vbo->draw(primitiveType, draw.firstVertex, draw.vertexCount);
+            m_frameStatistics.draws++;
+        }
+    }
+
+    vbo->unbindArrays();
+
+    if (blend) {
+        glDisable(GL_BLEND);
+    }
+    ShaderManager::instance()->popShader();
+
+    m_nodes.clear();
+}
+
+} // namespace KWin
@@ -0,0 +1,114 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kwinglutils.h"
+#include "kwinrenderquadlist.h"
+
+#include <QMatrix4x4>
+#include <QRectF>
+#include <QVector4D>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * The OpenGLRenderList collects the render nodes of all windows painted in a frame, so they
+ * can be drawn together: the vertices of all nodes are uploaded with a single mapping of the
+ * streaming buffer, and the nodes are grouped into batches that share the shader, the blend
+ * state and the uniforms.
+ *
+ * There is no depth buffer, so the windows must still be drawn in the painter's order where
+ * they overlap. A node is only moved into an earlier batch if it does not overlap any of the
+ * nodes drawn in the batches after it, which keeps the result the same as drawing the nodes
+ * one after another.
+ */
+class OpenGLRenderList
+{
+public:
+    struct Node
+    {
+        GLTexture *texture = nullptr;
+        RenderQuadList quads;
+        /**
+         * The translation of the quads to the screen, it is added to the vertex positions
+         * so all nodes can be drawn with the same projection matrix.
+         */
+        QPointF offset;
+        QMatrix4x4 textureMatrix;
+        ShaderTraits traits = ShaderTrait::MapTexture;
+        QVector4D modulation = QVector4D(1, 1, 1, 1);
+        float saturation = 1;
+        bool blend = false;
+    };
+
+    /**
+     * The work done to draw the windows in a frame, both with the render list and without it.
+     */
+    struct Statistics
+    {
+        int nodes = 0;
+        int batchedNodes = 0;
+        int draws = 0;
+        int stateChanges = 0;
+        qint64 uploadedBytes = 0;
+    };
+
+    OpenGLRenderList();
+
+    /**
+     * Returns @c false if batching has been disabled with KWIN_GL_BATCHING=0.
+     */
+    bool isEnabled() const;
+
+    /**
+     * Returns @c true between begin() and end(), the nodes have to be appended then instead
+     * of being drawn.
+     */
+    bool isRecording() const;
+
+    void begin(const QMatrix4x4 &projectionMatrix);
+    void end();
+
+    void append(const Node &node);
+
+    /**
+     * Draws the nodes appended so far. This has to be called before anything is drawn
+     * without the render list while it is recording.
+     */
+    void flush();
+
+    void beginFrame();
+    void endFrame();
+
+    /**
+     * The statistics of the frame being painted, the code drawing without the render list
+     * adds its work to them.
+     */
+    Statistics &frameStatistics();
+    Statistics lastFrameStatistics() const;
+
+    /**
+     * Groups the @a nodes into batches, the returned lists contain the indices of the nodes
+     * in the order in which they have to be drawn.
+     */
+    static QVector<QVector<int>> buildBatches(const QVector<Node> &nodes);
+
+private:
+    QVector<Node> m_nodes;
+    QMatrix4x4 m_projectionMatrix;
+    Statistics m_frameStatistics;
+    Statistics m_lastFrameStatistics;
+    bool m_enabled;
+    bool m_recording = false;
+};
+
+} // namespace KWin
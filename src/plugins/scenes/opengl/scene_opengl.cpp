@@ -24,6 +24,7 @@
 #include "abstract_client.h"
 #include "composite.h"
 #include "effects.h"
+#include "frametimingrecorder.h"
 #include "lanczosfilter.h"
 #include "main.h"
 #include "overlaywindow.h"
@@ -75,6 +76,7 @@ SceneOpenGL::SceneOpenGL(OpenGLBackend *backend, QObject *parent)
     : Scene(parent)
     , init_ok(true)
     , m_backend(backend)
+    , m_renderList(new OpenGLRenderList)
 {
     if (m_backend->isFailed()) {
         init_ok = false;
@@ -112,6 +114,7 @@ SceneOpenGL::~SceneOpenGL()
         makeOpenGLContextCurrent();
     }
     SceneOpenGL::EffectFrame::cleanup();
+    m_decorationAtlas.reset();
 
     // backend might be still needed for a different scene
     delete m_backend;
@@ -437,8 +440,11 @@ void SceneOpenGL::paint(AbstractOutput *output, const QRegion &damage, const QLi
 
             updateProjectionMatrix(geo);
 
+            m_frameCount++;
+            m_renderList->beginFrame();
             paintScreen(damage.intersected(geo), repaint, &update, &valid,
                         renderLoop, projectionMatrix());   // call generic implementation
+            m_renderList->endFrame();
             paintCursor(valid);
 
             if (!GLPlatform::instance()->isGLES() && !output) {
@@ -461,9 +467,17 @@ void SceneOpenGL::paint(AbstractOutput *output, const QRegion &damage, const QLi
             GLVertexBuffer::streamingBuffer()->endOfFrame();
             m_backend->endFrame(output, valid, update);
             GLVertexBuffer::streamingBuffer()->framePosted();
+
+            if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+                recorder->mark(FrameTimingRecorder::Phase::SwapEnd);
+            }
         }
     }
 
+    // the surface textures are updated while the frame is painted
+    m_lastFrameUploadStatistics = GLTexture::uploadStatistics();
+    GLTexture::resetUploadStatistics();
+
     // do cleanup
     clearStackingOrder();
 }
@@ -637,6 +651,53 @@ QSharedPointer<GLTexture> SceneOpenGL::textureForOutput(AbstractOutput* output)
     return m_backend->textureForOutput(output);
 }
 
+OpenGLDecorationAtlas *SceneOpenGL::decorationAtlas()
+{
+    if (!m_decorationAtlasChecked) {
+        m_decorationAtlasChecked = true;
+        if (OpenGLDecorationAtlas::isSupported()) {
+            m_decorationAtlas.reset(new OpenGLDecorationAtlas);
+            // The nodes recorded so far may still refer to the old texture of the atlas.
+            connect(m_decorationAtlas.data(), &OpenGLDecorationAtlas::aboutToRelocate, this, [this]() {
+                if (m_renderList->isRecording()) {
+                    m_renderList->flush();
+                }
+            });
+        }
+    }
+    return m_decorationAtlas.data();
+}
+
+QString SceneOpenGL::supportInformation() const
+{
+    const OpenGLRenderList::Statistics statistics = m_renderList->lastFrameStatistics();
+    QString support;
+    support.append(QStringLiteral("Batched window rendering: %1\n")
+                   .arg(m_renderList->isEnabled() ? QStringLiteral("yes") : QStringLiteral("no")));
+    support.append(QStringLiteral("Render nodes in the last frame: %1 (%2 batched)\n")
+                   .arg(statistics.nodes).arg(statistics.batchedNodes));
+    support.append(QStringLiteral("Draw calls in the last frame: %1\n").arg(statistics.draws));
+    support.append(QStringLiteral("State changes in the last frame: %1\n").arg(statistics.stateChanges));
+    support.append(QStringLiteral("Vertex data uploaded in the last frame: %1 bytes\n").arg(statistics.uploadedBytes));
+    support.append(QStringLiteral("Streaming texture uploads: %1\n")
+                   .arg(GLTexture::supportsStreamingUploads() ? QStringLiteral("yes") : QStringLiteral("no")));
+    support.append(QStringLiteral("Texture data uploaded in the last frame: %1 bytes (%2 bytes streamed)\n")
+                   .arg(m_lastFrameUploadStatistics.uploadedBytes).arg(m_lastFrameUploadStatistics.streamedBytes));
+    support.append(QStringLiteral("Texture uploads not streamed in the last frame: %1 (%2 pixel buffers)\n")
+                   .arg(m_lastFrameUploadStatistics.fallbacks).arg(m_lastFrameUploadStatistics.pixelBuffers));
+    support.append(QStringLiteral("Decoration atlas: %1\n")
+                   .arg(m_decorationAtlas ? QStringLiteral("yes") : QStringLiteral("no")));
+    if (m_decorationAtlas) {
+        const OpenGLDecorationAtlas::Statistics atlasStatistics = m_decorationAtlas->statistics();
+        support.append(QStringLiteral("Decorations in the atlas: %1\n").arg(atlasStatistics.allocations));
+        support.append(QStringLiteral("Decoration atlas memory: %1 bytes (%2 bytes used)\n")
+                       .arg(atlasStatistics.textureBytes).arg(atlasStatistics.usedBytes));
+        support.append(QStringLiteral("Decoration atlas uploads: %1 bytes\n").arg(atlasStatistics.uploadedBytes));
+        support.append(QStringLiteral("Decoration atlas repacks: %1\n").arg(atlasStatistics.repacks));
+    }
+    return support;
+}
+
 PlatformSurfaceTexture *SceneOpenGL::createPlatformSurfaceTextureInternal(SurfacePixmapInternal *pixmap)
 {
     return m_backend->createPlatformSurfaceTextureInternal(pixmap);
@@ -739,7 +800,20 @@ void SceneOpenGL2::paintSimpleScreen(int mask, const QRegion &region)
 {
     m_screenProjectionMatrix = m_projectionMatrix;
 
+    // Effects can draw anything before and after each window, and they can read back what
+    // has been drawn, so the windows can only be drawn together if there are none.
+    OpenGLRenderList *list = renderList();
+    const bool batched = list->isEnabled() && !list->isRecording()
+        && !static_cast<EffectsHandlerImpl *>(effects)->hasActiveEffects();
+    if (batched) {
+        list->begin(m_projectionMatrix);
+    }
+
     Scene::paintSimpleScreen(mask, region);
+
+    if (batched) {
+        list->end();
+    }
 }
 
 void SceneOpenGL2::paintGenericScreen(int mask, const ScreenPaintData &data)
@@ -856,45 +930,114 @@ static GLTexture *bindSurfaceTexture(SurfaceItem *surfaceItem)
     return platformSurfaceTexture->texture();
 }
 
-static WindowQuadList clipQuads(const Item *item, const OpenGLWindow::RenderContext *context)
-{
-    const WindowQuadList quads = item->quads();
-    if (context->clip != infiniteRegion() && !context->hardwareClipping) {
-        const QPoint offset = context->transforms.top().map(QPoint(0, 0));
-
-        WindowQuadList ret;
-        ret.reserve(quads.count());
-
-        // split all quads in bounding rect with the actual rects in the region
-        for (const WindowQuad &quad : qAsConst(quads)) {
-            for (const QRect &r : qAsConst(context->clip)) {
-                const QRectF rf(r.translated(-offset));
-                const QRectF quadRect(QPointF(quad.left(), quad.top()), QPointF(quad.right(), quad.bottom()));
-                const QRectF &intersected = rf.intersected(quadRect);
-                if (intersected.isValid()) {
-                    if (quadRect == intersected) {
-                        // case 1: completely contains, include and do not check other rects
-                        ret << quad;
-                        break;
-                    }
-                    // case 2: intersection
-                    ret << quad.makeSubQuad(intersected.left(), intersected.top(), intersected.right(), intersected.bottom());
-                }
-            }
+// The number of frames after which the cached clipped quads and transforms of an item are
+// dropped if they have not been used.
+static const quint64 s_itemCacheRetention = 8;
+
+static uint regionHash(const QRegion &region)
+{
+    uint hash = 0;
+    for (const QRect &rect : region) {
+        hash = qHash(rect.x(), hash);
+        hash = qHash(rect.y(), hash);
+        hash = qHash(rect.width(), hash);
+        hash = qHash(rect.height(), hash);
+    }
+    return hash;
+}
+
+RenderQuadList OpenGLWindow::clipQuads(const Item *item, const RenderContext *context)
+{
+    const RenderQuadList quads = item->quads();
+    if (context->clip == infiniteRegion() || context->hardwareClipping) {
+        return quads;
+    }
+
+    const QPoint offset = context->transforms.top().map(QPoint(0, 0));
+    Scene::ItemCacheStatistics &statistics = m_scene->itemCacheStatistics();
+
+    // Most items are painted with the same clip region frame after frame, so the quads
+    // clipped in an earlier paint pass can be reused as long as the item hasn't changed.
+    ClippedQuads &entry = m_clippedQuads[qMakePair(item, context->clipHash)];
+    entry.lastUsed = m_scene->frameCount();
+    if (entry.generation == item->generation() && entry.offset == offset && entry.clip == context->clip) {
+        statistics.clippedQuadsHits++;
+        return entry.quads;
+    }
+
+    statistics.clippedQuadsMisses++;
+    entry.generation = item->generation();
+    entry.clip = context->clip;
+    entry.offset = offset;
+    entry.quads = quads.clipped(context->clip, offset);
+    return entry.quads;
+}
+
+void OpenGLWindow::pushTransform(const Item *item, RenderContext *context)
+{
+    Scene::ItemCacheStatistics &statistics = m_scene->itemCacheStatistics();
+    const quint64 parentStamp = context->transformStamps.top();
+
+    // The composed transform only has to be computed again if the item or one of its
+    // ancestors has changed, in which case the parent has got a new stamp.
+    CachedTransform &entry = m_transforms[item];
+    entry.lastUsed = m_scene->frameCount();
+    if (entry.stamp && entry.generation == item->generation() && entry.parentStamp == parentStamp) {
+        statistics.transformHits++;
+    } else {
+        static quint64 s_lastStamp = 0;
+        statistics.transformMisses++;
+
+        QMatrix4x4 matrix;
+        matrix.translate(item->position().x(), item->position().y());
+        matrix *= item->transform();
+
+        entry.generation = item->generation();
+        entry.parentStamp = parentStamp;
+        entry.stamp = ++s_lastStamp;
+        entry.transform = context->transforms.top() * matrix;
+    }
+
+    context->transforms.push(entry.transform);
+    context->transformStamps.push(entry.stamp);
+}
+
+void OpenGLWindow::pruneItemCaches()
+{
+    const quint64 frame = m_scene->frameCount();
+    if (m_lastPruneFrame == frame) {
+        return;
+    }
+    m_lastPruneFrame = frame;
+
+    for (auto it = m_clippedQuads.begin(); it != m_clippedQuads.end();) {
+        if (frame - it->lastUsed > s_itemCacheRetention) {
+            it = m_clippedQuads.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = m_transforms.begin(); it != m_transforms.end();) {
+        if (frame - it->lastUsed > s_itemCacheRetention) {
+            it = m_transforms.erase(it);
+        } else {
+            ++it;
         }
-        return ret;
     }
-    return quads;
+}
+
+static QMatrix4x4 textureMatrix(const OpenGLWindow::RenderNode &renderNode)
+{
+    QMatrix4x4 matrix = renderNode.texture->matrix(renderNode.coordinateType);
+    matrix.translate(renderNode.textureOffset.x(), renderNode.textureOffset.y());
+    return matrix;
 }
 
 void OpenGLWindow::createRenderNode(Item *item, RenderContext *context)
 {
     const QList<Item *> sortedChildItems = item->sortedChildItems();
 
-    QMatrix4x4 matrix;
-    matrix.translate(item->position().x(), item->position().y());
-    matrix *= item->transform();
-    context->transforms.push(context->transforms.top() * matrix);
+    pushTransform(item, context);
 
     for (Item *childItem : sortedChildItems) {
         if (childItem->z() >= 0) {
@@ -907,7 +1050,7 @@ void OpenGLWindow::createRenderNode(Item *item, RenderContext *context)
 
     item->preprocess();
     if (auto shadowItem = qobject_cast<ShadowItem *>(item)) {
-        WindowQuadList quads = clipQuads(item, context);
+        const RenderQuadList quads = clipQuads(item, context);
         if (!quads.isEmpty()) {
             SceneOpenGLShadow *shadow = static_cast<SceneOpenGLShadow *>(shadowItem->shadow());
             context->renderNodes.append(RenderNode{
@@ -920,7 +1063,7 @@ void OpenGLWindow::createRenderNode(Item *item, RenderContext *context)
             });
         }
     } else if (auto decorationItem = qobject_cast<DecorationItem *>(item)) {
-        WindowQuadList quads = clipQuads(item, context);
+        const RenderQuadList quads = clipQuads(item, context);
         if (!quads.isEmpty()) {
             auto renderer = static_cast<const SceneOpenGLDecorationRenderer *>(decorationItem->renderer());
             context->renderNodes.append(RenderNode{
@@ -930,10 +1073,11 @@ void OpenGLWindow::createRenderNode(Item *item, RenderContext *context)
                 .opacity = context->paintData.opacity(),
                 .hasAlpha = true,
                 .coordinateType = UnnormalizedCoordinates,
+                .textureOffset = renderer->textureOffset(),
             });
         }
     } else if (auto surfaceItem = qobject_cast<SurfaceItem *>(item)) {
-        WindowQuadList quads = clipQuads(item, context);
+        const RenderQuadList quads = clipQuads(item, context);
         if (!quads.isEmpty()) {
             SurfacePixmap *pixmap = surfaceItem->pixmap();
             if (pixmap) {
@@ -961,6 +1105,7 @@ void OpenGLWindow::createRenderNode(Item *item, RenderContext *context)
     }
 
     context->transforms.pop();
+    context->transformStamps.pop();
 }
 
 QMatrix4x4 OpenGLWindow::modelViewProjectionMatrix(int mask, const WindowPaintData &data) const
@@ -987,6 +1132,59 @@ QMatrix4x4 OpenGLWindow::modelViewProjectionMatrix(int mask, const WindowPaintDa
     return scene->projectionMatrix() * mvMatrix;
 }
 
+static bool isTranslation(const QMatrix4x4 &matrix)
+{
+    QMatrix4x4 translation;
+    translation.translate(matrix(0, 3), matrix(1, 3));
+    return matrix == translation;
+}
+
+bool OpenGLWindow::appendToRenderList(int mask, const WindowPaintData &data, const RenderContext &context)
+{
+    OpenGLRenderList *renderList = m_scene->renderList();
+    if (!renderList->isRecording()) {
+        return false;
+    }
+
+    // The render list draws everything with the projection matrix of the screen, so the
+    // window must be drawn with the default shader and without any transformations.
+    if (data.shader || context.hardwareClipping
+            || (mask & (Scene::PAINT_WINDOW_TRANSFORMED | Scene::PAINT_SCREEN_TRANSFORMED))
+            || !data.projectionMatrix().isIdentity() || !data.modelViewMatrix().isIdentity()) {
+        return false;
+    }
+    for (const RenderNode &renderNode : context.renderNodes) {
+        if (!isTranslation(renderNode.transformMatrix)) {
+            return false;
+        }
+    }
+
+    ShaderTraits traits = ShaderTrait::MapTexture;
+    if (data.opacity() != 1.0 || data.brightness() != 1.0 || data.crossFadeProgress() != 1.0) {
+        traits |= ShaderTrait::Modulate;
+    }
+    if (data.saturation() != 1.0) {
+        traits |= ShaderTrait::AdjustSaturation;
+    }
+
+    for (const RenderNode &renderNode : context.renderNodes) {
+        if (renderNode.quads.isEmpty() || !renderNode.texture) {
+            continue;
+        }
+        renderList->append(OpenGLRenderList::Node{
+            .texture = renderNode.texture,
+            .quads = renderNode.quads,
+            .offset = QPointF(renderNode.transformMatrix(0, 3), renderNode.transformMatrix(1, 3)),
+            .textureMatrix = textureMatrix(renderNode),
+            .traits = traits,
+            .modulation = modulate(renderNode.opacity, data.brightness()),
+            .saturation = float(data.saturation()),
+            .blend = renderNode.hasAlpha || renderNode.opacity < 1.0,
+        });
+    }
+    return true;
+}
+
 static QMatrix4x4 transformForPaintData(int mask, const WindowPaintData &data)
 {
     // TODO: Switch to QTransform.
@@ -1027,11 +1225,22 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
     };
 
     renderContext.transforms.push(QMatrix4x4());
+    renderContext.transformStamps.push(0);
+    renderContext.clipHash = regionHash(region);
 
     windowItem()->setTransform(transformForPaintData(mask, data));
 
+    pruneItemCaches();
     createRenderNode(windowItem(), &renderContext);
 
+    if (appendToRenderList(mask, data, renderContext)) {
+        return;
+    }
+    // Whatever has been collected so far has to be drawn first.
+    OpenGLRenderList *renderList = m_scene->renderList();
+    renderList->flush();
+    OpenGLRenderList::Statistics &statistics = renderList->frameStatistics();
+
     int quadCount = 0;
     for (const RenderNode &node : qAsConst(renderContext.renderNodes)) {
         quadCount += node.quads.count();
@@ -1051,8 +1260,10 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
             traits |= ShaderTrait::AdjustSaturation;
 
         shader = ShaderManager::instance()->pushShader(traits);
+        statistics.stateChanges++;
     }
     shader->setUniform(GLShader::Saturation, data.saturation());
+    statistics.stateChanges++;
 
     const bool indexedQuads = GLVertexBuffer::supportsIndexedQuads();
     const GLenum primitiveType = indexedQuads ? GL_QUADS : GL_TRIANGLES;
@@ -1082,7 +1293,7 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
         renderNode.firstVertex = v;
         renderNode.vertexCount = renderNode.quads.count() * verticesPerQuad;
 
-        const QMatrix4x4 matrix = renderNode.texture->matrix(renderNode.coordinateType);
+        const QMatrix4x4 matrix = textureMatrix(renderNode);
 
         renderNode.quads.makeInterleavedArrays(primitiveType, &map[v], matrix);
         v += renderNode.quads.count() * verticesPerQuad;
@@ -1090,6 +1301,7 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
 
     vbo->unmap();
     vbo->bindArrays();
+    statistics.uploadedBytes += size;
 
     // Make sure the blend function is set up correctly in case we will be doing blending
     glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
@@ -1102,7 +1314,11 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
         if (renderNode.vertexCount == 0)
             continue;
 
-        setBlendEnabled(renderNode.hasAlpha || renderNode.opacity < 1.0);
+        const bool blendingEnabled = renderNode.hasAlpha || renderNode.opacity < 1.0;
+        if (blendingEnabled != m_blendingEnabled) {
+            statistics.stateChanges++;
+        }
+        setBlendEnabled(blendingEnabled);
 
         shader->setUniform(GLShader::ModelViewProjectionMatrix,
                            modelViewProjection * renderNode.transformMatrix);
@@ -1110,6 +1326,7 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
             shader->setUniform(GLShader::ModulationConstant,
                                modulate(renderNode.opacity, data.brightness()));
             opacity = renderNode.opacity;
+            statistics.stateChanges++;
         }
 
         renderNode.texture->setFilter(GL_LINEAR);
@@ -1118,6 +1335,10 @@ void OpenGLWindow::performPaint(int mask, const QRegion &region, const WindowPai
 
         vbo->draw(region, primitiveType, renderNode.firstVertex,
                   renderNode.vertexCount, renderContext.hardwareClipping);
+
+        statistics.nodes++;
+        statistics.stateChanges += 2;
+        statistics.draws += renderContext.hardwareClipping ? region.rectCount() : 1;
     }
 
     vbo->unbindArrays();
@@ -1148,6 +1369,9 @@ QSharedPointer<GLTexture> OpenGLWindow::windowTexture()
         const QRect virtualGeometry = window()->bufferGeometry();
         QSharedPointer<GLTexture> texture(new GLTexture(GL_RGBA8, virtualGeometry.size() * window()->bufferScale()));
 
+        // The windows collected so far belong to the current render target.
+        m_scene->renderList()->flush();
+
         QScopedPointer<GLRenderTarget> framebuffer(new KWin::GLRenderTarget(*texture));
         GLRenderTarget::pushRenderTarget(framebuffer.data());
 
@@ -1603,76 +1827,154 @@ void SceneOpenGL::EffectFrame::cleanup()
 //****************************************
 // SceneOpenGL::Shadow
 //****************************************
-class DecorationShadowTextureCache
+/**
+ * The ShadowTextureCache shares the textures of shadows with the same image, for instance the
+ * shadows of all windows with the same decoration, or the shadows that the windows of an
+ * application provide themselves. The images are looked up by a hash of their pixels, and
+ * compared with the image of the cached texture before the texture is shared.
+ */
+class ShadowTextureCache
 {
 public:
-    ~DecorationShadowTextureCache();
-    DecorationShadowTextureCache(const DecorationShadowTextureCache&) = delete;
-    static DecorationShadowTextureCache &instance();
+    ~ShadowTextureCache();
+    ShadowTextureCache(const ShadowTextureCache&) = delete;
+    static ShadowTextureCache &instance();
 
-    void unregister(SceneOpenGLShadow *shadow);
-    QSharedPointer<GLTexture> getTexture(SceneOpenGLShadow *shadow);
+    /**
+     * Returns the texture for the @a image, the texture has to be released with release()
+     * when it's no longer used.
+     */
+    QSharedPointer<GLTexture> acquire(const QImage &image);
+    void release(GLTexture *texture);
 
 private:
-    DecorationShadowTextureCache() = default;
+    ShadowTextureCache() = default;
+
+    struct Key {
+        quint64 hash;
+        QSize size;
+        QImage::Format format;
+
+        bool operator==(const Key &other) const {
+            return hash == other.hash && size == other.size && format == other.format;
+        }
+    };
+    friend uint qHash(const Key &key, uint seed) {
+        seed = qHash(key.hash, seed);
+        seed = qHash(key.size.width(), seed);
+        seed = qHash(key.size.height(), seed);
+        return qHash(int(key.format), seed);
+    }
+
     struct Data {
+        QImage image;
         QSharedPointer<GLTexture> texture;
-        QVector<SceneOpenGLShadow*> shadows;
+        int refCount;
     };
-    QHash<KDecoration2::DecorationShadow*, Data> m_cache;
+
+    static Key makeKey(const QImage &image);
+    static QSharedPointer<GLTexture> createTexture(const QImage &image);
+
+    QHash<Key, Data> m_cache;
+    QHash<GLTexture *, Key> m_keys;
 };
 
-DecorationShadowTextureCache &DecorationShadowTextureCache::instance()
+ShadowTextureCache &ShadowTextureCache::instance()
 {
-    static DecorationShadowTextureCache s_instance;
+    static ShadowTextureCache s_instance;
     return s_instance;
 }
 
-DecorationShadowTextureCache::~DecorationShadowTextureCache()
+ShadowTextureCache::~ShadowTextureCache()
 {
     Q_ASSERT(m_cache.isEmpty());
 }
 
-void DecorationShadowTextureCache::unregister(SceneOpenGLShadow *shadow)
+ShadowTextureCache::Key ShadowTextureCache::makeKey(const QImage &image)
 {
-    auto it = m_cache.begin();
-    while (it != m_cache.end()) {
-        auto &d = it.value();
-        // check whether the Vector of Shadows contains our shadow and remove all of them
-        auto glIt = d.shadows.begin();
-        while (glIt != d.shadows.end()) {
-            if (*glIt == shadow) {
-                glIt = d.shadows.erase(glIt);
-            } else {
-                glIt++;
+    // Only the pixels are hashed, the padding at the end of the lines may be uninitialized.
+    // Two hashes with different seeds make collisions between different images unlikely.
+    const int lineSize = image.width() * image.depth() / 8;
+    uint low = 0;
+    uint high = 1;
+    for (int y = 0; y < image.height(); ++y) {
+        low = qHashBits(image.constScanLine(y), lineSize, low);
+        high = qHashBits(image.constScanLine(y), lineSize, high);
+    }
+    return Key{(quint64(high) << 32) | low, image.size(), image.format()};
+}
+
+QSharedPointer<GLTexture> ShadowTextureCache::createTexture(const QImage &image)
+{
+    QImage textureImage = image;
+
+    // Check if the image is alpha-only in practice, and if so convert it to an 8-bpp format
+    if (image.depth() == 32 && !GLPlatform::instance()->isGLES() && GLTexture::supportsSwizzle() && GLTexture::supportsFormatRG()) {
+        QImage alphaImage(image.size(), QImage::Format_Alpha8);
+        bool alphaOnly = true;
+
+        for (ptrdiff_t y = 0; alphaOnly && y < image.height(); y++) {
+            const uint32_t * const src = reinterpret_cast<const uint32_t *>(image.scanLine(y));
+            uint8_t * const dst = reinterpret_cast<uint8_t *>(alphaImage.scanLine(y));
+
+            for (ptrdiff_t x = 0; x < image.width(); x++) {
+                if (src[x] & 0x00ffffff)
+                    alphaOnly = false;
+
+                dst[x] = qAlpha(src[x]);
             }
         }
-        // if there are no shadows any more we can erase the cache entry
-        if (d.shadows.isEmpty()) {
-            it = m_cache.erase(it);
-        } else {
-            it++;
+
+        if (alphaOnly) {
+            textureImage = alphaImage;
         }
     }
+
+    auto texture = QSharedPointer<GLTexture>::create(textureImage);
+
+    if (texture->internalFormat() == GL_R8) {
+        // Swizzle red to alpha and all other channels to zero
+        texture->bind();
+        texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
+    }
+
+    return texture;
 }
 
-QSharedPointer<GLTexture> DecorationShadowTextureCache::getTexture(SceneOpenGLShadow *shadow)
+QSharedPointer<GLTexture> ShadowTextureCache::acquire(const QImage &image)
 {
-    Q_ASSERT(shadow->hasDecorationShadow());
-    unregister(shadow);
-    const auto &decoShadow = shadow->decorationShadow().toStrongRef();
-    Q_ASSERT(!decoShadow.isNull());
-    auto it = m_cache.find(decoShadow.data());
+    const Key key = makeKey(image);
+
+    auto it = m_cache.find(key);
     if (it != m_cache.end()) {
-        Q_ASSERT(!it.value().shadows.contains(shadow));
-        it.value().shadows << shadow;
-        return it.value().texture;
+        if (it->image == image) {
+            it->refCount++;
+            return it->texture;
+        }
+        // A different image with the same hash, it gets a texture of its own that isn't
+        // cached, release() ignores it
+        return createTexture(image);
+    }
+
+    const QSharedPointer<GLTexture> texture = createTexture(image);
+    m_cache.insert(key, Data{image, texture, 1});
+    m_keys.insert(texture.data(), key);
+    return texture;
+}
+
+void ShadowTextureCache::release(GLTexture *texture)
+{
+    auto keyIt = m_keys.find(texture);
+    if (keyIt == m_keys.end()) {
+        return;
+    }
+
+    auto it = m_cache.find(*keyIt);
+    Q_ASSERT(it != m_cache.end());
+    if (--it->refCount == 0) {
+        m_cache.erase(it);
+        m_keys.erase(keyIt);
     }
-    Data d;
-    d.shadows << shadow;
-    d.texture = QSharedPointer<GLTexture>::create(shadow->decorationShadowImage());
-    m_cache.insert(decoShadow.data(), d);
-    return d.texture;
 }
 
 SceneOpenGLShadow::SceneOpenGLShadow(Toplevel *toplevel)
@@ -1685,19 +1987,24 @@ SceneOpenGLShadow::~SceneOpenGLShadow()
     Scene *scene = Compositor::self()->scene();
     if (scene) {
         scene->makeOpenGLContextCurrent();
-        DecorationShadowTextureCache::instance().unregister(this);
+        ShadowTextureCache::instance().release(m_texture.data());
         m_texture.reset();
     }
 }
 
 bool SceneOpenGLShadow::prepareBackend()
 {
-    if (hasDecorationShadow()) {
-        // simplifies a lot by going directly to
-        Scene *scene = Compositor::self()->scene();
-        scene->makeOpenGLContextCurrent();
-        m_texture = DecorationShadowTextureCache::instance().getTexture(this);
+    Scene *scene = Compositor::self()->scene();
+    scene->makeOpenGLContextCurrent();
+    ShadowTextureCache::instance().release(m_texture.data());
+    m_texture.reset();
 
+    if (hasDecorationShadow()) {
+        const QImage image = decorationShadowImage();
+        if (image.isNull()) {
+            return false;
+        }
+        m_texture = ShadowTextureCache::instance().acquire(image);
         return true;
     }
     const QSize top(shadowPixmap(ShadowElementTop).size());
@@ -1742,38 +2049,7 @@ bool SceneOpenGLShadow::prepareBackend()
 
     p.end();
 
-    // Check if the image is alpha-only in practice, and if so convert it to an 8-bpp format
-    if (!GLPlatform::instance()->isGLES() && GLTexture::supportsSwizzle() && GLTexture::supportsFormatRG()) {
-        QImage alphaImage(image.size(), QImage::Format_Alpha8);
-        bool alphaOnly = true;
-
-        for (ptrdiff_t y = 0; alphaOnly && y < image.height(); y++) {
-            const uint32_t * const src = reinterpret_cast<const uint32_t *>(image.scanLine(y));
-            uint8_t * const dst = reinterpret_cast<uint8_t *>(alphaImage.scanLine(y));
-
-            for (ptrdiff_t x = 0; x < image.width(); x++) {
-                if (src[x] & 0x00ffffff)
-                    alphaOnly = false;
-
-                dst[x] = qAlpha(src[x]);
-            }
-        }
-
-        if (alphaOnly) {
-            image = alphaImage;
-        }
-    }
-
-    Scene *scene = Compositor::self()->scene();
-    scene->makeOpenGLContextCurrent();
-    m_texture = QSharedPointer<GLTexture>::create(image);
-
-    if (m_texture->internalFormat() == GL_R8) {
-        // Swizzle red to alpha and all other channels to zero
-        m_texture->bind();
-        m_texture->setSwizzle(GL_ZERO, GL_ZERO, GL_ZERO, GL_RED);
-    }
-
+    m_texture = ShadowTextureCache::instance().acquire(image);
     return true;
 }
 
@@ -1788,31 +2064,40 @@ SceneOpenGLDecorationRenderer::~SceneOpenGLDecorationRenderer()
     if (Scene *scene = Compositor::self()->scene()) {
         scene->makeOpenGLContextCurrent();
     }
+    releaseAtlasRect();
 }
 
-// Rotates the given source rect 90° counter-clockwise,
-// and flips it vertically
-static QImage rotate(const QImage &srcImage, const QRect &srcRect)
+GLTexture *SceneOpenGLDecorationRenderer::texture() const
 {
-    auto dpr = srcImage.devicePixelRatio();
-    QImage image(srcRect.height() * dpr, srcRect.width() * dpr, srcImage.format());
-    image.setDevicePixelRatio(dpr);
-    const QPoint srcPoint(srcRect.x() * dpr, srcRect.y() * dpr);
-
-    const uint32_t *src = reinterpret_cast<const uint32_t *>(srcImage.bits());
-    uint32_t *dst = reinterpret_cast<uint32_t *>(image.bits());
+    if (m_atlas && m_atlasHandle != -1) {
+        return m_atlas->texture();
+    }
+    return m_texture.data();
+}
 
-    for (int x = 0; x < image.width(); x++) {
-        const uint32_t *s = src + (srcPoint.y() + x) * srcImage.width() + srcPoint.x();
-        uint32_t *d = dst + x;
+QPoint SceneOpenGLDecorationRenderer::textureOffset() const
+{
+    if (m_atlas && m_atlasHandle != -1) {
+        return m_atlas->rect(m_atlasHandle).topLeft();
+    }
+    return QPoint();
+}
 
-        for (int y = 0; y < image.height(); y++) {
-            *d = s[y];
-            d += image.width();
-        }
+void SceneOpenGLDecorationRenderer::releaseAtlasRect()
+{
+    if (m_atlas && m_atlasHandle != -1) {
+        m_atlas->release(m_atlasHandle);
     }
+    m_atlasHandle = -1;
+}
 
-    return image;
+void SceneOpenGLDecorationRenderer::update(const QImage &image, const QPoint &offset)
+{
+    if (m_atlas && m_atlasHandle != -1) {
+        m_atlas->update(m_atlasHandle, image, offset);
+    } else if (m_texture) {
+        m_texture->update(image, offset);
+    }
 }
 
 static void clamp_row(int left, int width, int right, const uint32_t *src, uint32_t *dest)
@@ -1868,7 +2153,7 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
         resetImageSizesDirty();
     }
 
-    if (!m_texture) {
+    if (!texture()) {
         // for invalid sizes we get no texture, see BUG 361551
         return;
     }
@@ -1905,14 +2190,28 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
         QRect viewport = geo.translated(-rect.x(), -rect.y());
         const qreal devicePixelRatio = client()->client()->screenScale();
 
-        QImage image(rect.size() * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+        // The left and the right part are stored rotated, so all parts are rows of the texture.
+        // Instead of rotating the image afterwards, the part is painted with swapped axes, the
+        // texture coordinates of the decoration quads rotate it back when it's drawn.
+        QImage image((rotated ? rect.size().transposed() : rect.size()) * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
         image.setDevicePixelRatio(devicePixelRatio);
         image.fill(Qt::transparent);
 
+        const QRect painterViewport(viewport.topLeft(), viewport.size() * devicePixelRatio);
         QPainter painter(&image);
         painter.setRenderHint(QPainter::Antialiasing);
-        painter.setViewport(QRect(viewport.topLeft(), viewport.size() * devicePixelRatio));
+        painter.setViewport(painterViewport);
         painter.setWindow(QRect(geo.topLeft(), geo.size() * qPainterEffectiveDevicePixelRatio(&painter)));
+        if (rotated) {
+            // The window-viewport mapping is a scale and a translation, swapping the axes in
+            // logical coordinates amounts to swapping them in device coordinates if the offset
+            // between the mapped axes is compensated for.
+            const qreal scale = qreal(painterViewport.width()) / painter.window().width();
+            const QPointF translation = QPointF(viewport.topLeft()) - QPointF(geo.topLeft()) * scale;
+            const qreal shift = (translation.y() - translation.x()) / scale;
+            painter.setWorldTransform(QTransform(0, 1, 1, 0, shift, -shift));
+            viewport = viewport.transposed();
+        }
         painter.setClipRect(geo);
         renderToPainter(&painter, geo);
         painter.end();
@@ -1921,14 +2220,11 @@ void SceneOpenGLDecorationRenderer::render(const QRegion &region)
         const bool isIntegerScaling = qFuzzyCompare(devicePixelRatio, std::ceil(devicePixelRatio));
         clamp(image, isIntegerScaling ? viewportScaled : viewportScaled.marginsRemoved({1, 1, 1, 1}));
 
+        QPoint dirtyOffset = geo.topLeft() - partRect.topLeft();
         if (rotated) {
-            // TODO: get this done directly when rendering to the image
-            image = rotate(image, QRect(QPoint(), rect.size()));
-            viewport = QRect(viewport.y(), viewport.x(), viewport.height(), viewport.width());
+            dirtyOffset = dirtyOffset.transposed();
         }
-
-        const QPoint dirtyOffset = geo.topLeft() - partRect.topLeft();
-        m_texture->update(image, (position + dirtyOffset - viewport.topLeft()) * image.devicePixelRatio());
+        update(image, (position + dirtyOffset - viewport.topLeft()) * image.devicePixelRatio());
     };
 
     const QRect geometry = region.boundingRect();
@@ -1968,9 +2264,23 @@ void SceneOpenGLDecorationRenderer::resizeTexture()
     size.rwidth() = align(size.width(), 128);
 
     size *= client()->client()->screenScale();
-    if (m_texture && m_texture->size() == size)
+    if (texture() && m_size == size)
         return;
+    m_size = size;
+
+    releaseAtlasRect();
+    if (!m_atlas) {
+        m_atlas = static_cast<SceneOpenGL *>(Compositor::self()->scene())->decorationAtlas();
+    }
+    if (m_atlas && !size.isEmpty()) {
+        m_atlasHandle = m_atlas->allocate(size);
+        if (m_atlasHandle != -1) {
+            m_texture.reset();
+            return;
+        }
+    }
 
+    // The decoration doesn't fit in the atlas, it gets a texture of its own.
     if (!size.isEmpty()) {
         m_texture.reset(new GLTexture(GL_RGBA8, size.width(), size.height()));
         m_texture->setYInverted(true);
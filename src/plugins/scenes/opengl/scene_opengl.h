@@ -12,6 +12,8 @@
 #define KWIN_SCENE_OPENGL_H
 
 #include "openglbackend.h"
+#include "opengldecorationatlas.h"
+#include "openglrenderlist.h"
 
 #include "decorationitem.h"
 #include "scene.h"
@@ -56,6 +58,28 @@ public:
 
     QVector<QByteArray> openGLPlatformInterfaceExtensions() const override;
     QSharedPointer<GLTexture> textureForOutput(AbstractOutput *output) const override;
+    QString supportInformation() const override;
+
+    /**
+     * The render list used to draw the windows of the frame being painted together.
+     */
+    OpenGLRenderList *renderList() const {
+        return m_renderList.data();
+    }
+
+    /**
+     * Returns the texture atlas shared by the decorations of all windows, or @c nullptr if
+     * the atlas can't be used.
+     */
+    OpenGLDecorationAtlas *decorationAtlas();
+
+    /**
+     * Returns the number of frames painted so far, the caches of the windows use it to drop
+     * the entries that have not been used in a while.
+     */
+    quint64 frameCount() const {
+        return m_frameCount;
+    }
 
     static SceneOpenGL *createScene(QObject *parent);
 
@@ -82,6 +106,11 @@ private:
     bool m_resetOccurred = false;
     bool m_debug;
     OpenGLBackend *m_backend;
+    QScopedPointer<OpenGLRenderList> m_renderList;
+    QScopedPointer<OpenGLDecorationAtlas> m_decorationAtlas;
+    GLTexture::UploadStatistics m_lastFrameUploadStatistics;
+    bool m_decorationAtlasChecked = false;
+    quint64 m_frameCount = 0;
 };
 
 class SceneOpenGL2 : public SceneOpenGL
@@ -127,13 +156,15 @@ public:
     struct RenderNode
     {
         GLTexture *texture = nullptr;
-        WindowQuadList quads;
+        RenderQuadList quads;
         QMatrix4x4 transformMatrix;
         int firstVertex = 0;
         int vertexCount = 0;
         qreal opacity = 1;
         bool hasAlpha = false;
         TextureCoordinateType coordinateType = UnnormalizedCoordinates;
+        // The position of the quads' texture in a texture atlas, in unnormalized coordinates.
+        QPoint textureOffset;
     };
 
     struct RenderContext
@@ -143,6 +174,10 @@ public:
         const QRegion clip;
         const WindowPaintData &paintData;
         const bool hardwareClipping;
+        // The stamps of the transforms on the stack, they identify the composed transforms
+        // so the transforms of the child items can be cached.
+        QStack<quint64> transformStamps = {};
+        uint clipHash = 0;
     };
 
     OpenGLWindow(Toplevel *toplevel, SceneOpenGL *scene);
@@ -156,9 +191,38 @@ private:
     QVector4D modulate(float opacity, float brightness) const;
     void setBlendEnabled(bool enabled);
     void createRenderNode(Item *item, RenderContext *context);
+    RenderQuadList clipQuads(const Item *item, const RenderContext *context);
+    bool appendToRenderList(int mask, const WindowPaintData &data, const RenderContext &context);
+
+    void pushTransform(const Item *item, RenderContext *context);
+    void pruneItemCaches();
+
+    struct ClippedQuads
+    {
+        quint64 generation;
+        QRegion clip;
+        QPoint offset;
+        RenderQuadList quads;
+        quint64 lastUsed;
+    };
+
+    struct CachedTransform
+    {
+        quint64 generation;
+        quint64 parentStamp;
+        quint64 stamp;
+        QMatrix4x4 transform;
+        quint64 lastUsed;
+    };
 
     SceneOpenGL *m_scene;
     bool m_blendingEnabled = false;
+    // The clipped quads of the items, by item and by the hash of the clip region, so the
+    // quads clipped for each output are kept when the window is painted on several outputs.
+    QHash<QPair<const Item *, uint>, ClippedQuads> m_clippedQuads;
+    // The transforms of the items composed with the ones of their parents.
+    QHash<const Item *, CachedTransform> m_transforms;
+    quint64 m_lastPruneFrame = 0;
 };
 
 class SceneOpenGL::EffectFrame
@@ -237,16 +301,25 @@ public:
 
     void render(const QRegion &region) override;
 
-    GLTexture *texture() {
-        return m_texture.data();
-    }
-    GLTexture *texture() const {
-        return m_texture.data();
-    }
+    /**
+     * Returns the texture with the parts of the decoration, either the atlas shared by all
+     * decorations or a texture of its own if the decoration doesn't fit in the atlas.
+     */
+    GLTexture *texture() const;
+    /**
+     * Returns the position of the parts of the decoration in the texture, in device pixels.
+     */
+    QPoint textureOffset() const;
 
 private:
     void resizeTexture();
+    void releaseAtlasRect();
+    void update(const QImage &image, const QPoint &offset);
+
     QScopedPointer<GLTexture> m_texture;
+    QPointer<OpenGLDecorationAtlas> m_atlas;
+    int m_atlasHandle = -1;
+    QSize m_size;
 };
 
 class KWIN_EXPORT OpenGLFactory : public SceneFactory
@@ -15,6 +15,7 @@
 #include "decorations/decoratedclient.h"
 #include "deleted.h"
 #include "effects.h"
+#include "frametimingrecorder.h"
 #include "main.h"
 #include "renderloop.h"
 #include "screens.h"
@@ -54,6 +55,7 @@ SceneQPainter::SceneQPainter(QPainterBackend *backend, QObject *parent)
     : Scene(parent)
     , m_backend(backend)
     , m_painter(new QPainter())
+    , m_blitter(SoftwareBlitter::create())
 {
 }
 
@@ -104,6 +106,10 @@ void SceneQPainter::paint(AbstractOutput *output, const QRegion &damage, const Q
         m_painter->end();
         renderLoop->endFrame();
         m_backend->endFrame(output, updateRegion);
+
+        if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+            recorder->mark(FrameTimingRecorder::Phase::SwapEnd);
+        }
     }
 
     // do cleanup
@@ -165,6 +171,28 @@ QImage *SceneQPainter::qpainterRenderBuffer(AbstractOutput *output) const
     return m_backend->bufferForScreen(output);
 }
 
+QString SceneQPainter::supportInformation() const
+{
+    QString support;
+    support.append(QStringLiteral("Shared memory rendered without copies: %1 KiB\n").arg(m_backend->borrowedShmBytes() / 1024));
+    support.append(QStringLiteral("Shared memory copied: %1 KiB\n").arg(m_backend->copiedShmBytes() / 1024));
+    if (m_blitter) {
+        support.append(QStringLiteral("Software blitter: %1\n").arg(SoftwareBlitter::isaName(m_blitter->isa())));
+        support.append(QStringLiteral("Images drawn by the software blitter: %1\n").arg(m_blitter->blittedImageCount()));
+        support.append(QStringLiteral("Images drawn with QPainter: %1\n").arg(m_blitter->fallbackImageCount()));
+    } else {
+        support.append(QStringLiteral("Software blitter: disabled\n"));
+    }
+    return support;
+}
+
+void SceneQPainter::drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect)
+{
+    if (!m_blitter || !m_blitter->drawImage(painter, targetRect, image, sourceRect)) {
+        painter->drawImage(targetRect, image, sourceRect);
+    }
+}
+
 //****************************************
 // SceneQPainter::Window
 //****************************************
@@ -217,13 +245,10 @@ void SceneQPainter::Window::performPaint(int mask, const QRegion &_region, const
 
     if (!opaque) {
         tempPainter.restore();
-        tempPainter.setCompositionMode(QPainter::CompositionMode_DestinationIn);
-        QColor translucent(Qt::transparent);
-        translucent.setAlphaF(data.opacity());
-        tempPainter.fillRect(QRect(QPoint(0, 0), boundingRect.size()), translucent);
         tempPainter.end();
         painter = scenePainter;
-        painter->drawImage(boundingRect.topLeft(), tempImage);
+        painter->setOpacity(data.opacity());
+        m_scene->drawImage(painter, QRectF(boundingRect.topLeft(), tempImage.size()), tempImage, tempImage.rect());
     }
 
     painter->restore();
@@ -286,7 +311,7 @@ void SceneQPainter::Window::renderSurfaceItem(QPainter *painter, SurfaceItem *su
         const QPointF bufferTopLeft = matrix.map(rect.topLeft());
         const QPointF bufferBottomRight = matrix.map(rect.bottomRight());
 
-        painter->drawImage(rect, platformSurfaceTexture->image(),
+        m_scene->drawImage(painter, rect, platformSurfaceTexture->image(),
                            QRectF(bufferTopLeft, bufferBottomRight));
     }
 }
@@ -303,10 +328,15 @@ void SceneQPainter::Window::renderDecorationItem(QPainter *painter, DecorationIt
         return;
     }
 
-    painter->drawImage(dtr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top));
-    painter->drawImage(dlr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left));
-    painter->drawImage(drr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right));
-    painter->drawImage(dbr, renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom));
+    const QImage top = renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Top);
+    const QImage left = renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Left);
+    const QImage right = renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Right);
+    const QImage bottom = renderer->image(SceneQPainterDecorationRenderer::DecorationPart::Bottom);
+
+    m_scene->drawImage(painter, dtr, top, top.rect());
+    m_scene->drawImage(painter, dlr, left, left.rect());
+    m_scene->drawImage(painter, drr, right, right.rect());
+    m_scene->drawImage(painter, dbr, bottom, bottom.rect());
 }
 
 DecorationRenderer *SceneQPainter::createDecorationRenderer(Decoration::DecoratedClientImpl *impl)
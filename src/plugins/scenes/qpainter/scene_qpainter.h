@@ -10,6 +10,7 @@
 #define KWIN_SCENE_QPAINTER_H
 
 #include "qpainterbackend.h"
+#include "softwareblitter.h"
 
 #include "decorationitem.h"
 #include "scene.h"
@@ -41,6 +42,7 @@ public:
 
     QPainter *scenePainter() const override;
     QImage *qpainterRenderBuffer(AbstractOutput *output) const override;
+    QString supportInformation() const override;
 
     QPainterBackend *backend() const {
         return m_backend.data();
@@ -56,8 +58,10 @@ protected:
 
 private:
     explicit SceneQPainter(QPainterBackend *backend, QObject *parent = nullptr);
+    void drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect);
     QScopedPointer<QPainterBackend> m_backend;
     QScopedPointer<QPainter> m_painter;
+    QScopedPointer<SoftwareBlitter> m_blitter;
     class Window;
 };
 
@@ -0,0 +1,467 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "softwareblitkernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KWIN_BLIT_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define KWIN_BLIT_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace KWin
+{
+
+//****************************************
+// Generic
+//****************************************
+
+/**
+ * Multiplies all channels of the pixel @a x by @a a / 255, rounded the same way as QPainter
+ * does it.
+ */
+static inline uint byteMul(uint x, uint a)
+{
+    uint t = (x & 0xff00ff) * a;
+    t = (t + ((t >> 8) & 0xff00ff) + 0x800080) >> 8;
+    t &= 0xff00ff;
+
+    x = ((x >> 8) & 0xff00ff) * a;
+    x = (x + ((x >> 8) & 0xff00ff) + 0x800080);
+    x &= 0xff00ff00;
+    return x | t;
+}
+
+static inline void sourceOverPixel(uint *destination, uint source)
+{
+    if (source >= 0xff000000) {
+        *destination = source;
+    } else if (source) {
+        *destination = source + byteMul(*destination, 255 - (source >> 24));
+    }
+}
+
+static void copyOpaqueGeneric(uint *destination, const uint *source, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        destination[i] = source[i] | 0xff000000;
+    }
+}
+
+static void makeOpaqueGeneric(uint *pixels, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        pixels[i] |= 0xff000000;
+    }
+}
+
+static void sourceOverGeneric(uint *destination, const uint *source, int count, uint constAlpha)
+{
+    if (constAlpha == 255) {
+        for (int i = 0; i < count; ++i) {
+            sourceOverPixel(destination + i, source[i]);
+        }
+    } else {
+        for (int i = 0; i < count; ++i) {
+            sourceOverPixel(destination + i, byteMul(source[i], constAlpha));
+        }
+    }
+}
+
+static void fetchScaled2xGeneric(uint *destination, const uint *source, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        destination[i] = source[i >> 1];
+    }
+}
+
+static void fetchScaled3x2Generic(uint *destination, const uint *source, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        destination[i] = source[(2 * i + 1) / 3];
+    }
+}
+
+static const SoftwareBlitKernels s_genericKernels = {
+    copyOpaqueGeneric,
+    makeOpaqueGeneric,
+    sourceOverGeneric,
+    fetchScaled2xGeneric,
+    fetchScaled3x2Generic,
+};
+
+#if KWIN_BLIT_X86
+
+//****************************************
+// SSE2
+//****************************************
+
+/**
+ * Multiplies the channels of four pixels by the 16 bit values in @a alpha / 255, the same
+ * way as byteMul() does it.
+ */
+__attribute__((target("sse2"))) static inline __m128i byteMulSse2(__m128i pixels, __m128i alpha)
+{
+    const __m128i mask = _mm_set1_epi32(0x00ff00ff);
+    const __m128i half = _mm_set1_epi16(0x80);
+
+    __m128i ag = _mm_mullo_epi16(_mm_srli_epi16(pixels, 8), alpha);
+    __m128i rb = _mm_mullo_epi16(_mm_and_si128(pixels, mask), alpha);
+    ag = _mm_add_epi16(_mm_add_epi16(ag, _mm_srli_epi16(ag, 8)), half);
+    rb = _mm_add_epi16(_mm_add_epi16(rb, _mm_srli_epi16(rb, 8)), half);
+    return _mm_or_si128(_mm_andnot_si128(mask, ag), _mm_srli_epi16(rb, 8));
+}
+
+/**
+ * Returns 255 - alpha of four pixels in both 16 bit halves of each pixel.
+ */
+__attribute__((target("sse2"))) static inline __m128i inverseAlphaSse2(__m128i pixels)
+{
+    const __m128i inverse = _mm_srli_epi32(_mm_xor_si128(pixels, _mm_set1_epi32(-1)), 24);
+    return _mm_or_si128(inverse, _mm_slli_epi32(inverse, 16));
+}
+
+__attribute__((target("sse2"))) static void copyOpaqueSse2(uint *destination, const uint *source, int count)
+{
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_or_si128(pixels, alphaMask));
+    }
+    copyOpaqueGeneric(destination + i, source + i, count - i);
+}
+
+__attribute__((target("sse2"))) static void makeOpaqueSse2(uint *pixels, int count)
+{
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i *chunk = reinterpret_cast<__m128i *>(pixels + i);
+        _mm_storeu_si128(chunk, _mm_or_si128(_mm_loadu_si128(chunk), alphaMask));
+    }
+    makeOpaqueGeneric(pixels + i, count - i);
+}
+
+__attribute__((target("sse2"))) static void sourceOverSse2(uint *destination, const uint *source, int count, uint constAlpha)
+{
+    const __m128i alphaMask = _mm_set1_epi32(int(0xff000000));
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i constAlphaVector = _mm_set1_epi16(short(constAlpha));
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i));
+        if (constAlpha != 255) {
+            pixels = byteMulSse2(pixels, constAlphaVector);
+        }
+        __m128i *target = reinterpret_cast<__m128i *>(destination + i);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), alphaMask)) == 0xffff) {
+            _mm_storeu_si128(target, pixels);
+        } else if (_mm_movemask_epi8(_mm_cmpeq_epi32(pixels, zero)) != 0xffff) {
+            const __m128i background = byteMulSse2(_mm_loadu_si128(target), inverseAlphaSse2(pixels));
+            _mm_storeu_si128(target, _mm_add_epi32(pixels, background));
+        }
+    }
+    sourceOverGeneric(destination + i, source + i, count - i, constAlpha);
+}
+
+__attribute__((target("sse2"))) static void fetchScaled2xSse2(uint *destination, const uint *source, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i / 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_unpacklo_epi32(pixels, pixels));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 4), _mm_unpackhi_epi32(pixels, pixels));
+    }
+    for (; i < count; ++i) {
+        destination[i] = source[i >> 1];
+    }
+}
+
+__attribute__((target("sse2"))) static void fetchScaled3x2Sse2(uint *destination, const uint *source, int count)
+{
+    // Every four source pixels s0 s1 s2 s3 become the six pixels s0 s1 s1 s2 s3 s3.
+    int i = 0;
+    for (; i + 6 <= count; i += 6) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(source + i / 3 * 2));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(2, 1, 1, 0)));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(destination + i + 4), _mm_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3)));
+    }
+    for (; i < count; ++i) {
+        destination[i] = source[(2 * i + 1) / 3];
+    }
+}
+
+static const SoftwareBlitKernels s_sse2Kernels = {
+    copyOpaqueSse2,
+    makeOpaqueSse2,
+    sourceOverSse2,
+    fetchScaled2xSse2,
+    fetchScaled3x2Sse2,
+};
+
+//****************************************
+// AVX2
+//****************************************
+
+__attribute__((target("avx2"))) static inline __m256i byteMulAvx2(__m256i pixels, __m256i alpha)
+{
+    const __m256i mask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i half = _mm256_set1_epi16(0x80);
+
+    __m256i ag = _mm256_mullo_epi16(_mm256_srli_epi16(pixels, 8), alpha);
+    __m256i rb = _mm256_mullo_epi16(_mm256_and_si256(pixels, mask), alpha);
+    ag = _mm256_add_epi16(_mm256_add_epi16(ag, _mm256_srli_epi16(ag, 8)), half);
+    rb = _mm256_add_epi16(_mm256_add_epi16(rb, _mm256_srli_epi16(rb, 8)), half);
+    return _mm256_or_si256(_mm256_andnot_si256(mask, ag), _mm256_srli_epi16(rb, 8));
+}
+
+__attribute__((target("avx2"))) static inline __m256i inverseAlphaAvx2(__m256i pixels)
+{
+    const __m256i inverse = _mm256_srli_epi32(_mm256_xor_si256(pixels, _mm256_set1_epi32(-1)), 24);
+    return _mm256_or_si256(inverse, _mm256_slli_epi32(inverse, 16));
+}
+
+__attribute__((target("avx2"))) static void copyOpaqueAvx2(uint *destination, const uint *source, int count)
+{
+    const __m256i alphaMask = _mm256_set1_epi32(int(0xff000000));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), _mm256_or_si256(pixels, alphaMask));
+    }
+    copyOpaqueSse2(destination + i, source + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void makeOpaqueAvx2(uint *pixels, int count)
+{
+    const __m256i alphaMask = _mm256_set1_epi32(int(0xff000000));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i *chunk = reinterpret_cast<__m256i *>(pixels + i);
+        _mm256_storeu_si256(chunk, _mm256_or_si256(_mm256_loadu_si256(chunk), alphaMask));
+    }
+    makeOpaqueSse2(pixels + i, count - i);
+}
+
+__attribute__((target("avx2"))) static void sourceOverAvx2(uint *destination, const uint *source, int count, uint constAlpha)
+{
+    const __m256i alphaMask = _mm256_set1_epi32(int(0xff000000));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i constAlphaVector = _mm256_set1_epi16(short(constAlpha));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i));
+        if (constAlpha != 255) {
+            pixels = byteMulAvx2(pixels, constAlphaVector);
+        }
+        __m256i *target = reinterpret_cast<__m256i *>(destination + i);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, alphaMask), alphaMask)) == -1) {
+            _mm256_storeu_si256(target, pixels);
+        } else if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(pixels, zero)) != -1) {
+            const __m256i background = byteMulAvx2(_mm256_loadu_si256(target), inverseAlphaAvx2(pixels));
+            _mm256_storeu_si256(target, _mm256_add_epi32(pixels, background));
+        }
+    }
+    sourceOverSse2(destination + i, source + i, count - i, constAlpha);
+}
+
+__attribute__((target("avx2"))) static void fetchScaled2xAvx2(uint *destination, const uint *source, int count)
+{
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i / 2));
+        // The unpack instructions work on the 128 bit lanes separately.
+        const __m256i low = _mm256_unpacklo_epi32(pixels, pixels);
+        const __m256i high = _mm256_unpackhi_epi32(pixels, pixels);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), _mm256_permute2x128_si256(low, high, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i + 8), _mm256_permute2x128_si256(low, high, 0x31));
+    }
+    fetchScaled2xSse2(destination + i, source + i / 2, count - i);
+}
+
+__attribute__((target("avx2"))) static void fetchScaled3x2Avx2(uint *destination, const uint *source, int count)
+{
+    // Every eight source pixels become the twelve pixels s0 s1 s1 s2 s3 s3 s4 s5 s5 s6 s7 s7.
+    const __m256i firstIndices = _mm256_setr_epi32(0, 1, 1, 2, 3, 3, 4, 5);
+    const __m256i secondIndices = _mm256_setr_epi32(5, 6, 7, 7, 7, 7, 7, 7);
+    int i = 0;
+    for (; i + 12 <= count; i += 12) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + i / 3 * 2));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + i), _mm256_permutevar8x32_epi32(pixels, firstIndices));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + i + 8),
+                         _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(pixels, secondIndices)));
+    }
+    fetchScaled3x2Sse2(destination + i, source + i / 3 * 2, count - i);
+}
+
+static const SoftwareBlitKernels s_avx2Kernels = {
+    copyOpaqueAvx2,
+    makeOpaqueAvx2,
+    sourceOverAvx2,
+    fetchScaled2xAvx2,
+    fetchScaled3x2Avx2,
+};
+
+#endif // KWIN_BLIT_X86
+
+#if KWIN_BLIT_NEON
+
+//****************************************
+// NEON
+//****************************************
+
+/**
+ * Multiplies the channels of four pixels by the bytes in @a alpha / 255, the same way as
+ * byteMul() does it.
+ */
+static inline uint8x16_t byteMulNeon(uint8x16_t pixels, uint8x16_t alpha)
+{
+    uint16x8_t low = vmull_u8(vget_low_u8(pixels), vget_low_u8(alpha));
+    uint16x8_t high = vmull_u8(vget_high_u8(pixels), vget_high_u8(alpha));
+    low = vaddq_u16(low, vshrq_n_u16(low, 8));
+    high = vaddq_u16(high, vshrq_n_u16(high, 8));
+    return vcombine_u8(vrshrn_n_u16(low, 8), vrshrn_n_u16(high, 8));
+}
+
+/**
+ * Returns 255 - alpha of four pixels in all bytes of each pixel.
+ */
+static inline uint8x16_t inverseAlphaNeon(uint32x4_t pixels)
+{
+    uint32x4_t inverse = vshrq_n_u32(vmvnq_u32(pixels), 24);
+    inverse = vorrq_u32(inverse, vshlq_n_u32(inverse, 8));
+    inverse = vorrq_u32(inverse, vshlq_n_u32(inverse, 16));
+    return vreinterpretq_u8_u32(inverse);
+}
+
+static inline bool allLanesSet(uint32x4_t mask)
+{
+    const uint32x2_t folded = vand_u32(vget_low_u32(mask), vget_high_u32(mask));
+    return (vget_lane_u32(folded, 0) & vget_lane_u32(folded, 1)) == 0xffffffff;
+}
+
+static void copyOpaqueNeon(uint *destination, const uint *source, int count)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(destination + i, vorrq_u32(vld1q_u32(source + i), alphaMask));
+    }
+    copyOpaqueGeneric(destination + i, source + i, count - i);
+}
+
+static void makeOpaqueNeon(uint *pixels, int count)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_u32(pixels + i, vorrq_u32(vld1q_u32(pixels + i), alphaMask));
+    }
+    makeOpaqueGeneric(pixels + i, count - i);
+}
+
+static void sourceOverNeon(uint *destination, const uint *source, int count, uint constAlpha)
+{
+    const uint32x4_t alphaMask = vdupq_n_u32(0xff000000);
+    const uint32x4_t zero = vdupq_n_u32(0);
+    const uint8x16_t constAlphaVector = vdupq_n_u8(constAlpha);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t pixels = vld1q_u32(source + i);
+        if (constAlpha != 255) {
+            pixels = vreinterpretq_u32_u8(byteMulNeon(vreinterpretq_u8_u32(pixels), constAlphaVector));
+        }
+        if (allLanesSet(vceqq_u32(vandq_u32(pixels, alphaMask), alphaMask))) {
+            vst1q_u32(destination + i, pixels);
+        } else if (!allLanesSet(vceqq_u32(pixels, zero))) {
+            const uint8x16_t background = byteMulNeon(vreinterpretq_u8_u32(vld1q_u32(destination + i)),
+                                                      inverseAlphaNeon(pixels));
+            vst1q_u32(destination + i, vaddq_u32(pixels, vreinterpretq_u32_u8(background)));
+        }
+    }
+    sourceOverGeneric(destination + i, source + i, count - i, constAlpha);
+}
+
+static void fetchScaled2xNeon(uint *destination, const uint *source, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const uint32x4_t pixels = vld1q_u32(source + i / 2);
+        const uint32x4x2_t zipped = vzipq_u32(pixels, pixels);
+        vst1q_u32(destination + i, zipped.val[0]);
+        vst1q_u32(destination + i + 4, zipped.val[1]);
+    }
+    fetchScaled2xGeneric(destination + i, source + i / 2, count - i);
+}
+
+static void fetchScaled3x2Neon(uint *destination, const uint *source, int count)
+{
+    // Every four source pixels s0 s1 s2 s3 become the six pixels s0 s1 s1 s2 s3 s3.
+    int i = 0;
+    for (; i + 6 <= count; i += 6) {
+        const uint32x4_t pixels = vld1q_u32(source + i / 3 * 2);
+        const uint32x4x2_t zipped = vzipq_u32(pixels, pixels);
+        vst1q_u32(destination + i, vextq_u32(zipped.val[0], zipped.val[1], 1));
+        vst1_u32(destination + i + 4, vget_high_u32(zipped.val[1]));
+    }
+    fetchScaled3x2Generic(destination + i, source + i / 3 * 2, count - i);
+}
+
+static const SoftwareBlitKernels s_neonKernels = {
+    copyOpaqueNeon,
+    makeOpaqueNeon,
+    sourceOverNeon,
+    fetchScaled2xNeon,
+    fetchScaled3x2Neon,
+};
+
+#endif // KWIN_BLIT_NEON
+
+bool isSoftwareBlitIsaSupported(SoftwareBlitIsa isa)
+{
+    return softwareBlitKernels(isa);
+}
+
+const SoftwareBlitKernels *softwareBlitKernels(SoftwareBlitIsa isa)
+{
+    switch (isa) {
+    case SoftwareBlitIsa::Generic:
+        return &s_genericKernels;
+    case SoftwareBlitIsa::SSE2:
+#if KWIN_BLIT_X86
+        if (__builtin_cpu_supports("sse2")) {
+            return &s_sse2Kernels;
+        }
+#endif
+        return nullptr;
+    case SoftwareBlitIsa::AVX2:
+#if KWIN_BLIT_X86
+        if (__builtin_cpu_supports("avx2")) {
+            return &s_avx2Kernels;
+        }
+#endif
+        return nullptr;
+    case SoftwareBlitIsa::NEON:
+#if KWIN_BLIT_NEON
+        return &s_neonKernels;
+#endif
+        return nullptr;
+    }
+    return nullptr;
+}
+
+} // namespace KWin
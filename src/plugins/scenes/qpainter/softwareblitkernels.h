@@ -0,0 +1,69 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+
+namespace KWin
+{
+
+/**
+ * The instruction sets the software blit kernels are implemented with.
+ */
+enum class SoftwareBlitIsa {
+    Generic,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+/**
+ * The per-row kernels of the software blitter. All pixels are 32 bit ARGB values, color
+ * channels are premultiplied by the alpha channel.
+ */
+struct SoftwareBlitKernels
+{
+    /**
+     * Copies @a count pixels from @a source to @a destination and makes them opaque. The
+     * buffers must not overlap.
+     */
+    void (*copyOpaque)(uint *destination, const uint *source, int count);
+    /**
+     * Makes @a count pixels opaque in place.
+     */
+    void (*makeOpaque)(uint *pixels, int count);
+    /**
+     * Composes @a count pixels from @a source over @a destination, the source pixels are
+     * multiplied by @a constAlpha (0-255) first. The results match the ones of QPainter.
+     */
+    void (*sourceOver)(uint *destination, const uint *source, int count, uint constAlpha);
+    /**
+     * Fetches @a count pixels scaled up by a factor of 2 from @a source with the nearest
+     * neighbor sampling, i.e. destination pixel i comes from the source pixel i / 2.
+     */
+    void (*fetchScaled2x)(uint *destination, const uint *source, int count);
+    /**
+     * Fetches @a count pixels scaled up by a factor of 1.5 from @a source with the nearest
+     * neighbor sampling, i.e. destination pixel i comes from the source pixel (2i + 1) / 3.
+     */
+    void (*fetchScaled3x2)(uint *destination, const uint *source, int count);
+};
+
+/**
+ * Returns whether the kernels for the @a isa are built in and can run on this CPU.
+ */
+bool isSoftwareBlitIsaSupported(SoftwareBlitIsa isa);
+
+/**
+ * Returns the kernels implemented with the @a isa, or @c nullptr if it is not supported.
+ */
+const SoftwareBlitKernels *softwareBlitKernels(SoftwareBlitIsa isa);
+
+} // namespace KWin
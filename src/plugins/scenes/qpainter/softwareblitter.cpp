@@ -0,0 +1,292 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "softwareblitter.h"
+
+#include <QPaintEngine>
+#include <QPainter>
+
+namespace KWin
+{
+
+/**
+ * The supported scale factors, as the number of target pixels for a number of source pixels.
+ */
+struct ScaleFactor
+{
+    int targetPixels;
+    int sourcePixels;
+};
+
+static const ScaleFactor s_scaleFactors[] = {
+    {1, 1},
+    {2, 1},
+    {3, 2},
+};
+
+static bool findScaleFactor(const QSize &sourceSize, const QSize &targetSize, ScaleFactor *factor)
+{
+    for (const ScaleFactor &candidate : s_scaleFactors) {
+        if (sourceSize.width() * candidate.targetPixels == targetSize.width() * candidate.sourcePixels
+                && sourceSize.height() * candidate.targetPixels == targetSize.height() * candidate.sourcePixels) {
+            *factor = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Rounds the @a rect to whole pixels, but only if it is already aligned to them.
+ */
+static bool snapToPixels(const QRectF &rect, QRect *snapped)
+{
+    const qreal tolerance = 1.0 / 1024;
+    const int left = qRound(rect.left());
+    const int top = qRound(rect.top());
+    const int right = qRound(rect.right());
+    const int bottom = qRound(rect.bottom());
+    if (qAbs(rect.left() - left) > tolerance || qAbs(rect.top() - top) > tolerance
+            || qAbs(rect.right() - right) > tolerance || qAbs(rect.bottom() - bottom) > tolerance) {
+        return false;
+    }
+    *snapped = QRect(left, top, right - left, bottom - top);
+    return true;
+}
+
+static bool isSupportedFormat(QImage::Format format)
+{
+    return format == QImage::Format_RGB32 || format == QImage::Format_ARGB32_Premultiplied;
+}
+
+SoftwareBlitter::SoftwareBlitter(SoftwareBlitIsa isa)
+    : m_isa(isa)
+    , m_kernels(softwareBlitKernels(isa))
+{
+    if (!m_kernels) {
+        m_isa = SoftwareBlitIsa::Generic;
+        m_kernels = softwareBlitKernels(m_isa);
+    }
+}
+
+SoftwareBlitter *SoftwareBlitter::create()
+{
+    const QByteArray requestedIsa = qgetenv("KWIN_QPAINTER_BLITTER").toLower();
+    if (requestedIsa == "0") {
+        return nullptr;
+    }
+
+    const SoftwareBlitIsa isas[] = {
+        SoftwareBlitIsa::Generic,
+        SoftwareBlitIsa::SSE2,
+        SoftwareBlitIsa::AVX2,
+        SoftwareBlitIsa::NEON,
+    };
+    for (SoftwareBlitIsa isa : isas) {
+        if (requestedIsa == isaName(isa).toLower().toLatin1() && isSoftwareBlitIsaSupported(isa)) {
+            return new SoftwareBlitter(isa);
+        }
+    }
+    return new SoftwareBlitter(bestIsa());
+}
+
+SoftwareBlitIsa SoftwareBlitter::bestIsa()
+{
+    if (isSoftwareBlitIsaSupported(SoftwareBlitIsa::AVX2)) {
+        return SoftwareBlitIsa::AVX2;
+    }
+    if (isSoftwareBlitIsaSupported(SoftwareBlitIsa::SSE2)) {
+        return SoftwareBlitIsa::SSE2;
+    }
+    if (isSoftwareBlitIsaSupported(SoftwareBlitIsa::NEON)) {
+        return SoftwareBlitIsa::NEON;
+    }
+    return SoftwareBlitIsa::Generic;
+}
+
+QString SoftwareBlitter::isaName(SoftwareBlitIsa isa)
+{
+    switch (isa) {
+    case SoftwareBlitIsa::Generic:
+        return QStringLiteral("Generic");
+    case SoftwareBlitIsa::SSE2:
+        return QStringLiteral("SSE2");
+    case SoftwareBlitIsa::AVX2:
+        return QStringLiteral("AVX2");
+    case SoftwareBlitIsa::NEON:
+        return QStringLiteral("NEON");
+    }
+    Q_UNREACHABLE();
+}
+
+SoftwareBlitIsa SoftwareBlitter::isa() const
+{
+    return m_isa;
+}
+
+quint64 SoftwareBlitter::blittedImageCount() const
+{
+    return m_blittedImageCount;
+}
+
+quint64 SoftwareBlitter::fallbackImageCount() const
+{
+    return m_fallbackImageCount;
+}
+
+bool SoftwareBlitter::canBlit(QImage::Format destinationFormat, QImage::Format sourceFormat,
+                              const QSize &sourceSize, const QSize &targetSize)
+{
+    ScaleFactor factor;
+    return isSupportedFormat(destinationFormat) && isSupportedFormat(sourceFormat)
+        && findScaleFactor(sourceSize, targetSize, &factor);
+}
+
+bool SoftwareBlitter::drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect)
+{
+    if (tryDrawImage(painter, targetRect, image, sourceRect)) {
+        ++m_blittedImageCount;
+        return true;
+    }
+    ++m_fallbackImageCount;
+    return false;
+}
+
+bool SoftwareBlitter::tryDrawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect)
+{
+    QPaintDevice *device = painter->device();
+    if (!device || device->devType() != QInternal::Image || painter->paintEngine()->type() != QPaintEngine::Raster) {
+        return false;
+    }
+    QImage *destination = static_cast<QImage *>(device);
+    if (destination->devicePixelRatio() != 1) {
+        return false;
+    }
+    if (painter->compositionMode() != QPainter::CompositionMode_SourceOver) {
+        return false;
+    }
+
+    const QTransform transform = painter->combinedTransform();
+    if (transform.type() > QTransform::TxScale || transform.m11() <= 0 || transform.m22() <= 0) {
+        return false;
+    }
+
+    QRect target;
+    QRect source;
+    if (!snapToPixels(transform.mapRect(targetRect), &target) || !snapToPixels(sourceRect, &source)) {
+        return false;
+    }
+    if (source.isEmpty() || !image.rect().contains(source)) {
+        return false;
+    }
+    if (!canBlit(destination->format(), image.format(), source.size(), target.size())) {
+        return false;
+    }
+    if (source.size() != target.size() && painter->testRenderHint(QPainter::SmoothPixmapTransform)) {
+        return false;
+    }
+
+    QRegion clip = target & destination->rect();
+    if (painter->hasClipping()) {
+        const QRegion logicalClip = painter->clipRegion();
+        QVector<QRect> deviceClip;
+        deviceClip.reserve(logicalClip.rectCount());
+        for (const QRect &rect : logicalClip) {
+            QRect deviceRect;
+            if (!snapToPixels(transform.mapRect(QRectF(rect)), &deviceRect)) {
+                return false;
+            }
+            deviceClip.append(deviceRect);
+        }
+        // The transformation keeps the order of the rectangles, so they are still y-x banded.
+        QRegion deviceClipRegion;
+        deviceClipRegion.setRects(deviceClip.constData(), deviceClip.count());
+        clip &= deviceClipRegion;
+    }
+
+    // Same as the raster paint engine, which works with the opacity in the 0-256 range.
+    const uint constAlpha = (qRound(painter->opacity() * 256) * 255) >> 8;
+    if (constAlpha && !clip.isEmpty()) {
+        blit(destination, target, clip, image, source, constAlpha);
+    }
+    return true;
+}
+
+uint *SoftwareBlitter::scratch(int count)
+{
+    if (m_scratch.count() < count) {
+        m_scratch.resize(count);
+    }
+    return m_scratch.data();
+}
+
+void SoftwareBlitter::blit(QImage *destination, const QRect &targetRect, const QRegion &clip,
+                           const QImage &source, const QRect &sourceRect, uint constAlpha)
+{
+    ScaleFactor factor;
+    if (!findScaleFactor(sourceRect.size(), targetRect.size(), &factor)) {
+        return;
+    }
+
+    const bool scaled = factor.targetPixels != factor.sourcePixels;
+    const bool opaque = source.format() == QImage::Format_RGB32;
+
+    // The raster paint engine writes to the image without detaching it, so must the blitter,
+    // otherwise an image that is painted on while it is shared would end up detached.
+    uchar *bits = const_cast<uchar *>(destination->constBits());
+    const int bytesPerLine = destination->bytesPerLine();
+
+    for (const QRect &rect : clip & targetRect & destination->rect()) {
+        // Fetch scaled rows starting at the beginning of a scale period, so the kernels don't
+        // need to care about the phase.
+        const int offset = rect.x() - targetRect.x();
+        const int phase = offset % factor.targetPixels;
+        const int sourceX = sourceRect.x() + (offset - phase) / factor.targetPixels * factor.sourcePixels;
+        const int width = rect.width();
+
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            const int row = y - targetRect.y();
+            const int sourceY = sourceRect.y() + ((2 * row + 1) * factor.sourcePixels) / (2 * factor.targetPixels);
+            const uint *sourceLine = reinterpret_cast<const uint *>(source.constScanLine(sourceY)) + sourceX;
+            uint *destinationLine = reinterpret_cast<uint *>(bits + qsizetype(y) * bytesPerLine) + rect.x();
+
+            const uint *pixels = sourceLine;
+            uint *fetchedPixels = nullptr;
+            if (scaled) {
+                uint *buffer = scratch(phase + width);
+                if (factor.targetPixels == 2) {
+                    m_kernels->fetchScaled2x(buffer, sourceLine, phase + width);
+                } else {
+                    m_kernels->fetchScaled3x2(buffer, sourceLine, phase + width);
+                }
+                fetchedPixels = buffer + phase;
+                pixels = fetchedPixels;
+            }
+
+            if (opaque && constAlpha == 255) {
+                m_kernels->copyOpaque(destinationLine, pixels, width);
+            } else if (opaque) {
+                // The scaled pixels are in the scratch buffer already, they are made opaque
+                // in place instead of being copied onto themselves
+                uint *buffer = fetchedPixels;
+                if (buffer) {
+                    m_kernels->makeOpaque(buffer, width);
+                } else {
+                    buffer = scratch(width);
+                    m_kernels->copyOpaque(buffer, pixels, width);
+                }
+                m_kernels->sourceOver(destinationLine, buffer, width, constAlpha);
+            } else {
+                m_kernels->sourceOver(destinationLine, pixels, width, constAlpha);
+            }
+        }
+    }
+}
+
+} // namespace KWin
@@ -0,0 +1,90 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "softwareblitkernels.h"
+
+#include <QImage>
+#include <QRegion>
+#include <QVector>
+
+class QPainter;
+
+namespace KWin
+{
+
+/**
+ * The SoftwareBlitter draws images the way QPainter::drawImage() does, but for the cases that
+ * are common in the QPainter scene it uses the kernels for the best instruction set the CPU
+ * supports instead of the generic paths of QPainter.
+ *
+ * The supported cases are images with the RGB32 or ARGB32_Premultiplied format drawn on
+ * images with one of these formats, with a constant opacity, at an integer position, and
+ * either unscaled or scaled up by a factor of 2 or 1.5.
+ */
+class SoftwareBlitter
+{
+public:
+    explicit SoftwareBlitter(SoftwareBlitIsa isa);
+
+    /**
+     * Creates a blitter with the best supported instruction set. The instruction set can be
+     * chosen with the KWIN_QPAINTER_BLITTER environment variable, "generic", "sse2", "avx2" or
+     * "neon"; if it is set to 0, no blitter is created and @c nullptr is returned.
+     */
+    static SoftwareBlitter *create();
+
+    static SoftwareBlitIsa bestIsa();
+    static QString isaName(SoftwareBlitIsa isa);
+
+    SoftwareBlitIsa isa() const;
+
+    /**
+     * Draws the @a sourceRect of the @a image into the @a targetRect with the @a painter,
+     * honoring its transformation, clipping and opacity. Returns @c false if this is not one
+     * of the supported cases; nothing is drawn then, and the caller has to use QPainter.
+     */
+    bool drawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect);
+
+    /**
+     * Draws the @a sourceRect of the @a source image into the @a targetRect of the
+     * @a destination image, only the parts inside the @a clip region are touched. The size
+     * of the @a targetRect must be the size of the @a sourceRect scaled by a supported factor,
+     * see canBlit().
+     */
+    void blit(QImage *destination, const QRect &targetRect, const QRegion &clip,
+              const QImage &source, const QRect &sourceRect, uint constAlpha);
+
+    /**
+     * Returns whether images with the @a sourceFormat can be drawn on images with the
+     * @a destinationFormat, with the @a sourceSize scaled to the @a targetSize.
+     */
+    static bool canBlit(QImage::Format destinationFormat, QImage::Format sourceFormat,
+                        const QSize &sourceSize, const QSize &targetSize);
+
+    /**
+     * The number of images drawn by the blitter, and the number of the ones that had to be
+     * drawn with QPainter because drawImage() did not support them.
+     */
+    quint64 blittedImageCount() const;
+    quint64 fallbackImageCount() const;
+
+private:
+    bool tryDrawImage(QPainter *painter, const QRectF &targetRect, const QImage &image, const QRectF &sourceRect);
+    uint *scratch(int count);
+
+    SoftwareBlitIsa m_isa;
+    const SoftwareBlitKernels *m_kernels;
+    QVector<uint> m_scratch;
+    quint64 m_blittedImageCount = 0;
+    quint64 m_fallbackImageCount = 0;
+};
+
+} // namespace KWin
@@ -7,6 +7,7 @@
 */
 
 #include "pipewirestream.h"
+#include "composite.h"
 #include "cursor.h"
 #include "dmabuftexture.h"
 #include "eglnativefence.h"
@@ -17,6 +18,7 @@
 #include "main.h"
 #include "pipewirecore.h"
 #include "platform.h"
+#include "scene.h"
 #include "utils.h"
 
 #include <KLocalizedString>
@@ -25,6 +27,9 @@
 #include <QPainter>
 
 #include <spa/buffer/meta.h>
+#include <spa/utils/defs.h>
+
+#include <cstring>
 
 #include <fcntl.h>
 #include <sys/mman.h>
@@ -65,6 +70,11 @@ void PipeWireStream::onStreamStateChanged(void *data, pw_stream_state old, pw_st
 #define CURSOR_META_SIZE(w,h)	(sizeof(struct spa_meta_cursor) + \
 				 sizeof(struct spa_meta_bitmap) + w * h * CURSOR_BPP)
 
+// How many damage rectangles are sent along with every buffer
+static const int s_maxDamageRects = 16;
+// How many frames can be read back from the GPU at the same time
+static const int s_maxPendingReadbacks = 3;
+
 void PipeWireStream::newStreamParams()
 {
     const int bpp = videoFormat.format == SPA_VIDEO_FORMAT_RGB || videoFormat.format == SPA_VIDEO_FORMAT_BGR ? 3 : 4;
@@ -87,9 +97,15 @@ void PipeWireStream::newStreamParams()
         (spa_pod*) spa_pod_builder_add_object (&pod_builder,
                                                SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
                                                SPA_PARAM_META_type, SPA_POD_Id (SPA_META_Cursor),
-                                               SPA_PARAM_META_size, SPA_POD_Int (CURSOR_META_SIZE (cursorSize, cursorSize)))
+                                               SPA_PARAM_META_size, SPA_POD_Int (CURSOR_META_SIZE (cursorSize, cursorSize))),
+        (spa_pod*) spa_pod_builder_add_object (&pod_builder,
+                                               SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
+                                               SPA_PARAM_META_type, SPA_POD_Id (SPA_META_VideoDamage),
+                                               SPA_PARAM_META_size, SPA_POD_CHOICE_RANGE_Int (sizeof(spa_meta_region) * s_maxDamageRects,
+                                                                                              sizeof(spa_meta_region) * 1,
+                                                                                              sizeof(spa_meta_region) * s_maxDamageRects))
     };
-    pw_stream_update_params(pwStream, params, 2);
+    pw_stream_update_params(pwStream, params, 3);
 }
 
 void PipeWireStream::onStreamParamChanged(void *data, uint32_t id, const struct spa_pod *format)
@@ -160,6 +176,9 @@ void PipeWireStream::onStreamAddBuffer(void *data, pw_buffer *buffer)
             qCCritical(KWIN_SCREENCAST) << "memfd: Failed to mmap memory";
         else
             qCDebug(KWIN_SCREENCAST) << "memfd: created successfully" << spa_data->data << spa_data->maxsize;
+
+        // The buffer has never been filled, so it has to be updated entirely the first time.
+        stream->m_bufferDamage.insert(buffer, QRect(QPoint(), stream->m_resolution));
 #endif
     }
 }
@@ -168,6 +187,7 @@ void PipeWireStream::onStreamRemoveBuffer(void *data, pw_buffer *buffer)
 {
     PipeWireStream *stream = static_cast<PipeWireStream *>(data);
     stream->m_dmabufDataForPwBuffer.remove(buffer);
+    stream->m_bufferDamage.remove(buffer);
 
     struct spa_buffer *spa_buffer = buffer->buffer;
     struct spa_data *spa_data = spa_buffer->datas;
@@ -192,6 +212,7 @@ PipeWireStream::PipeWireStream(bool hasAlpha, const QSize &resolution, QObject *
 PipeWireStream::~PipeWireStream()
 {
     m_stopped = true;
+    releaseReadbacks();
     if (pwStream) {
         pw_stream_destroy(pwStream);
     }
@@ -274,6 +295,9 @@ bool PipeWireStream::createStream()
                 m_repainting = true;
                 recordFrame(m_cursor.lastFrameTexture.data(), QRegion{m_cursor.lastRect} | cursorGeometry(Cursors::self()->currentCursor()));
                 m_repainting = false;
+            } else if (!m_frame.isEmpty()) {
+                // The frame is still around, so only the cursor needs to be drawn again.
+                queueFrame(QRegion());
             }
         });
     }
@@ -306,6 +330,30 @@ static GLTexture *copyTexture(GLTexture *texture)
     return copy;
 }
 
+static void addDamageMeta(spa_buffer *buffer, const QRegion &damage)
+{
+    spa_meta *meta = spa_buffer_find_meta(buffer, SPA_META_VideoDamage);
+    if (!meta || meta->size < sizeof(spa_meta_region)) {
+        return;
+    }
+
+    auto regions = static_cast<spa_meta_region *>(meta->data);
+    const int capacity = meta->size / sizeof(spa_meta_region);
+    int count = 0;
+    if (damage.rectCount() > capacity) {
+        const QRect bounds = damage.boundingRect();
+        regions[count++].region = SPA_REGION(bounds.x(), bounds.y(), uint32_t(bounds.width()), uint32_t(bounds.height()));
+    } else {
+        for (const QRect &rect : damage) {
+            regions[count++].region = SPA_REGION(rect.x(), rect.y(), uint32_t(rect.width()), uint32_t(rect.height()));
+        }
+    }
+    // An empty region terminates the list if it doesn't fill the whole meta.
+    if (count < capacity) {
+        regions[count].region = SPA_REGION(0, 0, 0, 0);
+    }
+}
+
 void PipeWireStream::recordFrame(GLTexture *frameTexture, const QRegion &damagedRegion)
 {
     Q_ASSERT(!m_stopped);
@@ -318,6 +366,8 @@ void PipeWireStream::recordFrame(GLTexture *frameTexture, const QRegion &damaged
 
     if (frameTexture->size() != m_resolution) {
         m_resolution = frameTexture->size();
+        releaseReadbacks();
+        m_frame.clear();
         newStreamParams();
         return;
     }
@@ -331,6 +381,13 @@ void PipeWireStream::recordFrame(GLTexture *frameTexture, const QRegion &damaged
         return;
     }
 
+    // Buffers in system memory are filled from a copy of the frame that is read back
+    // asynchronously, see readbackFrame().
+    if (m_dmabufDataForPwBuffer.isEmpty()) {
+        readbackFrame(frameTexture, damagedRegion);
+        return;
+    }
+
     struct pw_buffer *buffer = pw_stream_dequeue_buffer(pwStream);
 
     if (!buffer) {
@@ -340,8 +397,7 @@ void PipeWireStream::recordFrame(GLTexture *frameTexture, const QRegion &damaged
     struct spa_buffer *spa_buffer = buffer->buffer;
     struct spa_data *spa_data = spa_buffer->datas;
 
-    uint8_t *data = (uint8_t *) spa_data->data;
-    if (!data && spa_buffer->datas->type != SPA_DATA_DmaBuf) {
+    if (spa_buffer->datas->type != SPA_DATA_DmaBuf) {
         qCWarning(KWIN_SCREENCAST) << "Failed to record frame: invalid buffer data";
         pw_stream_queue_buffer(pwStream, buffer);
         return;
@@ -349,91 +405,324 @@ void PipeWireStream::recordFrame(GLTexture *frameTexture, const QRegion &damaged
 
     const auto size = frameTexture->size();
     spa_data->chunk->offset = 0;
-    if (data || spa_data[0].type == SPA_DATA_MemFd) {
-        const int bpp = data && !m_hasAlpha ? 3 : 4;
-        const uint stride = SPA_ROUND_UP_N (size.width() * bpp, 4);
-        const uint bufferSize = stride * size.height();
-
-        if (bufferSize > spa_data->maxsize) {
-            qCDebug(KWIN_SCREENCAST) << "Failed to record frame: frame is too big";
-            pw_stream_queue_buffer(pwStream, buffer);
+
+    auto &buf = m_dmabufDataForPwBuffer[buffer];
+
+    spa_data->chunk->stride = buf->stride();
+    spa_data->chunk->size = spa_data->maxsize;
+
+    GLRenderTarget::pushRenderTarget(buf->framebuffer());
+    frameTexture->bind();
+
+    QRect r(QPoint(), size);
+    auto shader = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
+
+    QMatrix4x4 mvp;
+    mvp.ortho(r);
+    shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+
+    QRegion dr = damagedRegion;
+    if (m_cursor.texture) {
+        dr |= m_cursor.lastRect;
+    }
+
+    frameTexture->render(damagedRegion, r, true);
+
+    auto cursor = Cursors::self()->currentCursor();
+    if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && m_cursor.viewport.contains(cursor->pos())) {
+        if (!m_repainting) //We need to copy the last version of the stream to render the moved cursor on top
+            m_cursor.lastFrameTexture.reset(copyTexture(frameTexture));
+
+        if (!m_cursor.texture || m_cursor.lastKey != cursor->image().cacheKey())
+            m_cursor.texture.reset(new GLTexture(cursor->image()));
+
+        m_cursor.texture->setYInverted(false);
+        m_cursor.texture->bind();
+        const auto cursorRect = cursorGeometry(cursor);
+        mvp.translate(cursorRect.left(), r.height() - cursorRect.top() - cursor->image().height() * m_cursor.scale);
+        shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        m_cursor.texture->render(cursorRect, cursorRect, true);
+        glDisable(GL_BLEND);
+        m_cursor.texture->unbind();
+        m_cursor.lastRect = cursorRect;
+        dr |= cursorRect;
+    }
+    ShaderManager::instance()->popShader();
+
+    GLRenderTarget::popRenderTarget();
+    frameTexture->unbind();
+
+    addDamageMeta(spa_buffer, dr & r);
+
+    if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Metadata) {
+        sendCursorData(Cursors::self()->currentCursor(),
+                        (spa_meta_cursor *) spa_buffer_find_meta_data (spa_buffer, SPA_META_Cursor, sizeof (spa_meta_cursor)));
+    }
+
+    tryEnqueue(buffer);
+}
+
+int PipeWireStream::frameStride() const
+{
+    const int bytesPerPixel = m_hasAlpha ? 4 : 3;
+    return SPA_ROUND_UP_N(m_resolution.width() * bytesPerPixel, 4);
+}
+
+static bool supportsPackRowLength()
+{
+    return !GLPlatform::instance()->isGLES() || hasGLVersion(3, 0);
+}
+
+static bool supportsAsynchronousReadback()
+{
+    return hasGLVersion(3, 0) && kwinApp()->platform()->supportsNativeFence();
+}
+
+void PipeWireStream::readPixels(GLTexture *frameTexture, const QRegion &region, void *destination)
+{
+    const int bytesPerPixel = m_hasAlpha ? 4 : 3;
+    const int stride = frameStride();
+
+    GLRenderTarget renderTarget(*frameTexture);
+    GLRenderTarget::pushRenderTarget(&renderTarget);
+    if (supportsPackRowLength()) {
+        glPixelStorei(GL_PACK_ROW_LENGTH, m_resolution.width());
+    }
+    for (const QRect &rect : region) {
+        // If a pixel pack buffer is bound, the destination is an offset into the buffer.
+        const quintptr offset = rect.y() * stride + rect.x() * bytesPerPixel;
+        glReadPixels(rect.x(), rect.y(), rect.width(), rect.height(),
+                     m_hasAlpha ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE,
+                     reinterpret_cast<GLvoid *>(quintptr(destination) + offset));
+    }
+    if (supportsPackRowLength()) {
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+    }
+    GLRenderTarget::popRenderTarget();
+}
+
+void PipeWireStream::readbackFrame(GLTexture *frameTexture, const QRegion &damagedRegion)
+{
+    const QRect frameRect(QPoint(), m_resolution);
+    const int frameSize = frameStride() * m_resolution.height();
+    if (m_frame.size() != frameSize) {
+        m_frame.fill(0, frameSize);
+        m_unreadDamage = frameRect;
+    }
+
+    QRegion damage = (damagedRegion | m_unreadDamage) & frameRect;
+    m_unreadDamage = QRegion();
+    if (!supportsPackRowLength()) {
+        // Without GL_PACK_ROW_LENGTH, only whole rows can be read into the frame.
+        damage = frameRect;
+    }
+    if (damage.isEmpty()) {
+        return;
+    }
+
+    if (!supportsAsynchronousReadback()) {
+        readPixels(frameTexture, damage, m_frame.data());
+        queueFrame(damage);
+        return;
+    }
+
+    if (m_freePixelBuffers.isEmpty()) {
+        if (m_pendingReadbacks.count() == s_maxPendingReadbacks) {
+            // The GPU is still busy with previous readbacks, the damaged parts will be read
+            // along with the next frame instead of stalling until a pixel buffer is free.
+            m_unreadDamage = damage;
             return;
         }
+        GLuint pixelBuffer = 0;
+        glGenBuffers(1, &pixelBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, frameSize, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        m_freePixelBuffers.append(pixelBuffer);
+    }
 
-        spa_data->chunk->size = bufferSize;
-        spa_data->chunk->stride = stride;
+    PendingReadback readback;
+    readback.pixelBuffer = m_freePixelBuffers.takeLast();
+    readback.damage = damage;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+    readPixels(frameTexture, damage, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    // The readback completes once the GPU has executed the commands, which usually
+    // happens before the next frame is rendered. Wait for it without blocking.
+    readback.fence = new EGLNativeFence(kwinApp()->platform()->sceneEglDisplay());
+    if (!readback.fence->isValid()) {
+        qCWarning(KWIN_SCREENCAST) << "Failed to create a native EGL fence";
+        m_pendingReadbacks.append(readback);
+        finishReadbacks(m_pendingReadbacks.count());
+        return;
+    }
 
-        frameTexture->bind();
-        if (GLPlatform::instance()->isGLES()) {
-            glReadPixels(0, 0, size.width(), size.height(), m_hasAlpha ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, (GLvoid*)data);
-        } else if (GLPlatform::instance()->glVersion() >= kVersionNumber(4, 5)) {
-            glGetTextureImage(frameTexture->texture(), 0, m_hasAlpha ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, bufferSize, data);
+    readback.notifier = new QSocketNotifier(readback.fence->fileDescriptor(), QSocketNotifier::Read, this);
+    const GLuint pixelBuffer = readback.pixelBuffer;
+    connect(readback.notifier, &QSocketNotifier::activated, this, [this, pixelBuffer]() {
+        // The GPU executes commands in order, so all the previous readbacks are done, too.
+        for (int i = 0; i < m_pendingReadbacks.count(); ++i) {
+            if (m_pendingReadbacks[i].pixelBuffer == pixelBuffer) {
+                finishReadbacks(i + 1);
+                break;
+            }
+        }
+    });
+    m_pendingReadbacks.append(readback);
+}
+
+void PipeWireStream::finishReadbacks(int count)
+{
+    Compositor::self()->scene()->makeOpenGLContextCurrent();
+
+    const int bytesPerPixel = m_hasAlpha ? 4 : 3;
+    const int stride = frameStride();
+    QRegion damage;
+
+    for (int i = 0; i < count; ++i) {
+        const PendingReadback readback = m_pendingReadbacks.takeFirst();
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.pixelBuffer);
+        const auto pixels = static_cast<const uint8_t *>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_frame.size(), GL_MAP_READ_BIT));
+        if (pixels) {
+            uint8_t *frame = reinterpret_cast<uint8_t *>(m_frame.data());
+            for (const QRect &rect : readback.damage) {
+                const int offset = rect.x() * bytesPerPixel;
+                const int length = rect.width() * bytesPerPixel;
+                for (int y = rect.top(); y <= rect.bottom(); ++y) {
+                    memcpy(frame + y * stride + offset, pixels + y * stride + offset, length);
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            damage |= readback.damage;
         } else {
-            glGetTexImage(frameTexture->target(), 0, m_hasAlpha ? GL_BGRA : GL_BGR, GL_UNSIGNED_BYTE, data);
+            qCWarning(KWIN_SCREENCAST) << "Failed to map a pixel buffer";
+            m_unreadDamage |= readback.damage;
         }
-        auto cursor = Cursors::self()->currentCursor();
-        if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && m_cursor.viewport.contains(cursor->pos())) {
-            QImage dest(data, size.width(), size.height(), QImage::Format_RGBA8888_Premultiplied);
-            QPainter painter(&dest);
-            const auto position = (cursor->pos() - m_cursor.viewport.topLeft() - cursor->hotspot()) * m_cursor.scale;
-            painter.drawImage(QRect{position, cursor->image().size()}, cursor->image());
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        // This may be called from the notifier itself, so it can't be deleted right away.
+        if (readback.notifier) {
+            readback.notifier->setEnabled(false);
+            readback.notifier->deleteLater();
         }
-    } else {
-        auto &buf = m_dmabufDataForPwBuffer[buffer];
+        delete readback.fence;
+        m_freePixelBuffers.append(readback.pixelBuffer);
+    }
 
-        spa_data->chunk->stride = buf->stride();
-        spa_data->chunk->size = spa_data->maxsize;
+    queueFrame(damage);
+}
 
-        GLRenderTarget::pushRenderTarget(buf->framebuffer());
-        frameTexture->bind();
+void PipeWireStream::releaseReadbacks()
+{
+    if (m_freePixelBuffers.isEmpty() && m_pendingReadbacks.isEmpty()) {
+        return;
+    }
+    if (Compositor::self() && Compositor::self()->scene()) {
+        Compositor::self()->scene()->makeOpenGLContextCurrent();
+    }
 
-        QRect r(QPoint(), size);
-        auto shader = ShaderManager::instance()->pushShader(ShaderTrait::MapTexture);
+    for (const PendingReadback &readback : qAsConst(m_pendingReadbacks)) {
+        delete readback.notifier;
+        delete readback.fence;
+        glDeleteBuffers(1, &readback.pixelBuffer);
+    }
+    m_pendingReadbacks.clear();
 
-        QMatrix4x4 mvp;
-        mvp.ortho(r);
-        shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+    glDeleteBuffers(m_freePixelBuffers.count(), m_freePixelBuffers.constData());
+    m_freePixelBuffers.clear();
+    m_unreadDamage = QRegion();
+}
 
-        QRegion dr = damagedRegion;
-        if (m_cursor.texture) {
-            dr |= m_cursor.lastRect;
-        }
+void PipeWireStream::queueFrame(const QRegion &damagedRegion)
+{
+    const QRect frameRect(QPoint(), m_resolution);
+    const int bytesPerPixel = m_hasAlpha ? 4 : 3;
+    const int stride = frameStride();
+
+    auto cursor = Cursors::self()->currentCursor();
+    QRect cursorImageRect;
+    QRect cursorRect;
+    if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && m_cursor.viewport.contains(cursor->pos())) {
+        const auto position = (cursor->pos() - m_cursor.viewport.topLeft() - cursor->hotspot()) * m_cursor.scale;
+        // The cursor is drawn at its position, only the part inside the frame is damaged
+        cursorImageRect = QRect(position, cursor->image().size());
+        cursorRect = cursorImageRect & frameRect;
+    }
 
-        frameTexture->render(damagedRegion, r, true);
+    // Every buffer misses the new damage, not only the one that is going to be sent.
+    for (auto it = m_bufferDamage.begin(); it != m_bufferDamage.end(); ++it) {
+        *it |= damagedRegion;
+    }
+    m_unsentDamage |= damagedRegion | m_cursor.lastRect | cursorRect;
+    m_cursor.lastRect = cursorRect;
+    if (m_unsentDamage.isEmpty()) {
+        return;
+    }
 
-        auto cursor = Cursors::self()->currentCursor();
-        if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Embedded && m_cursor.viewport.contains(cursor->pos())) {
-            if (!m_repainting) //We need to copy the last version of the stream to render the moved cursor on top
-                m_cursor.lastFrameTexture.reset(copyTexture(frameTexture));
+    struct pw_buffer *buffer = pw_stream_dequeue_buffer(pwStream);
+    if (!buffer) {
+        return;
+    }
+
+    struct spa_buffer *spa_buffer = buffer->buffer;
+    struct spa_data *spa_data = spa_buffer->datas;
+
+    uint8_t *data = (uint8_t *) spa_data->data;
+    if (!data) {
+        qCWarning(KWIN_SCREENCAST) << "Failed to record frame: invalid buffer data";
+        pw_stream_queue_buffer(pwStream, buffer);
+        return;
+    }
 
-            if (!m_cursor.texture || m_cursor.lastKey != cursor->image().cacheKey())
-                m_cursor.texture.reset(new GLTexture(cursor->image()));
+    const uint bufferSize = m_frame.size();
+    if (bufferSize > spa_data->maxsize) {
+        qCDebug(KWIN_SCREENCAST) << "Failed to record frame: frame is too big";
+        pw_stream_queue_buffer(pwStream, buffer);
+        return;
+    }
 
-            m_cursor.texture->setYInverted(false);
-            m_cursor.texture->bind();
-            const auto cursorRect = cursorGeometry(cursor);
-            mvp.translate(cursorRect.left(), r.height() - cursorRect.top() - cursor->image().height() * m_cursor.scale);
-            shader->setUniform(GLShader::ModelViewProjectionMatrix, mvp);
+    spa_data->chunk->offset = 0;
+    spa_data->chunk->size = bufferSize;
+    spa_data->chunk->stride = stride;
 
-            glEnable(GL_BLEND);
-            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-            m_cursor.texture->render(cursorRect, cursorRect, true);
-            glDisable(GL_BLEND);
-            m_cursor.texture->unbind();
-            m_cursor.lastRect = cursorRect;
+    // Only copy the parts that have changed since this buffer has been filled the last time.
+    auto bufferDamageIt = m_bufferDamage.find(buffer);
+    if (bufferDamageIt == m_bufferDamage.end()) {
+        bufferDamageIt = m_bufferDamage.insert(buffer, frameRect);
+    }
+    QRegion &bufferDamage = *bufferDamageIt;
+    const uint8_t *frame = reinterpret_cast<const uint8_t *>(m_frame.constData());
+    for (const QRect &rect : bufferDamage & frameRect) {
+        const int offset = rect.x() * bytesPerPixel;
+        const int length = rect.width() * bytesPerPixel;
+        for (int y = rect.top(); y <= rect.bottom(); ++y) {
+            memcpy(data + y * stride + offset, frame + y * stride + offset, length);
         }
-        ShaderManager::instance()->popShader();
-
-        GLRenderTarget::popRenderTarget();
     }
-    frameTexture->unbind();
+    bufferDamage = QRegion();
+
+    if (!cursorRect.isEmpty()) {
+        QImage dest(data, m_resolution.width(), m_resolution.height(), stride, QImage::Format_RGBA8888_Premultiplied);
+        QPainter painter(&dest);
+        painter.drawImage(cursorImageRect, cursor->image());
+        // The cursor is not part of the frame, it has to be wiped out next time.
+        bufferDamage = cursorRect;
+    }
+
+    addDamageMeta(spa_buffer, m_unsentDamage);
+    m_unsentDamage = QRegion();
 
     if (m_cursor.mode == KWaylandServer::ScreencastV1Interface::Metadata) {
-        sendCursorData(Cursors::self()->currentCursor(),
-                        (spa_meta_cursor *) spa_buffer_find_meta_data (spa_buffer, SPA_META_Cursor, sizeof (spa_meta_cursor)));
+        sendCursorData(cursor, (spa_meta_cursor *) spa_buffer_find_meta_data (spa_buffer, SPA_META_Cursor, sizeof (spa_meta_cursor)));
     }
 
-    tryEnqueue(buffer);
+    pw_stream_queue_buffer(pwStream, buffer);
 }
 
 void PipeWireStream::tryEnqueue(pw_buffer *buffer)
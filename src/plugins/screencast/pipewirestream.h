@@ -18,6 +18,9 @@
 #include <QSharedPointer>
 #include <QSize>
 #include <QSocketNotifier>
+#include <QVector>
+
+#include <epoxy/gl.h>
 
 #include <pipewire/pipewire.h>
 #include <spa/param/format-utils.h>
@@ -72,6 +75,12 @@ private:
     void newStreamParams();
     void tryEnqueue(pw_buffer *buffer);
     void enqueue();
+    int frameStride() const;
+    void readPixels(GLTexture *frameTexture, const QRegion &region, void *destination);
+    void readbackFrame(GLTexture *frameTexture, const QRegion &damagedRegion);
+    void finishReadbacks(int count);
+    void releaseReadbacks();
+    void queueFrame(const QRegion &damagedRegion);
 
     QSharedPointer<PipeWireCore> pwCore;
     struct pw_stream *pwStream = nullptr;
@@ -104,6 +113,24 @@ private:
     pw_buffer *m_pendingBuffer = nullptr;
     QSocketNotifier *m_pendingNotifier = nullptr;
     EGLNativeFence *m_pendingFence = nullptr;
+
+    struct PendingReadback {
+        GLuint pixelBuffer = 0;
+        QRegion damage;
+        EGLNativeFence *fence = nullptr;
+        QSocketNotifier *notifier = nullptr;
+    };
+
+    // The latest frame in the stream format, memfd buffers are updated from it
+    QByteArray m_frame;
+    // The parts of the frame that changed since the buffer has been filled the last time
+    QHash<struct pw_buffer *, QRegion> m_bufferDamage;
+    // Damage that has not been sent in a buffer yet
+    QRegion m_unsentDamage;
+    // Damage that could not be read back because all pixel buffers were busy
+    QRegion m_unreadDamage;
+    QVector<GLuint> m_freePixelBuffers;
+    QVector<PendingReadback> m_pendingReadbacks;
 };
 
 } // namespace KWin
@@ -16,10 +16,12 @@
 #include "input_event.h"
 #include "input_event_spy.h"
 #include "osd.h"
+#include "renderloop.h"
 #include "screens.h"
 #include "wayland_server.h"
 #include "workspace.h"
 #include "decorations/decoratedclient.h"
+#include "libinput/device.h"
 // KDecoration
 #include <KDecoration2/Decoration>
 // KWayland
@@ -41,6 +43,9 @@
 
 #include <linux/input.h>
 
+#include <chrono>
+#include <utility>
+
 namespace KWin
 {
 
@@ -104,7 +109,10 @@ PointerInputRedirection::PointerInputRedirection(InputRedirection* parent)
     : InputDeviceHandler(parent)
     , m_cursor(nullptr)
     , m_supportsWarping(Application::usesLibinput())
+    , m_coalesceMotion(qEnvironmentVariableIntValue("KWIN_POINTER_MOTION_COALESCING") == 1)
 {
+    m_motionTimer.setSingleShot(true);
+    connect(&m_motionTimer, &QTimer::timeout, this, &PointerInputRedirection::processQueuedMotion);
 }
 
 PointerInputRedirection::~PointerInputRedirection() = default;
@@ -249,25 +257,144 @@ void PointerInputRedirection::processMotion(const QPointF &pos, const QSizeF &de
     if (!inited()) {
         return;
     }
+    // Queued motion happened before, e.g. before the pointer gets warped.
+    processQueuedMotion();
+    const QVector<MouseEvent::RelativeMotion> relativeMotions = std::exchange(m_pendingRelativeMotions, {});
     if (PositionUpdateBlocker::isPositionBlocked()) {
         PositionUpdateBlocker::schedulePosition(pos, delta, deltaNonAccelerated, time, timeUsec);
         return;
     }
 
+    if (timeUsec) {
+        // libinput stamps the events with the monotonic clock, like the steady clock.
+        const quint64 now = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        if (now >= timeUsec) {
+            const quint64 latency = now - timeUsec;
+            m_motionLatency.events++;
+            m_motionLatency.last = latency;
+            m_motionLatency.total += latency;
+            m_motionLatency.maximum = std::max(m_motionLatency.maximum, latency);
+        }
+    }
+
     PositionUpdateBlocker blocker(this);
     updatePosition(pos);
     MouseEvent event(QEvent::MouseMove, m_pos, Qt::NoButton, m_qtButtons,
                      input()->keyboardModifiers(), time,
                      delta, deltaNonAccelerated, timeUsec, device);
     event.setModifiersRelevantForGlobalShortcuts(input()->modifiersRelevantForGlobalShortcuts());
+    event.setRelativeMotions(relativeMotions);
 
     update();
     input()->processSpies(std::bind(&InputEventSpy::pointerEvent, std::placeholders::_1, &event));
     input()->processFilters(std::bind(&InputEventFilter::pointerEvent, std::placeholders::_1, &event, 0));
 }
 
+PointerInputRedirection::MotionLatency PointerInputRedirection::motionLatency() const
+{
+    return m_motionLatency;
+}
+
+void PointerInputRedirection::queueMotion(const QPointF &pos, const QSizeF &delta, const QSizeF &deltaNonAccelerated, uint32_t time, quint64 timeUsec, LibInput::Device *device)
+{
+    if (!m_coalesceMotion || !inited() || isConstrained()) {
+        processMotion(pos, delta, deltaNonAccelerated, time, timeUsec, device);
+        return;
+    }
+
+    const QPointF current = queuedPos();
+    // The relative motion is sent to the clients event by event
+    if (!delta.isNull() || !deltaNonAccelerated.isNull()) {
+        m_queuedMotion.relativeMotions.append(MouseEvent::RelativeMotion{delta, deltaNonAccelerated, timeUsec});
+    }
+    if (m_hasQueuedMotion) {
+        m_queuedMotion.delta += delta;
+        m_queuedMotion.deltaNonAccelerated += deltaNonAccelerated;
+        m_coalescedMotionEvents++;
+    } else {
+        m_queuedMotion.delta = delta;
+        m_queuedMotion.deltaNonAccelerated = deltaNonAccelerated;
+        m_hasQueuedMotion = true;
+
+        // The motion is processed right before the next frame is painted, so the frame shows
+        // the latest position of the pointer.
+        RenderLoop *renderLoop = nullptr;
+        if (kwinApp()->platform()->isPerScreenRenderingEnabled()) {
+            if (AbstractOutput *output = kwinApp()->platform()->outputAt(current.toPoint())) {
+                renderLoop = output->renderLoop();
+            }
+        } else {
+            renderLoop = kwinApp()->platform()->renderLoop();
+        }
+        if (renderLoop) {
+            const int refreshRate = renderLoop->refreshRate();
+            const int frameTime = refreshRate > 0 ? 1000000 / refreshRate : 16;
+            m_motionFrameConnection = connect(renderLoop, &RenderLoop::frameAboutToBeRequested,
+                                              this, &PointerInputRedirection::processQueuedMotion);
+            if (kwinApp()->platform()->usesSoftwareCursor() && !kwinApp()->platform()->isCursorHidden()) {
+                renderLoop->scheduleRepaint();
+                // The render loop doesn't request frames while it's inhibited, e.g. while the
+                // outputs are turned off, the motion must not wait for it.
+                m_motionTimer.start(2 * frameTime);
+            } else {
+                // Nothing has to be painted for the cursor, the motion is processed with the
+                // next frame if there is one or after a frame's time otherwise
+                m_motionTimer.start(frameTime);
+            }
+        } else {
+            m_motionTimer.start(0);
+        }
+    }
+    // Clamp the position right away, the motion that follows is relative to it.
+    m_queuedMotion.pos = confineToScreens(pos, current);
+    m_queuedMotion.time = time;
+    m_queuedMotion.timeUsec = timeUsec;
+    m_queuedMotion.device = device;
+}
+
+void PointerInputRedirection::processQueuedMotion()
+{
+    if (!m_hasQueuedMotion) {
+        return;
+    }
+    m_hasQueuedMotion = false;
+    disconnect(m_motionFrameConnection);
+    m_motionFrameConnection = QMetaObject::Connection();
+    m_motionTimer.stop();
+
+    const QueuedMotion motion = m_queuedMotion;
+    m_pendingRelativeMotions = std::exchange(m_queuedMotion.relativeMotions, {});
+    processMotion(motion.pos, motion.delta, motion.deltaNonAccelerated, motion.time, motion.timeUsec, motion.device);
+}
+
+QPointF PointerInputRedirection::queuedPos() const
+{
+    return m_hasQueuedMotion ? m_queuedMotion.pos : m_pos;
+}
+
+bool PointerInputRedirection::isMotionCoalescingEnabled() const
+{
+    return m_coalesceMotion;
+}
+
+void PointerInputRedirection::setMotionCoalescingEnabled(bool enabled)
+{
+    m_coalesceMotion = enabled;
+    if (!enabled) {
+        processQueuedMotion();
+    }
+}
+
+quint64 PointerInputRedirection::coalescedMotionEvents() const
+{
+    return m_coalescedMotionEvents;
+}
+
 void PointerInputRedirection::processButton(uint32_t button, InputRedirection::PointerButtonState state, uint32_t time, LibInput::Device *device)
 {
+    processQueuedMotion();
+
     QEvent::Type type;
     switch (state) {
     case InputRedirection::PointerButtonReleased:
@@ -305,6 +432,7 @@ void PointerInputRedirection::processButton(uint32_t button, InputRedirection::P
 void PointerInputRedirection::processAxis(InputRedirection::PointerAxis axis, qreal delta, qint32 discreteDelta,
     InputRedirection::PointerAxisSource source, uint32_t time, LibInput::Device *device)
 {
+    processQueuedMotion();
     update();
 
     Q_EMIT input()->pointerAxisChanged(axis, delta);
@@ -328,6 +456,7 @@ void PointerInputRedirection::processSwipeGestureBegin(int fingerCount, quint32
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
     input()->processFilters(std::bind(&InputEventFilter::swipeGestureBegin, std::placeholders::_1, fingerCount, time));
@@ -339,6 +468,7 @@ void PointerInputRedirection::processSwipeGestureUpdate(const QSizeF &delta, qui
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureUpdate, std::placeholders::_1, delta, time));
@@ -351,6 +481,7 @@ void PointerInputRedirection::processSwipeGestureEnd(quint32 time, KWin::LibInpu
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureEnd, std::placeholders::_1, time));
@@ -363,6 +494,7 @@ void PointerInputRedirection::processSwipeGestureCancelled(quint32 time, KWin::L
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::swipeGestureCancelled, std::placeholders::_1, time));
@@ -375,6 +507,7 @@ void PointerInputRedirection::processPinchGestureBegin(int fingerCount, quint32
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureBegin, std::placeholders::_1, fingerCount, time));
@@ -387,6 +520,7 @@ void PointerInputRedirection::processPinchGestureUpdate(qreal scale, qreal angle
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureUpdate, std::placeholders::_1, scale, angleDelta, delta, time));
@@ -399,6 +533,7 @@ void PointerInputRedirection::processPinchGestureEnd(quint32 time, KWin::LibInpu
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureEnd, std::placeholders::_1, time));
@@ -411,6 +546,7 @@ void PointerInputRedirection::processPinchGestureCancelled(quint32 time, KWin::L
     if (!inited()) {
         return;
     }
+    processQueuedMotion();
     update();
 
     input()->processSpies(std::bind(&InputEventSpy::pinchGestureCancelled, std::placeholders::_1, time));
@@ -802,22 +938,28 @@ QPointF PointerInputRedirection::applyPointerConfinement(const QPointF &pos) con
     return m_pos;
 }
 
-void PointerInputRedirection::updatePosition(const QPointF &pos)
+QPointF PointerInputRedirection::confineToScreens(const QPointF &pos, const QPointF &current) const
 {
-    if (m_locked) {
-        // locked pointer should not move
-        return;
-    }
     // verify that at least one screen contains the pointer position
     QPointF p = pos;
     if (!screenContainsPos(p)) {
         const QRectF unitedScreensGeometry = workspace()->geometry();
         p = confineToBoundingBox(p, unitedScreensGeometry);
         if (!screenContainsPos(p)) {
-            const AbstractOutput *currentOutput = kwinApp()->platform()->outputAt(m_pos.toPoint());
+            const AbstractOutput *currentOutput = kwinApp()->platform()->outputAt(current.toPoint());
             p = confineToBoundingBox(p, currentOutput->geometry());
         }
     }
+    return p;
+}
+
+void PointerInputRedirection::updatePosition(const QPointF &pos)
+{
+    if (m_locked) {
+        // locked pointer should not move
+        return;
+    }
+    QPointF p = confineToScreens(pos, m_pos);
     p = applyPointerConfinement(p);
     if (p == m_pos) {
         // didn't change due to confinement
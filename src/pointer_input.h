@@ -12,6 +12,7 @@
 #define KWIN_POINTER_INPUT_H
 
 #include "input.h"
+#include "input_event.h"
 #include "cursor.h"
 #include "xcursortheme.h"
 
@@ -19,6 +20,7 @@
 #include <QObject>
 #include <QPointer>
 #include <QPointF>
+#include <QTimer>
 
 class QWindow;
 
@@ -91,6 +93,37 @@ public:
      * @internal
      */
     void processMotion(const QPointF &pos, const QSizeF &delta, const QSizeF &deltaNonAccelerated, uint32_t time, quint64 timeUsec, LibInput::Device *device);
+    /**
+     * Processes a pointer motion event of an input device. If motion coalescing is enabled,
+     * consecutive motion events are merged and processed once per frame of the render loop,
+     * otherwise the event is processed right away.
+     * @internal
+     */
+    void queueMotion(const QPointF &pos, const QSizeF &delta, const QSizeF &deltaNonAccelerated, uint32_t time, quint64 timeUsec, LibInput::Device *device);
+    /**
+     * Processes the motion events merged by queueMotion() that have not been processed yet.
+     * @internal
+     */
+    void processQueuedMotion();
+    /**
+     * Returns the position the pointer moves to once the queued motion has been processed.
+     */
+    QPointF queuedPos() const;
+
+    /**
+     * Returns @c true if the pointer motion events are coalesced. It is disabled by default
+     * and can be enabled with KWIN_POINTER_MOTION_COALESCING=1.
+     *
+     * The motion is never coalesced while the pointer is locked or confined, the clients that
+     * constrain the pointer get all relative motion events.
+     */
+    bool isMotionCoalescingEnabled() const;
+    void setMotionCoalescingEnabled(bool enabled);
+    /**
+     * Returns the number of motion events that have been merged into later ones.
+     */
+    quint64 coalescedMotionEvents() const;
+
     /**
      * @internal
      */
@@ -132,6 +165,19 @@ public:
      */
     void processPinchGestureCancelled(quint32 time, KWin::LibInput::Device *device = nullptr);
 
+    /**
+     * The time between the kernel timestamps of the pointer motion events and the moment
+     * processMotion() handles them, in microseconds.
+     */
+    struct MotionLatency
+    {
+        quint64 events = 0;
+        quint64 last = 0;
+        quint64 total = 0;
+        quint64 maximum = 0;
+    };
+    MotionLatency motionLatency() const;
+
 private:
     void cleanupInternalWindow(QWindow *old, QWindow *now) override;
     void cleanupDecoration(Decoration::DecoratedClientImpl *old, Decoration::DecoratedClientImpl *now) override;
@@ -143,6 +189,7 @@ private:
     void updateOnStartMoveResize();
     void updateToReset();
     void updatePosition(const QPointF &pos);
+    QPointF confineToScreens(const QPointF &pos, const QPointF &current) const;
     void updateButton(uint32_t button, InputRedirection::PointerButtonState state);
     void warpXcbOnSurfaceLeft(KWaylandServer::SurfaceInterface *surface);
     QPointF applyPointerConfinement(const QPointF &pos) const;
@@ -165,6 +212,25 @@ private:
     bool m_confined = false;
     bool m_locked = false;
     bool m_enableConstraints = true;
+    MotionLatency m_motionLatency;
+
+    struct QueuedMotion
+    {
+        QPointF pos;
+        QSizeF delta;
+        QSizeF deltaNonAccelerated;
+        uint32_t time = 0;
+        quint64 timeUsec = 0;
+        QPointer<LibInput::Device> device;
+        QVector<MouseEvent::RelativeMotion> relativeMotions;
+    };
+    QueuedMotion m_queuedMotion;
+    QVector<MouseEvent::RelativeMotion> m_pendingRelativeMotions;
+    bool m_hasQueuedMotion = false;
+    bool m_coalesceMotion;
+    quint64 m_coalescedMotionEvents = 0;
+    QMetaObject::Connection m_motionFrameConnection;
+    QTimer m_motionTimer;
 };
 
 class WaylandCursorImage : public QObject
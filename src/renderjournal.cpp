@@ -6,11 +6,14 @@
 
 #include "renderjournal.h"
 
+#include <algorithm>
+
 namespace KWin
 {
 
 RenderJournal::RenderJournal()
 {
+    m_histogram.fill(0);
 }
 
 void RenderJournal::beginFrame()
@@ -25,6 +28,20 @@ void RenderJournal::endFrame()
         m_log.dequeue();
     }
     m_log.enqueue(duration);
+    addToHistogram(duration);
+}
+
+void RenderJournal::addToHistogram(std::chrono::nanoseconds duration)
+{
+    // Decay the old samples rather than discarding them so the estimate follows changes in
+    // the workload, e.g. a heavy effect being started, within a few dozens of frames.
+    for (qreal &weight : m_histogram) {
+        weight *= s_decay;
+    }
+    m_histogramWeight = m_histogramWeight * s_decay + 1;
+
+    const int bucket = std::clamp<int>(duration / s_bucketWidth, 0, s_bucketCount - 1);
+    m_histogram[bucket] += 1;
 }
 
 std::chrono::nanoseconds RenderJournal::minimum() const
@@ -53,4 +70,23 @@ std::chrono::nanoseconds RenderJournal::average() const
     return result / m_log.count();
 }
 
+std::chrono::nanoseconds RenderJournal::percentile(qreal percentile) const
+{
+    if (qFuzzyIsNull(m_histogramWeight)) {
+        return std::chrono::nanoseconds::zero();
+    }
+
+    const qreal threshold = m_histogramWeight * std::clamp(percentile, 0.0, 1.0);
+    qreal accumulated = 0;
+    for (int i = 0; i < s_bucketCount; ++i) {
+        accumulated += m_histogram[i];
+        if (accumulated >= threshold) {
+            // Report the upper bound of the bucket to err on the side of caution.
+            return s_bucketWidth * (i + 1);
+        }
+    }
+
+    return s_bucketWidth * s_bucketCount;
+}
+
 } // namespace KWin
@@ -11,6 +11,8 @@
 #include <QElapsedTimer>
 #include <QQueue>
 
+#include <array>
+
 namespace KWin
 {
 
@@ -48,10 +50,26 @@ public:
      */
     std::chrono::nanoseconds average() const;
 
+    /**
+     * Returns the estimated amount of time that it takes to render a single frame in the
+     * given @a percentile, e.g. 0.95 for the p95 render time. Unlike minimum(), maximum()
+     * and average(), the estimate is based on an exponentially decaying histogram of all
+     * frames rendered so far, recent frames having more weight than older ones.
+     */
+    std::chrono::nanoseconds percentile(qreal percentile) const;
+
 private:
+    void addToHistogram(std::chrono::nanoseconds duration);
+
     QElapsedTimer m_timer;
     QQueue<std::chrono::nanoseconds> m_log;
     int m_size = 15;
+
+    static constexpr std::chrono::nanoseconds s_bucketWidth = std::chrono::microseconds(100);
+    static constexpr int s_bucketCount = 256;
+    static constexpr qreal s_decay = 0.98;
+    std::array<qreal, s_bucketCount> m_histogram;
+    qreal m_histogramWeight = 0;
 };
 
 } // namespace KWin
@@ -5,6 +5,7 @@
 */
 
 #include "renderloop.h"
+#include "frametimingrecorder.h"
 #include "options.h"
 #include "renderloop_p.h"
 #include "utils.h"
@@ -52,8 +53,6 @@ void RenderLoopPrivate::scheduleRepaint()
     }
 
     // Estimate when it's a good time to perform the next compositing cycle.
-    const std::chrono::nanoseconds safetyMargin = std::chrono::milliseconds(3);
-
     std::chrono::nanoseconds renderTime;
     switch (options->latencyPolicy()) {
     case LatencyExteremelyLow:
@@ -83,9 +82,12 @@ void RenderLoopPrivate::scheduleRepaint()
     case RenderTimeEstimatorAverage:
         renderTime = std::max(renderTime, renderJournal.average());
         break;
+    case RenderTimeEstimatorPercentile:
+        renderTime = std::max(renderTime, renderJournal.percentile(0.95));
+        break;
     }
 
-    std::chrono::nanoseconds nextRenderTimestamp = nextPresentationTimestamp - renderTime - safetyMargin;
+    nextRenderTimestamp = nextPresentationTimestamp - renderTime - safetyMargin;
 
     // If we can't render the frame before the deadline, start compositing immediately.
     if (nextRenderTimestamp < currentTime) {
@@ -96,6 +98,28 @@ void RenderLoopPrivate::scheduleRepaint()
     compositeTimer.start(std::chrono::duration_cast<std::chrono::milliseconds>(waitInterval));
 }
 
+void RenderLoopPrivate::updateSafetyMargin(bool missed)
+{
+    // Only the percentile estimator learns the safety margin, the other estimators keep
+    // the fixed margin they have been tuned with.
+    if (options->renderTimeEstimator() != RenderTimeEstimatorPercentile) {
+        safetyMargin = std::chrono::milliseconds(3);
+        return;
+    }
+
+    const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / refreshRate);
+    const std::chrono::nanoseconds minimumMargin = std::chrono::milliseconds(1);
+    const std::chrono::nanoseconds maximumMargin = std::max(minimumMargin, vblankInterval / 2);
+
+    // Back off quickly after a missed vblank and slowly win the latency back afterwards.
+    if (missed) {
+        safetyMargin += std::chrono::milliseconds(1);
+    } else {
+        safetyMargin -= std::chrono::microseconds(10);
+    }
+    safetyMargin = std::clamp(safetyMargin, minimumMargin, maximumMargin);
+}
+
 void RenderLoopPrivate::delayScheduleRepaint()
 {
     pendingReschedule = true;
@@ -114,6 +138,10 @@ void RenderLoopPrivate::notifyFrameFailed()
     Q_ASSERT(pendingFrameCount > 0);
     pendingFrameCount--;
 
+    if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+        recorder->frameFailed(q);
+    }
+
     if (!inhibitCount) {
         maybeScheduleRepaint();
     }
@@ -126,6 +154,23 @@ void RenderLoopPrivate::notifyFrameCompleted(std::chrono::nanoseconds timestamp)
 
     if (lastPresentationTimestamp <= timestamp) {
         lastPresentationTimestamp = timestamp;
+
+        // With a fixed refresh rate, the frame is considered to have missed its vblank
+        // if it has been presented more than half a refresh cycle past the prediction.
+        bool missed = false;
+        if (presentMode == SyncMode::Fixed && nextPresentationTimestamp != std::chrono::nanoseconds::zero()) {
+            const std::chrono::nanoseconds vblankInterval(1'000'000'000'000ull / refreshRate);
+            missed = timestamp > nextPresentationTimestamp + vblankInterval / 2;
+        }
+        presentedFrameCount++;
+        if (missed) {
+            missedFrameCount++;
+        }
+        updateSafetyMargin(missed);
+
+        if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+            recorder->framePresented(q, timestamp);
+        }
     } else {
         qCWarning(KWIN_CORE, "Got invalid presentation timestamp: %ld (current %ld)",
                   timestamp.count(), lastPresentationTimestamp.count());
@@ -145,6 +190,7 @@ void RenderLoopPrivate::dispatch()
     // the Compositor starts repainting.
     pendingRepaint = true;
 
+    Q_EMIT q->frameAboutToBeRequested(q);
     Q_EMIT q->frameRequested(q);
 
     // The Compositor may decide to not repaint when the frameRequested() signal is
@@ -193,11 +239,19 @@ void RenderLoop::beginFrame()
     d->pendingRepaint = false;
     d->pendingFrameCount++;
     d->renderJournal.beginFrame();
+
+    if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+        recorder->beginFrame(this);
+    }
 }
 
 void RenderLoop::endFrame()
 {
     d->renderJournal.endFrame();
+
+    if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+        recorder->mark(FrameTimingRecorder::Phase::EndFrame);
+    }
 }
 
 int RenderLoop::refreshRate() const
@@ -219,6 +273,9 @@ void RenderLoop::scheduleRepaint()
     if (d->pendingRepaint) {
         return;
     }
+    if (FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder()) {
+        recorder->repaintRequested(this);
+    }
     if (!d->pendingFrameCount && !d->inhibitCount) {
         d->scheduleRepaint();
     } else {
@@ -236,6 +293,26 @@ std::chrono::nanoseconds RenderLoop::nextPresentationTimestamp() const
     return d->nextPresentationTimestamp;
 }
 
+std::chrono::nanoseconds RenderLoop::nextRenderTimestamp() const
+{
+    return d->nextRenderTimestamp;
+}
+
+std::chrono::nanoseconds RenderLoop::safetyMargin() const
+{
+    return d->safetyMargin;
+}
+
+quint64 RenderLoop::presentedFrameCount() const
+{
+    return d->presentedFrameCount;
+}
+
+quint64 RenderLoop::missedFrameCount() const
+{
+    return d->missedFrameCount;
+}
+
 void RenderLoop::setFullscreenSurface(SurfaceItem *surfaceItem)
 {
     d->hasFullscreenSurface = surfaceItem != nullptr;
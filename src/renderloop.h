@@ -86,6 +86,30 @@ public:
      */
     std::chrono::nanoseconds nextPresentationTimestamp() const;
 
+    /**
+     * If a repaint has been scheduled, this function returns the time when the compositing
+     * cycle for the next frame is going to be started, i.e. the render deadline that has
+     * been picked for the next frame. The returned timestamp is sourced from the monotonic
+     * clock.
+     */
+    std::chrono::nanoseconds nextRenderTimestamp() const;
+
+    /**
+     * Returns the amount of time that is reserved on top of the estimated render time
+     * when scheduling the next frame.
+     */
+    std::chrono::nanoseconds safetyMargin() const;
+
+    /**
+     * Returns the number of frames that have been presented on the screen.
+     */
+    quint64 presentedFrameCount() const;
+
+    /**
+     * Returns the number of presented frames that have missed their predicted vblank.
+     */
+    quint64 missedFrameCount() const;
+
     /**
      * Sets the surface that currently gets scanned out,
      * so that this RenderLoop can adjust its timing behavior to that surface
@@ -127,6 +151,15 @@ Q_SIGNALS:
      */
     void frameRequested(RenderLoop *loop);
 
+    /**
+     * This signal is emitted right before the frameRequested() signal. The state that is
+     * updated once per frame, e.g. the coalesced pointer motion, has to be updated now, so
+     * it is shown in the frame.
+     *
+     * Repaints scheduled while this signal is emitted are painted in the requested frame.
+     */
+    void frameAboutToBeRequested(RenderLoop *loop);
+
 private:
     QScopedPointer<RenderLoopPrivate> d;
     friend class RenderLoopPrivate;
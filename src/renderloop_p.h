@@ -29,15 +29,20 @@ public:
 
     void notifyFrameFailed();
     void notifyFrameCompleted(std::chrono::nanoseconds timestamp);
+    void updateSafetyMargin(bool missed);
 
     RenderLoop *q;
     std::chrono::nanoseconds lastPresentationTimestamp = std::chrono::nanoseconds::zero();
     std::chrono::nanoseconds nextPresentationTimestamp = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds nextRenderTimestamp = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds safetyMargin = std::chrono::milliseconds(3);
     QTimer compositeTimer;
     RenderJournal renderJournal;
     int refreshRate = 60000;
     int pendingFrameCount = 0;
     int inhibitCount = 0;
+    quint64 presentedFrameCount = 0;
+    quint64 missedFrameCount = 0;
     bool pendingReschedule = false;
     bool pendingRepaint = false;
     RenderLoop::VrrPolicy vrrPolicy = RenderLoop::VrrPolicy::Never;
@@ -127,6 +127,10 @@ void Rules::readFromSettings(const RuleSettings *settings)
     READ_MATCH_STRING(windowrole, .toLower().toLatin1());
     READ_MATCH_STRING(title,);
     READ_MATCH_STRING(clientmachine, .toLower().toLatin1());
+    wmclassregexp = compileMatchExpression(QString::fromUtf8(wmclass), wmclassmatch);
+    windowroleregexp = compileMatchExpression(QString::fromUtf8(windowrole), windowrolematch);
+    titleregexp = compileMatchExpression(title, titlematch);
+    clientmachineregexp = compileMatchExpression(QString::fromUtf8(clientmachine), clientmachinematch);
     types = NET::WindowTypeMask(settings->types());
     READ_FORCE_RULE(placement,);
     READ_SET_RULE(position);
@@ -321,6 +325,17 @@ QString Rules::getDecoColor(const QString &themeName)
                                   QLatin1String("color-schemes/") + themeName + QLatin1String(".colors"));
 }
 
+QRegularExpression Rules::compileMatchExpression(const QString &pattern, StringMatch match)
+{
+    if (match != RegExpMatch) {
+        return QRegularExpression();
+    }
+    // The rules are matched whenever the title of a window changes, compile the expression once
+    QRegularExpression expression(pattern);
+    expression.optimize();
+    return expression;
+}
+
 bool Rules::matchType(NET::WindowType match_type) const
 {
     if (types != NET::AllTypesMask) {
@@ -335,10 +350,9 @@ bool Rules::matchType(NET::WindowType match_type) const
 bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_name) const
 {
     if (wmclassmatch != UnimportantMatch) {
-        // TODO optimize?
         QByteArray cwmclass = wmclasscomplete
                               ? match_name + ' ' + match_class : match_class;
-        if (wmclassmatch == RegExpMatch && !QRegularExpression(QString::fromUtf8(wmclass)).match(QString::fromUtf8(cwmclass)).hasMatch())
+        if (wmclassmatch == RegExpMatch && !wmclassregexp.match(QString::fromUtf8(cwmclass)).hasMatch())
             return false;
         if (wmclassmatch == ExactMatch && wmclass != cwmclass)
             return false;
@@ -351,7 +365,7 @@ bool Rules::matchWMClass(const QByteArray& match_class, const QByteArray& match_
 bool Rules::matchRole(const QByteArray& match_role) const
 {
     if (windowrolematch != UnimportantMatch) {
-        if (windowrolematch == RegExpMatch && !QRegularExpression(QString::fromUtf8(windowrole)).match(QString::fromUtf8(match_role)).hasMatch())
+        if (windowrolematch == RegExpMatch && !windowroleregexp.match(QString::fromUtf8(match_role)).hasMatch())
             return false;
         if (windowrolematch == ExactMatch && windowrole != match_role)
             return false;
@@ -364,7 +378,7 @@ bool Rules::matchRole(const QByteArray& match_role) const
 bool Rules::matchTitle(const QString& match_title) const
 {
     if (titlematch != UnimportantMatch) {
-        if (titlematch == RegExpMatch && !QRegularExpression(title).match(match_title).hasMatch())
+        if (titlematch == RegExpMatch && !titleregexp.match(match_title).hasMatch())
             return false;
         if (titlematch == ExactMatch && title != match_title)
             return false;
@@ -382,7 +396,7 @@ bool Rules::matchClientMachine(const QByteArray& match_machine, bool local) cons
                 && matchClientMachine("localhost", true))
             return true;
         if (clientmachinematch == RegExpMatch
-                && !QRegularExpression(QString::fromUtf8(clientmachine)).match(QString::fromUtf8(match_machine)).hasMatch())
+                && !clientmachineregexp.match(QString::fromUtf8(match_machine)).hasMatch())
             return false;
         if (clientmachinematch == ExactMatch
                 && clientmachine != match_machine)
@@ -396,6 +410,11 @@ bool Rules::matchClientMachine(const QByteArray& match_machine, bool local) cons
 
 #ifndef KCMRULES
 bool Rules::match(const AbstractClient* c) const
+{
+    return matchProperties(c) && matchCaption(c);
+}
+
+bool Rules::matchProperties(const AbstractClient* c) const
 {
     if (!matchType(c->windowType(true)))
         return false;
@@ -405,6 +424,11 @@ bool Rules::match(const AbstractClient* c) const
         return false;
     if (!matchClientMachine(c->clientMachine()->hostName(), c->clientMachine()->isLocal()))
         return false;
+    return true;
+}
+
+bool Rules::matchCaption(const AbstractClient* c) const
+{
     if (titlematch != UnimportantMatch) // track title changes to rematch rules
         QObject::connect(c, &AbstractClient::captionChanged, c, &AbstractClient::evaluateWindowRules,
                          // QueuedConnection, because title may change before
@@ -636,6 +660,14 @@ APPLY_RULE(desktopfile, DesktopFile, QString)
 #undef APPLY_RULE
 #undef APPLY_FORCE_RULE
 
+QByteArray Rules::exactWMClass() const
+{
+    if (wmclassmatch != ExactMatch) {
+        return QByteArray();
+    }
+    return wmclass;
+}
+
 bool Rules::isTemporary() const
 {
     return temporary_state > 0;
@@ -941,6 +973,7 @@ RuleBook::RuleBook(QObject *parent)
     , m_updateTimer(new QTimer(this))
     , m_updatesDisabled(false)
     , m_temporaryRulesMessages()
+    , m_matchCacheEnabled(qgetenv("KWIN_WINDOW_RULES_CACHE") != "0")
 {
     initializeX11();
     connect(kwinApp(), &Application::x11ConnectionChanged, this, &RuleBook::initializeX11);
@@ -975,29 +1008,142 @@ void RuleBook::deleteAll()
 {
     qDeleteAll(m_rules);
     m_rules.clear();
+    rulesChanged();
+}
+
+void RuleBook::rulesChanged()
+{
+    m_indexDirty = true;
+    ++m_generation;
+}
+
+bool RuleBook::isMatchCacheEnabled() const
+{
+    return m_matchCacheEnabled;
+}
+
+void RuleBook::setMatchCacheEnabled(bool enabled)
+{
+    m_matchCacheEnabled = enabled;
+    m_matchCache.clear();
+}
+
+QVector<Rules *> RuleBook::candidateRules(const AbstractClient *c)
+{
+    if (m_indexDirty) {
+        m_wmclassIndex.clear();
+        m_unindexedRules.clear();
+        for (int i = 0; i < m_rules.count(); ++i) {
+            const QByteArray wmclass = m_rules[i]->exactWMClass();
+            if (wmclass.isEmpty()) {
+                m_unindexedRules.append(i);
+            } else {
+                m_wmclassIndex[wmclass].append(i);
+            }
+        }
+        m_indexDirty = false;
+    }
+
+    // the rules matching the complete window class are indexed by the name and the class
+    QVector<int> positions = m_unindexedRules;
+    positions += m_wmclassIndex.value(c->resourceClass());
+    positions += m_wmclassIndex.value(c->resourceName() + ' ' + c->resourceClass());
+    std::sort(positions.begin(), positions.end());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+
+    QVector<Rules *> candidates;
+    candidates.reserve(positions.count());
+    for (int position : qAsConst(positions)) {
+        candidates.append(m_rules[position]);
+    }
+    return candidates;
+}
+
+QVector<Rules *> RuleBook::propertyMatches(const AbstractClient *c)
+{
+    const NET::WindowType windowType = c->windowType(true);
+    const QByteArray windowRole = c->windowRole().toLower();
+    const QByteArray hostName = c->clientMachine()->hostName();
+    const bool local = c->clientMachine()->isLocal();
+
+    auto it = m_matchCache.find(c);
+    if (it != m_matchCache.end()
+            && it->generation == m_generation
+            && it->windowType == windowType
+            && it->resourceClass == c->resourceClass()
+            && it->resourceName == c->resourceName()
+            && it->windowRole == windowRole
+            && it->hostName == hostName
+            && it->local == local) {
+        return it->rules;
+    }
+
+    if (it == m_matchCache.end()) {
+        it = m_matchCache.insert(c, MatchCache());
+        connect(c, &QObject::destroyed, this, [this, c]() {
+            m_matchCache.remove(c);
+        });
+    }
+    it->generation = m_generation;
+    it->windowType = windowType;
+    it->resourceClass = c->resourceClass();
+    it->resourceName = c->resourceName();
+    it->windowRole = windowRole;
+    it->hostName = hostName;
+    it->local = local;
+    it->rules.clear();
+    const QVector<Rules *> candidates = candidateRules(c);
+    for (Rules *rule : candidates) {
+        if (rule->matchProperties(c)) {
+            it->rules.append(rule);
+        }
+    }
+    return it->rules;
 }
 
 WindowRules RuleBook::find(const AbstractClient* c, bool ignore_temporary)
 {
     QVector< Rules* > ret;
-    for (QList< Rules* >::Iterator it = m_rules.begin();
-            it != m_rules.end();
-       ) {
-        if (ignore_temporary && (*it)->isTemporary()) {
+    if (!m_matchCacheEnabled) {
+        for (QList< Rules* >::Iterator it = m_rules.begin();
+                it != m_rules.end();
+           ) {
+            if (ignore_temporary && (*it)->isTemporary()) {
+                ++it;
+                continue;
+            }
+            if ((*it)->match(c)) {
+                Rules* rule = *it;
+                qCDebug(KWIN_CORE) << "Rule found:" << rule << ":" << c;
+                if (rule->isTemporary()) {
+                    it = m_rules.erase(it);
+                    rulesChanged();
+                } else {
+                    ++it;
+                }
+                ret.append(rule);
+                continue;
+            }
             ++it;
+        }
+        return WindowRules(ret);
+    }
+
+    // Only the caption is matched again if none of the other properties of the window
+    // has changed, windows change their caption much more often.
+    const QVector<Rules *> matches = propertyMatches(c);
+    for (Rules *rule : matches) {
+        if (ignore_temporary && rule->isTemporary()) {
             continue;
         }
-        if ((*it)->match(c)) {
-            Rules* rule = *it;
+        if (rule->matchCaption(c)) {
             qCDebug(KWIN_CORE) << "Rule found:" << rule << ":" << c;
-            if (rule->isTemporary())
-                it = m_rules.erase(it);
-            else
-                ++it;
+            if (rule->isTemporary()) {
+                m_rules.removeOne(rule);
+                rulesChanged();
+            }
             ret.append(rule);
-            continue;
         }
-        ++it;
     }
     return WindowRules(ret);
 }
@@ -1035,6 +1181,7 @@ void RuleBook::load()
     RuleBookSettings book(m_config);
     book.load();
     m_rules = book.rules().toList();
+    rulesChanged();
 }
 
 void RuleBook::save()
@@ -1065,6 +1212,7 @@ void RuleBook::temporaryRulesMessage(const QString& message)
             was_temporary = true;
     Rules* rule = new Rules(message, true);
     m_rules.prepend(rule);   // highest priority first
+    rulesChanged();
     if (!was_temporary)
         QTimer::singleShot(60000, this, &RuleBook::cleanupTemporaryRules);
 }
@@ -1077,6 +1225,7 @@ void RuleBook::cleanupTemporaryRules()
        ) {
         if ((*it)->discardTemporary(false)) { // deletes (*it)
             it = m_rules.erase(it);
+            rulesChanged();
         } else {
             if ((*it)->isTemporary())
                 has_temporary = true;
@@ -1101,6 +1250,7 @@ void RuleBook::discardUsed(AbstractClient* c, bool withdrawn)
                 c->removeRule(*it);
                 Rules* r = *it;
                 it = m_rules.erase(it);
+                rulesChanged();
                 delete r;
                 continue;
             }
@@ -12,7 +12,9 @@
 
 
 #include <netwm_def.h>
+#include <QHash>
 #include <QRect>
+#include <QRegularExpression>
 #include <QVector>
 
 #include "placement.h"
@@ -134,6 +136,11 @@ public:
 #ifndef KCMRULES
     bool discardUsed(bool withdrawn);
     bool match(const AbstractClient* c) const;
+    // match() split in the properties of a window that rarely change and its caption
+    bool matchProperties(const AbstractClient* c) const;
+    bool matchCaption(const AbstractClient* c) const;
+    // the window class a window must have to match, empty if the rule matches other classes too
+    QByteArray exactWMClass() const;
     bool update(AbstractClient*, int selection);
     bool isTemporary() const;
     bool discardTemporary(bool force);   // removes if temporary and forced or too old
@@ -184,6 +191,7 @@ private:
     bool matchClientMachine(const QByteArray& match_machine, bool local) const;
     void readFromSettings(const RuleSettings *settings);
     static ForceRule convertForceRule(int v);
+    static QRegularExpression compileMatchExpression(const QString &pattern, StringMatch match);
     static QString getDecoColor(const QString &themeName);
 #ifndef KCMRULES
     static bool checkSetRule(SetRule rule, bool init);
@@ -202,6 +210,10 @@ private:
     StringMatch titlematch;
     QByteArray clientmachine;
     StringMatch clientmachinematch;
+    QRegularExpression wmclassregexp;
+    QRegularExpression windowroleregexp;
+    QRegularExpression titleregexp;
+    QRegularExpression clientmachineregexp;
     NET::WindowTypes types; // types for matching
     Placement::Policy placement;
     ForceRule placementrule;
@@ -292,6 +304,14 @@ public:
     void edit(AbstractClient* c, bool whole_app);
     void requestDiskStorage();
 
+    /**
+     * Returns @c false if the rules are matched against every window without looking them up
+     * by the window class and without remembering the matches, which can be forced with
+     * KWIN_WINDOW_RULES_CACHE=0.
+     */
+    bool isMatchCacheEnabled() const;
+    void setMatchCacheEnabled(bool enabled);
+
     void setConfig(const KSharedConfig::Ptr &config) {
         m_config = config;
     }
@@ -302,12 +322,35 @@ private Q_SLOTS:
     void save();
 
 private:
+    struct MatchCache
+    {
+        quint64 generation = 0;
+        NET::WindowType windowType = NET::Unknown;
+        QByteArray resourceClass;
+        QByteArray resourceName;
+        QByteArray windowRole;
+        QByteArray hostName;
+        bool local = false;
+        QVector<Rules *> rules;
+    };
+
     void deleteAll();
     void initializeX11();
     void cleanupX11();
+    void rulesChanged();
+    QVector<Rules *> candidateRules(const AbstractClient *c);
+    QVector<Rules *> propertyMatches(const AbstractClient *c);
     QTimer *m_updateTimer;
     bool m_updatesDisabled;
     QList<Rules*> m_rules;
+    // Positions in m_rules of the rules matching only one window class, and of all other rules.
+    QHash<QByteArray, QVector<int>> m_wmclassIndex;
+    QVector<int> m_unindexedRules;
+    bool m_indexDirty = true;
+    // Bumped whenever rules are added or removed, the cached matches of older generations are stale.
+    quint64 m_generation = 1;
+    QHash<const AbstractClient *, MatchCache> m_matchCache;
+    bool m_matchCacheEnabled;
     QScopedPointer<KXMessages> m_temporaryRulesMessages;
     KSharedConfig::Ptr m_config;
 
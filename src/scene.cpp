@@ -54,6 +54,7 @@
 
 #include "scene.h"
 #include "abstract_output.h"
+#include "frametimingrecorder.h"
 #include "internal_client.h"
 #include "platform.h"
 #include "shadowitem.h"
@@ -64,6 +65,7 @@
 #include "x11client.h"
 
 #include <QQuickWindow>
+#include <QScopeGuard>
 #include <QVector2D>
 
 #include "x11client.h"
@@ -76,6 +78,8 @@
 #include "composite.h"
 #include <QtMath>
 
+#include <algorithm>
+
 namespace KWin
 {
 
@@ -86,7 +90,13 @@ namespace KWin
 Scene::Scene(QObject *parent)
     : QObject(parent)
 {
-    connect(kwinApp()->platform(), &Platform::outputDisabled, this, &Scene::removeRepaints);
+    connect(kwinApp()->platform(), &Platform::outputEnabled, this, &Scene::handleOutputEnabled);
+    connect(kwinApp()->platform(), &Platform::outputDisabled, this, &Scene::handleOutputDisabled);
+
+    const QVector<AbstractOutput *> outputs = kwinApp()->platform()->enabledOutputs();
+    for (AbstractOutput *output : outputs) {
+        connect(output, &AbstractOutput::geometryChanged, this, &Scene::updateWindowOutputs);
+    }
 }
 
 Scene::~Scene()
@@ -126,6 +136,26 @@ void Scene::removeRepaints(AbstractOutput *output)
     m_repaints.remove(output);
 }
 
+void Scene::handleOutputEnabled(AbstractOutput *output)
+{
+    connect(output, &AbstractOutput::geometryChanged, this, &Scene::updateWindowOutputs);
+    updateWindowOutputs();
+}
+
+void Scene::handleOutputDisabled(AbstractOutput *output)
+{
+    disconnect(output, &AbstractOutput::geometryChanged, this, &Scene::updateWindowOutputs);
+    removeRepaints(output);
+    updateWindowOutputs();
+}
+
+void Scene::updateWindowOutputs()
+{
+    for (Window *window : qAsConst(m_windows)) {
+        window->updateOutputs();
+    }
+}
+
 
 QMatrix4x4 Scene::createProjectionMatrix(const QRect &rect)
 {
@@ -182,6 +212,11 @@ void Scene::paintScreen(const QRegion &damage, const QRegion &repaint,
         m_expectedPresentTimestamp = presentTime;
     }
 
+    FrameTimingRecorder *recorder = FrameTimingRecorder::activeRecorder();
+    if (recorder) {
+        recorder->mark(FrameTimingRecorder::Phase::PrePaintBegin);
+    }
+
     // preparation step
     static_cast<EffectsHandlerImpl*>(effects)->startPaint();
 
@@ -210,19 +245,39 @@ void Scene::paintScreen(const QRegion &damage, const QRegion &repaint,
         region = displayRegion;
     }
 
+    // Windows that don't intersect the screen can be skipped entirely, unless they may
+    // be painted elsewhere because of transformations.
+    if (!(mask & (PAINT_SCREEN_TRANSFORMED | PAINT_SCREEN_WITH_TRANSFORMED_WINDOWS))
+            && !static_cast<EffectsHandlerImpl *>(effects)->needsAllWindows()) {
+        cullStackingOrder();
+    }
+
     painted_region = region;
     repaint_region = repaint;
 
+    if (recorder) {
+        recorder->mark(FrameTimingRecorder::Phase::PaintBegin);
+    }
+
     ScreenPaintData data(projection, screen);
     effects->paintScreen(mask, region, data);
 
     Q_EMIT frameRendered();
 
+    if (recorder) {
+        recorder->mark(FrameTimingRecorder::Phase::PostPaintBegin);
+    }
+
     Q_FOREACH (Window *w, stacking_order) {
         effects->postPaintWindow(effectWindow(w));
     }
 
     effects->postPaintScreen();
+    static_cast<EffectsHandlerImpl*>(effects)->endPaint();
+
+    if (recorder) {
+        recorder->mark(FrameTimingRecorder::Phase::PostPaintEnd);
+    }
 
     // make sure not to go outside of the screen area
     *updateRegion = damaged_region;
@@ -385,38 +440,25 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
         fullRepaint = (dirtyArea == displayRegion);
     }
 
-    QRegion allclips, upperTranslucentDamage;
-    upperTranslucentDamage = repaint_region;
+    // The culler keeps its state between the culling and the painting pass, so painting
+    // the screen again while painting windows must not reuse the same culler.
+    if (m_occlusionCullerDepth == int(m_occlusionCullers.size())) {
+        m_occlusionCullers.push_back(std::make_unique<OcclusionCuller>());
+    }
+    OcclusionCuller &occlusionCuller = *m_occlusionCullers[m_occlusionCullerDepth++];
+    auto cullerGuard = qScopeGuard([this]() {
+        m_occlusionCullerDepth--;
+    });
 
     // This is the occlusion culling pass
+    occlusionCuller.begin(phase2data.count(), fullRepaint, displayRegion, repaint_region);
     for (int i = phase2data.count() - 1; i >= 0; --i) {
-        Phase2Data *data = &phase2data[i];
-
-        if (fullRepaint) {
-            data->region = displayRegion;
-        } else {
-            data->region |= upperTranslucentDamage;
-        }
-
-        // subtract the parts which will possibly been drawn as part of
-        // a higher opaque window
-        data->region -= allclips;
-
+        const Phase2Data &data = phase2data[i];
         // Here we rely on WindowPrePaintData::setTranslucent() to remove
         // the clip if needed.
-        if (!data->clip.isEmpty() && !(data->mask & PAINT_WINDOW_TRANSLUCENT)) {
-            // clip away the opaque regions for all windows below this one
-            allclips |= data->clip;
-            // extend the translucent damage for windows below this by remaining (translucent) regions
-            if (!fullRepaint) {
-                upperTranslucentDamage |= data->region - data->clip;
-            }
-        } else if (!fullRepaint) {
-            upperTranslucentDamage |= data->region;
-        }
+        occlusionCuller.cullWindow(i, data.region, data.clip, data.mask & PAINT_WINDOW_TRANSLUCENT);
     }
 
-    QRegion paintedArea;
     // Fill any areas of the root window not covered by opaque windows
     if (m_paintScreenCount == 1) {
         aboutToStartPainting(painted_screen, dirtyArea);
@@ -426,21 +468,22 @@ void Scene::paintSimpleScreen(int orig_mask, const QRegion &region)
         }
     }
     if (!(orig_mask & PAINT_SCREEN_BACKGROUND_FIRST)) {
-        paintedArea = dirtyArea - allclips;
-        paintBackground(paintedArea);
+        const QRegion background = occlusionCuller.exposedRegion(dirtyArea);
+        occlusionCuller.beginPainting(background);
+        paintBackground(background);
+    } else {
+        occlusionCuller.beginPainting(QRegion());
     }
 
-    // Now walk the list bottom to top and draw the windows.
+    // Now walk the list bottom to top and draw the windows. Each window is painted
+    // in all regions which have been drawn so far.
     for (int i = 0; i < phase2data.count(); ++i) {
         Phase2Data *data = &phase2data[i];
-
-        // add all regions which have been drawn so far
-        paintedArea |= data->region;
-        data->region = paintedArea;
-
+        data->region = occlusionCuller.paintWindow(i);
         paintWindow(data->window, data->mask, data->region);
     }
 
+    const QRegion paintedArea = occlusionCuller.paintedArea();
     if (fullRepaint) {
         painted_region = displayRegion;
         damaged_region = displayRegion - repaintClip;
@@ -506,6 +549,18 @@ void Scene::clearStackingOrder()
     stacking_order.clear();
 }
 
+void Scene::cullStackingOrder()
+{
+    if (!painted_screen) {
+        return;
+    }
+    // Item repaints are tracked per output and only scheduled on the outputs that the
+    // item intersects, so the windows which are dropped here have nothing to repaint.
+    stacking_order.erase(std::remove_if(stacking_order.begin(), stacking_order.end(), [this](Window *window) {
+        return !window->isOnOutput(painted_screen);
+    }), stacking_order.end());
+}
+
 void Scene::paintWindow(Window* w, int mask, const QRegion &_region)
 {
     // no painting outside visible screen (and no transformations)
@@ -577,6 +632,21 @@ QPainter *Scene::scenePainter() const
     return nullptr;
 }
 
+QString Scene::supportInformation() const
+{
+    return QString();
+}
+
+const Scene::ItemCacheStatistics &Scene::itemCacheStatistics() const
+{
+    return m_itemCacheStatistics;
+}
+
+Scene::ItemCacheStatistics &Scene::itemCacheStatistics()
+{
+    return m_itemCacheStatistics;
+}
+
 QImage *Scene::qpainterRenderBuffer(AbstractOutput *output) const
 {
     Q_UNUSED(output)
@@ -627,6 +697,10 @@ Scene::Window::Window(Toplevel *client, QObject *parent)
 
     connect(toplevel, &Toplevel::frameGeometryChanged, this, &Window::updateWindowPosition);
     updateWindowPosition();
+
+    connect(m_windowItem.data(), &WindowItem::positionChanged, this, &Window::updateOutputs);
+    connect(m_windowItem.data(), &WindowItem::boundingRectChanged, this, &Window::updateOutputs);
+    updateOutputs();
 }
 
 Scene::Window::~Window()
@@ -755,6 +829,24 @@ void Scene::Window::updateWindowPosition()
     m_windowItem->setPosition(pos());
 }
 
+bool Scene::Window::isOnOutput(AbstractOutput *output) const
+{
+    return m_outputs.contains(output);
+}
+
+void Scene::Window::updateOutputs()
+{
+    const QRect visibleGeometry = m_windowItem->mapToGlobal(m_windowItem->boundingRect());
+
+    m_outputs.clear();
+    const QVector<AbstractOutput *> outputs = kwinApp()->platform()->enabledOutputs();
+    for (AbstractOutput *output : outputs) {
+        if (output->geometry().intersects(visibleGeometry)) {
+            m_outputs.append(output);
+        }
+    }
+}
+
 //****************************************
 // Scene::EffectFrame
 //****************************************
@@ -10,6 +10,7 @@
 #ifndef KWIN_SCENE_H
 #define KWIN_SCENE_H
 
+#include "occlusionculler.h"
 #include "toplevel.h"
 #include "utils.h"
 #include "kwineffects.h"
@@ -17,6 +18,8 @@
 #include <QElapsedTimer>
 #include <QMatrix4x4>
 
+#include <memory>
+
 namespace KWin
 {
 
@@ -164,6 +167,26 @@ public:
      */
     virtual QImage *qpainterRenderBuffer(AbstractOutput *output) const;
 
+    /**
+     * Returns scene specific information to be included in the support information.
+     * Default implementation returns an empty string.
+     */
+    virtual QString supportInformation() const;
+
+    /**
+     * How often the scene could reuse the clipped quads and the transforms of items that it
+     * computed in an earlier frame, and how often it had to compute them again.
+     */
+    struct ItemCacheStatistics
+    {
+        quint64 clippedQuadsHits = 0;
+        quint64 clippedQuadsMisses = 0;
+        quint64 transformHits = 0;
+        quint64 transformMisses = 0;
+    };
+    const ItemCacheStatistics &itemCacheStatistics() const;
+    ItemCacheStatistics &itemCacheStatistics();
+
     /**
      * The backend specific extensions (e.g. EGL/GLX extensions).
      *
@@ -197,6 +220,8 @@ protected:
     virtual Window *createWindow(Toplevel *toplevel) = 0;
     void createStackingOrder(const QList<Toplevel *> &toplevels);
     void clearStackingOrder();
+    // drops the windows that don't intersect the painted screen from the stacking order
+    void cullStackingOrder();
     // shared implementation, starts painting the screen
     void paintScreen(const QRegion &damage, const QRegion &repaint,
                      QRegion *updateRegion, QRegion *validRegion, RenderLoop *renderLoop,
@@ -256,9 +281,15 @@ protected:
     QVector< Window* > stacking_order;
 private:
     void removeRepaints(AbstractOutput *output);
+    void handleOutputEnabled(AbstractOutput *output);
+    void handleOutputDisabled(AbstractOutput *output);
+    void updateWindowOutputs();
     std::chrono::milliseconds m_expectedPresentTimestamp = std::chrono::milliseconds::zero();
     QHash< Toplevel*, Window* > m_windows;
     QMap<AbstractOutput *, QRegion> m_repaints;
+    std::vector<std::unique_ptr<OcclusionCuller>> m_occlusionCullers;
+    int m_occlusionCullerDepth = 0;
+    ItemCacheStatistics m_itemCacheStatistics;
     // how many times finalPaintScreen() has been called
     int m_paintScreenCount = 0;
 };
@@ -324,6 +355,9 @@ public:
     bool isVisible() const;
     // is the window fully opaque
     bool isOpaque() const;
+    // does the visible geometry of the window intersect the given output
+    bool isOnOutput(AbstractOutput *output) const;
+    void updateOutputs();
     QRegion decorationShape() const;
     void updateToplevel(Deleted *deleted);
     void referencePreviousPixmap();
@@ -346,6 +380,7 @@ private:
 
     int disable_painting;
     QScopedPointer<WindowItem> m_windowItem;
+    QVector<AbstractOutput *> m_outputs;
     Q_DISABLE_COPY(Window)
 };
 
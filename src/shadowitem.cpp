@@ -78,11 +78,11 @@ static inline void distributeVertically(QRectF &topRect, QRectF &bottomRect)
     }
 }
 
-WindowQuadList ShadowItem::buildQuads() const
+RenderQuadList ShadowItem::buildQuads() const
 {
     // Do not draw shadows if window width or window height is less than 5 px. 5 is an arbitrary choice.
     if (!m_window->wantsShadowToBeRendered() || m_window->width() < 5 || m_window->height() < 5) {
-        return WindowQuadList();
+        return RenderQuadList();
     }
 
     const QSizeF top(m_shadow->elementSize(Shadow::ShadowElementTop));
@@ -158,7 +158,7 @@ WindowQuadList ShadowItem::buildQuads() const
           ty1 = 0.0,
           ty2 = 0.0;
 
-    WindowQuadList quads;
+    RenderQuadList quads;
     quads.reserve(8);
 
     if (topLeftRect.isValid()) {
@@ -166,12 +166,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = 0.0;
         tx2 = topLeftRect.width() / width;
         ty2 = topLeftRect.height() / height;
-        WindowQuad topLeftQuad;
-        topLeftQuad[0] = WindowVertex(topLeftRect.left(),  topLeftRect.top(),    tx1, ty1);
-        topLeftQuad[1] = WindowVertex(topLeftRect.right(), topLeftRect.top(),    tx2, ty1);
-        topLeftQuad[2] = WindowVertex(topLeftRect.right(), topLeftRect.bottom(), tx2, ty2);
-        topLeftQuad[3] = WindowVertex(topLeftRect.left(),  topLeftRect.bottom(), tx1, ty2);
-        quads.append(topLeftQuad);
+        quads.append(topLeftRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (topRightRect.isValid()) {
@@ -179,12 +175,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = 0.0;
         tx2 = 1.0;
         ty2 = topRightRect.height() / height;
-        WindowQuad topRightQuad;
-        topRightQuad[0] = WindowVertex(topRightRect.left(),  topRightRect.top(),    tx1, ty1);
-        topRightQuad[1] = WindowVertex(topRightRect.right(), topRightRect.top(),    tx2, ty1);
-        topRightQuad[2] = WindowVertex(topRightRect.right(), topRightRect.bottom(), tx2, ty2);
-        topRightQuad[3] = WindowVertex(topRightRect.left(),  topRightRect.bottom(), tx1, ty2);
-        quads.append(topRightQuad);
+        quads.append(topRightRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (bottomRightRect.isValid()) {
@@ -192,12 +184,8 @@ WindowQuadList ShadowItem::buildQuads() const
         tx2 = 1.0;
         ty1 = 1.0 - bottomRightRect.height() / height;
         ty2 = 1.0;
-        WindowQuad bottomRightQuad;
-        bottomRightQuad[0] = WindowVertex(bottomRightRect.left(),  bottomRightRect.top(),    tx1, ty1);
-        bottomRightQuad[1] = WindowVertex(bottomRightRect.right(), bottomRightRect.top(),    tx2, ty1);
-        bottomRightQuad[2] = WindowVertex(bottomRightRect.right(), bottomRightRect.bottom(), tx2, ty2);
-        bottomRightQuad[3] = WindowVertex(bottomRightRect.left(),  bottomRightRect.bottom(), tx1, ty2);
-        quads.append(bottomRightQuad);
+        quads.append(bottomRightRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (bottomLeftRect.isValid()) {
@@ -205,12 +193,8 @@ WindowQuadList ShadowItem::buildQuads() const
         tx2 = bottomLeftRect.width() / width;
         ty1 = 1.0 - bottomLeftRect.height() / height;
         ty2 = 1.0;
-        WindowQuad bottomLeftQuad;
-        bottomLeftQuad[0] = WindowVertex(bottomLeftRect.left(),  bottomLeftRect.top(),    tx1, ty1);
-        bottomLeftQuad[1] = WindowVertex(bottomLeftRect.right(), bottomLeftRect.top(),    tx2, ty1);
-        bottomLeftQuad[2] = WindowVertex(bottomLeftRect.right(), bottomLeftRect.bottom(), tx2, ty2);
-        bottomLeftQuad[3] = WindowVertex(bottomLeftRect.left(),  bottomLeftRect.bottom(), tx1, ty2);
-        quads.append(bottomLeftQuad);
+        quads.append(bottomLeftRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     QRectF topRect(QPointF(topLeftRect.right(), outerRect.top()),
@@ -238,12 +222,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = 0.0;
         tx2 = tx1 + top.width() / width;
         ty2 = topRect.height() / height;
-        WindowQuad topQuad;
-        topQuad[0] = WindowVertex(topRect.left(),  topRect.top(),    tx1, ty1);
-        topQuad[1] = WindowVertex(topRect.right(), topRect.top(),    tx2, ty1);
-        topQuad[2] = WindowVertex(topRect.right(), topRect.bottom(), tx2, ty2);
-        topQuad[3] = WindowVertex(topRect.left(),  topRect.bottom(), tx1, ty2);
-        quads.append(topQuad);
+        quads.append(topRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (rightRect.isValid()) {
@@ -251,12 +231,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = shadowMargins.top() / height;
         tx2 = 1.0;
         ty2 = ty1 + right.height() / height;
-        WindowQuad rightQuad;
-        rightQuad[0] = WindowVertex(rightRect.left(),  rightRect.top(),    tx1, ty1);
-        rightQuad[1] = WindowVertex(rightRect.right(), rightRect.top(),    tx2, ty1);
-        rightQuad[2] = WindowVertex(rightRect.right(), rightRect.bottom(), tx2, ty2);
-        rightQuad[3] = WindowVertex(rightRect.left(),  rightRect.bottom(), tx1, ty2);
-        quads.append(rightQuad);
+        quads.append(rightRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (bottomRect.isValid()) {
@@ -264,12 +240,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = 1.0 - bottomRect.height() / height;
         tx2 = tx1 + bottom.width() / width;
         ty2 = 1.0;
-        WindowQuad bottomQuad;
-        bottomQuad[0] = WindowVertex(bottomRect.left(),  bottomRect.top(),    tx1, ty1);
-        bottomQuad[1] = WindowVertex(bottomRect.right(), bottomRect.top(),    tx2, ty1);
-        bottomQuad[2] = WindowVertex(bottomRect.right(), bottomRect.bottom(), tx2, ty2);
-        bottomQuad[3] = WindowVertex(bottomRect.left(),  bottomRect.bottom(), tx1, ty2);
-        quads.append(bottomQuad);
+        quads.append(bottomRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     if (leftRect.isValid()) {
@@ -277,12 +249,8 @@ WindowQuadList ShadowItem::buildQuads() const
         ty1 = shadowMargins.top() / height;
         tx2 = leftRect.width() / width;
         ty2 = ty1 + left.height() / height;
-        WindowQuad leftQuad;
-        leftQuad[0] = WindowVertex(leftRect.left(),  leftRect.top(),    tx1, ty1);
-        leftQuad[1] = WindowVertex(leftRect.right(), leftRect.top(),    tx2, ty1);
-        leftQuad[2] = WindowVertex(leftRect.right(), leftRect.bottom(), tx2, ty2);
-        leftQuad[3] = WindowVertex(leftRect.left(),  leftRect.bottom(), tx1, ty2);
-        quads.append(leftQuad);
+        quads.append(leftRect, QVector2D(tx1, ty1), QVector2D(tx2, ty1),
+                     QVector2D(tx2, ty2), QVector2D(tx1, ty2));
     }
 
     return quads;
@@ -0,0 +1,292 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "smartplacement.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace KWin
+{
+
+/**
+ * Looks at all windows for every position.
+ */
+class SmartPlacement::LinearScanner
+{
+public:
+    LinearScanner(const QVector<Window> &windows, const QSize &size)
+        : m_windows(windows)
+        , m_width(size.width() - 1)
+        , m_height(size.height() - 1)
+    {
+    }
+
+    qint64 overlap(int x, int y) const
+    {
+        qint64 overlap = 0;
+        for (const Window &window : m_windows) {
+            if (x < window.right && x + m_width > window.left && y < window.bottom && y + m_height > window.top) {
+                const int width = std::min(x + m_width, window.right) - std::max(x, window.left);
+                const int height = std::min(y + m_height, window.bottom) - std::max(y, window.top);
+                overlap += qint64(window.weight) * width * height;
+            }
+        }
+        return overlap;
+    }
+
+    int nextX(int x, int y) const
+    {
+        int next = std::numeric_limits<int>::max();
+        for (const Window &window : m_windows) {
+            if (y < window.bottom && window.top < y + m_height) {
+                if (window.right > x) {
+                    next = std::min(next, window.right);
+                }
+                if (window.left - m_width > x) {
+                    next = std::min(next, window.left - m_width);
+                }
+            }
+        }
+        return next;
+    }
+
+    int nextY(int y) const
+    {
+        int next = std::numeric_limits<int>::max();
+        for (const Window &window : m_windows) {
+            if (window.bottom > y) {
+                next = std::min(next, window.bottom);
+            }
+            if (window.top - m_height > y) {
+                next = std::min(next, window.top - m_height);
+            }
+        }
+        return next;
+    }
+
+private:
+    const QVector<Window> &m_windows;
+    int m_width;
+    int m_height;
+};
+
+/**
+ * Sweeps over the windows overlapping a row once, when the row is entered.
+ *
+ * The covered area of the row is kept as a sorted list of the left and right edges of the
+ * windows. Each edge knows the weighted area covered left of it and the weighted height
+ * covered right of it, so the overlap of a position is the difference of the covered area
+ * at its right and at its left edge.
+ */
+class SmartPlacement::SweepScanner
+{
+public:
+    SweepScanner(const QVector<Window> &windows, const QSize &size)
+        : m_windows(windows)
+        , m_width(size.width() - 1)
+        , m_height(size.height() - 1)
+    {
+        m_rowStops.reserve(windows.count() * 2);
+        m_edges.reserve(windows.count() * 2);
+        m_columnStops.reserve(windows.count() * 2);
+        for (const Window &window : windows) {
+            m_columnStops.append(window.bottom);
+            m_columnStops.append(window.top - m_height);
+        }
+        std::sort(m_columnStops.begin(), m_columnStops.end());
+    }
+
+    qint64 overlap(int x, int y)
+    {
+        enterRow(y);
+        return coveredArea(x + m_width) - coveredArea(x);
+    }
+
+    int nextX(int x, int y)
+    {
+        enterRow(y);
+        const auto it = std::upper_bound(m_rowStops.constBegin(), m_rowStops.constEnd(), x);
+        return it == m_rowStops.constEnd() ? std::numeric_limits<int>::max() : *it;
+    }
+
+    int nextY(int y) const
+    {
+        const auto it = std::upper_bound(m_columnStops.constBegin(), m_columnStops.constEnd(), y);
+        return it == m_columnStops.constEnd() ? std::numeric_limits<int>::max() : *it;
+    }
+
+private:
+    struct Edge
+    {
+        int x;
+        qint64 height;
+        qint64 area;
+    };
+
+    void enterRow(int y)
+    {
+        if (m_hasRow && m_row == y) {
+            return;
+        }
+        m_hasRow = true;
+        m_row = y;
+
+        m_rowStops.clear();
+        QVector<QPair<int, qint64>> events;
+        events.reserve(m_windows.count() * 2);
+        for (const Window &window : m_windows) {
+            if (y < window.bottom && window.top < y + m_height) {
+                m_rowStops.append(window.right);
+                m_rowStops.append(window.left - m_width);
+                if (window.weight) {
+                    const int height = std::min(y + m_height, window.bottom) - std::max(y, window.top);
+                    const qint64 weightedHeight = qint64(window.weight) * height;
+                    events.append(qMakePair(window.left, weightedHeight));
+                    events.append(qMakePair(window.right, -weightedHeight));
+                }
+            }
+        }
+        std::sort(m_rowStops.begin(), m_rowStops.end());
+        std::sort(events.begin(), events.end(), [](const QPair<int, qint64> &a, const QPair<int, qint64> &b) {
+            return a.first < b.first;
+        });
+
+        m_edges.clear();
+        qint64 height = 0;
+        qint64 area = 0;
+        for (const QPair<int, qint64> &event : qAsConst(events)) {
+            if (!m_edges.isEmpty() && m_edges.last().x == event.first) {
+                m_edges.last().height += event.second;
+                height = m_edges.last().height;
+                continue;
+            }
+            if (!m_edges.isEmpty()) {
+                area += height * (event.first - m_edges.last().x);
+            }
+            height += event.second;
+            m_edges.append(Edge{event.first, height, area});
+        }
+    }
+
+    /**
+     * Returns the weighted area of the row covered by the windows left of @a x.
+     */
+    qint64 coveredArea(int x) const
+    {
+        auto it = std::upper_bound(m_edges.constBegin(), m_edges.constEnd(), x, [](int x, const Edge &edge) {
+            return x < edge.x;
+        });
+        if (it == m_edges.constBegin()) {
+            return 0;
+        }
+        --it;
+        return it->area + it->height * (x - it->x);
+    }
+
+    const QVector<Window> &m_windows;
+    int m_width;
+    int m_height;
+    QVector<int> m_columnStops;
+    QVector<int> m_rowStops;
+    QVector<Edge> m_edges;
+    int m_row = 0;
+    bool m_hasRow = false;
+};
+
+bool SmartPlacement::isSweepEnabled()
+{
+    return qgetenv("KWIN_SMART_PLACEMENT_SWEEP") != "0";
+}
+
+void SmartPlacement::addWindow(const QRect &geometry, Weight weight)
+{
+    m_windows.append(Window{geometry.x(), geometry.y(), geometry.x() + geometry.width(), geometry.y() + geometry.height(), weight});
+}
+
+QPoint SmartPlacement::place(const QSize &size, const QRect &area) const
+{
+    SweepScanner scanner(m_windows, size);
+    return walk(size, area, scanner);
+}
+
+QPoint SmartPlacement::placeLinear(const QSize &size, const QRect &area) const
+{
+    LinearScanner scanner(m_windows, size);
+    return walk(size, area, scanner);
+}
+
+template<typename Scanner>
+QPoint SmartPlacement::walk(const QSize &size, const QRect &area, Scanner &scanner) const
+{
+    const qint64 none = 0, heightWrong = -1, widthWrong = -2; // overlap types
+    qint64 overlap;
+    qint64 minOverlap = 0;
+
+    const int width = size.width() - 1;
+    const int height = size.height() - 1;
+
+    int x = area.left();
+    int y = area.top();
+    QPoint optimal(x, y);
+
+    bool firstPass = true;
+
+    // loop over possible positions
+    do {
+        // test if enough room in x and y directions
+        if (y + height > area.bottom() && height < area.height()) {
+            overlap = heightWrong; // this throws the algorithm to an exit
+        } else if (x + width > area.right()) {
+            overlap = widthWrong;
+        } else {
+            overlap = scanner.overlap(x, y);
+        }
+
+        // first time we get no overlap we stop
+        if (overlap == none) {
+            optimal = QPoint(x, y);
+            break;
+        }
+
+        if (firstPass) {
+            firstPass = false;
+            minOverlap = overlap;
+        } else if (overlap >= none && overlap < minOverlap) {
+            // save the best position and the minimum overlap up to now
+            minOverlap = overlap;
+            optimal = QPoint(x, y);
+        }
+
+        if (overlap > none) {
+            // the first x position not overlapped by a window in this row
+            int possible = area.right();
+            if (possible - width > x) {
+                possible -= width;
+            }
+            x = std::min(possible, scanner.nextX(x, y));
+        } else if (overlap == widthWrong) {
+            // not enough room in this row, the first y position not overlapped by a window
+            x = area.left();
+            int possible = area.bottom();
+            if (possible - height > y) {
+                possible -= height;
+            }
+            y = std::min(possible, scanner.nextY(y));
+        }
+    } while (overlap != none && overlap != heightWrong && y < area.bottom());
+
+    if (height >= area.height()) {
+        optimal.setY(area.top());
+    }
+
+    return optimal;
+}
+
+} // namespace KWin
@@ -0,0 +1,81 @@
+/*
+    KWin - the KDE window manager
+    This file is part of the KDE project.
+
+    SPDX-FileCopyrightText: 2026 KWin Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QRect>
+#include <QVector>
+
+namespace KWin
+{
+
+/**
+ * The SmartPlacement finds the position of a new window that is overlapped the least by the
+ * other windows, the way the smart placement of Cristian Tibirna does it: the positions are
+ * tried row by row from the top-left corner of the area, jumping to the next edge of a window,
+ * and the first position without any overlap wins.
+ *
+ * Instead of going through all windows for every position, place() sweeps over the windows
+ * once for every row: the overlap of a position is looked up in the covered area of the row
+ * summed up from the left, and the next position in the sorted edges of the windows.
+ */
+class SmartPlacement
+{
+public:
+    /**
+     * The weights of the windows, a window that is kept above the new window counts more than
+     * one that is kept below it.
+     */
+    enum Weight {
+        Ignored = 0,
+        Normal = 1,
+        KeptAbove = 16,
+    };
+
+    /**
+     * Returns @c false if the sweep has been disabled with KWIN_SMART_PLACEMENT_SWEEP=0.
+     */
+    static bool isSweepEnabled();
+
+    /**
+     * Adds a window with the given frame @a geometry that the new window should not overlap.
+     */
+    void addWindow(const QRect &geometry, Weight weight = Normal);
+
+    /**
+     * Returns the top-left corner of a window of the given @a size in the @a area.
+     */
+    QPoint place(const QSize &size, const QRect &area) const;
+
+    /**
+     * Returns the same position as place(), but goes through all windows for every position
+     * that is tried.
+     */
+    QPoint placeLinear(const QSize &size, const QRect &area) const;
+
+private:
+    struct Window
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+        int weight;
+    };
+
+    class LinearScanner;
+    class SweepScanner;
+
+    template<typename Scanner>
+    QPoint walk(const QSize &size, const QRect &area, Scanner &scanner) const;
+
+    QVector<Window> m_windows;
+};
+
+} // namespace KWin
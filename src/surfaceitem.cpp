@@ -135,27 +135,21 @@ void SurfaceItem::preprocess()
     updatePixmap();
 }
 
-WindowQuadList SurfaceItem::buildQuads() const
+RenderQuadList SurfaceItem::buildQuads() const
 {
     const QRegion region = shape();
 
-    WindowQuadList quads;
+    RenderQuadList quads;
     quads.reserve(region.rectCount());
 
     for (const QRectF rect : region) {
-        WindowQuad quad;
-
         const QPointF bufferTopLeft = m_surfaceToBufferMatrix.map(rect.topLeft());
         const QPointF bufferTopRight = m_surfaceToBufferMatrix.map(rect.topRight());
         const QPointF bufferBottomRight = m_surfaceToBufferMatrix.map(rect.bottomRight());
         const QPointF bufferBottomLeft = m_surfaceToBufferMatrix.map(rect.bottomLeft());
 
-        quad[0] = WindowVertex(rect.topLeft(), bufferTopLeft);
-        quad[1] = WindowVertex(rect.topRight(), bufferTopRight);
-        quad[2] = WindowVertex(rect.bottomRight(), bufferBottomRight);
-        quad[3] = WindowVertex(rect.bottomLeft(), bufferBottomLeft);
-
-        quads << quad;
+        quads.append(rect, QVector2D(bufferTopLeft), QVector2D(bufferTopRight),
+                     QVector2D(bufferBottomRight), QVector2D(bufferBottomLeft));
     }
 
     return quads;
@@ -165,6 +159,10 @@ PlatformSurfaceTexture::~PlatformSurfaceTexture()
 {
 }
 
+void PlatformSurfaceTexture::discard()
+{
+}
+
 SurfacePixmap::SurfacePixmap(PlatformSurfaceTexture *platformTexture, QObject *parent)
     : QObject(parent)
     , m_platformTexture(platformTexture)
@@ -203,6 +201,9 @@ bool SurfacePixmap::isDiscarded() const
 void SurfacePixmap::markAsDiscarded()
 {
     m_isDiscarded = true;
+    if (m_platformTexture) {
+        m_platformTexture->discard();
+    }
 }
 
 } // namespace KWin
@@ -49,7 +49,7 @@ protected:
 
     virtual SurfacePixmap *createPixmap() = 0;
     void preprocess() override;
-    WindowQuadList buildQuads() const override;
+    RenderQuadList buildQuads() const override;
 
     void handleWindowClosed(Toplevel *original, Deleted *deleted);
 
@@ -67,6 +67,13 @@ public:
     virtual ~PlatformSurfaceTexture();
 
     virtual bool isValid() const = 0;
+
+    /**
+     * Called when the pixmap won't be updated anymore, because it has been discarded or its
+     * surface is gone. The pixmap may still be painted, e.g. in a closing animation, but the
+     * texture must no longer hold on to the buffer of the client.
+     */
+    virtual void discard();
 };
 
 class KWIN_EXPORT SurfacePixmap : public QObject
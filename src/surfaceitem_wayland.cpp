@@ -142,6 +142,13 @@ SurfacePixmapWayland::SurfacePixmapWayland(SurfaceItemWayland *item, QObject *pa
     : SurfacePixmap(Compositor::self()->scene()->createPlatformSurfaceTextureWayland(this), parent)
     , m_item(item)
 {
+    if (KWaylandServer::SurfaceInterface *surface = item->surface()) {
+        connect(surface, &QObject::destroyed, this, [this]() {
+            if (PlatformSurfaceTexture *texture = platformTexture()) {
+                texture->discard();
+            }
+        });
+    }
 }
 
 SurfacePixmapWayland::~SurfacePixmapWayland()
@@ -53,6 +53,7 @@ void TabletInputRedirection::tabletToolEvent(KWin::InputRedirection::TabletEvent
     if (!inited()) {
         return;
     }
+    input()->pointer()->processQueuedMotion();
     m_lastPosition = pos;
 
     QEvent::Type t;
@@ -88,6 +89,7 @@ void TabletInputRedirection::tabletToolEvent(KWin::InputRedirection::TabletEvent
 void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPressed,
                                                          const TabletToolId &tabletToolId)
 {
+    input()->pointer()->processQueuedMotion();
     input()->processSpies(std::bind(&InputEventSpy::tabletToolButtonEvent,
                                     std::placeholders::_1, button, isPressed, tabletToolId));
     input()->processFilters(std::bind( &InputEventFilter::tabletToolButtonEvent,
@@ -97,6 +99,7 @@ void KWin::TabletInputRedirection::tabletToolButtonEvent(uint button, bool isPre
 void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPressed,
                                                         const TabletPadId &tabletPadId)
 {
+    input()->pointer()->processQueuedMotion();
     input()->processSpies(std::bind( &InputEventSpy::tabletPadButtonEvent,
                                      std::placeholders::_1, button, isPressed, tabletPadId));
     input()->processFilters(std::bind( &InputEventFilter::tabletPadButtonEvent,
@@ -106,6 +109,7 @@ void KWin::TabletInputRedirection::tabletPadButtonEvent(uint button, bool isPres
 void KWin::TabletInputRedirection::tabletPadStripEvent(int number, int position, bool isFinger,
                                                        const TabletPadId &tabletPadId)
 {
+    input()->pointer()->processQueuedMotion();
     input()->processSpies(std::bind( &InputEventSpy::tabletPadStripEvent,
                                      std::placeholders::_1, number, position, isFinger, tabletPadId));
     input()->processFilters(std::bind( &InputEventFilter::tabletPadStripEvent,
@@ -115,6 +119,7 @@ void KWin::TabletInputRedirection::tabletPadStripEvent(int number, int position,
 void KWin::TabletInputRedirection::tabletPadRingEvent(int number, int position, bool isFinger,
                                                       const TabletPadId &tabletPadId)
 {
+    input()->pointer()->processQueuedMotion();
     input()->processSpies(std::bind( &InputEventSpy::tabletPadRingEvent,
                                      std::placeholders::_1, number, position, isFinger, tabletPadId));
     input()->processFilters(std::bind( &InputEventFilter::tabletPadRingEvent,
@@ -675,6 +675,7 @@ protected:
     virtual void propertyNotifyEvent(xcb_property_notify_event_t *e);
     virtual void clientMessageEvent(xcb_client_message_event_t *e);
     Xcb::Property fetchWmClientLeader() const;
+    static Xcb::Property fetchWmClientLeader(xcb_window_t window);
     void readWmClientLeader(Xcb::Property &p);
     void getWmClientLeader();
     void getWmClientMachine();
@@ -689,6 +690,7 @@ protected:
     void getResourceClass();
     void setResourceClass(const QByteArray &name, const QByteArray &className = QByteArray());
     Xcb::Property fetchSkipCloseAnimation() const;
+    static Xcb::Property fetchSkipCloseAnimation(xcb_window_t window);
     void readSkipCloseAnimation(Xcb::Property &prop);
     void getSkipCloseAnimation();
     void copyToDeleted(Toplevel* c);
@@ -141,6 +141,7 @@ void TouchInputRedirection::processDown(qint32 id, const QPointF &pos, quint32 t
     if (!inited()) {
         return;
     }
+    input()->pointer()->processQueuedMotion();
     m_lastPosition = pos;
     m_windowUpdatedInCycle = false;
     m_activeTouchPoints.insert(id);
@@ -158,6 +159,7 @@ void TouchInputRedirection::processUp(qint32 id, quint32 time, LibInput::Device
     if (!inited()) {
         return;
     }
+    input()->pointer()->processQueuedMotion();
     if (!m_activeTouchPoints.remove(id)) {
         return;
     }
@@ -176,6 +178,7 @@ void TouchInputRedirection::processMotion(qint32 id, const QPointF &pos, quint32
     if (!inited()) {
         return;
     }
+    input()->pointer()->processQueuedMotion();
     if (!m_activeTouchPoints.contains(id)) {
         return;
     }
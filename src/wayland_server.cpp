@@ -262,6 +262,8 @@ void WaylandServer::registerShellClient(AbstractClient *client)
         connect(client, &AbstractClient::windowShown, this, &WaylandServer::shellClientShown);
     }
     m_clients << client;
+    m_clientsBySurface.insert(client->surface(), client);
+    m_clientSurfaces.insert(client, client->surface());
 }
 
 void WaylandServer::registerXdgToplevelClient(XdgToplevelClient *client)
@@ -402,19 +404,9 @@ bool WaylandServer::init(InitializationFlags flags)
                 return;
             }
 
-            X11Client *client = ws->findClient([surface](const X11Client *client) {
-                return client->surfaceId() == surface->id();
-            });
-            if (client) {
-                client->setSurface(surface);
-                return;
-            }
-
-            Unmanaged *unmanaged = ws->findUnmanaged([surface](const Unmanaged *unmanaged) {
-                return unmanaged->surfaceId() == surface->id();
-            });
-            if (unmanaged) {
-                unmanaged->setSurface(surface);
+            const QPointer<Toplevel> toplevel = m_xwaylandSurfaceIds.take(surface->id());
+            if (toplevel && toplevel->surfaceId() == surface->id()) {
+                toplevel->setSurface(surface);
                 return;
             }
 
@@ -585,6 +577,13 @@ void WaylandServer::initWorkspace()
 {
     VirtualDesktopManager::self()->setVirtualDesktopManagement(m_virtualDesktopManagement);
 
+    connect(workspace(), &Workspace::clientAdded, this, [this](AbstractClient *client) {
+        if (X11Client *x11Client = qobject_cast<X11Client *>(client)) {
+            trackXwaylandSurfaceId(x11Client);
+        }
+    });
+    connect(workspace(), &Workspace::unmanagedAdded, this, &WaylandServer::trackXwaylandSurfaceId);
+
     if (m_windowManagement) {
         connect(workspace(), &Workspace::showingDesktopChanged, this,
             [this] (bool set) {
@@ -789,9 +788,35 @@ void WaylandServer::createInternalConnection()
 void WaylandServer::removeClient(AbstractClient *c)
 {
     m_clients.removeAll(c);
+    // A new client may have got a surface at the address of the destroyed surface already.
+    const KWaylandServer::SurfaceInterface *surface = m_clientSurfaces.take(c);
+    const auto it = m_clientsBySurface.find(surface);
+    if (it != m_clientsBySurface.end() && *it == c) {
+        m_clientsBySurface.erase(it);
+    }
     Q_EMIT shellClientRemoved(c);
 }
 
+void WaylandServer::trackXwaylandSurfaceId(Toplevel *toplevel)
+{
+    auto update = [this, toplevel]() {
+        if (toplevel->surfaceId() && !toplevel->surface()) {
+            m_xwaylandSurfaceIds.insert(toplevel->surfaceId(), toplevel);
+        }
+    };
+    connect(toplevel, &Toplevel::surfaceIdChanged, this, update);
+    connect(toplevel, &QObject::destroyed, this, [this]() {
+        for (auto it = m_xwaylandSurfaceIds.begin(); it != m_xwaylandSurfaceIds.end();) {
+            if (it->isNull()) {
+                it = m_xwaylandSurfaceIds.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    });
+    update();
+}
+
 void WaylandServer::dispatch()
 {
     if (!m_display) {
@@ -803,26 +828,14 @@ void WaylandServer::dispatch()
     m_display->dispatchEvents();
 }
 
-static AbstractClient *findClientInList(const QList<AbstractClient *> &clients, const KWaylandServer::SurfaceInterface *surface)
-{
-    auto it = std::find_if(clients.begin(), clients.end(),
-        [surface] (AbstractClient *c) {
-            return c->surface() == surface;
-        }
-    );
-    if (it == clients.end()) {
-        return nullptr;
-    }
-    return *it;
-}
-
 AbstractClient *WaylandServer::findClient(const KWaylandServer::SurfaceInterface *surface) const
 {
     if (!surface) {
         return nullptr;
     }
-    if (AbstractClient *c = findClientInList(m_clients, surface)) {
-        return c;
+    AbstractClient *client = m_clientsBySurface.value(surface);
+    if (client && client->surface() == surface) {
+        return client;
     }
     return nullptr;
 }
@@ -12,6 +12,7 @@
 #include <kwinglobals.h>
 #include "keyboard_input.h"
 
+#include <QHash>
 #include <QObject>
 
 class QThread;
@@ -274,6 +275,7 @@ private:
     void registerXdgToplevelClient(XdgToplevelClient *client);
     void registerXdgPopupClient(XdgPopupClient *client);
     void registerShellClient(AbstractClient *client);
+    void trackXwaylandSurfaceId(Toplevel *toplevel);
     void handleOutputAdded(AbstractOutput *output);
     void handleOutputRemoved(AbstractOutput *output);
     void handleOutputEnabled(AbstractOutput *output);
@@ -316,6 +318,11 @@ private:
     KWaylandServer::XdgForeignV2Interface *m_XdgForeign = nullptr;
     KWaylandServer::KeyStateInterface *m_keyState = nullptr;
     QList<AbstractClient *> m_clients;
+    // The surfaces are only used as keys, findClient() checks that the client still has the surface.
+    QHash<const KWaylandServer::SurfaceInterface *, AbstractClient *> m_clientsBySurface;
+    QHash<AbstractClient *, const KWaylandServer::SurfaceInterface *> m_clientSurfaces;
+    // The Xwayland windows whose surface id is known, but whose surface hasn't been created yet.
+    QHash<quint32, QPointer<Toplevel>> m_xwaylandSurfaceIds;
     InitializationFlags m_initFlags;
     QHash<AbstractWaylandOutput *, WaylandOutput *> m_waylandOutputs;
     QHash<AbstractWaylandOutput *, WaylandOutputDevice *> m_waylandOutputDevices;
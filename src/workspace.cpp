@@ -59,8 +59,12 @@
 #include <KLocalizedString>
 #include <KStartupInfo>
 // Qt
+#include <QElapsedTimer>
 #include <QtConcurrentRun>
 
+#include <memory>
+#include <vector>
+
 namespace KWin
 {
 
@@ -294,6 +298,17 @@ void Workspace::init()
     // TODO: ungrabXServer()
 }
 
+/**
+ * Returns the sequence number of a request sent to the X server, the difference between two
+ * of them is the number of requests sent in between.
+ */
+static uint nextRequestSequence()
+{
+    const xcb_get_input_focus_cookie_t cookie = xcb_get_input_focus_unchecked(connection());
+    xcb_discard_reply(connection(), cookie.sequence);
+    return cookie.sequence;
+}
+
 void Workspace::initializeX11()
 {
     if (!kwinApp()->x11Connection()) {
@@ -369,6 +384,8 @@ void Workspace::initializeX11()
             windowGeometries[i] = Xcb::WindowGeometry(wins[i]);
         }
 
+        QVector<xcb_window_t> clientWindows;
+
         // Get the replies
         for (int i = 0; i < tree->children_len; i++) {
             Xcb::WindowAttributes attr(windowAttributes.at(i));
@@ -386,10 +403,41 @@ void Workspace::initializeX11()
                 if (Application::wasCrash()) {
                     fixPositionAfterCrash(wins[i], windowGeometries.at(i).data());
                 }
+                clientWindows.append(wins[i]);
+            }
+        }
 
-                // ### This will request the attributes again
-                createClient(wins[i], true);
+        // Send the requests of all clients before the first reply is waited for, so the replies
+        // of all clients arrive together instead of one client after the other. The NETWinInfo
+        // and the client machine are still read while each client is managed
+        const bool measureAdoption = qEnvironmentVariableIntValue("KWIN_X11_ADOPTION_STATS") == 1;
+        QElapsedTimer adoptionTimer;
+        uint firstSequence = 0;
+        if (measureAdoption) {
+            adoptionTimer.start();
+            firstSequence = nextRequestSequence();
+        }
+
+        std::vector<std::unique_ptr<X11ManageRequests>> manageRequests;
+        manageRequests.reserve(clientWindows.count());
+        for (xcb_window_t window : qAsConst(clientWindows)) {
+            // The properties are read before embedClient() selects the events of the window,
+            // a change of a property after it has been read must not get lost
+            Xcb::selectInput(window, XCB_EVENT_MASK_PROPERTY_CHANGE);
+            manageRequests.emplace_back(new X11ManageRequests(window));
+            manageRequests.back()->fetchProperties();
+        }
+        for (int i = 0; i < clientWindows.count(); ++i) {
+            if (!createClient(clientWindows[i], true, *manageRequests[i])) {
+                Xcb::selectInput(clientWindows[i], XCB_EVENT_MASK_NO_EVENT);
             }
+            manageRequests[i].reset();
+        }
+
+        if (measureAdoption) {
+            qCInfo(KWIN_CORE) << "Adopted" << clientWindows.count() << "X11 windows in"
+                              << adoptionTimer.elapsed() << "ms with"
+                              << nextRequestSequence() - firstSequence - 1 << "requests";
         }
 
         // Propagate clients, will really happen at the end of the updates blocker block
@@ -589,6 +637,7 @@ void Workspace::addToStack(Toplevel *toplevel)
     }
     if (!stacking_order.contains(toplevel)) {
         stacking_order.append(toplevel);
+        m_stackingOrderSerial++;
     }
 }
 
@@ -609,6 +658,7 @@ void Workspace::replaceInStack(Toplevel *original, Deleted *deleted)
         // This can be the case only if an override-redirect window is unmapped.
         stacking_order.append(deleted);
     }
+    m_stackingOrderSerial++;
 
     for (Constraint *constraint : qAsConst(m_constraints)) {
         if (constraint->below == original) {
@@ -622,7 +672,9 @@ void Workspace::replaceInStack(Toplevel *original, Deleted *deleted)
 void Workspace::removeFromStack(Toplevel *toplevel)
 {
     unconstrained_stacking_order.removeAll(toplevel);
-    stacking_order.removeAll(toplevel);
+    if (stacking_order.removeAll(toplevel)) {
+        m_stackingOrderSerial++;
+    }
 
     for (int i = m_constraints.count() - 1; i >= 0; --i) {
         Constraint *constraint = m_constraints[i];
@@ -645,6 +697,12 @@ void Workspace::removeFromStack(Toplevel *toplevel)
 }
 
 X11Client *Workspace::createClient(xcb_window_t w, bool is_mapped)
+{
+    X11ManageRequests requests(w);
+    return createClient(w, is_mapped, requests);
+}
+
+X11Client *Workspace::createClient(xcb_window_t w, bool is_mapped, X11ManageRequests &requests)
 {
     StackingUpdatesBlocker blocker(this);
     X11Client *c = nullptr;
@@ -658,7 +716,7 @@ X11Client *Workspace::createClient(xcb_window_t w, bool is_mapped)
         connect(c, &X11Client::blockingCompositingChanged, compositor, &X11Compositor::updateClientCompositeBlocking);
     }
     connect(c, &X11Client::clientFullScreenSet, ScreenEdges::self(), &ScreenEdges::checkBlocking);
-    if (!c->manage(w, is_mapped)) {
+    if (!c->manage(w, is_mapped, requests)) {
         X11Client::deleteClient(c);
         return nullptr;
     }
@@ -700,6 +758,8 @@ void Workspace::addClient(X11Client *c)
     }
     m_x11Clients.append(c);
     m_allClients.append(c);
+    m_x11ClientIds.insert(c, QVector<xcb_window_t>());
+    updateX11ClientIndex(c);
     addToStack(c);
     markXStackingOrderAsDirty();
     updateClientArea(); // This cannot be in manage(), because the client got added only now
@@ -721,6 +781,7 @@ void Workspace::addClient(X11Client *c)
 void Workspace::addUnmanaged(Unmanaged* c)
 {
     m_unmanaged.append(c);
+    m_unmanagedIndex.insert(c->window(), c);
     markXStackingOrderAsDirty();
 }
 
@@ -738,6 +799,7 @@ void Workspace::removeX11Client(X11Client *c)
     Q_ASSERT(m_x11Clients.contains(c));
     // TODO: if marked client is removed, notify the marked list
     m_x11Clients.removeAll(c);
+    removeFromX11ClientIndex(c, m_x11ClientIds.take(c));
     Group* group = findGroup(c->window());
     if (group != nullptr)
         group->lostLeader();
@@ -748,6 +810,10 @@ void Workspace::removeUnmanaged(Unmanaged* c)
 {
     Q_ASSERT(m_unmanaged.contains(c));
     m_unmanaged.removeAll(c);
+    const auto it = m_unmanagedIndex.find(c->window());
+    if (it != m_unmanagedIndex.end() && *it == c) {
+        m_unmanagedIndex.erase(it);
+    }
     Q_EMIT unmanagedRemoved(c);
     markXStackingOrderAsDirty();
 }
@@ -1732,10 +1798,12 @@ QString Workspace::supportInformation() const
             }
 
             support.append(QStringLiteral("OpenGL 2 Shaders are used\n"));
+            support.append(Compositor::self()->scene()->supportInformation());
             break;
         }
         case QPainterCompositing:
             support.append("Compositing Type: QPainter\n");
+            support.append(Compositor::self()->scene()->supportInformation());
             break;
         case NoCompositing:
         default:
@@ -1808,32 +1876,48 @@ Unmanaged *Workspace::findUnmanaged(std::function<bool (const Unmanaged*)> func)
 
 Unmanaged *Workspace::findUnmanaged(xcb_window_t w) const
 {
-    return findUnmanaged([w](const Unmanaged *u) {
-        return u->window() == w;
-    });
+    return m_unmanagedIndex.value(w);
 }
 
 X11Client *Workspace::findClient(Predicate predicate, xcb_window_t w) const
 {
-    switch (predicate) {
-    case Predicate::WindowMatch:
-        return findClient([w](const X11Client *c) {
-            return c->window() == w;
-        });
-    case Predicate::WrapperIdMatch:
-        return findClient([w](const X11Client *c) {
-            return c->wrapperId() == w;
-        });
-    case Predicate::FrameIdMatch:
-        return findClient([w](const X11Client *c) {
-            return c->frameId() == w;
-        });
-    case Predicate::InputIdMatch:
-        return findClient([w](const X11Client *c) {
-            return c->inputId() == w;
-        });
+    // every X event is routed through these lookups, so they must not walk all clients
+    if (w == XCB_WINDOW_NONE) {
+        return nullptr;
+    }
+    return m_x11ClientIndex[int(predicate)].value(w);
+}
+
+void Workspace::updateX11ClientIndex(X11Client *c)
+{
+    const auto it = m_x11ClientIds.find(c);
+    if (it == m_x11ClientIds.end()) {
+        return;
+    }
+    // the ids in the order of Predicate
+    const QVector<xcb_window_t> ids{c->window(), c->wrapperId(), c->frameId(), c->inputId()};
+    QVector<xcb_window_t> &indexedIds = *it;
+    if (indexedIds == ids) {
+        return;
+    }
+    removeFromX11ClientIndex(c, indexedIds);
+    for (int i = 0; i < ids.count(); ++i) {
+        if (ids[i] != XCB_WINDOW_NONE) {
+            m_x11ClientIndex[i].insert(ids[i], c);
+        }
+    }
+    indexedIds = ids;
+}
+
+void Workspace::removeFromX11ClientIndex(X11Client *c, const QVector<xcb_window_t> &ids)
+{
+    for (int i = 0; i < ids.count(); ++i) {
+        // the id may have been reused by another client already
+        const auto it = m_x11ClientIndex[i].find(ids[i]);
+        if (it != m_x11ClientIndex[i].end() && *it == c) {
+            m_x11ClientIndex[i].erase(it);
+        }
     }
-    return nullptr;
 }
 
 Toplevel *Workspace::findToplevel(std::function<bool (const Toplevel*)> func) const
@@ -1897,6 +1981,9 @@ Toplevel *Workspace::findInternal(QWindow *w) const
 void Workspace::markXStackingOrderAsDirty()
 {
     m_xStackingDirty = true;
+    if (m_compositor) {
+        m_compositor->invalidateWindowsToRender();
+    }
     if (kwinApp()->x11Connection() && !kwinApp()->isClosingX11Connection()) {
         m_xStackingQueryTree.reset(new Xcb::Tree(kwinApp()->x11RootWindow()));
     }
@@ -54,6 +54,7 @@ class Unmanaged;
 class UserActionsMenu;
 class VirtualDesktop;
 class X11Client;
+class X11ManageRequests;
 class X11EventFilter;
 enum class Predicate;
 
@@ -280,6 +281,11 @@ public:
      * at the last position
      */
     const QList<Toplevel *> &stackingOrder() const;
+    /**
+     * Returns a number that changes whenever the stackingOrder() changes, including the
+     * changes that don't emit stackingOrderChanged(), e.g. when a window is added to the stack.
+     */
+    quint64 stackingOrderSerial() const;
     QList<Toplevel *> xStackingOrder() const;
     QList<X11Client *> ensureStackingOrder(const QList<X11Client *> &clients) const;
     QList<AbstractClient*> ensureStackingOrder(const QList<AbstractClient*> &clients) const;
@@ -332,6 +338,11 @@ public:
     bool showingDesktop() const;
 
     void removeX11Client(X11Client *);   // Only called from X11Client::destroyClient() or X11Client::releaseWindow()
+    /**
+     * Updates the lookup of @p c by its window ids in findClient(), needs to be called
+     * when the client creates or destroys one of its windows while it's managed.
+     */
+    void updateX11ClientIndex(X11Client *c);
     void setActiveClient(AbstractClient*);
     Group* findGroup(xcb_window_t leader) const;
     void addGroup(Group* group);
@@ -559,6 +570,8 @@ private:
 
     /// This is the right way to create a new client
     X11Client *createClient(xcb_window_t w, bool is_mapped);
+    X11Client *createClient(xcb_window_t w, bool is_mapped, X11ManageRequests &requests);
+    void removeFromX11ClientIndex(X11Client *c, const QVector<xcb_window_t> &ids);
     void setupClientConnections(AbstractClient *client);
     void addClient(X11Client *c);
     Unmanaged* createUnmanaged(xcb_window_t w);
@@ -613,11 +626,16 @@ private:
     QList<X11Client *> m_x11Clients;
     QList<AbstractClient*> m_allClients;
     QList<Unmanaged *> m_unmanaged;
+    // The managed X11 clients by the window ids they are found with, indexed by Predicate.
+    QHash<xcb_window_t, X11Client *> m_x11ClientIndex[4];
+    QHash<X11Client *, QVector<xcb_window_t>> m_x11ClientIds;
+    QHash<xcb_window_t, Unmanaged *> m_unmanagedIndex;
     QList<Deleted *> deleted;
     QList<InternalClient *> m_internalClients;
 
     QList<Toplevel *> unconstrained_stacking_order; // Topmost last
     QList<Toplevel *> stacking_order; // Topmost last
+    quint64 m_stackingOrderSerial = 0;
     QVector<xcb_window_t> manual_overlays; //Topmost last
     bool force_restacking;
     QList<Toplevel *> x_stacking; // From XQueryTree()
@@ -753,6 +771,11 @@ inline const QList<Toplevel *> &Workspace::stackingOrder() const
     return stacking_order;
 }
 
+inline quint64 Workspace::stackingOrderSerial() const
+{
+    return m_stackingOrderSerial;
+}
+
 inline bool Workspace::wasUserInteraction() const
 {
     return was_user_interaction;
@@ -356,17 +356,52 @@ void X11Client::destroyClient()
     deleteClient(this);
 }
 
+X11ManageRequests::X11ManageRequests(xcb_window_t window)
+    : attributes(window)
+    , geometry(window)
+    , motifHints(atoms->motif_wm_hints)
+    , m_window(window)
+{
+}
+
+void X11ManageRequests::fetchProperties()
+{
+    wmClientLeader = X11Client::fetchWmClientLeader(m_window);
+    skipCloseAnimation = X11Client::fetchSkipCloseAnimation(m_window);
+    showOnScreenEdge = X11Client::fetchShowOnScreenEdge(m_window);
+    preferredColorScheme = X11Client::fetchPreferredColorScheme(m_window);
+    firstInTabBox = X11Client::fetchFirstInTabBox(m_window);
+    transient = X11Client::fetchTransient(m_window);
+    activities = X11Client::fetchActivities(m_window);
+    applicationMenuServiceName = X11Client::fetchApplicationMenuServiceName(m_window);
+    applicationMenuObjectPath = X11Client::fetchApplicationMenuObjectPath(m_window);
+    geometryHints.init(m_window);
+    motifHints.init(m_window);
+    m_propertiesFetched = true;
+}
+
+bool X11ManageRequests::havePropertiesBeenFetched() const
+{
+    return m_propertiesFetched;
+}
+
 /**
  * Manages the clients. This means handling the very first maprequest:
  * reparenting, initial geometry, initial state, placement, etc.
  * Returns false if KWin is not going to manage this window.
  */
 bool X11Client::manage(xcb_window_t w, bool isMapped)
+{
+    X11ManageRequests requests(w);
+    return manage(w, isMapped, requests);
+}
+
+bool X11Client::manage(xcb_window_t w, bool isMapped, X11ManageRequests &requests)
 {
     StackingUpdatesBlocker stacking_blocker(workspace());
 
-    Xcb::WindowAttributes attr(w);
-    Xcb::WindowGeometry windowGeometry(w);
+    Xcb::WindowAttributes &attr = requests.attributes;
+    Xcb::WindowGeometry &windowGeometry = requests.geometry;
     if (attr.isNull() || windowGeometry.isNull()) {
         return false;
     }
@@ -410,18 +445,21 @@ bool X11Client::manage(xcb_window_t w, bool isMapped)
         NET::WM2DesktopFileName |
         NET::WM2GTKFrameExtents;
 
-    auto wmClientLeaderCookie = fetchWmClientLeader();
-    auto skipCloseAnimationCookie = fetchSkipCloseAnimation();
-    auto showOnScreenEdgeCookie = fetchShowOnScreenEdge();
-    auto colorSchemeCookie = fetchPreferredColorScheme();
-    auto firstInTabBoxCookie = fetchFirstInTabBox();
-    auto transientCookie = fetchTransient();
-    auto activitiesCookie = fetchActivities();
-    auto applicationMenuServiceNameCookie = fetchApplicationMenuServiceName();
-    auto applicationMenuObjectPathCookie = fetchApplicationMenuObjectPath();
-
-    m_geometryHints.init(window());
-    m_motif.init(window());
+    if (!requests.havePropertiesBeenFetched()) {
+        requests.fetchProperties();
+    }
+    auto &wmClientLeaderCookie = requests.wmClientLeader;
+    auto &skipCloseAnimationCookie = requests.skipCloseAnimation;
+    auto &showOnScreenEdgeCookie = requests.showOnScreenEdge;
+    auto &colorSchemeCookie = requests.preferredColorScheme;
+    auto &firstInTabBoxCookie = requests.firstInTabBox;
+    auto &transientCookie = requests.transient;
+    auto &activitiesCookie = requests.activities;
+    auto &applicationMenuServiceNameCookie = requests.applicationMenuServiceName;
+    auto &applicationMenuObjectPathCookie = requests.applicationMenuObjectPath;
+
+    m_geometryHints = requests.geometryHints;
+    m_motif = requests.motifHints;
     info = new WinInfo(this, m_client, rootWindow(), properties, properties2);
 
     if (isDesktop() && bit_depth == 32) {
@@ -1059,6 +1097,7 @@ void X11Client::updateInputWindow()
 
     if (region.isEmpty()) {
         m_decoInputExtent.reset();
+        workspace()->updateX11ClientIndex(this);
         return;
     }
 
@@ -1081,6 +1120,7 @@ void X11Client::updateInputWindow()
             XCB_EVENT_MASK_POINTER_MOTION
         };
         m_decoInputExtent.create(bounds, XCB_WINDOW_CLASS_INPUT_ONLY, mask, values);
+        workspace()->updateX11ClientIndex(this);
         if (mapping_state == Mapped)
             m_decoInputExtent.map();
     } else {
@@ -1173,6 +1213,7 @@ void X11Client::destroyDecoration()
         }
     }
     m_decoInputExtent.reset();
+    workspace()->updateX11ClientIndex(this);
 }
 
 void X11Client::maybeCreateX11DecorationRenderer()
@@ -2401,10 +2442,16 @@ void X11Client::updateAllowedActions(bool force)
 }
 
 Xcb::StringProperty X11Client::fetchActivities() const
+{
+    return fetchActivities(window());
+}
+
+Xcb::StringProperty X11Client::fetchActivities(xcb_window_t window)
 {
 #ifdef KWIN_BUILD_ACTIVITIES
-    return Xcb::StringProperty(window(), atoms->activities);
+    return Xcb::StringProperty(window, atoms->activities);
 #else
+    Q_UNUSED(window)
     return Xcb::StringProperty();
 #endif
 }
@@ -2480,7 +2527,12 @@ void X11Client::setSessionActivityOverride(bool needed)
 
 Xcb::Property X11Client::fetchFirstInTabBox() const
 {
-    return Xcb::Property(false, m_client, atoms->kde_first_in_window_list,
+    return fetchFirstInTabBox(m_client);
+}
+
+Xcb::Property X11Client::fetchFirstInTabBox(xcb_window_t window)
+{
+    return Xcb::Property(false, window, atoms->kde_first_in_window_list,
                          atoms->kde_first_in_window_list, 0, 1);
 }
 
@@ -2498,7 +2550,12 @@ void X11Client::updateFirstInTabBox()
 
 Xcb::StringProperty X11Client::fetchPreferredColorScheme() const
 {
-    return Xcb::StringProperty(m_client, atoms->kde_color_sheme);
+    return fetchPreferredColorScheme(m_client);
+}
+
+Xcb::StringProperty X11Client::fetchPreferredColorScheme(xcb_window_t window)
+{
+    return Xcb::StringProperty(window, atoms->kde_color_sheme);
 }
 
 QString X11Client::readPreferredColorScheme(Xcb::StringProperty &property) const
@@ -2640,7 +2697,12 @@ QMatrix4x4 X11Client::inputTransformation() const
 
 Xcb::Property X11Client::fetchShowOnScreenEdge() const
 {
-    return Xcb::Property(false, window(), atoms->kde_screen_edge_show, XCB_ATOM_CARDINAL, 0, 1);
+    return fetchShowOnScreenEdge(window());
+}
+
+Xcb::Property X11Client::fetchShowOnScreenEdge(xcb_window_t window)
+{
+    return Xcb::Property(false, window, atoms->kde_screen_edge_show, XCB_ATOM_CARDINAL, 0, 1);
 }
 
 void X11Client::readShowOnScreenEdge(Xcb::Property &property)
@@ -2740,7 +2802,12 @@ QSize X11Client::resizeIncrements() const
 
 Xcb::StringProperty X11Client::fetchApplicationMenuServiceName() const
 {
-    return Xcb::StringProperty(m_client, atoms->kde_net_wm_appmenu_service_name);
+    return fetchApplicationMenuServiceName(m_client);
+}
+
+Xcb::StringProperty X11Client::fetchApplicationMenuServiceName(xcb_window_t window)
+{
+    return Xcb::StringProperty(window, atoms->kde_net_wm_appmenu_service_name);
 }
 
 void X11Client::readApplicationMenuServiceName(Xcb::StringProperty &property)
@@ -2756,7 +2823,12 @@ void X11Client::checkApplicationMenuServiceName()
 
 Xcb::StringProperty X11Client::fetchApplicationMenuObjectPath() const
 {
-    return Xcb::StringProperty(m_client, atoms->kde_net_wm_appmenu_object_path);
+    return fetchApplicationMenuObjectPath(m_client);
+}
+
+Xcb::StringProperty X11Client::fetchApplicationMenuObjectPath(xcb_window_t window)
+{
+    return Xcb::StringProperty(window, atoms->kde_net_wm_appmenu_object_path);
 }
 
 void X11Client::readApplicationMenuObjectPath(Xcb::StringProperty &property)
@@ -2923,7 +2995,12 @@ bool X11Client::sameAppWindowRoleMatch(const X11Client *c1, const X11Client *c2,
 
 Xcb::TransientFor X11Client::fetchTransient() const
 {
-    return Xcb::TransientFor(window());
+    return fetchTransient(window());
+}
+
+Xcb::TransientFor X11Client::fetchTransient(xcb_window_t window)
+{
+    return Xcb::TransientFor(window);
 }
 
 void X11Client::readTransientProperty(Xcb::TransientFor &transientFor)
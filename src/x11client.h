@@ -67,6 +67,43 @@ private:
     xcb_gcontext_t m_gc;
 };
 
+/**
+ * The requests X11Client::manage() sends for a window before it looks at any of the replies.
+ * The requests for many windows can be sent at once, so the replies of all windows arrive
+ * together instead of one window after the other.
+ */
+class X11ManageRequests
+{
+public:
+    explicit X11ManageRequests(xcb_window_t window);
+
+    /**
+     * Sends the requests for the properties of the window. X11Client::manage() sends them once
+     * it has selected the property change events of the window, a caller sending them earlier
+     * has to select XCB_EVENT_MASK_PROPERTY_CHANGE itself, so that no change gets lost.
+     */
+    void fetchProperties();
+    bool havePropertiesBeenFetched() const;
+
+    Xcb::WindowAttributes attributes;
+    Xcb::WindowGeometry geometry;
+    Xcb::Property wmClientLeader;
+    Xcb::Property skipCloseAnimation;
+    Xcb::Property showOnScreenEdge;
+    Xcb::StringProperty preferredColorScheme;
+    Xcb::Property firstInTabBox;
+    Xcb::TransientFor transient;
+    Xcb::StringProperty activities;
+    Xcb::StringProperty applicationMenuServiceName;
+    Xcb::StringProperty applicationMenuObjectPath;
+    Xcb::GeometryHints geometryHints;
+    Xcb::MotifHints motifHints;
+
+private:
+    xcb_window_t m_window;
+    bool m_propertiesFetched = false;
+};
+
 class KWIN_EXPORT X11Client : public AbstractClient
 {
     Q_OBJECT
@@ -138,6 +175,7 @@ public:
     NET::WindowType windowType(bool direct = false, int supported_types = 0) const override;
 
     bool manage(xcb_window_t w, bool isMapped);
+    bool manage(xcb_window_t w, bool isMapped, X11ManageRequests &requests);
     void releaseWindow(bool on_shutdown = false);
     void destroyClient() override;
 
@@ -257,9 +295,11 @@ public:
     bool isClientSideDecorated() const;
 
     Xcb::Property fetchFirstInTabBox() const;
+    static Xcb::Property fetchFirstInTabBox(xcb_window_t window);
     void readFirstInTabBox(Xcb::Property &property);
     void updateFirstInTabBox();
     Xcb::StringProperty fetchPreferredColorScheme() const;
+    static Xcb::StringProperty fetchPreferredColorScheme(xcb_window_t window);
     QString readPreferredColorScheme(Xcb::StringProperty &property) const;
     QString preferredColorScheme() const override;
 
@@ -276,10 +316,12 @@ public:
     void showOnScreenEdge() override;
 
     Xcb::StringProperty fetchApplicationMenuServiceName() const;
+    static Xcb::StringProperty fetchApplicationMenuServiceName(xcb_window_t window);
     void readApplicationMenuServiceName(Xcb::StringProperty &property);
     void checkApplicationMenuServiceName();
 
     Xcb::StringProperty fetchApplicationMenuObjectPath() const;
+    static Xcb::StringProperty fetchApplicationMenuObjectPath(xcb_window_t window);
     void readApplicationMenuObjectPath(Xcb::StringProperty &property);
     void checkApplicationMenuObjectPath();
 
@@ -433,6 +475,7 @@ private:
     void updateInputWindow();
 
     Xcb::Property fetchShowOnScreenEdge() const;
+    static Xcb::Property fetchShowOnScreenEdge(xcb_window_t window);
     void readShowOnScreenEdge(Xcb::Property &property);
     /**
      * Reads the property and creates/destroys the screen edge if required
@@ -464,6 +507,7 @@ private:
     MappingState mapping_state;
 
     Xcb::TransientFor fetchTransient() const;
+    static Xcb::TransientFor fetchTransient(xcb_window_t window);
     void readTransientProperty(Xcb::TransientFor &transientFor);
     void readTransient();
     xcb_window_t verifyTransientFor(xcb_window_t transient_for, bool set);
@@ -502,10 +546,12 @@ private:
     static bool check_active_modal; ///< \see X11Client::checkActiveModal()
     int sm_stacking_order;
     friend struct ResetupRulesProcedure;
+    friend class X11ManageRequests;
 
     friend bool performTransiencyCheck();
 
     Xcb::StringProperty fetchActivities() const;
+    static Xcb::StringProperty fetchActivities(xcb_window_t window);
     void readActivities(Xcb::StringProperty &property);
     void checkActivities();
     bool activitiesDefined; //whether the x property was actually set